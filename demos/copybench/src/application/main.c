@@ -0,0 +1,166 @@
+/*
+ * ARTICo3 test application
+ * Gather/scatter copy microbenchmark
+ *
+ * Main application
+ *
+ * This application measures the bandwidth of the memory copies performed
+ * by the ARTICo3 Daemon between user ports and DMA staging buffers. It
+ * reproduces the copies of an addvector-like kernel (two input ports and
+ * one output port, one slice per accelerator and port) and compares the
+ * original per-slice memcpy() loop against the gather/scatter copy engine
+ * with different numbers of worker threads, e.g.
+ *
+ *     ./copybench                  (default: 4 accelerators, 256 rounds)
+ *     ./copybench 8 1024           (8 accelerators, 1024 rounds)
+ *
+ * The staging buffer is allocated in DMA memory (coherent, i.e. usually
+ * non-cacheable) when the ARTICo3 device is available, and in regular
+ * memory otherwise. The Daemon can then be started with the best number
+ * of workers for the platform (A3_COPY_WORKERS environment variable).
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>   // memcpy(), memset()
+#include <time.h>     // clock_gettime()
+#include <unistd.h>   // close(), sysconf()
+#include <fcntl.h>    // open(), O_RDWR
+#include <sys/mman.h> // mmap()
+
+#include "artico3.h"
+#include "artico3_data.h"
+#include "artico3_copy.h"
+
+#define ITERATIONS (20)    // Number of measurements per configuration
+#define BANKWORDS  (1366)  // Words per memory bank (16kB, 3 banks)
+#define NPORTS     (3)     // Number of ports (2 inputs, 1 output)
+#define NINPUTS    (2)     // Number of input ports
+
+// Get current time (ns)
+static uint64_t now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((uint64_t)t.tv_sec * 1000000000) + t.tv_nsec;
+}
+
+// Build copy list for one transfer (gather: ports to staging, scatter: staging to ports)
+static unsigned int batch(struct a3copy_t *copies, a3data_t **ports, a3data_t *mem, unsigned int naccs, unsigned int round, int gather) {
+    unsigned int acc, port, ncopies = 0;
+
+    for (acc = 0; acc < naccs; acc++) {
+        for (port = 0; port < NPORTS; port++) {
+            // Inputs are gathered, outputs are scattered
+            if (gather != (port < NINPUTS)) continue;
+            a3data_t *dat = &ports[port][(round + acc) * BANKWORDS];
+            a3data_t *stg = &mem[(port * naccs * BANKWORDS) + (acc * BANKWORDS)];
+            copies[ncopies].dst = gather ? (void *)stg : (void *)dat;
+            copies[ncopies].src = gather ? (const void *)dat : (const void *)stg;
+            copies[ncopies].size = BANKWORDS * sizeof (a3data_t);
+            copies[ncopies].flags = gather ? A3_COPY_STREAM : 0;
+            ncopies++;
+        }
+    }
+
+    return ncopies;
+}
+
+// Measure one copy method (engine == NULL for the per-slice memcpy() loop)
+static double measure(struct a3copyengine_t *engine, a3data_t **ports, a3data_t *mem, unsigned int naccs, unsigned int nrounds, int gather) {
+    struct a3copy_t copies[NPORTS * 64];
+    unsigned int i, c, round, ncopies;
+    uint64_t t0, best = UINT64_MAX;
+    size_t bytes = 0;
+
+    for (i = 0; i < ITERATIONS; i++) {
+        bytes = 0;
+        t0 = now();
+        for (round = 0; round < nrounds; round += naccs) {
+            ncopies = batch(copies, ports, mem, naccs, round, gather);
+            if (engine) {
+                a3_copy_run(engine, copies, ncopies);
+            }
+            else {
+                for (c = 0; c < ncopies; c++) memcpy(copies[c].dst, copies[c].src, copies[c].size);
+            }
+            for (c = 0; c < ncopies; c++) bytes += copies[c].size;
+        }
+        t0 = now() - t0;
+        if (t0 < best) best = t0;
+    }
+
+    // Bandwidth (MB/s) of the best iteration
+    return (bytes / 1e6) / (best / 1e9);
+}
+
+int main(int argc, char *argv[]) {
+    unsigned int i, naccs, nrounds, nworkers, maxworkers;
+    a3data_t *ports[NPORTS], *mem = NULL;
+    struct a3copyengine_t engine;
+    size_t memsize;
+    int fd, dma, gather, errors;
+
+    /* Command line parsing */
+
+    naccs = (argc > 1) ? atoi(argv[1]) : 0;
+    naccs = ((naccs > 0) && (naccs <= 64)) ? naccs : 4;
+    nrounds = (argc > 2) ? atoi(argv[2]) : 0;
+    nrounds = (nrounds > 0) ? nrounds : 256;
+    nrounds = ((nrounds + naccs - 1) / naccs) * naccs;
+    maxworkers = a3_copy_workers();
+    printf("Using %u accelerators, %u rounds, %u bytes per slice, up to %u workers\n", naccs, nrounds, (unsigned int)(BANKWORDS * sizeof (a3data_t)), maxworkers);
+
+
+    /* APP */
+
+    // Allocate ports and staging buffer
+    for (i = 0; i < NPORTS; i++) {
+        ports[i] = malloc(nrounds * BANKWORDS * sizeof (a3data_t));
+        if (!ports[i]) return -1;
+        memset(ports[i], i + 1, nrounds * BANKWORDS * sizeof (a3data_t));
+    }
+    memsize = NPORTS * naccs * BANKWORDS * sizeof (a3data_t);
+    dma = 0;
+    fd = open("/dev/artico3", O_RDWR);
+    if (fd >= 0) {
+        mem = mmap(NULL, memsize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, sysconf(_SC_PAGESIZE));
+        if (mem == MAP_FAILED) mem = NULL;
+        dma = (mem != NULL);
+        close(fd);
+    }
+    if (!mem) mem = malloc(memsize);
+    if (!mem) return -1;
+    printf("Using %s staging buffer\n", dma ? "DMA" : "regular");
+    for (i = 0; i < (NPORTS * naccs * BANKWORDS); i++) mem[i] = i;
+
+    // Compare copy methods (gather and scatter)
+    for (gather = 1; gather >= 0; gather--) {
+        printf("%s :\n", gather ? "gather (ports -> staging)" : "scatter (staging -> ports)");
+        printf("    memcpy() loop       : %10.2f MB/s\n", measure(NULL, ports, mem, naccs, nrounds, gather));
+        for (nworkers = 0; nworkers <= maxworkers; nworkers++) {
+            if (a3_copy_init(&engine, nworkers) != 0) {
+                printf("    copy engine (%u)     : failed\n", nworkers);
+                a3_copy_clean(&engine);
+                continue;
+            }
+            printf("    copy engine (%u)     : %10.2f MB/s\n", nworkers, measure(&engine, ports, mem, naccs, nrounds, gather));
+            a3_copy_clean(&engine);
+        }
+    }
+
+    // Check results (last scatter copies the staging buffer to the output port)
+    errors = 0;
+    for (i = 0; i < (nrounds * BANKWORDS); i++) {
+        if (ports[NPORTS - 1][i] != mem[((NPORTS - 1) * naccs * BANKWORDS) + (i % (naccs * BANKWORDS))]) errors++;
+    }
+    printf("Found %d errors\n", errors);
+
+    // Release memory
+    for (i = 0; i < NPORTS; i++) free(ports[i]);
+    if (dma) munmap(mem, memsize);
+    else free(mem);
+
+    return errors;
+}
@@ -29,9 +29,9 @@ int main(int argc, char *argv[]) {
     struct timeval t0, tf;
     float t;
 
-    a3data_t *phase  = NULL;
-    a3data_t *cosine = NULL;
-    a3data_t *sine   = NULL;
+    float *phase  = NULL;
+    float *cosine = NULL;
+    float *sine   = NULL;
 
     /* Command line parsing */
 
@@ -65,17 +65,17 @@ int main(int argc, char *argv[]) {
     t = ((tf.tv_sec - t0.tv_sec) * 1000.0) + ((tf.tv_usec - t0.tv_usec) / 1000.0);
     printf("Kernel loading : %.6f ms\n", t);
 
-    // Allocate data buffers
-    phase  = artico3_alloc(naccs * VALUES * sizeof *phase, "cordic", "port0", A3_P_I);
-    cosine = artico3_alloc(naccs * VALUES * sizeof *cosine, "cordic", "port1", A3_P_O);
-    sine   = artico3_alloc(naccs * VALUES * sizeof *sine, "cordic", "port2", A3_P_O);
+    // Allocate data buffers (Q2.29 phase, Q1.30 cosine and sine, converted by the Daemon)
+    phase  = artico3_alloc_typed(naccs * VALUES * sizeof *phase, "cordic", "port0", A3_P_I, A3_T_Q(29));
+    cosine = artico3_alloc_typed(naccs * VALUES * sizeof *cosine, "cordic", "port1", A3_P_O, A3_T_Q(30));
+    sine   = artico3_alloc_typed(naccs * VALUES * sizeof *sine, "cordic", "port2", A3_P_O, A3_T_Q(30));
 
     // Initialize data buffers
     printf("Initializing data buffers...\n");
     srand(time(NULL));
     for (i = 0; i < naccs; i++) {
         for (j = 0; j < VALUES; j++) {
-            phase[(i * VALUES) + j] = (int32_t)((1 << 29) * (-M_PI + (j * ((2 * M_PI) / VALUES))));
+            phase[(i * VALUES) + j] = -M_PI + (j * ((2 * M_PI) / VALUES));
         }
     }
 
@@ -98,11 +98,11 @@ int main(int argc, char *argv[]) {
     for (i = 0; i < naccs; i++) {
         for (j = 0; j < VALUES; j++) {
             float phase_hw, cos_sw, sin_sw, cos_hw, sin_hw, error;
-            phase_hw  = ((float)(int32_t)phase[(i * VALUES) + j]) / (1 << 29);
+            phase_hw  = phase[(i * VALUES) + j];
             cos_sw    = cos(phase_hw);
             sin_sw    = sin(phase_hw);
-            cos_hw    = ((float)(int32_t)cosine[(i * VALUES) + j]) / (1 << 30);
-            sin_hw    = ((float)(int32_t)sine[(i * VALUES) + j]) / (1 << 30);
+            cos_hw    = cosine[(i * VALUES) + j];
+            sin_hw    = sine[(i * VALUES) + j];
             error     = fabsf(cos_hw - cos_sw);
             max_error = (error > max_error) ? error : max_error;
             if (error > 1e-6) errors++;
@@ -0,0 +1,209 @@
+/*
+ * ARTICo3 test application
+ * DMA memory microbenchmark
+ *
+ * Main application
+ *
+ * This application compares the DMA memory types supported by the
+ * ARTICo3 infrastructure using an addvector kernel (two input banks and
+ * one output bank), for buffer sizes that range from one block (one
+ * memory bank) up to the number of blocks specified by the user, e.g.
+ *
+ *     ./dmabench                   (default: up to 256 blocks)
+ *     ./dmabench 1024              (up to 1024 blocks)
+ *
+ * For each buffer size, three port configurations are measured:
+ *
+ *     regular   : POSIX shared memory ports, copied by the Daemon to/from
+ *                 its DMA staging buffers
+ *     coherent  : zero-copy ports in coherent DMA memory
+ *     cached    : zero-copy ports in cached DMA memory (A3_P_CACHED)
+ *
+ * The application reports the copy throughput (memcpy() from/to regular
+ * memory, i.e. the cost of filling the input ports and reading the output
+ * port) and the DMA throughput (kernel execution, including the staging
+ * copies and cache maintenance performed by the Daemon). The DMA staging
+ * buffers used for the regular ports are coherent by default, and can be
+ * made cached by starting the Daemon with A3_DMA_CACHED=1.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>   // memcpy(), memset()
+#include <time.h>     // clock_gettime()
+
+#include "artico3.h"
+
+#define ITERATIONS (10)    // Number of measurements per configuration
+#define BANKWORDS  (1366)  // Words per memory bank (16kB, 3 banks)
+#define MAXBLOCKS  (256)   // Default maximum number of blocks
+
+enum mode_t {MODE_REGULAR, MODE_COHERENT, MODE_CACHED};
+static const char *modes[] = {"regular", "coherent", "cached"};
+
+struct result_t {
+    double copyin;
+    double copyout;
+    double dma;
+};
+
+// Get current time (ns)
+static uint64_t now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((uint64_t)t.tv_sec * 1000000000) + t.tv_nsec;
+}
+
+// Measure one port configuration (returns number of errors, or -1 if ports cannot be allocated)
+static int measure(enum mode_t mode, unsigned int blocks, a3data_t *a, a3data_t *b, a3data_t *c, struct result_t *res) {
+    a3data_t *pa = NULL, *pb = NULL, *pc = NULL, *ab = NULL;
+    size_t bytes = blocks * BANKWORDS * sizeof (a3data_t);
+    uint64_t t0, tin = UINT64_MAX, tout = UINT64_MAX, tdma = UINT64_MAX;
+    unsigned int i, w;
+    int errors;
+
+    // Allocate ports (zero-copy input ports use the hardware layout, i.e. interleaved banks)
+    if (mode == MODE_REGULAR) {
+        pa = artico3_alloc(bytes, "addvector", "a", A3_P_I);
+        pb = artico3_alloc(bytes, "addvector", "b", A3_P_I);
+        pc = artico3_alloc(bytes, "addvector", "c", A3_P_O);
+        if (!pa || !pb || !pc) goto err_alloc;
+    }
+    else {
+        ab = artico3_alloc_zc(2 * bytes, "addvector", "ab", A3_P_I | ((mode == MODE_CACHED) ? A3_P_CACHED : 0), 2);
+        pc = artico3_alloc_zc(bytes, "addvector", "c", A3_P_O | ((mode == MODE_CACHED) ? A3_P_CACHED : 0), 1);
+        if (!ab || !pc) goto err_alloc;
+    }
+
+    for (i = 0; i < ITERATIONS; i++) {
+        memset(c, 0, bytes);
+
+        // Fill input ports
+        t0 = now();
+        if (ab) {
+            for (w = 0; w < blocks; w++) {
+                memcpy(&ab[(2 * w) * BANKWORDS], &a[w * BANKWORDS], BANKWORDS * sizeof (a3data_t));
+                memcpy(&ab[(2 * w + 1) * BANKWORDS], &b[w * BANKWORDS], BANKWORDS * sizeof (a3data_t));
+            }
+        }
+        else {
+            memcpy(pa, a, bytes);
+            memcpy(pb, b, bytes);
+        }
+        t0 = now() - t0;
+        if (t0 < tin) tin = t0;
+
+        // Execute kernel
+        t0 = now();
+        artico3_kernel_execute("addvector", blocks * BANKWORDS, BANKWORDS);
+        artico3_kernel_wait("addvector");
+        t0 = now() - t0;
+        if (t0 < tdma) tdma = t0;
+
+        // Read output port
+        t0 = now();
+        memcpy(c, pc, bytes);
+        t0 = now() - t0;
+        if (t0 < tout) tout = t0;
+    }
+
+    // Check results
+    errors = 0;
+    for (i = 0; i < (blocks * BANKWORDS); i++) {
+        if (c[i] != (a[i] + b[i])) errors++;
+    }
+
+    // Bandwidth (MB/s) of the best iteration
+    res->copyin = ((2 * bytes) / 1e6) / (tin / 1e9);
+    res->copyout = (bytes / 1e6) / (tout / 1e9);
+    res->dma = ((3 * bytes) / 1e6) / (tdma / 1e9);
+
+    // Release ports
+    if (ab) {
+        artico3_free("addvector", "ab");
+        artico3_free("addvector", "c");
+    }
+    else {
+        artico3_free("addvector", "a");
+        artico3_free("addvector", "b");
+        artico3_free("addvector", "c");
+    }
+
+    return errors;
+
+err_alloc:
+    if (pa) artico3_free("addvector", "a");
+    if (pb) artico3_free("addvector", "b");
+    if (ab) artico3_free("addvector", "ab");
+    if (pc) artico3_free("addvector", "c");
+    return -1;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned int i, blocks, maxblocks;
+    a3data_t *a = NULL, *b = NULL, *c = NULL;
+    struct result_t res;
+    enum mode_t mode;
+    int ret, errors;
+
+    /* Command line parsing */
+
+    maxblocks = (argc > 1) ? atoi(argv[1]) : 0;
+    maxblocks = ((maxblocks > 0) && (maxblocks <= 65536)) ? maxblocks : MAXBLOCKS;
+    printf("Using up to %u blocks, %u bytes per block and port\n", maxblocks, (unsigned int)(BANKWORDS * sizeof (a3data_t)));
+
+
+    /* APP */
+
+    // Allocate reference data
+    a = malloc(maxblocks * BANKWORDS * sizeof *a);
+    b = malloc(maxblocks * BANKWORDS * sizeof *b);
+    c = malloc(maxblocks * BANKWORDS * sizeof *c);
+    if (!a || !b || !c) return -1;
+    for (i = 0; i < (maxblocks * BANKWORDS); i++) {
+        a[i] = i;
+        b[i] = 3 * i;
+    }
+
+    // Initialize ARTICo3 infrastructure
+    ret = artico3_init();
+    if (ret < 0) return -1;
+
+    // Create kernel instance and load accelerators
+    artico3_kernel_create("addvector", 16384, 3, 0);
+    artico3_load("addvector", 0, 0, 0, 1);
+    artico3_load("addvector", 1, 0, 0, 1);
+    artico3_load("addvector", 2, 0, 0, 1);
+    artico3_load("addvector", 3, 0, 0, 1);
+
+    // Compare port configurations across buffer sizes
+    errors = 0;
+    printf("%10s | %-8s | %16s | %16s | %16s\n", "size (kB)", "mode", "copy in (MB/s)", "copy out (MB/s)", "DMA (MB/s)");
+    for (blocks = 1; blocks <= maxblocks; blocks *= 2) {
+        for (mode = MODE_REGULAR; mode <= MODE_CACHED; mode++) {
+            ret = measure(mode, blocks, a, b, c, &res);
+            if (ret < 0) {
+                printf("%10.1f | %-8s | %16s | %16s | %16s\n", (blocks * BANKWORDS * sizeof (a3data_t)) / 1024.0, modes[mode], "failed", "failed", "failed");
+                continue;
+            }
+            printf("%10.1f | %-8s | %16.2f | %16.2f | %16.2f\n", (blocks * BANKWORDS * sizeof (a3data_t)) / 1024.0, modes[mode], res.copyin, res.copyout, res.dma);
+            errors += ret;
+        }
+    }
+    printf("Found %d errors\n", errors);
+
+    // Release kernel instance
+    artico3_kernel_release("addvector");
+
+    // Clean ARTICo3 setup
+    artico3_exit();
+
+    // Release reference data
+    free(a);
+    free(b);
+    free(c);
+
+    return errors;
+}
@@ -0,0 +1,172 @@
+/*
+ * ARTICo3 test application
+ * Request round-trip latency
+ *
+ * Main application
+ *
+ * This application measures the round-trip latency of short control
+ * requests (kernel reset, configuration register read) between the user
+ * and the ARTICo3 Daemon, and prints their distribution. Run it (and the
+ * Daemon) with different spin budgets to compare spin-then-sleep against
+ * sleeping right away, e.g.
+ *
+ *     A3_SPIN_BUDGET=0 ./daemon    A3_SPIN_BUDGET=0 ./latency
+ *     ./daemon                     ./latency
+ *
+ * The Daemon-side breakdown of each measurement (queue-wait, dispatch
+ * and service time) is read from the Daemon statistics shared memory
+ * object, as any external monitoring tool would do.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>     // clock_gettime()
+#include <unistd.h>   // close()
+#include <fcntl.h>    // O_RDONLY
+#include <sys/mman.h> // shm_open(), mmap()
+
+#include "artico3.h"
+#include "artico3_data.h"
+
+#define ITERATIONS (10000) // Number of requests to measure
+#define BUCKETS    (32)    // Number of histogram buckets (log2 of latency in ns)
+
+// Get current time (ns)
+static uint64_t now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return ((uint64_t)t.tv_sec * 1000000000) + t.tv_nsec;
+}
+
+// Sort latencies (ascending)
+static int compare(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Print latency distribution
+static void report(const char *name, uint64_t *lat, unsigned int n) {
+    unsigned int i, bucket, hist[BUCKETS] = {0};
+    uint64_t sum = 0;
+
+    for (i = 0; i < n; i++) {
+        for (bucket = 0; (bucket < (BUCKETS - 1)) && ((1ull << (bucket + 1)) <= lat[i]); bucket++);
+        hist[bucket]++;
+        sum += lat[i];
+    }
+    qsort(lat, n, sizeof *lat, compare);
+
+    printf("%s : %u requests\n", name, n);
+    printf("    mean %8.2f us | p50 %8.2f us | p90 %8.2f us | p99 %8.2f us | max %8.2f us\n",
+        (sum / (double)n) / 1000.0, lat[n / 2] / 1000.0, lat[(n * 9) / 10] / 1000.0, lat[(n * 99) / 100] / 1000.0, lat[n - 1] / 1000.0);
+    for (bucket = 0; bucket < BUCKETS; bucket++) {
+        if (!hist[bucket]) continue;
+        printf("    [%8.2f us, %8.2f us) %6u ", (1ull << bucket) / 1000.0, (2ull << bucket) / 1000.0, hist[bucket]);
+        for (i = 0; i < (hist[bucket] * 50) / n; i++) printf("#");
+        printf("\n");
+    }
+}
+
+// Print Daemon-side latency breakdown (difference between two snapshots)
+static void breakdown(const struct a3stats_t *stats, enum a3func_t func, const struct a3funcstats_t *before) {
+    const struct a3funcstats_t *after = &stats->funcs[func];
+    uint64_t n = after->service.count - before->service.count;
+
+    if (!n) return;
+    printf("    daemon (%s) : queue %8.2f us | dispatch %8.2f us | service %8.2f us | errors %llu\n", after->name,
+        ((after->queue.sum - before->queue.sum) / (double)n) / 1000.0,
+        ((after->dispatch.sum - before->dispatch.sum) / (double)n) / 1000.0,
+        ((after->service.sum - before->service.sum) / (double)n) / 1000.0,
+        (unsigned long long)(after->errors - before->errors));
+}
+
+int main(int argc, char *argv[]) {
+    unsigned int i, iterations;
+    int kernel;
+    uint64_t t0, *lat = NULL;
+    a3data_t cfg[16];
+    int fd;
+    const struct a3stats_t *stats = NULL;
+    struct a3funcstats_t before;
+
+    /* Command line parsing */
+
+    iterations = 0;
+    if (argc > 1) {
+        iterations = atoi(argv[1]);
+    }
+    iterations = (iterations > 0) ? iterations : ITERATIONS;
+    printf("Using %d iterations (A3_SPIN_BUDGET=%s)\n", iterations, getenv("A3_SPIN_BUDGET") ? getenv("A3_SPIN_BUDGET") : "default");
+
+    lat = malloc(iterations * sizeof *lat);
+    if (!lat) return -1;
+
+
+    /* APP */
+
+    // Initialize ARTICo3 infrastructure
+    artico3_init();
+
+    // Map Daemon statistics (read-only)
+    fd = shm_open(A3_STATS_FILENAME, O_RDONLY, 0);
+    if (fd >= 0) {
+        stats = mmap(0, sizeof *stats, PROT_READ, MAP_SHARED, fd, 0);
+        if (stats == MAP_FAILED) stats = NULL;
+        close(fd);
+    }
+
+    // Create kernel instance
+    kernel = artico3_kernel_create("addvector", 16384, 3, 0);
+
+    // Load accelerators
+    artico3_load("addvector", 0, 0, 0, 0);
+
+    // Warm up
+    for (i = 0; i < 100; i++) {
+        artico3_kernel_reset("addvector");
+    }
+
+    // Single request round trip
+    if (stats) before = stats->funcs[A3_F_KERNEL_RESET];
+    for (i = 0; i < iterations; i++) {
+        t0 = now();
+        artico3_kernel_reset("addvector");
+        lat[i] = now() - t0;
+    }
+    report("artico3_kernel_reset()", lat, iterations);
+    if (stats) breakdown(stats, A3_F_KERNEL_RESET, &before);
+
+    // Single request round trip (kernel handle)
+    if (stats) before = stats->funcs[A3_F_KERNEL_RESET];
+    for (i = 0; i < iterations; i++) {
+        t0 = now();
+        artico3_kernel_reset_h(kernel);
+        lat[i] = now() - t0;
+    }
+    report("artico3_kernel_reset_h()", lat, iterations);
+    if (stats) breakdown(stats, A3_F_KERNEL_RESET, &before);
+
+    // Configuration register read round trip
+    if (stats) before = stats->funcs[A3_F_KERNEL_RCFG];
+    for (i = 0; i < iterations; i++) {
+        t0 = now();
+        artico3_kernel_rcfg("addvector", 0x000, cfg);
+        lat[i] = now() - t0;
+    }
+    report("artico3_kernel_rcfg()", lat, iterations);
+    if (stats) breakdown(stats, A3_F_KERNEL_RCFG, &before);
+
+    // Release kernel instance
+    artico3_kernel_release("addvector");
+
+    // Clean ARTICo3 setup
+    if (stats) munmap((void *)stats, sizeof *stats);
+    artico3_exit();
+
+    free(lat);
+
+    return 0;
+}
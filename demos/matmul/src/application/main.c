@@ -7,6 +7,13 @@
  *
  * Main application
  *
+ * The matrices are split in MSIZE_ACC x MSIZE_ACC blocks, and each
+ * work-group computes the product of one block of A and one block of B.
+ * The input ports hold the whole matrices, and port views select the
+ * blocks of each work-group: for each row of blocks of the result, the
+ * work-groups go through the blocks of the corresponding row of A (same
+ * row for every block column) and through the columns of blocks of B.
+ *
  */
 
 #include <stdio.h>
@@ -35,14 +42,13 @@ void matmul_sw(int size, a3data_t a[size], a3data_t b[size], a3data_t c[size]) {
 
 int main(int argc, char *argv[]) {
     unsigned int i, j, k, i2, j2, errors, naccs;
+    struct a3view_t view;
     struct timeval t0, tf;
     float t_hw, t_sw;
 
     a3data_t *a = NULL;
     a3data_t *b = NULL;
     a3data_t *hw = NULL;
-    a3data_t *a_local = NULL;
-    a3data_t *b_local = NULL;
     a3data_t *hw_local = NULL;
     a3data_t *sw = NULL;
 
@@ -70,15 +76,27 @@ int main(int argc, char *argv[]) {
     printf("Kernel loading : %.6f ms\n", t_hw);
 
     // Allocate memory
-    a = malloc(MSIZE_APP * MSIZE_APP * sizeof *a);
-    b = malloc(MSIZE_APP * MSIZE_APP * sizeof *b);
     hw = malloc(MSIZE_APP * MSIZE_APP * sizeof *hw);
     sw = malloc(MSIZE_APP * MSIZE_APP * sizeof *sw);
 
-    // Allocate data buffers
-    a_local = artico3_alloc(MSIZE_APP * MSIZE_ACC * sizeof *a_local, "matmul", "a", A3_P_I);
-    b_local = artico3_alloc(MSIZE_APP * MSIZE_ACC * sizeof *b_local, "matmul", "b", A3_P_I);
-    hw_local = artico3_alloc(MSIZE_APP * MSIZE_ACC * sizeof *hw_local, "matmul", "hw", A3_P_O);
+    // Allocate data buffers (partial products are stored one block after
+    // the other, for a whole row of blocks of the result)
+    a = artico3_alloc(MSIZE_APP * MSIZE_APP * sizeof *a, "matmul", "a", A3_P_I);
+    b = artico3_alloc(MSIZE_APP * MSIZE_APP * sizeof *b, "matmul", "b", A3_P_I);
+    hw_local = artico3_alloc(MSIZE_APP * MSIZE_APP * sizeof *hw_local, "matmul", "hw", A3_P_O);
+
+    // Set port views (work-group t multiplies block (i, t % 8) of A and
+    // block (t % 8, t / 8) of B, with 8 blocks per matrix row)
+    view.stride = MSIZE_APP;
+    view.rows = MSIZE_ACC;
+    view.cols = MSIZE_ACC;
+    view.ntiles = MSIZE_APP / MSIZE_ACC;
+    view.offset = 0;
+    view.tstep = MSIZE_ACC * MSIZE_APP;
+    view.gstep = MSIZE_ACC;
+    artico3_port_view("matmul", "b", &view);
+    view.tstep = MSIZE_ACC;
+    view.gstep = 0;
 
     // Initialize data buffers
     printf("Initializing data buffers...\n");
@@ -93,30 +111,23 @@ int main(int argc, char *argv[]) {
     gettimeofday(&t0, NULL);
 
     for (i = 0; i < MSIZE_APP; i += MSIZE_ACC) {
+        // Select row of blocks of A
+        view.offset = i * MSIZE_APP;
+        artico3_port_view("matmul", "a", &view);
+        // Perform computation
+        artico3_kernel_execute("matmul", (MSIZE_APP / MSIZE_ACC) * MSIZE_APP, MSIZE_ACC);
+        artico3_kernel_wait("matmul");
+        // Accumulate partial outputs
         for (j = 0; j < MSIZE_APP; j += MSIZE_ACC) {
-            // Initialize accumulator
             for (i2 = 0; i2 < MSIZE_ACC; i2++) {
                 for (j2 = 0; j2 < MSIZE_ACC; j2++) {
                     hw[((i + i2) * MSIZE_APP) + (j + j2)] = 0;
                 }
             }
-            // Copy partial inputs
-            for (k = 0; k < MSIZE_APP; k+=MSIZE_ACC) {
-                for (i2 = 0; i2 < MSIZE_ACC; i2++) {
-                    for (j2 = 0; j2 < MSIZE_ACC; j2++) {
-                        a_local[((i2 + k) * MSIZE_ACC) + j2] = a[((i + i2) * MSIZE_APP) + (k + j2)];
-                        b_local[((i2 + k) * MSIZE_ACC) + j2] = b[((k + i2) * MSIZE_APP) + (j + j2)];
-                    }
-                }
-            }
-            // Perform computation
-            artico3_kernel_execute("matmul", MSIZE_APP, MSIZE_ACC);
-            artico3_kernel_wait("matmul");
-            // Copy partial output
-            for (k = 0; k < MSIZE_APP; k+=MSIZE_ACC) {
+            for (k = 0; k < MSIZE_APP; k += MSIZE_ACC) {
                 for (i2 = 0; i2 < MSIZE_ACC; i2++) {
                     for (j2 = 0; j2 < MSIZE_ACC; j2++) {
-                        hw[((i + i2) * MSIZE_APP) + (j + j2)] += hw_local[((i2 + k)* MSIZE_ACC) + j2];
+                        hw[((i + i2) * MSIZE_APP) + (j + j2)] += hw_local[(j * MSIZE_APP) + ((k + i2) * MSIZE_ACC) + j2];
                     }
                 }
             }
@@ -179,8 +190,6 @@ int main(int argc, char *argv[]) {
     }
 
     // Free software result memory
-    free(a);
-    free(b);
     free(hw);
     free(sw);
 
@@ -0,0 +1,259 @@
+/*
+ * ARTICo3 request arguments
+ *
+ * Description : This file contains the primitives used to pack (user) and
+ *               parse (daemon) request arguments in the per-user argument
+ *               arena.
+ *
+ *               Every access is bounds-checked against the payload size.
+ *               Errors are sticky: once an access fails, the following ones
+ *               are ignored, so that callers only need to check @error
+ *               after packing/parsing all the arguments. Strings are stored
+ *               length-prefixed (including the '\0' terminator), and are
+ *               parsed in place (the daemon parses a private copy of the
+ *               payload, which the user cannot modify).
+ *
+ */
+
+
+#ifndef _ARTICO3_ARGS_H_
+#define _ARTICO3_ARGS_H_
+
+#include <stdint.h> // uint32_t
+#include <string.h> // memcpy(), memset(), strlen()
+#include <errno.h>  // EMSGSIZE
+
+#include "artico3_data.h"
+
+
+/*
+ * ARTICo3 argument cursor
+ *
+ * @data  : request payload
+ * @size  : size (in bytes) of the request payload
+ * @pos   : current position inside the request payload
+ * @error : 0 if every access was inside the payload, error code otherwise
+ * @user  : ID of the user that sent the request (set by the daemon from
+ *          the submission queue, -1 otherwise)
+ *
+ */
+struct a3args_t {
+    char *data;
+    uint32_t size;
+    uint32_t pos;
+    int error;
+    int user;
+};
+
+
+/*
+ * ARTICo3 argument cursor init
+ *
+ * @args : argument cursor
+ * @data : request payload
+ * @size : size (in bytes) of the request payload
+ *
+ */
+static inline void a3_args_init(struct a3args_t *args, void *data, uint32_t size) {
+    args->data = data;
+    args->size = size;
+    args->pos = 0;
+    args->error = 0;
+    args->user = -1;
+}
+
+
+/*
+ * ARTICo3 argument alignment
+ *
+ * @n : number of bytes
+ *
+ * Return : @n rounded up to a multiple of A3_ARGS_ALIGN
+ *
+ */
+static inline uint32_t a3_args_align(uint32_t n) {
+    return (n + A3_ARGS_ALIGN - 1) & ~(uint32_t)(A3_ARGS_ALIGN - 1);
+}
+
+
+/*
+ * ARTICo3 argument string size
+ *
+ * @str : string to be packed
+ *
+ * Return : number of payload bytes required to pack @str
+ *
+ */
+static inline uint32_t a3_args_strsize(const char *str) {
+    return sizeof (uint32_t) + strlen(str) + 1;
+}
+
+
+/*
+ * ARTICo3 argument reserve
+ *
+ * This function advances the cursor, returning the (in-place) location
+ * of the next @n bytes of the payload.
+ *
+ * @args : argument cursor
+ * @n    : number of bytes
+ *
+ * Return : pointer to the payload bytes on success, NULL otherwise
+ *
+ */
+static inline void *a3_args_reserve(struct a3args_t *args, uint32_t n) {
+    void *ptr = NULL;
+
+    if (args->error) return NULL;
+    if (n > (args->size - args->pos)) {
+        args->error = -EMSGSIZE;
+        return NULL;
+    }
+    ptr = &(args->data[args->pos]);
+    args->pos += n;
+
+    return ptr;
+}
+
+
+/*
+ * ARTICo3 argument put
+ *
+ * @args : argument cursor
+ * @src  : argument value
+ * @n    : argument size (in bytes)
+ *
+ */
+static inline void a3_args_put(struct a3args_t *args, const void *src, uint32_t n) {
+    void *ptr = a3_args_reserve(args, n);
+    if (ptr) memcpy(ptr, src, n);
+}
+
+
+/*
+ * ARTICo3 argument get
+ *
+ * @args : argument cursor
+ * @dst  : argument value (zeroed if outside the payload)
+ * @n    : argument size (in bytes)
+ *
+ */
+static inline void a3_args_get(struct a3args_t *args, void *dst, uint32_t n) {
+    void *ptr = a3_args_reserve(args, n);
+    if (ptr) memcpy(dst, ptr, n);
+    else memset(dst, 0, n);
+}
+
+
+/*
+ * ARTICo3 argument put string
+ *
+ * @args : argument cursor
+ * @str  : string to be packed
+ *
+ */
+static inline void a3_args_put_str(struct a3args_t *args, const char *str) {
+    uint32_t len = strlen(str) + 1;
+
+    a3_args_put(args, &len, sizeof len);
+    a3_args_put(args, str, len);
+}
+
+
+/*
+ * ARTICo3 argument get string
+ *
+ * @args : argument cursor
+ *
+ * Return : pointer to the (in-place) string on success, NULL otherwise
+ *
+ * NOTE : the string is only checked when it is parsed, so the payload must
+ *        not be writable by others while the string is used.
+ *
+ */
+static inline const char *a3_args_get_str(struct a3args_t *args) {
+    uint32_t len = 0;
+    char *str = NULL;
+
+    a3_args_get(args, &len, sizeof len);
+    str = a3_args_reserve(args, len);
+    if (!str) return NULL;
+    if ((len == 0) || (str[len - 1] != '\0')) {
+        args->error = -EMSGSIZE;
+        return NULL;
+    }
+
+    return str;
+}
+
+
+/*
+ * ARTICo3 argument kernel reference size
+ *
+ * @kernel : kernel handle (0 to reference the kernel by name)
+ * @name   : kernel name (NULL to reference the kernel by handle only)
+ *
+ * Return : number of payload bytes required to pack the kernel reference
+ *
+ */
+static inline uint32_t a3_args_kernsize(int kernel, const char *name) {
+    return sizeof (int) + (((kernel > 0) || !name) ? 0 : a3_args_strsize(name));
+}
+
+
+/*
+ * ARTICo3 argument put kernel reference
+ *
+ * Kernels are referenced by handle, or by name (handle 0) when the
+ * handle is not known yet (e.g. kernels created in the same batch).
+ *
+ * @args   : argument cursor
+ * @kernel : kernel handle (0 to reference the kernel by name)
+ * @name   : kernel name (NULL to reference the kernel by handle only)
+ *
+ */
+static inline void a3_args_put_kernel(struct a3args_t *args, int kernel, const char *name) {
+    int ref = 0;
+
+    if ((kernel > 0) || !name) {
+        a3_args_put(args, &kernel, sizeof kernel);
+    }
+    else {
+        a3_args_put(args, &ref, sizeof ref);
+        a3_args_put_str(args, name);
+    }
+}
+
+
+/*
+ * ARTICo3 argument get kernel reference
+ *
+ * @args : argument cursor
+ * @name : kernel name (NULL if the kernel is referenced by handle)
+ *
+ * Return : kernel handle (0 if the kernel is referenced by name)
+ *
+ */
+static inline int a3_args_get_kernel(struct a3args_t *args, const char **name) {
+    int kernel;
+
+    a3_args_get(args, &kernel, sizeof kernel);
+    *name = kernel ? NULL : a3_args_get_str(args);
+
+    return kernel;
+}
+
+
+/*
+ * ARTICo3 argument bytes left
+ *
+ * @args : argument cursor
+ *
+ * Return : number of payload bytes after the current position
+ *
+ */
+static inline uint32_t a3_args_left(struct a3args_t *args) {
+    return args->error ? 0 : (args->size - args->pos);
+}
+
+#endif /* _ARTICO3_ARGS_H_ */
@@ -0,0 +1,628 @@
+/*
+ * ARTICo3 gather/scatter copy engine
+ *
+ * Description : This file contains the engine used to perform the memory
+ *               copies between user buffers and DMA staging buffers. Each
+ *               batch of copies (one per accelerator and port) is split in
+ *               parts of similar size, which are performed in parallel by
+ *               the calling thread and a small set of worker threads pinned
+ *               to the last cores of the system. Copies to DMA staging
+ *               buffers (coherent, i.e. non-cacheable, memory that is never
+ *               read back by the processor) use vectorized loads and
+ *               non-temporal stores when the platform supports them (NEON
+ *               on ARM, SSE2 on x86). Copies to user buffers, which are
+ *               read back by the application, use memcpy().
+ *
+ *               Copies of typed ports (see A3_T_* in artico3_data.h) are
+ *               converted on the fly: floating point data is converted
+ *               to/from fixed point (and packed/unpacked to/from 16-bit
+ *               half-words) four or eight elements at a time with vector
+ *               instructions when available.
+ *
+ *               The number of workers defaults to the number of online
+ *               processors minus one (up to A3_COPY_MAXWORKERS), and can be
+ *               overridden at runtime with the environment variable
+ *               A3_COPY_WORKERS (0 disables the workers).
+ *
+ */
+
+
+#ifndef _ARTICO3_COPY_H_
+#define _ARTICO3_COPY_H_
+
+#include <stdint.h>       // uint8_t, uint32_t, uintptr_t
+#include <stdlib.h>       // getenv(), strtol()
+#include <string.h>       // memcpy(), memset()
+#include <errno.h>        // ENOMEM
+#include <pthread.h>      // pthread_create(), pthread_join()
+#include <unistd.h>       // syscall(), sysconf()
+#include <sys/syscall.h>  // SYS_sched_setaffinity
+
+#if defined(__aarch64__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+    // NEON intrinsics (aarch64 streaming copies use inline assembly)
+    #include <arm_neon.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+#include "artico3_data.h"
+#include "artico3_sync.h"
+
+#define A3_COPY_MAXWORKERS (7)       // Maximum number of copy workers
+#define A3_COPY_MINPART    (1 << 16) // Minimum number of bytes per part (smaller batches are not split)
+
+#define A3_COPY_STREAM     (1 << 0)  // Copy flag: use non-temporal stores (destination not read back)
+#define A3_COPY_UNPACK     (1 << 1)  // Copy flag: convert from hardware data (source) to @dtype (destination)
+
+
+/*
+ * ARTICo3 copy (one contiguous memory copy in a batch)
+ *
+ * @dst   : destination address
+ * @src   : source address
+ * @size  : number of bytes to be copied (hardware side, i.e. in the DMA
+ *          staging buffer, for typed copies)
+ * @flags : copy flags (A3_COPY_STREAM, A3_COPY_UNPACK)
+ * @dtype : data type of the application side of the copy (A3_T_*), data
+ *          is converted to hardware data unless A3_COPY_UNPACK is set
+ *
+ */
+struct a3copy_t {
+    void *dst;
+    const void *src;
+    size_t size;
+    unsigned int flags;
+    unsigned int dtype;
+};
+
+
+/*
+ * ARTICo3 copy worker
+ *
+ * @engine : copy engine the worker belongs to
+ * @thread : worker thread
+ * @cpu    : processor the worker is pinned to
+ * @go     : futex word (1 when a part has been assigned to the worker)
+ * @start  : first byte of the assigned part (offset in the batch)
+ * @end    : last byte (excluded) of the assigned part (offset in the batch)
+ *
+ */
+struct a3copyworker_t {
+    struct a3copyengine_t *engine;
+    pthread_t thread;
+    unsigned int cpu;
+    uint32_t go;
+    size_t start;
+    size_t end;
+};
+
+
+/*
+ * ARTICo3 copy engine
+ *
+ * @nworkers : number of worker threads
+ * @workers  : worker threads
+ * @lock     : synchronization primitive to run one batch at a time
+ * @copies   : current batch of copies
+ * @ncopies  : number of copies in the current batch
+ * @pending  : futex word (number of workers still copying the current batch)
+ * @shutdown : flag to command the workers to finish
+ *
+ */
+struct a3copyengine_t {
+    unsigned int nworkers;
+    struct a3copyworker_t workers[A3_COPY_MAXWORKERS];
+    pthread_mutex_t lock;
+    const struct a3copy_t *copies;
+    unsigned int ncopies;
+    uint32_t pending;
+    int shutdown;
+};
+
+
+/*
+ * ARTICo3 copy memory block (streaming)
+ *
+ * This function copies a contiguous memory block, using vectorized loads
+ * and non-temporal stores when available (the tail, and the head until
+ * the destination is aligned, are copied with memcpy()).
+ *
+ * @dst  : destination address
+ * @src  : source address
+ * @size : number of bytes to be copied
+ *
+ */
+static inline void a3_copy_stream(void *dst, const void *src, size_t size) {
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+#if defined(__aarch64__) || defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__SSE2__)
+    size_t head;
+
+    // Align destination to 16 bytes
+    head = (16 - ((uintptr_t)d & 15)) & 15;
+    if (head > size) head = size;
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    size -= head;
+#endif
+
+#if defined(__aarch64__)
+    for (; size >= 64; size -= 64, d += 64, s += 64) {
+        __asm__ __volatile__ (
+            "ldp  q0, q1, [%1]\n\t"
+            "ldp  q2, q3, [%1, #32]\n\t"
+            "stnp q0, q1, [%0]\n\t"
+            "stnp q2, q3, [%0, #32]\n\t"
+            : : "r" (d), "r" (s) : "v0", "v1", "v2", "v3", "memory");
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    // ARMv7 has no non-temporal stores (wide stores are merged in the write buffer)
+    for (; size >= 64; size -= 64, d += 64, s += 64) {
+        uint8x16_t v0, v1, v2, v3;
+        __builtin_prefetch(s + 256);
+        v0 = vld1q_u8(s);
+        v1 = vld1q_u8(s + 16);
+        v2 = vld1q_u8(s + 32);
+        v3 = vld1q_u8(s + 48);
+        vst1q_u8(d, v0);
+        vst1q_u8(d + 16, v1);
+        vst1q_u8(d + 32, v2);
+        vst1q_u8(d + 48, v3);
+    }
+#elif defined(__SSE2__)
+    for (; size >= 64; size -= 64, d += 64, s += 64) {
+        __m128i v0, v1, v2, v3;
+        v0 = _mm_loadu_si128((const __m128i *)s);
+        v1 = _mm_loadu_si128((const __m128i *)(s + 16));
+        v2 = _mm_loadu_si128((const __m128i *)(s + 32));
+        v3 = _mm_loadu_si128((const __m128i *)(s + 48));
+        _mm_stream_si128((__m128i *)d, v0);
+        _mm_stream_si128((__m128i *)(d + 16), v1);
+        _mm_stream_si128((__m128i *)(d + 32), v2);
+        _mm_stream_si128((__m128i *)(d + 48), v3);
+    }
+    // Non-temporal stores are weakly ordered
+    _mm_sfence();
+#endif
+
+    memcpy(d, s, size);
+}
+
+
+/*
+ * ARTICo3 convert floating point to fixed point (scalar)
+ *
+ * @x     : floating point value
+ * @scale : fixed point scale (2 to the number of fractional bits)
+ *
+ * Return : 32-bit fixed point value (rounded to nearest, saturated)
+ *
+ * NOTE   : rounding is performed on the truncated value and its remainder
+ *          (which are exact), since adding 0.5 before truncating is not
+ *          (e.g. 0.49999997f + 0.5f rounds to 1.0f)
+ *
+ */
+static inline int32_t a3_copy_ftoq(float x, float scale) {
+    float v = x * scale, r;
+    int32_t q;
+
+    if (v >= 2147483648.0f) return INT32_MAX;
+    if (!(v >= -2147483648.0f)) return INT32_MIN;
+    q = (int32_t)v;
+    r = v - (float)q;
+    if (r >= 0.5f) q++;
+    else if (r <= -0.5f) q--;
+    return q;
+}
+
+
+/*
+ * ARTICo3 convert floating point to 16-bit fixed point (scalar)
+ *
+ * @x     : floating point value
+ * @scale : fixed point scale (2 to the number of fractional bits)
+ *
+ * Return : 16-bit fixed point value (rounded to nearest, saturated)
+ *
+ */
+static inline int16_t a3_copy_ftoq16(float x, float scale) {
+    int32_t q = a3_copy_ftoq(x, scale);
+
+    if (q > INT16_MAX) return INT16_MAX;
+    if (q < INT16_MIN) return INT16_MIN;
+    return (int16_t)q;
+}
+
+
+#if defined(__aarch64__)
+/*
+ * ARTICo3 convert floating point to fixed point (NEON, four elements)
+ *
+ * NOTE : vcvtaq_s32_f32() rounds to nearest (ties away from zero) and
+ *        saturates, as a3_copy_ftoq()
+ *
+ */
+static inline int32x4_t a3_copy_ftoqx4(float32x4_t x, float32x4_t scale) {
+    return vcvtaq_s32_f32(vmulq_f32(x, scale));
+}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+/*
+ * ARTICo3 convert floating point to fixed point (NEON, four elements)
+ *
+ * NOTE : vcvtq_s32_f32() truncates and saturates, hence the result is
+ *        rounded using the remainder (as in a3_copy_ftoq()), with
+ *        saturating additions
+ *
+ */
+static inline int32x4_t a3_copy_ftoqx4(float32x4_t x, float32x4_t scale) {
+    float32x4_t v = vmulq_f32(x, scale);
+    int32x4_t q = vcvtq_s32_f32(v);
+    float32x4_t r = vsubq_f32(v, vcvtq_f32_s32(q));
+
+    q = vqsubq_s32(q, vreinterpretq_s32_u32(vcgeq_f32(r, vdupq_n_f32(0.5f))));
+    q = vqaddq_s32(q, vreinterpretq_s32_u32(vcleq_f32(r, vdupq_n_f32(-0.5f))));
+    return q;
+}
+#elif defined(__SSE2__)
+/*
+ * ARTICo3 convert floating point to fixed point (SSE2, four elements)
+ *
+ * NOTE : _mm_cvttps_epi32() truncates and returns INT32_MIN on overflow,
+ *        hence the result is rounded using the remainder (as in
+ *        a3_copy_ftoq(), only below 2^23, since larger values are
+ *        integers), and positive overflows are turned into INT32_MAX by
+ *        flipping all bits
+ *
+ */
+static inline __m128i a3_copy_ftoqx4(__m128 x, __m128 scale) {
+    __m128 v = _mm_mul_ps(x, scale);
+    __m128i q = _mm_cvttps_epi32(v);
+    __m128 r = _mm_sub_ps(v, _mm_cvtepi32_ps(q));
+    __m128 big = _mm_cmpge_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), v), _mm_set1_ps(8388608.0f));
+
+    q = _mm_sub_epi32(q, _mm_castps_si128(_mm_andnot_ps(big, _mm_cmpge_ps(r, _mm_set1_ps(0.5f)))));
+    q = _mm_add_epi32(q, _mm_castps_si128(_mm_andnot_ps(big, _mm_cmple_ps(r, _mm_set1_ps(-0.5f)))));
+    return _mm_xor_si128(q, _mm_castps_si128(_mm_cmpge_ps(v, _mm_set1_ps(2147483648.0f))));
+}
+#endif
+
+
+/*
+ * ARTICo3 copy and pack memory block (application to hardware data)
+ *
+ * This function copies a contiguous memory block to a DMA staging buffer,
+ * converting its elements from @dtype to hardware data. Identity types
+ * (raw, floating point and packed 16-bit integers) are streamed as they
+ * are (see a3_copy_stream()).
+ *
+ * @dst   : destination address (hardware data)
+ * @src   : source address (application data)
+ * @size  : number of bytes to be written to @dst
+ * @dtype : data type of the source (A3_T_*)
+ *
+ */
+static inline void a3_copy_pack(void *dst, const void *src, size_t size, unsigned int dtype) {
+    const float *s = src;
+    const float scale = (float)((uint64_t)1 << A3_T_FRAC(dtype));
+    size_t i = 0, n;
+
+    if (A3_T_KIND(dtype) == A3_T_Q(0)) {
+        int32_t *d = dst;
+        n = size / sizeof *d;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__SSE2__)
+        for (; (i < n) && ((uintptr_t)&d[i] & 15); i++) d[i] = a3_copy_ftoq(s[i], scale);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        for (; (i + 4) <= n; i += 4) {
+            vst1q_s32(&d[i], a3_copy_ftoqx4(vld1q_f32(&s[i]), vdupq_n_f32(scale)));
+        }
+#elif defined(__SSE2__)
+        for (; (i + 4) <= n; i += 4) {
+            _mm_stream_si128((__m128i *)&d[i], a3_copy_ftoqx4(_mm_loadu_ps(&s[i]), _mm_set1_ps(scale)));
+        }
+#endif
+        for (; i < n; i++) d[i] = a3_copy_ftoq(s[i], scale);
+    }
+    else if (A3_T_KIND(dtype) == A3_T_Q16X2(0)) {
+        int16_t *d = dst;
+        n = size / sizeof *d;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__SSE2__)
+        for (; (i < n) && ((uintptr_t)&d[i] & 15); i++) d[i] = a3_copy_ftoq16(s[i], scale);
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        for (; (i + 8) <= n; i += 8) {
+            int16x4_t lo = vqmovn_s32(a3_copy_ftoqx4(vld1q_f32(&s[i]), vdupq_n_f32(scale)));
+            int16x4_t hi = vqmovn_s32(a3_copy_ftoqx4(vld1q_f32(&s[i + 4]), vdupq_n_f32(scale)));
+            vst1q_s16(&d[i], vcombine_s16(lo, hi));
+        }
+#elif defined(__SSE2__)
+        for (; (i + 8) <= n; i += 8) {
+            __m128i lo = a3_copy_ftoqx4(_mm_loadu_ps(&s[i]), _mm_set1_ps(scale));
+            __m128i hi = a3_copy_ftoqx4(_mm_loadu_ps(&s[i + 4]), _mm_set1_ps(scale));
+            _mm_stream_si128((__m128i *)&d[i], _mm_packs_epi32(lo, hi));
+        }
+#endif
+        for (; i < n; i++) d[i] = a3_copy_ftoq16(s[i], scale);
+    }
+    else {
+        a3_copy_stream(dst, src, size);
+        return;
+    }
+
+#if defined(__SSE2__) && !(defined(__ARM_NEON) || defined(__ARM_NEON__))
+    // Non-temporal stores are weakly ordered
+    _mm_sfence();
+#endif
+}
+
+
+/*
+ * ARTICo3 copy and unpack memory block (hardware to application data)
+ *
+ * This function copies a contiguous memory block from a DMA staging
+ * buffer, converting its elements from hardware data to @dtype. Identity
+ * types (raw, floating point and packed 16-bit integers) are copied as
+ * they are.
+ *
+ * @dst   : destination address (application data)
+ * @src   : source address (hardware data)
+ * @size  : number of bytes to be read from @src
+ * @dtype : data type of the destination (A3_T_*)
+ *
+ */
+static inline void a3_copy_unpack(void *dst, const void *src, size_t size, unsigned int dtype) {
+    float *d = dst;
+    const float scale = 1.0f / (float)((uint64_t)1 << A3_T_FRAC(dtype));
+    size_t i = 0, n;
+
+    if (A3_T_KIND(dtype) == A3_T_Q(0)) {
+        const int32_t *s = src;
+        n = size / sizeof *s;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        for (; (i + 4) <= n; i += 4) {
+            vst1q_f32(&d[i], vmulq_f32(vcvtq_f32_s32(vld1q_s32(&s[i])), vdupq_n_f32(scale)));
+        }
+#elif defined(__SSE2__)
+        for (; (i + 4) <= n; i += 4) {
+            _mm_storeu_ps(&d[i], _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)&s[i])), _mm_set1_ps(scale)));
+        }
+#endif
+        for (; i < n; i++) d[i] = (float)s[i] * scale;
+    }
+    else if (A3_T_KIND(dtype) == A3_T_Q16X2(0)) {
+        const int16_t *s = src;
+        n = size / sizeof *s;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        for (; (i + 8) <= n; i += 8) {
+            int16x8_t v = vld1q_s16(&s[i]);
+            vst1q_f32(&d[i], vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), vdupq_n_f32(scale)));
+            vst1q_f32(&d[i + 4], vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), vdupq_n_f32(scale)));
+        }
+#elif defined(__SSE2__)
+        for (; (i + 8) <= n; i += 8) {
+            __m128i v = _mm_loadu_si128((const __m128i *)&s[i]);
+            _mm_storeu_ps(&d[i], _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), _mm_set1_ps(scale)));
+            _mm_storeu_ps(&d[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), _mm_set1_ps(scale)));
+        }
+#endif
+        for (; i < n; i++) d[i] = (float)s[i] * scale;
+    }
+    else {
+        memcpy(dst, src, size);
+    }
+}
+
+
+/*
+ * ARTICo3 copy part of a batch
+ *
+ * This function performs the bytes [@start, @end) of a batch of copies
+ * (i.e. as if all the copies were concatenated). Typed copies are split
+ * by hardware bytes, i.e. their application side advances A3_T_RATIO()
+ * times faster.
+ *
+ * @copies  : batch of copies
+ * @ncopies : number of copies in the batch
+ * @start   : first byte to be copied
+ * @end     : last byte (excluded) to be copied
+ *
+ */
+static inline void a3_copy_part(const struct a3copy_t *copies, unsigned int ncopies, size_t start, size_t end) {
+    unsigned int i;
+    size_t base, lo, hi;
+
+    for (i = 0, base = 0; (i < ncopies) && (base < end); base += copies[i].size, i++) {
+        if ((base + copies[i].size) <= start) continue;
+        lo = (start > base) ? (start - base) : 0;
+        hi = ((end < (base + copies[i].size)) ? end : (base + copies[i].size)) - base;
+        if (copies[i].flags & A3_COPY_UNPACK) {
+            a3_copy_unpack((uint8_t *)copies[i].dst + (lo * A3_T_RATIO(copies[i].dtype)), (const uint8_t *)copies[i].src + lo, hi - lo, copies[i].dtype);
+        }
+        else if (copies[i].dtype != A3_T_RAW) {
+            a3_copy_pack((uint8_t *)copies[i].dst + lo, (const uint8_t *)copies[i].src + (lo * A3_T_RATIO(copies[i].dtype)), hi - lo, copies[i].dtype);
+        }
+        else if (copies[i].flags & A3_COPY_STREAM) {
+            a3_copy_stream((uint8_t *)copies[i].dst + lo, (const uint8_t *)copies[i].src + lo, hi - lo);
+        }
+        else {
+            memcpy((uint8_t *)copies[i].dst + lo, (const uint8_t *)copies[i].src + lo, hi - lo);
+        }
+    }
+}
+
+
+/*
+ * ARTICo3 copy worker thread
+ *
+ */
+static inline void *a3_copy_worker(void *arg) {
+    struct a3copyworker_t *worker = arg;
+    struct a3copyengine_t *engine = worker->engine;
+    unsigned long mask[16] = {0};
+    unsigned int spin, budget = a3_spin_budget();
+
+    // Pin worker to its processor (best effort)
+    if (worker->cpu < (8 * sizeof mask)) {
+        mask[worker->cpu / (8 * sizeof (unsigned long))] = 1ul << (worker->cpu % (8 * sizeof (unsigned long)));
+        syscall(SYS_sched_setaffinity, 0, sizeof mask, mask);
+    }
+
+    while (1) {
+
+        // Wait for a part to be assigned (spin first, then sleep)
+        for (spin = 0; (spin < budget) && !__atomic_load_n(&worker->go, __ATOMIC_ACQUIRE); spin++) {
+            a3_cpu_relax();
+        }
+        while (!__atomic_load_n(&worker->go, __ATOMIC_ACQUIRE)) {
+            a3_futex_wait(&worker->go, 0);
+        }
+        if (engine->shutdown) break;
+
+        // Copy assigned part
+        a3_copy_part(engine->copies, engine->ncopies, worker->start, worker->end);
+
+        // Notify completion
+        __atomic_store_n(&worker->go, 0, __ATOMIC_RELAXED);
+        if (__atomic_sub_fetch(&engine->pending, 1, __ATOMIC_RELEASE) == 0) {
+            a3_futex_wake(&engine->pending);
+        }
+
+    }
+
+    return NULL;
+}
+
+
+/*
+ * ARTICo3 get default number of copy workers
+ *
+ * Return : A3_COPY_WORKERS environment variable if set, number of online
+ *          processors minus one otherwise (up to A3_COPY_MAXWORKERS)
+ *
+ */
+static inline unsigned int a3_copy_workers() {
+    const char *env = getenv("A3_COPY_WORKERS");
+    long nworkers;
+
+    nworkers = env ? strtol(env, NULL, 0) : (sysconf(_SC_NPROCESSORS_ONLN) - 1);
+    if (nworkers < 0) nworkers = 0;
+    if (nworkers > A3_COPY_MAXWORKERS) nworkers = A3_COPY_MAXWORKERS;
+    return nworkers;
+}
+
+
+/*
+ * ARTICo3 initialize copy engine
+ *
+ * This function creates the worker threads of a copy engine. Workers are
+ * pinned to the last processors of the system (the first ones are more
+ * likely to be used by the application threads).
+ *
+ * @engine   : copy engine
+ * @nworkers : number of worker threads (0 to copy in the calling threads only)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+static inline int a3_copy_init(struct a3copyengine_t *engine, unsigned int nworkers) {
+    unsigned int i;
+    long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    memset(engine, 0, sizeof *engine);
+    pthread_mutex_init(&engine->lock, NULL);
+    if (nworkers > A3_COPY_MAXWORKERS) nworkers = A3_COPY_MAXWORKERS;
+    if (ncpus < 1) ncpus = 1;
+
+    for (i = 0; i < nworkers; i++) {
+        engine->workers[i].engine = engine;
+        engine->workers[i].cpu = (ncpus - 1) - (i % ncpus);
+        if (pthread_create(&engine->workers[i].thread, NULL, a3_copy_worker, &engine->workers[i]) != 0) {
+            break;
+        }
+        engine->nworkers++;
+    }
+
+    return (engine->nworkers == nworkers) ? 0 : -ENOMEM;
+}
+
+
+/*
+ * ARTICo3 clean copy engine
+ *
+ * This function finishes the worker threads of a copy engine.
+ *
+ * @engine : copy engine
+ *
+ */
+static inline void a3_copy_clean(struct a3copyengine_t *engine) {
+    unsigned int i;
+
+    engine->shutdown = 1;
+    for (i = 0; i < engine->nworkers; i++) {
+        __atomic_store_n(&engine->workers[i].go, 1, __ATOMIC_RELEASE);
+        a3_futex_wake(&engine->workers[i].go);
+        pthread_join(engine->workers[i].thread, NULL);
+    }
+    engine->nworkers = 0;
+    pthread_mutex_destroy(&engine->lock);
+}
+
+
+/*
+ * ARTICo3 run batch of copies
+ *
+ * This function performs a batch of copies, and returns when all of them
+ * have finished. Batches are split among the calling thread and the
+ * workers (at least A3_COPY_MINPART bytes per part). If the workers are
+ * busy with the batch of another thread, the batch is performed by the
+ * calling thread only.
+ *
+ * @engine  : copy engine
+ * @copies  : batch of copies
+ * @ncopies : number of copies in the batch
+ *
+ */
+static inline void a3_copy_run(struct a3copyengine_t *engine, const struct a3copy_t *copies, unsigned int ncopies) {
+    unsigned int i, nparts, spin, budget;
+    uint32_t pending;
+    size_t total;
+
+    // Compute number of parts
+    for (i = 0, total = 0; i < ncopies; i++) total += copies[i].size;
+    nparts = total / A3_COPY_MINPART;
+    if (nparts > (engine->nworkers + 1)) nparts = engine->nworkers + 1;
+
+    // Small batches (or busy workers): copy in the calling thread
+    if ((nparts < 2) || (pthread_mutex_trylock(&engine->lock) != 0)) {
+        a3_copy_part(copies, ncopies, 0, total);
+        return;
+    }
+
+    // Assign parts to workers (64-byte aligned boundaries)
+    engine->copies = copies;
+    engine->ncopies = ncopies;
+    __atomic_store_n(&engine->pending, nparts - 1, __ATOMIC_RELAXED);
+    for (i = 1; i < nparts; i++) {
+        engine->workers[i - 1].start = ((total * i) / nparts) & ~(size_t)63;
+        engine->workers[i - 1].end = (i == (nparts - 1)) ? total : ((total * (i + 1)) / nparts) & ~(size_t)63;
+        __atomic_store_n(&engine->workers[i - 1].go, 1, __ATOMIC_RELEASE);
+        a3_futex_wake(&engine->workers[i - 1].go);
+    }
+
+    // Copy first part in the calling thread
+    a3_copy_part(copies, ncopies, 0, (total / nparts) & ~(size_t)63);
+
+    // Wait for the workers (spin first, then sleep)
+    budget = a3_spin_budget();
+    for (spin = 0; (spin < budget) && __atomic_load_n(&engine->pending, __ATOMIC_ACQUIRE); spin++) {
+        a3_cpu_relax();
+    }
+    while ((pending = __atomic_load_n(&engine->pending, __ATOMIC_ACQUIRE)) != 0) {
+        a3_futex_wait(&engine->pending, pending);
+    }
+
+    pthread_mutex_unlock(&engine->lock);
+}
+
+#endif /* _ARTICO3_COPY_H_ */
@@ -13,12 +13,37 @@
 #ifndef _ARTICO3_DATA_H_
 #define _ARTICO3_DATA_H_
 
-#include <stdint.h>  // uint32_t
-#include <pthread.h> // pthread_mutex_t, pthread_cond_t
+#include <stdint.h>    // uint32_t
+#include <pthread.h>   // pthread_mutex_t, pthread_cond_t
+#include <sys/types.h> // pid_t
 
-#define A3_ARGS_SIZE              (100) // Size of the request input arguments shared memory object
-#define A3_MAXCHANNELS_PER_CLIENT (10)  // Max number of simultaneous execution threads per user
+#define A3_ARENA_SIZE             (64 * 1024) // Size of the per-user request argument arena (bytes)
+#define A3_ARGS_ALIGN             (8)   // Alignment of request input arguments inside the arena (bytes, power of 2)
 #define A3_COORDINATOR_FILENAME   "a3d" // Coordinator shared memory object filename
+#define A3_TOPOLOGY_FILENAME      "a3topo" // Topology shared memory object filename
+#define A3_RING_SIZE              (16)  // Number of entries in the per-user request rings (power of 2, max number of in-flight requests per user)
+#define A3_BATCH_MAXSIZE          (A3_ARENA_SIZE / 4) // Max payload size of a single batch request (bytes)
+#define A3_MAXHANDLES             (16)  // Max number of in-flight asynchronous kernel executions per user
+#define A3_MAXSTREAMS             (8)   // Max number of streaming executions per user
+#define A3_TOPOLOGY_MAXKERNS      (16)  // Max number of kernels in the topology (>= A3_MAXKERNS)
+#define A3_NAME_SIZE              (128) // Max length of kernel names (including '\0')
+#define A3_STATS_FILENAME         "a3stats" // Statistics shared memory object filename
+#define A3_STATS_VERSION          (1)   // Statistics shared memory layout version
+#define A3_STATS_MAXFUNCS         (32)  // Max number of request types in the statistics
+#define A3_STATS_BUCKETS          (40)  // Number of latency histogram buckets (log2 of latency in ns)
+#define A3_STREAM_SUFFIX          "@stream" // Stream control shared memory object filename suffix (appended to the kernel name)
+
+/*
+ * ARTICo3 kernel handles
+ *
+ * Kernel handles are opaque (> 0) integers that encode the kernel ID
+ * (4 LSBs) and a creation sequence number, so that handles of released
+ * kernels are not mistaken for kernels created later with the same ID.
+ * Requests reference kernels by handle, or by name when the handle is 0.
+ *
+ */
+#define A3_KERNEL_HANDLE(id, seq) ((int)((((uint32_t)(seq) & 0x7ffffff) << 4) | ((id) & 0xf)))
+#define A3_KERNEL_HANDLE_ID(handle) ((uint8_t)((handle) & 0xf))
 
 /*
  * ARTICo3 data type
@@ -47,6 +72,86 @@ typedef uint32_t a3data_t;
  */
 enum a3pdir_t {A3_P_C, A3_P_I, A3_P_O, A3_P_IO};
 
+/*
+ * ARTICo3 port direction flags (OR-ed with the port direction)
+ *
+ * A3_P_CACHED - Zero-copy buffer in cached DMA memory
+ * A3_P_HUGE   - Shared memory buffer backed by huge pages (locked and pre-faulted)
+ *
+ */
+#define A3_P_CACHED (0x100)
+#define A3_P_HUGE   (0x200)
+
+/*
+ * ARTICo3 port data types (element type of the application buffer)
+ *
+ * A3_T_RAW      - Raw 32-bit words (a3data_t), no conversion
+ * A3_T_F32      - Single precision floating point, no conversion
+ * A3_T_I16X2    - 16-bit integers, two elements per word (even elements
+ *                 in the low half-word), no conversion
+ * A3_T_Q(f)     - Single precision floating point in the application,
+ *                 32-bit fixed point with @f fractional bits (0-31) in
+ *                 the accelerators
+ * A3_T_Q16X2(f) - Single precision floating point in the application,
+ *                 16-bit fixed point with @f fractional bits (0-15) in
+ *                 the accelerators, two elements per word (even elements
+ *                 in the low half-word)
+ *
+ * NOTE : conversions are performed by the Daemon when copying the data
+ *        to/from the DMA staging buffers. Floating point to fixed point
+ *        conversions round to nearest (ties away from zero) and saturate.
+ *
+ */
+#define A3_T_RAW      (0x000)
+#define A3_T_F32      (0x100)
+#define A3_T_I16X2    (0x200)
+#define A3_T_Q(f)     (0x300 | ((f) & 0xff))
+#define A3_T_Q16X2(f) (0x400 | ((f) & 0xff))
+
+#define A3_T_KIND(t)  ((t) & 0xf00)                              // Data type without fractional bits
+#define A3_T_FRAC(t)  ((t) & 0x0ff)                              // Number of fractional bits
+#define A3_T_RATIO(t) ((A3_T_KIND(t) == A3_T_Q16X2(0)) ? 2 : 1) // Application bytes per hardware byte
+#define A3_T_ESIZE(t) ((A3_T_KIND(t) == A3_T_I16X2) ? 2 : 4)    // Application element size (in bytes)
+
+/*
+ * ARTICo3 port view (access descriptor of a port buffer)
+ *
+ * By default, the data of each work-group is one contiguous block of the
+ * port buffer (work-group t starts where work-group t - 1 ends). Port views
+ * describe, instead, a row-major matrix with @stride words per row, from
+ * which each work-group transfers one tile of @rows rows and @cols words
+ * per row. Tiles are arranged in groups of @ntiles tiles, and the tile of
+ * work-group t starts at word
+ *
+ *     @offset + ((t % @ntiles) * @tstep) + ((t / @ntiles) * @gstep)
+ *
+ * For instance, tiles taken in row-major order from a grid with N tiles
+ * per row use @ntiles = N, @tstep = @cols and @gstep = @rows * @stride.
+ * Steps can be 0, so that input tiles are transferred more than once.
+ *
+ * @offset : first word of the first tile
+ * @stride : words per row of the matrix
+ * @rows   : rows per tile (0 to remove the view)
+ * @cols   : words per row of a tile
+ * @ntiles : tiles per group
+ * @tstep  : words between consecutive tiles of a group
+ * @gstep  : words between consecutive groups
+ *
+ * NOTE : sizes and offsets are expressed in 32-bit words of hardware data
+ *        (see A3_T_*), and the data of a work-group is the concatenation
+ *        of the rows of its tile.
+ *
+ */
+struct a3view_t {
+    size_t offset;
+    size_t stride;
+    size_t rows;
+    size_t cols;
+    size_t ntiles;
+    size_t tstep;
+    size_t gstep;
+};
+
 
 /*
  * ARTICo3 function type
@@ -60,20 +165,26 @@ typedef int (*a3func_t)(void*);
 /*
  * ARTICo3 function IDs
  *
- * A3_F_ADD_USER       - ARTICo3 artico3_add_user() Function
- * A3_F_LOAD           - ARTICo3 artico3_load() Function
- * A3_F_UNLOAD         - ARTICo3 artico3_unload() Function
- * A3_F_KERNEL_CREATE  - ARTICo3 artico3_kernel_create() Function
- * A3_F_KERNEL_RELEASE - ARTICo3 artico3_kernel_release() Function
- * A3_F_KERNEL_EXECUTE - ARTICo3 artico3_kernel_execute() Function
- * A3_F_KERNEL_WAIT    - ARTICo3 artico3_kernel_wait() Function
- * A3_F_KERNEL_RESET   - ARTICo3 artico3_kernel_reset() Function
- * A3_F_KERNEL_WCFG    - ARTICo3 artico3_kernel_wcfg() Function
- * A3_F_KERNEL_RCFG    - ARTICo3 artico3_kernel_wcfg() Function
- * A3_F_ALLOC          - ARTICo3 artico3_alloc() Function
- * A3_F_FREE           - ARTICo3 artico3_free() Function
- * A3_F_REMOVE_USER    - ARTICo3 artico3_remove_user() Function
- * A3_F_GET_NACCS      - ARTICo3 artico3_get_naccs() Function
+ * A3_F_ADD_USER             - ARTICo3 artico3_add_user() Function
+ * A3_F_LOAD                 - ARTICo3 artico3_load() Function
+ * A3_F_UNLOAD               - ARTICo3 artico3_unload() Function
+ * A3_F_KERNEL_CREATE        - ARTICo3 artico3_kernel_create() Function
+ * A3_F_KERNEL_RELEASE       - ARTICo3 artico3_kernel_release() Function
+ * A3_F_KERNEL_EXECUTE       - ARTICo3 artico3_kernel_execute() Function
+ * A3_F_KERNEL_WAIT          - ARTICo3 artico3_kernel_wait() Function
+ * A3_F_KERNEL_RESET         - ARTICo3 artico3_kernel_reset() Function
+ * A3_F_KERNEL_WCFG          - ARTICo3 artico3_kernel_wcfg() Function
+ * A3_F_KERNEL_RCFG          - ARTICo3 artico3_kernel_wcfg() Function
+ * A3_F_ALLOC                - ARTICo3 artico3_alloc() Function
+ * A3_F_FREE                 - ARTICo3 artico3_free() Function
+ * A3_F_REMOVE_USER          - ARTICo3 artico3_remove_user() Function
+ * A3_F_GET_NACCS            - ARTICo3 artico3_get_naccs() Function
+ * A3_F_BATCH                - ARTICo3 artico3_batch() Function
+ * A3_F_KERNEL_EXECUTE_ASYNC - ARTICo3 artico3_kernel_execute_async() Function
+ * A3_F_ALLOC_ZC             - ARTICo3 artico3_alloc_zc() Function
+ * A3_F_KERNEL_VCOUNT        - ARTICo3 artico3_kernel_vcount() Function
+ * A3_F_KERNEL_STREAM        - ARTICo3 artico3_kernel_stream() Function
+ * A3_F_PORT_VIEW            - ARTICo3 artico3_port_view() Function
  *
  */
 enum a3func_t {
@@ -90,60 +201,196 @@ enum a3func_t {
     A3_F_ALLOC,
     A3_F_FREE,
     A3_F_REMOVE_USER,
-    A3_F_GET_NACCS
+    A3_F_GET_NACCS,
+    A3_F_BATCH,
+    A3_F_KERNEL_EXECUTE_ASYNC,
+    A3_F_ALLOC_ZC,
+    A3_F_KERNEL_VCOUNT,
+    A3_F_KERNEL_STREAM,
+    A3_F_PORT_VIEW
 };
 
 
 /*
  * ARTICo3 request
  *
- * @user_id    : ID of the user quering the request
- * @channel_id : ID of the channel used for handling the request
- * @func       : function requested by the user
- * @shm        : user shared memory data filename (only used on new users)
+ * @user_id     : ID of the user quering the request
+ * @channel_id  : ID of the channel used for handling the request
+ * @func        : function requested by the user
+ * @args_offset : offset of the request input arguments in the user arena
+ * @args_size   : size (in bytes) of the request input arguments
+ * @tsubmit     : submission time (CLOCK_MONOTONIC, ns)
+ * @shm         : user shared memory data filename (only used on new users)
+ *
+ * NOTE : channels are private to each user process, the daemon only
+ *        echoes @channel_id back in the completion. The daemon checks
+ *        that the request input arguments lie inside the user arena
+ *        before parsing them (see artico3_args.h).
  *
  */
 struct a3request_t {
     int user_id;
     int channel_id;
     enum a3func_t func;
+    uint32_t args_offset;
+    uint32_t args_size;
+    uint64_t tsubmit;
     char shm[13];
 };
 
 
 /*
- * ARTICo3 channel (each channel handles a single request)
+ * ARTICo3 batch record (runtime call shipped inside a batch request)
+ *
+ * @func     : function requested by the user
+ * @response : processed function response (written by the daemon)
+ * @size     : size (in bytes) of the function input arguments
+ *
+ * NOTE : each record is immediately followed by its function input
+ *        arguments, padded so that the next record starts at a multiple
+ *        of A3_ARGS_ALIGN bytes.
+ *
+ */
+struct a3record_t {
+    enum a3func_t func;
+    int response;
+    uint32_t size;
+};
+
+
+/*
+ * ARTICo3 asynchronous completion (one per asynchronous kernel execution handle)
  *
- * @mutex              : synchronization primitive for accessing @request_available
- * @cond_response      : processed user request signaling conditional variable
- * @response_available : processed user request signaling flag
- * @response           : processed user request response
- * @free               : channel free flag
- * @args               : user request input arguments buffer
+ * @done     : completion flag (futex word, written by the daemon)
+ * @response : kernel execution result
  *
  */
-struct a3channel_t {
-    pthread_mutex_t mutex;
-    pthread_cond_t cond_response;
-    int response_available;
+struct a3async_t {
+    uint32_t done;
+    int response;
+};
+
+
+/*
+ * ARTICo3 stream control (streaming kernel execution over ring-buffered ports)
+ *
+ * @produced : work items written to the input ports (written by the producer)
+ * @closed   : no more work items will be produced (written by the producer)
+ * @flush    : the producer or the consumer is blocked, i.e. the pending
+ *             work items have to be processed even if they do not keep
+ *             every accelerator busy (set by the users, cleared by the
+ *             daemon)
+ * @events   : daemon wake-up counter (futex word, incremented after updating
+ *             @produced, @closed or @flush, the daemon sleeps on it)
+ * @consumed : work items read from the output ports (written by the consumer)
+ * @done     : work items processed, i.e. available in the output ports
+ *             (written by the daemon)
+ * @finished : every work item has been processed, or the execution has
+ *             failed (written by the daemon)
+ * @response : stream execution result (valid once @finished is set)
+ * @seq      : user wake-up counter (futex word, incremented after updating
+ *             @consumed, @done or @finished, the users sleep on it)
+ *
+ * NOTE : work item counters are free-running (modulo 2^32). The ports hold
+ *        the data of depth work items, work item i being stored at ring
+ *        position (i % depth), and a work item can only be produced once
+ *        the one stored depth positions before has been consumed.
+ *
+ */
+struct a3stream_t {
+    uint32_t produced __attribute__ ((aligned (64)));
+    uint32_t closed;
+    uint32_t flush;
+    uint32_t events;
+    uint32_t consumed __attribute__ ((aligned (64)));
+    uint32_t done __attribute__ ((aligned (64)));
+    uint32_t finished;
     int response;
-    int free;
-    char args[A3_ARGS_SIZE];
+    uint32_t seq;
+};
+
+
+/*
+ * ARTICo3 completion (response to a processed request)
+ *
+ * @channel_id : ID of the channel used for handling the request
+ * @response   : processed user request response
+ *
+ */
+struct a3completion_t {
+    int channel_id;
+    int response;
+};
+
+
+/*
+ * ARTICo3 ring indexes (single-producer/single-consumer)
+ *
+ * @head : index of the next entry to be consumed (written by the consumer)
+ * @tail : index of the next entry to be produced (written by the producer)
+ *
+ * NOTE : both indexes are free-running counters, the entry slot is
+ *        obtained by masking them with (A3_RING_SIZE - 1). They live in
+ *        different cache lines to avoid false sharing between producer
+ *        and consumer.
+ *
+ */
+struct a3ring_t {
+    uint32_t head __attribute__ ((aligned (64)));
+    uint32_t tail __attribute__ ((aligned (64)));
+};
+
+
+/*
+ * ARTICo3 submission queue (user -> daemon)
+ *
+ * @ring    : ring indexes
+ * @entries : submitted requests
+ *
+ */
+struct a3sq_t {
+    struct a3ring_t ring;
+    struct a3request_t entries[A3_RING_SIZE];
+};
+
+
+/*
+ * ARTICo3 completion queue (daemon -> user)
+ *
+ * @ring    : ring indexes
+ * @waiters : number of user threads sleeping on @ring.tail (futex)
+ * @entries : request completions
+ *
+ */
+struct a3cq_t {
+    struct a3ring_t ring;
+    uint32_t waiters;
+    struct a3completion_t entries[A3_RING_SIZE];
 };
 
 
 /*
- * ARTICo3 (user data and its channels data )
+ * ARTICo3 (user data)
  *
- * @user_id  : ID of the user quering the request
- * @channels : user threads to handle user request queries
- * @shm      : user shared memory data filename
+ * @user_id       : ID of the user quering the request
+ * @pid           : process ID of the user (read by the daemon when the user is added)
+ * @sq            : submission queue (requests sent to the daemon)
+ * @cq            : completion queue (responses sent back to the user)
+ * @async         : asynchronous kernel execution completions (one per handle)
+ * @async_seq     : number of asynchronous completions posted so far (futex word)
+ * @shm           : user shared memory data filename
+ * @arena         : request input arguments (allocated per channel by the user)
  *
  */
 struct a3user_t {
     int user_id;
-    struct a3channel_t channels[A3_MAXCHANNELS_PER_CLIENT];
+    pid_t pid;
+    struct a3sq_t sq;
+    struct a3cq_t cq;
+    struct a3async_t async[A3_MAXHANDLES];
+    uint32_t async_seq;
     char shm[13];
+    char arena[A3_ARENA_SIZE] __attribute__ ((aligned (64)));
 };
 
 
@@ -155,6 +402,12 @@ struct a3user_t {
  * @cond_free         : conditional variable indicating users the coordinator is free
  * @request_available : user request signaling flag
  * @request           : user request info
+ * @sleeping          : flag indicating the daemon is waiting on @cond_request
+ *
+ * NOTE : the single request slot (@request/@request_available) is only
+ *        used to register new users. Once registered, users submit their
+ *        requests through their own submission queue, and only need to
+ *        signal @cond_request when @sleeping is set.
  *
  */
 struct a3coordinator_t {
@@ -163,6 +416,117 @@ struct a3coordinator_t {
     pthread_cond_t cond_free;
     int request_available;
     struct a3request_t request;
+    int sleeping;
+};
+
+
+
+/*
+ * ARTICo3 topology kernel entry
+ *
+ * @id       : kernel ID (0 if the entry is not in use)
+ * @handle   : kernel handle
+ * @naccs    : number of equivalent accelerators (0 if not loaded)
+ * @slotmask : slots in which the kernel is loaded (bit i set for slot i)
+ * @name     : kernel name
+ *
+ */
+struct a3topokernel_t {
+    uint8_t id;
+    int handle;
+    int naccs;
+    uint32_t slotmask;
+    char name[A3_NAME_SIZE];
+};
+
+
+/*
+ * ARTICo3 topology (read-only for users, published by the daemon)
+ *
+ * @seq        : seqlock sequence number (odd while being updated)
+ * @generation : topology generation (incremented on every change)
+ * @nslots     : number of reconfigurable slots
+ * @id_reg     : kernel ID of each slot (4 bits per slot)
+ * @tmr_reg    : TMR group of each slot (4 bits per slot)
+ * @dmr_reg    : DMR group of each slot (4 bits per slot)
+ * @kernels    : kernel entries (indexed as in the daemon kernel list)
+ *
+ * NOTE : readers have to use a3_seqlock_read_begin()/a3_seqlock_read_retry()
+ *        on @seq to get a consistent snapshot. Register accesses carry the
+ *        @generation used to size the configuration arrays, and are
+ *        rejected (-EAGAIN) when it is no longer current.
+ *
+ */
+struct a3topology_t {
+    uint32_t seq;
+    uint32_t generation;
+    uint32_t nslots;
+    uint64_t id_reg;
+    uint64_t tmr_reg;
+    uint64_t dmr_reg;
+    struct a3topokernel_t kernels[A3_TOPOLOGY_MAXKERNS];
+};
+
+
+/*
+ * ARTICo3 latency histogram (log-scaled)
+ *
+ * @count   : number of samples
+ * @sum     : sum of every sample (ns)
+ * @max     : largest sample (ns)
+ * @buckets : number of samples in [2^i, 2^(i+1)) ns (the first bucket
+ *            also holds 0 ns samples, the last one every larger sample)
+ *
+ */
+struct a3hist_t {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t buckets[A3_STATS_BUCKETS];
+};
+
+
+/*
+ * ARTICo3 request statistics (one per request type)
+ *
+ * @name     : request type name
+ * @errors   : number of requests that returned an error code
+ * @queue    : time between user submission and daemon dequeue
+ * @dispatch : time between daemon dequeue and delegate thread start
+ * @service  : time between delegate thread start and response posting
+ *
+ */
+struct a3funcstats_t {
+    char name[32];
+    uint64_t errors;
+    struct a3hist_t queue;
+    struct a3hist_t dispatch;
+    struct a3hist_t service;
+};
+
+
+/*
+ * ARTICo3 statistics (read-only for external tools, published by the daemon)
+ *
+ * @version  : layout version (A3_STATS_VERSION)
+ * @nfuncs   : number of valid entries in @funcs
+ * @nbuckets : number of histogram buckets (A3_STATS_BUCKETS)
+ * @tstart   : daemon start time (CLOCK_MONOTONIC, ns)
+ * @funcs    : request statistics (indexed by enum a3func_t)
+ *
+ * NOTE : counters are never reset and are updated with relaxed atomic
+ *        operations, so that readers do not stop the daemon. Readers get
+ *        approximate snapshots (counters of the same histogram might be
+ *        off by the samples being recorded), and should compute rates
+ *        and percentiles from the difference between two snapshots.
+ *
+ */
+struct a3stats_t {
+    uint32_t version;
+    uint32_t nfuncs;
+    uint32_t nbuckets;
+    uint64_t tstart;
+    struct a3funcstats_t funcs[A3_STATS_MAXFUNCS];
 };
 
 #endif /* _ARTICO3_DATA_H_ */
\ No newline at end of file
@@ -0,0 +1,92 @@
+/*
+ * ARTICo3 request rings
+ *
+ * Description : This file contains the lock-free single-producer/single-consumer
+ *               ring primitives used to exchange requests and responses
+ *               between the daemon and the users through shared memory.
+ *
+ *               Producers fill the entry at a3_ring_tail() and then
+ *               publish it with a3_ring_push(). Consumers read the entry
+ *               at a3_ring_head() and then release it with a3_ring_pop().
+ *
+ */
+
+
+#ifndef _ARTICO3_RING_H_
+#define _ARTICO3_RING_H_
+
+#include <stdint.h> // uint32_t
+
+#include "artico3_data.h"
+
+
+/*
+ * ARTICo3 ring empty check (consumer side)
+ *
+ * @ring : ring indexes
+ *
+ * Return : 1 if there are no entries to be consumed, 0 otherwise
+ *
+ */
+static inline int a3_ring_empty(struct a3ring_t *ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_RELAXED) == __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+
+/*
+ * ARTICo3 ring full check (producer side)
+ *
+ * @ring : ring indexes
+ *
+ * Return : 1 if there are no free entries to be produced, 0 otherwise
+ *
+ */
+static inline int a3_ring_full(struct a3ring_t *ring) {
+    return (__atomic_load_n(&ring->tail, __ATOMIC_RELAXED) - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) == A3_RING_SIZE;
+}
+
+
+/*
+ * ARTICo3 ring head slot (consumer side)
+ *
+ * Return : index of the entry to be consumed
+ *
+ */
+static inline unsigned int a3_ring_head(struct a3ring_t *ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_RELAXED) & (A3_RING_SIZE - 1);
+}
+
+
+/*
+ * ARTICo3 ring tail slot (producer side)
+ *
+ * Return : index of the entry to be produced
+ *
+ */
+static inline unsigned int a3_ring_tail(struct a3ring_t *ring) {
+    return __atomic_load_n(&ring->tail, __ATOMIC_RELAXED) & (A3_RING_SIZE - 1);
+}
+
+
+/*
+ * ARTICo3 ring push (producer side)
+ *
+ * This function publishes the entry previously written at a3_ring_tail().
+ *
+ */
+static inline void a3_ring_push(struct a3ring_t *ring) {
+    __atomic_store_n(&ring->tail, __atomic_load_n(&ring->tail, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+
+/*
+ * ARTICo3 ring pop (consumer side)
+ *
+ * This function releases the entry previously read at a3_ring_head().
+ *
+ */
+static inline void a3_ring_pop(struct a3ring_t *ring) {
+    __atomic_store_n(&ring->head, __atomic_load_n(&ring->head, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+#endif /* _ARTICO3_RING_H_ */
@@ -0,0 +1,150 @@
+/*
+ * ARTICo3 shared memory buffers
+ *
+ * Description : This file contains the helpers used by the daemon and the
+ *               users to map the POSIX shared memory objects that back
+ *               the kernel ports. Both sides create, resize and map the
+ *               same object (in any order, since allocations can be
+ *               batched), so they have to agree on its size.
+ *
+ *               Buffers allocated with A3_P_HUGE are backed by transparent
+ *               huge pages: the object is resized to a multiple of the
+ *               huge page size, mapped at a huge page-aligned address and
+ *               advised with MADV_HUGEPAGE before the first fault (this
+ *               requires "advise" or "always" in
+ *               /sys/kernel/mm/transparent_hugepage/shmem_enabled, and
+ *               silently falls back to regular pages otherwise). They are
+ *               then locked in memory, or pre-faulted if the process is
+ *               not allowed to lock that much memory (RLIMIT_MEMLOCK).
+ *
+ */
+
+
+#ifndef _ARTICO3_SHM_H_
+#define _ARTICO3_SHM_H_
+
+#include <stdio.h>     // fopen(), fscanf(), fclose()
+#include <stdint.h>    // uint8_t, uintptr_t
+#include <unistd.h>    // ftruncate(), close(), sysconf()
+#include <fcntl.h>     // O_RDWR, O_CREAT
+#include <sys/mman.h>  // shm_open(), mmap(), munmap(), madvise(), mlock()
+#include <sys/stat.h>  // S_IRUSR, S_IWUSR
+
+#define A3_HUGEPAGE_SIZE (2 * 1024 * 1024) // Default huge page size (if it cannot be read from sysfs)
+
+
+/*
+ * ARTICo3 huge page size
+ *
+ * Return : size (in bytes) of the transparent huge pages
+ *
+ */
+static inline size_t a3_shm_hugepagesize() {
+    FILE *fp;
+    unsigned long size = 0;
+
+    fp = fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+    if (fp) {
+        if (fscanf(fp, "%lu", &size) != 1) size = 0;
+        fclose(fp);
+    }
+
+    return size ? size : A3_HUGEPAGE_SIZE;
+}
+
+
+/*
+ * ARTICo3 shared memory object size
+ *
+ * @size : size of the buffer (in bytes)
+ * @huge : huge page-backed buffer
+ *
+ * Return : size (in bytes) of the shared memory object and its mappings
+ *
+ */
+static inline size_t a3_shm_size(size_t size, int huge) {
+    size_t align;
+
+    if (!huge) return size;
+    align = a3_shm_hugepagesize();
+    return ((size + align - 1) / align) * align;
+}
+
+
+/*
+ * ARTICo3 map shared memory object
+ *
+ * This function creates (if required), resizes and maps the POSIX shared
+ * memory object @filename.
+ *
+ * @filename : name of the POSIX shared memory object
+ * @size     : size of the object, as returned by a3_shm_size()
+ * @huge     : huge page-backed buffer
+ *
+ * Return : pointer to the mapped memory on success, MAP_FAILED otherwise
+ *
+ * NOTE   : the mapping is released with munmap(@size)
+ *
+ */
+static inline void *a3_shm_map(const char *filename, size_t size, int huge) {
+    int fd;
+    size_t align, off;
+    uint8_t *addr, *data;
+
+    // Create a shared memory object (it might not exist yet if batching)
+    fd = shm_open(filename, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        return MAP_FAILED;
+    }
+
+    // Resize the shared memory object (a mapping beyond its end would
+    // raise SIGBUS on first access)
+    if (ftruncate(fd, size) < 0) {
+        close(fd);
+        return MAP_FAILED;
+    }
+
+    // Regular buffers are mapped anywhere, and faulted on first access
+    if (!huge) {
+        data = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        return data;
+    }
+
+    // Reserve an address range large enough to align the mapping
+    align = a3_shm_hugepagesize();
+    addr = mmap(0, size + align, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (addr == MAP_FAILED) {
+        close(fd);
+        return MAP_FAILED;
+    }
+    off = (align - ((uintptr_t)addr % align)) % align;
+
+    // Map the shared memory object at the aligned address
+    data = mmap(addr + off, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        munmap(addr, size + align);
+        return MAP_FAILED;
+    }
+
+    // Release the unused parts of the reservation
+    if (off) munmap(addr, off);
+    munmap(addr + off + size, align - off);
+
+#ifdef MADV_HUGEPAGE
+    // Request huge pages (has to be done before the first fault)
+    madvise(data, size, MADV_HUGEPAGE);
+#endif
+
+    // Lock the buffer in memory (pre-faults all pages), or pre-fault it
+    if (mlock(data, size) < 0) {
+        for (off = 0; off < size; off += sysconf(_SC_PAGESIZE)) {
+            (void)((volatile uint8_t *)data)[off];
+        }
+    }
+
+    return data;
+}
+
+#endif /* _ARTICO3_SHM_H_ */
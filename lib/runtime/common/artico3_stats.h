@@ -0,0 +1,95 @@
+/*
+ * ARTICo3 request statistics
+ *
+ * Description : This file contains the primitives used to timestamp
+ *               requests (user and daemon), and to record their latency
+ *               in the log-scaled histograms of the statistics shared
+ *               memory object (see struct a3stats_t).
+ *
+ *               Histograms are updated without locks (relaxed atomic
+ *               operations), so that several delegate threads can record
+ *               samples at the same time, and external tools can read
+ *               them while the daemon is running.
+ *
+ */
+
+
+#ifndef _ARTICO3_STATS_H_
+#define _ARTICO3_STATS_H_
+
+#include <stdint.h> // uint64_t
+#include <time.h>   // clock_gettime()
+
+#include "artico3_data.h"
+
+
+/*
+ * ARTICo3 get timestamp
+ *
+ * NOTE : CLOCK_MONOTONIC is system-wide, so that timestamps taken by the
+ *        users and the daemon can be compared.
+ *
+ * Return : current time (ns)
+ *
+ */
+static inline uint64_t a3_stats_now() {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+
+    return ((uint64_t)t.tv_sec * 1000000000ull) + t.tv_nsec;
+}
+
+
+/*
+ * ARTICo3 histogram bucket
+ *
+ * @ns : latency sample (ns)
+ *
+ * Return : index of the histogram bucket for @ns
+ *
+ */
+static inline unsigned int a3_stats_bucket(uint64_t ns) {
+    unsigned int bucket;
+
+    if (ns == 0) return 0;
+    bucket = 63 - __builtin_clzll(ns);
+
+    return (bucket < A3_STATS_BUCKETS) ? bucket : (A3_STATS_BUCKETS - 1);
+}
+
+
+/*
+ * ARTICo3 histogram record
+ *
+ * @hist : latency histogram
+ * @ns   : latency sample (ns)
+ *
+ */
+static inline void a3_stats_record(struct a3hist_t *hist, uint64_t ns) {
+    uint64_t max;
+
+    __atomic_fetch_add(&hist->buckets[a3_stats_bucket(ns)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&hist->sum, ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&hist->count, 1, __ATOMIC_RELAXED);
+
+    max = __atomic_load_n(&hist->max, __ATOMIC_RELAXED);
+    while ((ns > max) && !__atomic_compare_exchange_n(&hist->max, &max, ns, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+
+/*
+ * ARTICo3 elapsed time
+ *
+ * @t0 : start timestamp (ns)
+ * @tf : end timestamp (ns)
+ *
+ * Return : time between @t0 and @tf (0 if @tf is older, e.g. timestamps
+ *          written by misbehaving users)
+ *
+ */
+static inline uint64_t a3_stats_elapsed(uint64_t t0, uint64_t tf) {
+    return (tf > t0) ? (tf - t0) : 0;
+}
+
+#endif /* _ARTICO3_STATS_H_ */
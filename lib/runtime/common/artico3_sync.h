@@ -0,0 +1,160 @@
+/*
+ * ARTICo3 synchronization primitives
+ *
+ * Description : This file contains the low-level primitives used to wait
+ *               for events published through shared memory words (spin
+ *               first, then sleep in the kernel using futexes), and to
+ *               publish read-mostly data through shared memory (seqlocks).
+ *
+ *               The spin budget (number of polling iterations before
+ *               falling back to FUTEX_WAIT) defaults to A3_SPIN_BUDGET, and
+ *               can be overridden at runtime with the environment variable
+ *               of the same name (0 disables spinning).
+ *
+ */
+
+
+#ifndef _ARTICO3_SYNC_H_
+#define _ARTICO3_SYNC_H_
+
+#include <stdint.h>       // uint32_t
+#include <stdlib.h>       // getenv(), strtoul()
+#include <unistd.h>       // syscall(), sysconf()
+#include <sys/syscall.h>  // SYS_futex
+#include <linux/futex.h>  // FUTEX_WAIT, FUTEX_WAKE
+
+#define A3_SPIN_BUDGET (2000) // Default number of polling iterations before sleeping
+
+
+/*
+ * ARTICo3 get spin budget
+ *
+ * NOTE : spinning is disabled by default on uniprocessor systems, where
+ *        the waiter would only delay the thread it is waiting for.
+ *
+ * Return : A3_SPIN_BUDGET environment variable if set, default value otherwise
+ *
+ */
+static inline unsigned int a3_spin_budget() {
+    const char *env = getenv("A3_SPIN_BUDGET");
+    if (env) return strtoul(env, NULL, 0);
+    return (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? A3_SPIN_BUDGET : 0;
+}
+
+
+/*
+ * ARTICo3 busy-wait hint
+ *
+ * This function tells the processor that the caller is spinning, so that
+ * it can save power or yield resources to sibling hardware threads.
+ *
+ */
+static inline void a3_cpu_relax() {
+#if defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__ ("yield" ::: "memory");
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    __asm__ __volatile__ ("" ::: "memory");
+#endif
+}
+
+
+/*
+ * ARTICo3 futex wait
+ *
+ * This function puts the caller to sleep as long as @uaddr holds @val.
+ *
+ * NOTE : futexes are not process-private, since the words live in
+ *        shared memory objects accessed by the daemon and the users.
+ *
+ * @uaddr : address of the shared memory word
+ * @val   : expected value of the shared memory word
+ *
+ */
+static inline void a3_futex_wait(uint32_t *uaddr, uint32_t val) {
+    syscall(SYS_futex, uaddr, FUTEX_WAIT, val, NULL, NULL, 0);
+}
+
+
+/*
+ * ARTICo3 futex wake
+ *
+ * This function wakes up every thread sleeping on @uaddr.
+ *
+ * @uaddr : address of the shared memory word
+ *
+ */
+static inline void a3_futex_wake(uint32_t *uaddr) {
+    syscall(SYS_futex, uaddr, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+}
+
+
+
+/*
+ * ARTICo3 seqlock write begin (single writer)
+ *
+ * This function marks the data protected by @seq as being updated (odd
+ * sequence number), so that readers retry.
+ *
+ * @seq : seqlock sequence number
+ *
+ */
+static inline void a3_seqlock_write_begin(uint32_t *seq) {
+    __atomic_store_n(seq, __atomic_load_n(seq, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+
+/*
+ * ARTICo3 seqlock write end (single writer)
+ *
+ * This function publishes the data protected by @seq (even sequence number).
+ *
+ * @seq : seqlock sequence number
+ *
+ */
+static inline void a3_seqlock_write_end(uint32_t *seq) {
+    __atomic_store_n(seq, __atomic_load_n(seq, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+
+/*
+ * ARTICo3 seqlock read begin
+ *
+ * This function waits until no update is in progress.
+ *
+ * @seq : seqlock sequence number
+ *
+ * Return : sequence number to be passed to a3_seqlock_read_retry()
+ *
+ */
+static inline uint32_t a3_seqlock_read_begin(const uint32_t *seq) {
+    uint32_t val;
+
+    while ((val = __atomic_load_n(seq, __ATOMIC_ACQUIRE)) & 1) {
+        a3_cpu_relax();
+    }
+
+    return val;
+}
+
+
+/*
+ * ARTICo3 seqlock read retry
+ *
+ * This function checks whether the data read since a3_seqlock_read_begin()
+ * might have been modified by a concurrent update.
+ *
+ * @seq : seqlock sequence number
+ * @val : sequence number returned by a3_seqlock_read_begin()
+ *
+ * Return : 1 if the data has to be read again, 0 otherwise
+ *
+ */
+static inline int a3_seqlock_read_retry(const uint32_t *seq, uint32_t val) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(seq, __ATOMIC_RELAXED) != val;
+}
+
+#endif /* _ARTICO3_SYNC_H_ */
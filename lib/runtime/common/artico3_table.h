@@ -0,0 +1,151 @@
+/*
+ * ARTICo3 slot tables
+ *
+ * Description : This file contains the primitives used to manage tables
+ *               of fixed-size entries that grow on demand (daemon users,
+ *               user channels), with O(1) slot allocation and release.
+ *
+ *               Entries are stored in chunks of A3_TABLE_CHUNK entries
+ *               that are never moved nor released until the table is
+ *               cleaned, so that a3_table_entry() can be called without
+ *               locks on slots that have already been allocated. Free
+ *               slots are kept in a LIFO stack (lowest indexes first).
+ *               Allocation and release are not thread-safe, callers
+ *               have to serialize them.
+ *
+ */
+
+
+#ifndef _ARTICO3_TABLE_H_
+#define _ARTICO3_TABLE_H_
+
+#include <stdlib.h> // calloc(), realloc(), free()
+#include <errno.h>  // ENOMEM, ENOSPC
+
+#define A3_TABLE_CHUNK     (16)   // Number of entries per table chunk
+#define A3_TABLE_MAXCHUNKS (4096) // Max number of table chunks
+
+
+/*
+ * ARTICo3 slot table
+ *
+ * @size    : size (in bytes) of each entry
+ * @nslots  : number of allocated slots (free or in use)
+ * @nfree   : number of free slots
+ * @free    : stack of free slot indexes
+ * @chunks  : entry chunks
+ *
+ */
+struct a3table_t {
+    size_t size;
+    unsigned int nslots;
+    unsigned int nfree;
+    int *free;
+    char *chunks[A3_TABLE_MAXCHUNKS];
+};
+
+
+/*
+ * ARTICo3 slot table init
+ *
+ * @table : slot table
+ * @size  : size (in bytes) of each entry
+ *
+ */
+static inline void a3_table_init(struct a3table_t *table, size_t size) {
+    unsigned int i;
+
+    table->size = size;
+    table->nslots = 0;
+    table->nfree = 0;
+    table->free = NULL;
+    for (i = 0; i < A3_TABLE_MAXCHUNKS; i++) {
+        table->chunks[i] = NULL;
+    }
+}
+
+
+/*
+ * ARTICo3 slot table clean
+ *
+ * @table : slot table
+ *
+ */
+static inline void a3_table_clean(struct a3table_t *table) {
+    unsigned int i;
+
+    for (i = 0; i < (table->nslots / A3_TABLE_CHUNK); i++) {
+        free(table->chunks[i]);
+        table->chunks[i] = NULL;
+    }
+    free(table->free);
+    table->free = NULL;
+    table->nslots = 0;
+    table->nfree = 0;
+}
+
+
+/*
+ * ARTICo3 slot table entry
+ *
+ * @table : slot table
+ * @index : slot index (has to be lower than @table->nslots)
+ *
+ * Return : pointer to the (zero-initialized on growth) table entry
+ *
+ */
+static inline void *a3_table_entry(struct a3table_t *table, int index) {
+    return &(table->chunks[index / A3_TABLE_CHUNK][(index % A3_TABLE_CHUNK) * table->size]);
+}
+
+
+/*
+ * ARTICo3 slot table allocation
+ *
+ * This function pops a free slot, adding a new chunk of slots to the
+ * table when none is available.
+ *
+ * @table : slot table
+ *
+ * Return : slot index on success, error code otherwise
+ *
+ */
+static inline int a3_table_get(struct a3table_t *table) {
+    unsigned int i, chunk;
+    int *stack = NULL;
+
+    // Grow table if required
+    if (table->nfree == 0) {
+        chunk = table->nslots / A3_TABLE_CHUNK;
+        if (chunk == A3_TABLE_MAXCHUNKS) return -ENOSPC;
+
+        stack = realloc(table->free, (table->nslots + A3_TABLE_CHUNK) * sizeof *stack);
+        if (!stack) return -ENOMEM;
+        table->free = stack;
+
+        table->chunks[chunk] = calloc(A3_TABLE_CHUNK, table->size);
+        if (!table->chunks[chunk]) return -ENOMEM;
+
+        // Push new slots in reverse order (lowest indexes are popped first)
+        for (i = 0; i < A3_TABLE_CHUNK; i++) {
+            table->free[table->nfree++] = table->nslots + A3_TABLE_CHUNK - 1 - i;
+        }
+        table->nslots += A3_TABLE_CHUNK;
+    }
+
+    return table->free[--table->nfree];
+}
+
+
+/*
+ * ARTICo3 slot table release
+ *
+ * @table : slot table
+ * @index : slot index (returned by a3_table_get())
+ *
+ */
+static inline void a3_table_put(struct a3table_t *table, int index) {
+    table->free[table->nfree++] = index;
+}
+
+#endif /* _ARTICO3_TABLE_H_ */
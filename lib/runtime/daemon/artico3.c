@@ -37,7 +37,14 @@
 #include "artico3_rcfg.h"
 #include "artico3_dbg.h"
 #include "artico3_data.h"
+#include "artico3_ring.h"
+#include "artico3_sync.h"
+#include "artico3_args.h"
+#include "artico3_table.h"
+#include "artico3_stats.h"
 #include "artico3_pool.h"
+#include "artico3_copy.h"
+#include "artico3_shm.h"
 
 #include <inttypes.h>
 
@@ -51,6 +58,59 @@ const char * __shm_directory(size_t * len) {
 }
 
 
+/*
+ * ARTICo3 user slot (entry of the user table)
+ *
+ * @user           : user shared memory object (NULL if the slot is free or the user is being removed)
+ * @refs           : number of requests and asynchronous executions using the user
+ * @released       : condition signaled when a reference is released
+ * @pid            : process ID of the user (zero-copy ports are only shared with it)
+ * @response_mutex : user completion queue lock
+ *
+ * NOTE : slots are never moved (see artico3_table.h), so delegate threads
+ *        can access the slot of the user that sent the request without
+ *        locking the user table.
+ * NOTE : @user and @refs are accessed holding @users_mutex. The user shared
+ *        memory object is not released while @refs is not zero.
+ *
+ */
+struct a3userslot_t {
+    struct a3user_t *user;
+    unsigned int refs;
+    pthread_cond_t released;
+    pid_t pid;
+    pthread_mutex_t response_mutex;
+};
+
+
+/*
+ * ARTICo3 DMA request queue
+ *
+ * The hardware infrastructure (Data Shuffler configuration registers, DMA
+ * engine and accelerator registers) is shared by all kernels. Accesses to
+ * it are serialized in arrival order using a ticket queue, so that the
+ * rest of the work of a transfer (setting it up, and copying data to and
+ * from the DMA staging buffers) can be done concurrently with the
+ * transfers of other kernels.
+ *
+ * NOTE : the shuffler shadow registers (ID, TMR, DMR) can be read holding
+ *        either @mutex or the DMA request queue, and they can only be
+ *        modified holding both (always locked in that order).
+ *
+ * @lock : queue lock
+ * @cond : queue condition (signaled when a request is served)
+ * @head : ticket of the request being served
+ * @tail : ticket of the next request
+ *
+ */
+struct a3dmaqueue_t {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    unsigned long head;
+    unsigned long tail;
+};
+
+
 /*
  * ARTICo3 global variables
  *
@@ -59,13 +119,19 @@ const char * __shm_directory(size_t * len) {
  *
  * @shuffler            : current ARTICo3 infrastructure configuration
  * @kernels             : current kernel list
+ * @kernel_seq          : kernel creation sequence number (used to build kernel handles)
  *
  * @threads             : array of delegate scheduling threads
- * @mutex               : synchronization primitive for accessing @running
- * @running             : number of hardware kernels currently running (write/run/read)
+ * @mutex               : synchronization primitive for accessing the ARTICo3 configuration
+ *                        (slots, kernel ports, transfer plans and DMA staging buffers)
+ * @quiescent           : condition signaled when a kernel finishes a round (see a3kernel_t)
+ * @dmaqueue            : DMA request queue (hardware infrastructure accesses)
+ * @dmachans            : number of DMA channels in the platform (each kernel uses one)
  *
  * @coordinator         : current ARTICo3 Daemon coordinator
- * @users               : current user list
+ * @topology            : current ARTICo3 topology (published to the users)
+ * @stats               : current ARTICo3 request statistics (published to external tools)
+ * @users               : current user table (struct a3userslot_t entries, indexed by user ID)
  *
  * @add_user_mutex      : synchronization primitive for adding a new user
  * @kernel_create_mutex : synchronization primitive for creating a new kernel
@@ -73,8 +139,14 @@ const char * __shm_directory(size_t * len) {
  * @users_mutex         : synchronization primitive for accessing @users
  *
  * @termination_flag    : flag to signal artico3_handle_request() loop termination
+ * @spin_budget         : polling iterations before sleeping when waiting for user requests
+ * @dma_hysteresis      : time (ns) idle DMA staging buffers are kept in the kernel pools
+ * @dma_cached          : allocate cached DMA staging buffers (instead of coherent ones)
+ * @pipeline            : overlap memory copies of each round with the execution of the previous one
+ * @copyengine          : parallel engine for the copies between user ports and DMA staging buffers
  *
  * @artico3_functions   : array of ARTICo3 function pointers
+ * @artico3_names       : array of ARTICo3 function names (same order as @artico3_functions)
  *
  * @kernels_pool        : thread pool to handle kernels executions
  * @requests_pool       : thread pool to handle incoming user requests
@@ -93,13 +165,24 @@ struct a3shuffler_t shuffler = {
     .slots       = NULL,
 };
 static struct a3kernel_t **kernels = NULL;
+static unsigned int kernel_seq = 0;
+static unsigned long const_seq = 0;
 
 static pthread_t *threads = NULL;
 static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
-static int running = 0;
+static pthread_cond_t quiescent = PTHREAD_COND_INITIALIZER;
+static struct a3dmaqueue_t dmaqueue = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+    .head = 0,
+    .tail = 0,
+};
+static unsigned int dmachans = 1;
 
 static struct a3coordinator_t *coordinator = NULL;
-static struct a3user_t **users = NULL;
+static struct a3topology_t *topology = NULL;
+static struct a3stats_t *stats = NULL;
+static struct a3table_t users;
 
 static pthread_mutex_t add_user_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t kernel_create_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -107,6 +190,11 @@ static pthread_mutex_t kernels_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t users_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static int termination_flag = 0;
+static unsigned int spin_budget = A3_SPIN_BUDGET;
+static uint64_t dma_hysteresis = A3_DMA_HYSTERESIS * 1000000ull;
+static int dma_cached = A3_DMA_CACHED;
+static int pipeline = A3_PIPELINE;
+static struct a3copyengine_t copyengine;
 
 static a3func_t artico3_functions[] = {
     artico3_add_user,
@@ -122,7 +210,36 @@ static a3func_t artico3_functions[] = {
     artico3_alloc,
     artico3_free,
     artico3_remove_user,
-    artico3_get_naccs
+    artico3_get_naccs,
+    artico3_batch,
+    artico3_kernel_execute_async,
+    artico3_alloc_zc,
+    artico3_kernel_vcount,
+    artico3_kernel_stream,
+    artico3_port_view
+};
+
+static const char *artico3_names[] = {
+    "add_user",
+    "load",
+    "unload",
+    "kernel_create",
+    "kernel_release",
+    "kernel_execute",
+    "kernel_wait",
+    "kernel_reset",
+    "kernel_wcfg",
+    "kernel_rcfg",
+    "alloc",
+    "free",
+    "remove_user",
+    "get_naccs",
+    "batch",
+    "kernel_execute_async",
+    "alloc_zc",
+    "kernel_vcount",
+    "kernel_stream",
+    "port_view"
 };
 
 static struct a3pool_t *kernels_pool;
@@ -130,1326 +247,4027 @@ static struct a3pool_t *requests_pool;
 
 
 /*
- * ARTICo3 signal handler for SIGTERM and SIGINT
+ * ARTICo3 enter DMA request queue
  *
- * This function sets a termination flag when SIGTERM and SIGINT is received, signaling the daemon
- * to stop and perform a clean shutdown.
+ * This function waits until all previous requests to access the hardware
+ * infrastructure have been served.
  *
- * @signum : signal number (SIGTERM, SIGINT)
  */
-void artico3_handle_sigterm(int signum) {
+static void _artico3_dma_enter() {
+    unsigned long ticket;
 
-    // Set stop termination flag when signal is received
-    // Signal the request waiting thread to terminate
-    pthread_mutex_lock(&coordinator->mutex);
-    termination_flag = 1;
-    a3_print_info("[artico3-hw] signal [%d] received\n", signum);
-    pthread_cond_signal(&coordinator->cond_request);
-    pthread_mutex_unlock(&coordinator->mutex);
+    pthread_mutex_lock(&dmaqueue.lock);
+    ticket = dmaqueue.tail++;
+    while (ticket != dmaqueue.head) {
+        pthread_cond_wait(&dmaqueue.cond, &dmaqueue.lock);
+    }
+    pthread_mutex_unlock(&dmaqueue.lock);
+}
 
+
+/*
+ * ARTICo3 leave DMA request queue
+ *
+ * This function releases the hardware infrastructure to the next request
+ * in the queue.
+ *
+ */
+static void _artico3_dma_leave() {
+    pthread_mutex_lock(&dmaqueue.lock);
+    dmaqueue.head++;
+    pthread_cond_broadcast(&dmaqueue.cond);
+    pthread_mutex_unlock(&dmaqueue.lock);
 }
 
+
 /*
- * ARTICo3 init function
+ * ARTICo3 get DMA channel of a kernel
  *
- * This function sets up the basic software entities required to manage
- * the ARTICo3 low-level functionality (DMA transfers, kernel and slot
- * distributions, etc.).
+ * Kernels are assigned DMA channels in a round-robin fashion, so that
+ * the completion of their transfers is tracked independently.
  *
- * It also loads the FPGA with the initial bitstream (static system).
+ * @id : current kernel ID
+ *
+ * Return : DMA channel
  *
- * Return : 0 on success, error code otherwise
  */
-int artico3_init() {
-    const char *filename = "/dev/artico3";
-    unsigned int i;
-    int ret, shm_fd;
-    struct sigaction action;
+static unsigned int _artico3_dma_channel(uint8_t id) {
+    return (id - 1) % dmachans;
+}
 
-    /*
-     * NOTE: this function relies on predefined addresses for both control
-     *       and data interfaces of the ARTICo3 infrastructure.
-     *       If the processor memory map is changed somehow, this has to
-     *       be reflected in this file.
-     *
-     *       Zynq-7000 Devices
-     *       ARTICo3 Control -> 0x7aa00000
-     *       ARTICo3 Data    -> 0x8aa00000
-     *
-     *       Zynq UltraScale+ MPSoC Devices
-     *       ARTICo3 Control -> 0xa0000000
-     *       ARTICo3 Data    -> 0xb0000000
-     *
-     */
 
-    // Set up the signal handler to terminate the daemon SIGTERM
-    action.sa_handler = artico3_handle_sigterm;
-    sigemptyset(&action.sa_mask);
-    action.sa_flags = 0;
+/*
+ * ARTICo3 wait for DMA transfer to finish
+ *
+ * @channel : DMA channel used by the transfer
+ *
+ */
+static void _artico3_dma_wait(unsigned int channel) {
+    ioctl(artico3_fd, ARTICo3_IOC_DMA_WAIT, &channel);
+}
 
-    if (sigaction(SIGTERM, &action, NULL) == -1 || sigaction(SIGINT, &action, NULL) == -1) {
-        a3_print_error("[artico3-hw] SIGTERM/SIGINT handler error\n");
-    }
 
-    // Load static system (global FPGA reconfiguration)
-    fpga_load("system.bin", 0);
+/*
+ * ARTICo3 publish topology
+ *
+ * This function updates the topology shared with the users after any
+ * change in the kernel list or in the Shuffler configuration.
+ *
+ * NOTE : this function has to be called with mutex locked (it is the
+ *        single writer of the topology).
+ *
+ */
+static void _artico3_publish_topology() {
+    unsigned int index, slot;
+    struct a3topokernel_t *entry = NULL;
+
+    a3_seqlock_write_begin(&topology->seq);
+
+    // Update Shuffler configuration
+    topology->generation++;
+    topology->nslots = shuffler.nslots;
+    topology->id_reg = shuffler.id_reg;
+    topology->tmr_reg = shuffler.tmr_reg;
+    topology->dmr_reg = shuffler.dmr_reg;
+
+    // Update kernel entries
+    for (index = 0; index < A3_TOPOLOGY_MAXKERNS; index++) {
+        entry = &topology->kernels[index];
+        entry->id = 0;
+        entry->handle = 0;
+        entry->naccs = 0;
+        entry->slotmask = 0;
+        entry->name[0] = '\0';
+        if (index >= A3_MAXKERNS) continue;
 
-    // Open ARTICo3 device file
-    artico3_fd = open(filename, O_RDWR);
-    if (artico3_fd < 0) {
-        a3_print_error("[artico3-hw] open() %s failed\n", filename);
-        return -ENODEV;
-    }
-    a3_print_debug("[artico3-hw] artico3_fd=%d | dev=%s\n", artico3_fd, filename);
+        pthread_mutex_lock(&kernels_mutex);
+        if (kernels[index]) {
+            entry->id = kernels[index]->id;
+            entry->handle = kernels[index]->handle;
+            strncpy(entry->name, kernels[index]->name, A3_NAME_SIZE - 1);
+            entry->name[A3_NAME_SIZE - 1] = '\0';
+        }
+        pthread_mutex_unlock(&kernels_mutex);
+        if (!entry->id) continue;
 
-    // Obtain access to physical memory map using mmap()
-    artico3_hw = mmap(NULL, 0x100000, PROT_READ | PROT_WRITE, MAP_SHARED, artico3_fd, 0);
-    if (artico3_hw == MAP_FAILED) {
-        a3_print_error("[artico3-hw] mmap() failed\n");
-        ret = -ENOMEM;
-        goto err_mmap;
+        for (slot = 0; slot < shuffler.nslots; slot++) {
+            if (((shuffler.id_reg >> (4 * slot)) & 0xf) == entry->id) entry->slotmask |= 1 << slot;
+        }
+        if (entry->slotmask) entry->naccs = artico3_hw_get_naccs(entry->id);
     }
-    a3_print_debug("[artico3-hw] artico3_hw=%p\n", artico3_hw);
 
-    // Get maximum number of ARTICo3 slots in the platform
-    shuffler.nslots = artico3_hw_get_nslots();
-    if (shuffler.nslots == 0) {
-        a3_print_error("[artico3-hw] firmware read (number of slots) failed\n");
-        ret = -ENODEV;
-        goto err_malloc_slots;
+    a3_seqlock_write_end(&topology->seq);
+
+    a3_print_debug("[artico3-hw] published topology (generation=%u)\n", topology->generation);
+}
+
+
+/*
+ * ARTICo3 find kernel
+ *
+ * This function gets the position of a kernel in the kernel list. Kernels
+ * referenced by handle are accessed directly; kernels referenced by name
+ * (compatibility layer, batched calls) are searched in the whole list.
+ *
+ * NOTE : this function has to be called with kernels_mutex locked.
+ *
+ * @kernel : kernel handle (0 to search by name)
+ * @name   : kernel name (only used when @kernel is 0)
+ *
+ * Return : kernel list index on success, error code otherwise
+ *
+ */
+static int _artico3_kernel_find(int kernel, const char *name) {
+    unsigned int index;
+
+    // Kernel referenced by handle (the kernel ID is encoded in the handle)
+    if (kernel) {
+        index = A3_KERNEL_HANDLE_ID(kernel) - 1;
+        if ((kernel < 0) || (index >= A3_MAXKERNS) || !kernels[index] || (kernels[index]->handle != kernel)) {
+            a3_print_error("[artico3-hw] no kernel found with handle %d\n", kernel);
+            return -ENODEV;
+        }
+        return index;
     }
 
-    // Initialize Shuffler structure (software)
-    shuffler.slots = malloc(shuffler.nslots * sizeof (struct a3slot_t));
-    if (!shuffler.slots) {
-        a3_print_error("[artico3-hw] malloc() failed\n");
-        ret = -ENOMEM;
-        goto err_malloc_slots;
+    // Kernel referenced by name
+    for (index = 0; index < A3_MAXKERNS; index++) {
+        if (!kernels[index]) continue;
+        if (strcmp(kernels[index]->name, name) == 0) break;
     }
-    for (i = 0; i < shuffler.nslots; i++) {
-        shuffler.slots[i].kernel = NULL;
-        shuffler.slots[i].state = S_EMPTY;
+    if (index == A3_MAXKERNS) {
+        a3_print_error("[artico3-hw] no kernel found with name \"%s\"\n", name);
+        return -ENODEV;
     }
-    a3_print_debug("[artico3-hw] shuffler.slots=%p\n", shuffler.slots);
 
-    // Initialize kernel list (software)
-    kernels = malloc(A3_MAXKERNS * sizeof **kernels);
-    if (!kernels) {
-        a3_print_error("[artico3-hw] malloc() failed\n");
-        ret = -ENOMEM;
-        goto err_malloc_kernels;
+    return index;
+}
+
+
+/*
+ * ARTICo3 release idle DMA staging buffers
+ *
+ * This function releases the DMA staging buffers of a kernel that have
+ * been idle in its pool for longer than the configured hysteresis.
+ *
+ * NOTE : @mutex has to be held by the caller.
+ *
+ * @kernel : hardware kernel
+ * @force  : release every buffer in the pool, regardless of idle time
+ *
+ */
+static void _artico3_dma_trim(struct a3kernel_t *kernel, int force) {
+    struct a3dmabuf_t **prev = NULL, *buf = NULL;
+    uint64_t now = a3_stats_now();
+
+    prev = &kernel->dmabufs;
+    while (*prev) {
+        buf = *prev;
+        if (force || ((now - buf->tidle) >= dma_hysteresis)) {
+            *prev = buf->next;
+            a3_print_debug("[artico3-hw] releasing DMA staging buffer (kernel=%s,size=%zd)\n", kernel->name, buf->size);
+            munmap(buf->mem, buf->size);
+            free(buf);
+        }
+        else {
+            prev = &buf->next;
+        }
     }
-    for (i = 0; i < A3_MAXKERNS; i++) {
-        kernels[i] = NULL;
+}
+
+
+/*
+ * ARTICo3 get DMA staging buffer
+ *
+ * This function returns a DMA staging buffer of (at least) the requested
+ * size. Buffer sizes are rounded up to a power-of-two number of pages
+ * (size classes), and buffers are reused from the kernel pool whenever
+ * possible, so that the allocation in the driver (mmap()) is only
+ * performed when the pool has no buffer of the required class. New
+ * buffers are allocated in cached memory when requested (see
+ * A3_DMA_CACHED), falling back to coherent memory if the driver cannot
+ * allocate them (cached memory is limited by the kernel page allocator).
+ *
+ * NOTE : @mutex has to be held by the caller.
+ *
+ * @kernel : hardware kernel
+ * @size   : required size (in bytes)
+ *
+ * Return : DMA staging buffer on success, NULL otherwise
+ *
+ */
+static struct a3dmabuf_t *_artico3_dma_get(struct a3kernel_t *kernel, size_t size) {
+    struct a3dmabuf_t **prev = NULL, *buf = NULL;
+    size_t mapsize;
+
+    // Compute size class
+    for (mapsize = sysconf(_SC_PAGESIZE); mapsize < size; mapsize <<= 1);
+
+    // Reuse buffer from pool
+    for (prev = &kernel->dmabufs; *prev; prev = &(*prev)->next) {
+        if ((*prev)->size == mapsize) {
+            buf = *prev;
+            *prev = buf->next;
+            return buf;
+        }
     }
-    a3_print_debug("[artico3-hw] kernels=%p\n", kernels);
 
-    // Initialize delegate threads
-    threads = malloc(A3_MAXKERNS * sizeof *threads);
-    if (!threads) {
+    // Allocate new buffer
+    buf = malloc(sizeof *buf);
+    if (!buf) {
         a3_print_error("[artico3-hw] malloc() failed\n");
-        ret = -ENOMEM;
-        goto err_malloc_threads;
+        return NULL;
     }
-    for (i = 0; i < A3_MAXKERNS; i++) {
-        threads[i] = 0;
+    buf->mem = MAP_FAILED;
+    buf->cached = 0;
+    if (dma_cached) {
+        buf->mem = mmap(NULL, mapsize, PROT_READ | PROT_WRITE, MAP_SHARED, artico3_fd, (ARTICo3_MMAP_DMA | ARTICo3_MMAP_CACHED) * sysconf(_SC_PAGESIZE));
+        buf->cached = (buf->mem != MAP_FAILED);
     }
-    a3_print_debug("[artico3-hw] threads=%p\n", threads);
-
-    // Initialize users list (software)
-    users = malloc(A3_MAXUSERS * sizeof **users);
-    if (!users) {
-        a3_print_error("[artico3-hw] malloc() failed\n");
-        ret = -ENOMEM;
-        goto err_malloc_users;
+    if (buf->mem == MAP_FAILED) {
+        buf->mem = mmap(NULL, mapsize, PROT_READ | PROT_WRITE, MAP_SHARED, artico3_fd, ARTICo3_MMAP_DMA * sysconf(_SC_PAGESIZE));
     }
-    for (i = 0; i < A3_MAXUSERS; i++) {
-        users[i] = NULL;
+    if (buf->mem == MAP_FAILED) {
+        a3_print_error("[artico3-hw] mmap() failed\n");
+        free(buf);
+        return NULL;
     }
-    a3_print_debug("[artico3-hw] users=%p\n", users);
+    buf->size = mapsize;
+    a3_print_debug("[artico3-hw] allocated DMA staging buffer (kernel=%s,size=%zd,cached=%d)\n", kernel->name, buf->size, buf->cached);
 
-    // Enable clocks in reconfigurable region
-    artico3_hw_enable_clk();
+    return buf;
+}
 
-    // Print ARTICo3 control registers
-    artico3_hw_print_regs();
 
-    // Create a shared memory object for coordinator
-    shm_fd = shm_open(A3_COORDINATOR_FILENAME, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
-    if(shm_fd < 0) {
-        a3_print_error("[artico3-hw] shm_open() failed\n");
-        ret = -ENODEV;
-        goto err_shm;
-    }
+/*
+ * ARTICo3 put DMA staging buffer
+ *
+ * This function returns a DMA staging buffer to the kernel pool, and
+ * releases the buffers that have been idle for too long.
+ *
+ * NOTE : @mutex has to be held by the caller.
+ *
+ * @kernel : hardware kernel
+ * @buf    : DMA staging buffer (obtained with _artico3_dma_get())
+ *
+ */
+static void _artico3_dma_put(struct a3kernel_t *kernel, struct a3dmabuf_t *buf) {
+    buf->tidle = a3_stats_now();
+    buf->next = kernel->dmabufs;
+    kernel->dmabufs = buf;
+    _artico3_dma_trim(kernel, 0);
+}
 
-    // Resize the shared memory object
-    ftruncate(shm_fd, sizeof (struct a3coordinator_t));
 
-    // Allocate memory for application mapped to the shared memory object with mmap()
-    coordinator = mmap(0, sizeof (struct a3coordinator_t), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
-    if(coordinator == MAP_FAILED) {
-        a3_print_error("[artico3-hw] mmap() failed\n");
-        close(shm_fd);
-        shm_unlink(A3_COORDINATOR_FILENAME);
-        ret = -ENODEV;
-        goto err_shm;
-    }
-    a3_print_debug("[artico3-hw] mmap=%p\n", coordinator);
+/*
+ * ARTICo3 synchronize cached DMA memory
+ *
+ * Cached DMA memory (staging buffers and zero-copy ports) requires
+ * explicit cache maintenance around each DMA transfer: ownership is given
+ * to the device before any transfer (CPU caches written back and
+ * invalidated), and back to the CPU after a transfer from the
+ * accelerators (CPU caches invalidated). Coherent memory requires none.
+ *
+ * @mem    : user-space map of the cached DMA memory
+ * @offset : offset (in bytes) of the range involved in the DMA transfer
+ * @size   : size (in bytes) of the range involved in the DMA transfer
+ * @cmd    : ARTICo3_IOC_DMA_SYNC_DEV (before DMA) or ARTICo3_IOC_DMA_SYNC_CPU (after DMA)
+ *
+ */
+static void _artico3_dma_sync(void *mem, size_t offset, size_t size, unsigned long cmd) {
+    struct dmaproxy_sync_token token;
 
-    // Close shared memory object file descriptor (not needed anymore)
-    close(shm_fd);
+    if (!size) return;
 
-    // Initialize mutex and condition variables with shared memory attributes
-    pthread_mutexattr_t mutex_attr;
-    pthread_condattr_t cond_attr;
+    token.memaddr = mem;
+    token.memoff = offset;
+    token.size = size;
+    ioctl(artico3_fd, cmd, &token);
+}
 
-    pthread_mutexattr_init(&mutex_attr);
-    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
-    pthread_mutex_init(&coordinator->mutex, &mutex_attr);
-    pthread_mutexattr_destroy(&mutex_attr);
 
-    pthread_condattr_init(&cond_attr);
-    pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
-    pthread_cond_init(&coordinator->cond_request, &cond_attr);
-    pthread_cond_init(&coordinator->cond_free, &cond_attr);
-    pthread_condattr_destroy(&cond_attr);
+/*
+ * ARTICo3 release transfer plan
+ *
+ * This function drops a reference to a transfer plan, and frees it when
+ * it is no longer referenced.
+ *
+ * NOTE : @mutex has to be held by the caller.
+ *
+ * @plan : transfer plan (NULL is ignored)
+ *
+ */
+static void _artico3_plan_put(struct a3plan_t *plan) {
+    if (!plan) return;
+    if (--plan->refs == 0) free(plan);
+}
 
-    // Initialize flags
-    coordinator->request_available = 0;
-    coordinator->request.user_id = 0;
-    coordinator->request.channel_id = 0;
-    coordinator->request.func = 0;
 
-	// Initialize kernels thread pool
-    kernels_pool = artico3_pool_init(A3_MAXKERNS, 0);
-	if (!kernels_pool) {
-		a3_print_error("[artico3-hw] kernels thread pool failed\n");
-        ret = -ENODEV;
-        goto err_kernels_pool;
-	}
-    a3_print_debug("[artico3-hw] kernels thread pool=%p\n", kernels_pool);
-
-	// Initialize the requests thread pool
-    requests_pool = artico3_pool_init(A3_MAXKERNS, 1);
-	if(!requests_pool) {
-		a3_print_error("[artico3-hw] request thread pool failed\n");
-        ret = -ENODEV;
-        goto err_requests_pool;
-	}
-    a3_print_debug("[artico3-hw] request thread pool=%p\n", requests_pool);
-
-    return 0;
-
-err_requests_pool:
-    artico3_pool_clean(kernels_pool);
-
-err_kernels_pool:
-    pthread_mutex_destroy(&coordinator->mutex);
-    pthread_cond_destroy(&coordinator->cond_request);
-
-err_shm:
-    free(users);
-
-err_malloc_users:
-    free(threads);
-
-err_malloc_threads:
-    free(kernels);
-
-err_malloc_kernels:
-    free(shuffler.slots);
-
-err_malloc_slots:
-    munmap(artico3_hw, 0x100000);
-
-err_mmap:
-    close(artico3_fd);
+/*
+ * ARTICo3 invalidate transfer plans
+ *
+ * This function removes the cached transfer plans of a kernel, so that
+ * they are rebuilt in its next transfer (plans still referenced by
+ * ongoing transfers are freed when these are released).
+ *
+ * NOTE : @mutex has to be held by the caller.
+ *
+ * @kernel : hardware kernel
+ *
+ */
+static void _artico3_plan_invalidate(struct a3kernel_t *kernel) {
+    unsigned int i;
 
-    return ret;
+    for (i = 0; i < A3_PLANS; i++) {
+        _artico3_plan_put(kernel->plans[i]);
+        kernel->plans[i] = NULL;
+    }
 }
 
 
 /*
- * ARTICo3 exit function
+ * ARTICo3 get port view tile end
  *
- * This function cleans the software entities created by artico3_init().
+ * @view : port view
+ * @tile : tile (work-group) index
+ * @end  : first word after the tile in the port buffer
+ *
+ * Return : 0 on success, -EINVAL on overflow
  *
  */
-void artico3_exit() {
-
-    // Destroy thread pool
-    artico3_pool_clean(kernels_pool);
-    artico3_pool_clean(requests_pool);
-
-    // cleanup mutex and conditional variables
-    pthread_mutex_destroy(&coordinator->mutex);
-    pthread_cond_destroy(&coordinator->cond_request);
-    pthread_cond_destroy(&coordinator->cond_free);
-
-    // Cleanup daemon shared memory
-    munmap(coordinator, sizeof (struct a3coordinator_t));
-    shm_unlink(A3_COORDINATOR_FILENAME);
+static int _artico3_view_end(const struct a3view_t *view, size_t tile, size_t *end) {
+    size_t aux;
 
-    // Print ARTICo3 control registers
-    artico3_hw_print_regs();
-
-    // Disable clocks in reconfigurable region
-    artico3_hw_disable_clk();
-
-    // Release allocated memory for user list
-    free(users);
-
-    // Release allocated memory for delegate threads
-    free(threads);
-
-    // Release allocated memory for kernel list
-    free(kernels);
+    if (__builtin_mul_overflow(tile % view->ntiles, view->tstep, end)) return -EINVAL;
+    if (__builtin_mul_overflow(tile / view->ntiles, view->gstep, &aux)) return -EINVAL;
+    if (__builtin_add_overflow(*end, aux, end)) return -EINVAL;
+    if (__builtin_mul_overflow(view->rows - 1, view->stride, &aux)) return -EINVAL;
+    if (__builtin_add_overflow(*end, aux, end)) return -EINVAL;
+    if (__builtin_add_overflow(*end, view->offset + view->cols, end)) return -EINVAL;
 
-    // Release allocated memory for slot info
-    free(shuffler.slots);
+    return 0;
+}
 
-    // Release memory obtained with mmap()
-    munmap(artico3_hw, 0x100000);
 
-    // Close ARTICo3 device file
-    close(artico3_fd);
+/*
+ * ARTICo3 check port view bounds
+ *
+ * This function checks that the tiles of @nrounds work-groups lie inside
+ * the port buffer. Since steps are not negative, the farthest tile is
+ * either the last one or, if the last group is not complete, the last
+ * tile of the previous group.
+ *
+ * @view    : port view
+ * @words   : size of the port buffer, in 32-bit words
+ * @nrounds : number of work-groups
+ *
+ * Return : 0 if the tiles fit in the buffer, -EINVAL otherwise
+ *
+ */
+static int _artico3_view_check(const struct a3view_t *view, size_t words, unsigned int nrounds) {
+    size_t end, ngroups;
 
-    // Restore Data Shuffler structure
-    shuffler.id_reg      = 0x0000000000000000;
-    shuffler.tmr_reg     = 0x0000000000000000;
-    shuffler.dmr_reg     = 0x0000000000000000;
-    shuffler.blksize_reg = 0x00000000;
-    shuffler.clkgate_reg = 0x00000000;
-    shuffler.nslots      = 0;
-    shuffler.slots       = NULL;
+    if ((_artico3_view_end(view, nrounds - 1, &end) < 0) || (end > words)) return -EINVAL;
+    ngroups = (nrounds - 1) / view->ntiles;
+    if (ngroups && ((_artico3_view_end(view, (ngroups * view->ntiles) - 1, &end) < 0) || (end > words))) return -EINVAL;
 
+    return 0;
 }
 
 
 /*
- * ARTICo3 add new user
+ * ARTICo3 check port views of a kernel execution
  *
- * This function creates the software entities required to manage a new user.
+ * This function checks that the tiles of every input, output and
+ * bidirectional I/O port with view lie inside their buffers for a given
+ * work size.
  *
- * @args             : buffer storing the function arguments sent by the user
- *     @shm_filename : user shared memory object filename
+ * @kernel : hardware kernel
+ * @gsize  : global work size (total amount of work to be done)
+ * @lsize  : local work size (work that can be done by one accelerator)
  *
- * TODO: create folders and subfolders on /dev/shm for each user and its data (kernels, inputs, etc.)
+ * Return : 0 if all the views fit in their ports, -EINVAL otherwise
  *
- * Return : A3_MAXKERNS on success, error code otherwise
  */
-int artico3_add_user(void *args) {
-    unsigned int index;
-    int shm_fd;
-
-    // Get function arguments
-    // @shm_filename
-    char *shm_filename = args;
-
-    pthread_mutex_lock(&add_user_mutex);
+static int _artico3_kernel_views_check(struct a3kernel_t *kernel, size_t gsize, size_t lsize) {
+    unsigned int i, j;
+    struct a3port_t **lists[] = {kernel->inputs, kernel->outputs, kernel->inouts};
 
-    // Ensure shm filename do not colision with other users; if so, return with error
-    for (index = 0; index < A3_MAXUSERS; index++) {
-        pthread_mutex_lock(&users_mutex);
-        if (!users[index]) {
-            pthread_mutex_unlock(&users_mutex);
-            continue;
-        }
-        if (strcmp(users[index]->shm, shm_filename) == 0) {
-            a3_print_error("[artico3-hw] \"%s\" shm file already in use by user=%u\n", shm_filename, index);
-            pthread_mutex_unlock(&users_mutex);
-            return -EINVAL;
+    for (i = 0; i < kernel->membanks; i++) {
+        for (j = 0; j < 3; j++) {
+            if (!lists[j][i] || !lists[j][i]->view.rows) continue;
+            if (_artico3_view_check(&lists[j][i]->view, lists[j][i]->size / sizeof (a3data_t), (gsize + lsize - 1) / lsize) < 0) {
+                a3_print_error("[artico3-hw] port %s view does not fit in the port (gsize=%zd,lsize=%zd)\n", lists[j][i]->name, gsize, lsize);
+                return -EINVAL;
+            }
         }
-        pthread_mutex_unlock(&users_mutex);
-    }
-
-    // Search first available UID; if none, return with error
-    for (index = 0; index < A3_MAXUSERS; index++) {
-        if (users[index] == NULL) break;
-    }
-    if (index == A3_MAXUSERS) {
-        a3_print_error("[artico3-hw] user list is already full\n");
-        return -EBUSY;
     }
-    a3_print_debug("[artico3-hw] created new user=%d\n", index);
 
-    // Create the shared memory object
-    shm_fd = shm_open(shm_filename, O_RDWR, S_IRUSR | S_IWUSR);
-    if(shm_fd < 0) {
-        a3_print_error("[artico3-hw] shm_open() failed\n");
-        return -ENODEV;
-    }
+    return 0;
+}
 
-    // Resize the shared memory object
-    ftruncate(shm_fd, sizeof (struct a3user_t));
 
-    // Allocate memory for application mapped to the shared memory object with mmap()
-    users[index] = mmap(0, sizeof (struct a3user_t), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
-    if(users[index] == MAP_FAILED) {
-        close(shm_fd);
-        a3_print_error("[artico3-hw] mmap() failed\n");
-        return -ENOMEM;
+/*
+ * ARTICo3 check overlapping tiles of port view
+ *
+ * This function checks whether the tiles of two different work-groups
+ * share any word of the port buffer. Tiles are made of rows of @cols
+ * words, so two tiles whose first words are d words apart overlap when
+ * d - (k * @stride) is less than @cols words apart for some row shift k
+ * below @rows (only the two row shifts closest to d are checked).
+ *
+ * @view    : port view
+ * @nrounds : number of work-groups
+ *
+ * Return : 1 if tiles can overlap, 0 otherwise
+ *
+ */
+static int _artico3_view_overlaps(const struct a3view_t *view, unsigned int nrounds) {
+    long long a, b, d, k, ntiles, ngroups;
+
+    ntiles = (nrounds < view->ntiles) ? nrounds : view->ntiles;
+    ngroups = (nrounds + view->ntiles - 1) / view->ntiles;
+
+    // Distance between the first words of every pair of tiles (a tiles
+    // and b groups apart)
+    for (a = -(ntiles - 1); a < ntiles; a++) {
+        for (b = -(ngroups - 1); b < ngroups; b++) {
+            if (!a && !b) continue;
+            d = (a * (long long)view->tstep) + (b * (long long)view->gstep);
+            if (d < 0) d = -d;
+            if ((view->rows == 1) || !view->stride) {
+                if (d < (long long)view->cols) return 1;
+                continue;
+            }
+            k = d / view->stride;
+            if ((k < (long long)view->rows) && ((d - (k * (long long)view->stride)) < (long long)view->cols)) return 1;
+            if (((k + 1) < (long long)view->rows) && ((((k + 1) * (long long)view->stride) - d) < (long long)view->cols)) return 1;
+        }
     }
 
-    // Close shared memory object file descriptor (not needed anymore)
-    close(shm_fd);
-    a3_print_debug("[artico3-hw] created shared memory for user=%d\n", index);
-
-    // Save the user ID
-    users[index]->user_id = index;
-
-    // Save the user shm
-    strcpy(users[index]->shm,shm_filename);
-
-    pthread_mutex_unlock(&add_user_mutex);
-
-    // Return this current user index
-    // This is required to select the appropriate user within users in the _artico3_handle_request()
-    // to send the response back
-    return index;
+    return 0;
 }
 
 
 /*
- * ARTICo3 remove existing user
+ * ARTICo3 check pipelining of kernel execution
  *
- * This function cleans the software entities created by artico3_add_user().
+ * Pipelined executions gather the inputs of the next round before the
+ * outputs of the current one are scattered. This is only possible when
+ * the tiles of the work-groups of bidirectional I/O ports (i.e. the data
+ * read and written by different rounds) do not overlap.
  *
- * @args           : buffer storing the function arguments sent by the user
- *     @user_id    : ID of the user to be removed
- *     @channel_id : ID of the channel used for handling daemon/user communication
+ * @kernel  : hardware kernel
+ * @nrounds : number of work-groups
+ *
+ * Return : 1 if rounds can be pipelined, 0 otherwise
  *
  */
-int artico3_remove_user(void *args) {
-    unsigned int index;
-    struct a3channel_t *channel = NULL;
-    struct a3user_t *user = NULL;
-
-    // Get function arguments
-    int user_id, channel_id;
-    unsigned copied_bytes;
-    char *args_aux = args;
-
-    // @user_id
-    memcpy(&user_id, args_aux, sizeof (int));
-    copied_bytes = sizeof (int);
-    // @channel_id
-    memcpy(&channel_id, &(args_aux[copied_bytes]), sizeof (int));
-
-    pthread_mutex_lock(&users_mutex);
+static int _artico3_kernel_pipelinable(struct a3kernel_t *kernel, unsigned int nrounds) {
+    unsigned int i;
 
-    // Search for user in user list
-    for (index = 0; index < A3_MAXUSERS; index++) {
-        if (!users[index]) continue;
-        if (users[index]->user_id == user_id) break;
-    }
-    if (index == A3_MAXUSERS) {
-        a3_print_error("[artico3-hw] no user found with id %d\n", user_id);
-        pthread_mutex_unlock(&users_mutex);
-        return -ENODEV;
+    for (i = 0; i < kernel->membanks; i++) {
+        if (!kernel->inouts[i] || !kernel->inouts[i]->view.rows) continue;
+        if (_artico3_view_overlaps(&kernel->inouts[i]->view, nrounds)) return 0;
     }
 
-    // Get user pointer
-    user = users[index];
-
-    // Set user list entry as empty
-    users[index] = NULL;
-
-    pthread_mutex_unlock(&users_mutex);
+    return 1;
+}
 
-    // Get pointer to the channel employed by the user
-    channel = &user->channels[channel_id];
 
-    // Signal the channel that the request has been processed
-    pthread_mutex_lock(&channel->mutex);
-    channel->response_available = 1;
-    pthread_cond_signal(&channel->cond_response);
-    pthread_mutex_unlock(&channel->mutex);
-    a3_print_debug("[artico3-hw] signaled user the response is available\n");
+/*
+ * ARTICo3 get contiguous segment of a slice in its port buffer
+ *
+ * This function maps a byte range of the data of a port (i.e. the data of
+ * its work-groups, one after the other) to the port buffer. Ports without
+ * view are contiguous, whereas ports with view are split in tile rows.
+ *
+ * @slice  : transfer plan slice
+ * @datoff : offset of the range in the data of the port, in bytes
+ * @size   : size of the range, in bytes
+ * @bufoff : offset of the first segment of the range in the port buffer
+ *           (hardware data), in bytes
+ *
+ * Return : size (in bytes) of the first segment of the range
+ *
+ */
+static size_t _artico3_view_segment(const struct a3slice_t *slice, size_t datoff, size_t size, size_t *bufoff) {
+    const struct a3view_t *view = &slice->view;
+    size_t tile, row, col, rowbytes;
+
+    // Ports without view are contiguous
+    if (!view->rows) {
+        *bufoff = datoff;
+        return size;
+    }
 
-    // Clean shared memory object
-    munmap(user, sizeof (struct a3user_t));
-    a3_print_debug("[artico3-hw] released user (user id=%d)\n", user_id);
+    // Locate the range in its tile (one tile per work-group)
+    rowbytes = view->cols * sizeof (a3data_t);
+    tile = datoff / slice->stride;
+    row = (datoff % slice->stride) / rowbytes;
+    col = (datoff % slice->stride) % rowbytes;
 
-    return 0;
+    *bufoff = ((view->offset + ((tile % view->ntiles) * view->tstep) + ((tile / view->ntiles) * view->gstep) + (row * view->stride)) * sizeof (a3data_t)) + col;
+    return ((rowbytes - col) < size) ? (rowbytes - col) : size;
 }
 
 
 /*
- * ARTICo3 delegate handling request thread
+ * ARTICo3 build transfer plan
+ *
+ * This function computes the layout of the data transfers of a kernel
+ * (port slices for each accelerator, block size, hardware offset) for a
+ * given number of accelerators and work size. Ports hold the data of
+ * @gsize work items, and each round processes @lsize of them (or less,
+ * if @gsize is not a multiple of @lsize, in the last round).
  *
- * @args : request data
+ * Send plans involve the constant memories (unless already loaded), the
+ * inputs and the bidirectional I/O ports. Receive plans involve the
+ * bidirectional I/O ports and the outputs.
+ *
+ * Ports with view hold one tile per work-group, regardless of their
+ * size (@lsize work items per tile, see struct a3view_t).
+ *
+ * @kernel  : hardware kernel
+ * @type    : plan type (A3_PLAN_SEND, A3_PLAN_SEND_LOADED, A3_PLAN_RECV)
+ * @naccs   : number of (equivalent) accelerators
+ * @gsize   : global work size (total amount of work to be done)
+ * @lsize   : local work size (work that can be done by one accelerator)
+ *
+ * Return : transfer plan on success, NULL otherwise
  *
  */
-void *_artico3_handle_request(void *args) {
-    struct a3channel_t *channel = NULL;
-    void *func_args = NULL;
-    int response;
-
-    // Get request data
-    struct a3request_t request = *((struct a3request_t*) args);
-    free(args);
-
-    // Handle request to remove existing users
-    if (request.func == A3_F_REMOVE_USER) {
-        // Set function arguments
-        func_args = users[request.user_id]->channels[request.channel_id].args;
-
-        // Execute user requested ARTICo3 function
-        response = artico3_functions[request.func](func_args);
-        a3_print_debug("[artico3-hw] user request (request=%d, user=%d, response=%d)\n", request.func, request.user_id, response);
+static struct a3plan_t *_artico3_plan_build(struct a3kernel_t *kernel, unsigned int type, int naccs, size_t gsize, size_t lsize) {
+    unsigned int i, j, nports, nbanks, bank;
+    size_t words, tail, last, rest;
+    int acc;
+    uint32_t bankwords;
+    struct a3port_t **lists[3];
+    unsigned int counts[3] = {0, 0, 0};
+    struct a3plan_t *plan = NULL;
+    struct a3slice_t *slice = NULL;
+    struct a3port_t *zcport = NULL;
+
+    // Get port lists (constant memories first, then inputs and bidirectional
+    // I/O ports for send plans, or bidirectional I/O ports and outputs for
+    // receive plans)
+    lists[0] = kernel->consts;
+    lists[1] = (type == A3_PLAN_RECV) ? kernel->inouts : kernel->inputs;
+    lists[2] = (type == A3_PLAN_RECV) ? kernel->outputs : kernel->inouts;
+
+    // Get number of ports (and local memory banks used by them)
+    nbanks = 0;
+    for (i = 0; i < kernel->membanks; i++) {
+        if (lists[0][i]) counts[0]++;
+        for (j = 1; j < 3; j++) {
+            if (!lists[j][i]) continue;
+            counts[j]++;
+            nbanks += lists[j][i]->nbanks;
+        }
+    }
 
+    // Check that the tiles of the ports with view lie inside their buffers
+    // (views can change between the launch of an execution and its rounds)
+    if (_artico3_kernel_views_check(kernel, gsize, lsize) < 0) {
         return NULL;
     }
-    // Handle new user requests
-    if (request.func == A3_F_ADD_USER) {
-        // Set function arguments
-        func_args = request.shm;
-
-        // Execute user requested ARTICo3 function
-        response = artico3_functions[request.func](func_args);
-        a3_print_debug("[artico3-hw] user request (request=%d, user=%d, response=%d)\n", request.func, request.user_id, response);
-
-        // Return when an error is returned (there is no mechanism to send the response to the user)
-        if (response < 0) return NULL;
-
-        // Send function response back to the user
-        channel = &users[response]->channels[request.channel_id];
-        // Send the maximum number of kernels to the new user
-        channel->response = A3_MAXKERNS;
 
+    // Allocate memory for transfer plan
+    plan = malloc(sizeof *plan + (naccs * (counts[0] + counts[1] + counts[2]) * sizeof *plan->slices));
+    if (!plan) {
+        a3_print_error("[artico3-hw] malloc() failed\n");
+        return NULL;
+    }
+    plan->refs = 1;
+    plan->loaded = (type != A3_PLAN_SEND);
+    plan->naccs = naccs;
+    plan->gsize = gsize;
+    plan->lsize = lsize;
+    plan->nrounds = (gsize + lsize - 1) / lsize;
+    plan->nconsts = (type == A3_PLAN_RECV) ? 0 : counts[0];
+
+    // Constant memories are only transferred until loaded (one bank each)
+    if (type != A3_PLAN_SEND) counts[0] = 0;
+    nports = counts[0] + counts[1] + counts[2];
+    nbanks += counts[0];
+    plan->nports = nports;
+    plan->nslices = naccs * nports;
+
+    // Compute block size (32-bit words per accelerator) and hardware offset
+    bankwords = (kernel->membytes / kernel->membanks) / (sizeof (a3data_t));
+    plan->blksize = nbanks * bankwords;
+    if (type == A3_PLAN_RECV)
+        plan->hwoff = (kernel->id << 16) + (kernel->membytes - (plan->blksize * sizeof (a3data_t)));
+    else
+        plan->hwoff = (kernel->id << 16) + (plan->loaded ? (plan->nconsts * (kernel->membytes / kernel->membanks)) : 0);
+
+    // Compute slices of the first accelerator (work items in the last
+    // round are computed separately, since it can be partial)
+    tail = gsize - ((plan->nrounds - 1) * lsize);
+    plan->haszc = 0;
+    plan->ncopies = 0;
+    slice = plan->slices;
+    bank = 0;
+    for (j = (type == A3_PLAN_SEND) ? 0 : 1; j < 3; j++) {
+        for (i = 0; i < kernel->membanks; i++) {
+            if (!lists[j][i]) continue;
+            slice->port = lists[j][i];
+            slice->index = slice - plan->slices;
+            slice->acc = 0;
+            slice->memoff = bank * bankwords * sizeof (a3data_t);
+            slice->datoff = 0;
+            // Constant memories are transferred whole, always from the beginning
+            words = slice->port->size / sizeof (a3data_t);
+            slice->view = slice->port->view;
+            if (j == 0) {
+                slice->size = words * sizeof (a3data_t);
+                slice->last = slice->size;
+            }
+            else if (slice->view.rows) {
+                words = slice->view.rows * slice->view.cols;
+                slice->size = words * sizeof (a3data_t);
+                slice->last = ((((uint64_t)words * tail) + lsize - 1) / lsize) * sizeof (a3data_t);
+            }
+            else {
+                slice->size = (((uint64_t)words * lsize) / gsize) * sizeof (a3data_t);
+                // The last round gets the rest of the port, so that no data is
+                // lost when rounds do not hold a whole number of words (e.g.
+                // ports with less than one word per work item), as long as it
+                // fits in the local memory banks of the port
+                rest = words - ((plan->nrounds - 1) * (slice->size / sizeof (a3data_t)));
+                last = slice->port->nbanks * bankwords;
+                slice->last = ((rest < last) ? rest : last) * sizeof (a3data_t);
+            }
+            slice->stride = (j == 0) ? 0 : slice->size;
+            plan->ncopies += slice->view.rows ? (slice->view.rows + 1) : 1;
+            if (slice->port->key) {
+                plan->haszc = 1;
+                zcport = slice->port;
+            }
+            bank += slice->port->nbanks;
+            slice++;
+        }
     }
-    // Handle known user requests
-    else {
-        // Set function arguments
-        func_args = users[request.user_id]->channels[request.channel_id].args;
-
-        // Execute user requested ARTICo3 function
-        response = artico3_functions[request.func](func_args);
-        a3_print_debug("[artico3-hw] user request (request=%d, user=%d, channel=%d, response=%d)\n", request.func, request.user_id, request.channel_id, response);
-
-        // Send function response back to the user
-        channel = &users[request.user_id]->channels[request.channel_id];
-        channel->response = response;
 
+    // Slices of the other accelerators are shifted one block (and one
+    // work-group) per accelerator
+    plan->ncopies *= naccs;
+    for (acc = 1; acc < naccs; acc++) {
+        for (i = 0; i < nports; i++, slice++) {
+            *slice = plan->slices[i];
+            slice->acc = acc;
+            slice->memoff += acc * plan->blksize * sizeof (a3data_t);
+            slice->datoff += acc * slice->stride;
+        }
     }
 
-    // Indicate the request has been processed
-    pthread_mutex_lock(&channel->mutex);
-    channel->response_available = 1;
-    pthread_cond_signal(&channel->cond_response);
-    pthread_mutex_unlock(&channel->mutex);
-    a3_print_debug("[artico3-hw] signaled user that response is available\n");
+    // Zero-copy ports are transferred straight from/to user memory when they
+    // are the only port involved in the transfer, and each work-group fills
+    // all the banks of the port (i.e. the port has the hardware layout)
+    plan->zcport = NULL;
+    if ((nports == 1) && plan->haszc && (plan->slices[0].size == (plan->blksize * sizeof (a3data_t)))) {
+        plan->zcport = zcport;
+    }
 
-    return NULL;
+    return plan;
 }
 
 
 /*
- * ARTICo3 wait user hardware-acceleration request
+ * ARTICo3 get transfer plan
  *
- * This function waits a command request from user.
+ * This function gets the cached transfer plan of a kernel, and builds it
+ * again when it does not match the requested configuration. The caller
+ * gets a reference to the plan (to be dropped with _artico3_plan_put()).
  *
- * Return : 0 on success, error code otherwise
+ * NOTE : @mutex has to be held by the caller.
+ *
+ * @kernel  : hardware kernel
+ * @type    : plan type (A3_PLAN_SEND, A3_PLAN_SEND_LOADED, A3_PLAN_RECV)
+ * @naccs   : number of (equivalent) accelerators
+ * @gsize   : global work size (total amount of work to be done)
+ * @lsize   : local work size (work that can be done by one accelerator)
+ *
+ * Return : transfer plan on success, NULL otherwise
  *
  */
-int artico3_handle_request() {
-    int ret;
+static struct a3plan_t *_artico3_plan_get(struct a3kernel_t *kernel, unsigned int type, int naccs, size_t gsize, size_t lsize) {
+    struct a3plan_t *plan = kernel->plans[type];
+
+    if (!plan || (plan->naccs != naccs) || (plan->gsize != gsize) || (plan->lsize != lsize)) {
+        plan = _artico3_plan_build(kernel, type, naccs, gsize, lsize);
+        if (!plan) return NULL;
+        _artico3_plan_put(kernel->plans[type]);
+        kernel->plans[type] = plan;
+        a3_print_debug("[artico3-hw] built transfer plan (kernel=%s,type=%u,naccs=%d,nrounds=%u,slices=%u)\n", kernel->name, type, naccs, plan->nrounds, plan->nslices);
+    }
+    plan->refs++;
+
+    return plan;
+}
+
+
+/*
+ * ARTICo3 signal handler for SIGTERM and SIGINT
+ *
+ * This function sets a termination flag when SIGTERM and SIGINT is received, signaling the daemon
+ * to stop and perform a clean shutdown.
+ *
+ * @signum : signal number (SIGTERM, SIGINT)
+ */
+void artico3_handle_sigterm(int signum) {
+
+    // Set stop termination flag when signal is received
+    // Signal the request waiting thread to terminate
+    pthread_mutex_lock(&coordinator->mutex);
+    termination_flag = 1;
+    a3_print_info("[artico3-hw] signal [%d] received\n", signum);
+    pthread_cond_signal(&coordinator->cond_request);
+    pthread_mutex_unlock(&coordinator->mutex);
+
+}
+
+/*
+ * ARTICo3 init function
+ *
+ * This function sets up the basic software entities required to manage
+ * the ARTICo3 low-level functionality (DMA transfers, kernel and slot
+ * distributions, etc.).
+ *
+ * It also loads the FPGA with the initial bitstream (static system).
+ *
+ * Return : 0 on success, error code otherwise
+ */
+int artico3_init() {
+    const char *filename = "/dev/artico3";
+    unsigned int i;
+    int ret, shm_fd;
+    struct sigaction action;
+
+    /*
+     * NOTE: this function relies on predefined addresses for both control
+     *       and data interfaces of the ARTICo3 infrastructure.
+     *       If the processor memory map is changed somehow, this has to
+     *       be reflected in this file.
+     *
+     *       Zynq-7000 Devices
+     *       ARTICo3 Control -> 0x7aa00000
+     *       ARTICo3 Data    -> 0x8aa00000
+     *
+     *       Zynq UltraScale+ MPSoC Devices
+     *       ARTICo3 Control -> 0xa0000000
+     *       ARTICo3 Data    -> 0xb0000000
+     *
+     */
+
+    // Set up the signal handler to terminate the daemon SIGTERM
+    action.sa_handler = artico3_handle_sigterm;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = 0;
+
+    if (sigaction(SIGTERM, &action, NULL) == -1 || sigaction(SIGINT, &action, NULL) == -1) {
+        a3_print_error("[artico3-hw] SIGTERM/SIGINT handler error\n");
+    }
+
+    // Get spin-then-sleep configuration
+    spin_budget = a3_spin_budget();
+    a3_print_debug("[artico3-hw] spin_budget=%u\n", spin_budget);
+
+    // Get DMA staging buffer hysteresis (ms)
+    if (getenv("A3_DMA_HYSTERESIS")) {
+        dma_hysteresis = strtoull(getenv("A3_DMA_HYSTERESIS"), NULL, 0) * 1000000ull;
+    }
+    a3_print_debug("[artico3-hw] dma_hysteresis=%" PRIu64 "ns\n", dma_hysteresis);
+
+    // Get DMA staging buffer memory type (cached or coherent)
+    if (getenv("A3_DMA_CACHED")) {
+        dma_cached = strtol(getenv("A3_DMA_CACHED"), NULL, 0) != 0;
+    }
+    a3_print_debug("[artico3-hw] dma_cached=%d\n", dma_cached);
+
+    // Get execution mode (pipelined or sequential rounds)
+    if (getenv("A3_PIPELINE")) {
+        pipeline = strtol(getenv("A3_PIPELINE"), NULL, 0) != 0;
+    }
+    a3_print_debug("[artico3-hw] pipeline=%d\n", pipeline);
+
+    // Load static system (global FPGA reconfiguration)
+    fpga_load("system.bin", 0);
+
+    // Open ARTICo3 device file
+    artico3_fd = open(filename, O_RDWR);
+    if (artico3_fd < 0) {
+        a3_print_error("[artico3-hw] open() %s failed\n", filename);
+        return -ENODEV;
+    }
+    a3_print_debug("[artico3-hw] artico3_fd=%d | dev=%s\n", artico3_fd, filename);
+
+    // Obtain access to physical memory map using mmap()
+    artico3_hw = mmap(NULL, 0x100000, PROT_READ | PROT_WRITE, MAP_SHARED, artico3_fd, 0);
+    if (artico3_hw == MAP_FAILED) {
+        a3_print_error("[artico3-hw] mmap() failed\n");
+        ret = -ENOMEM;
+        goto err_mmap;
+    }
+    a3_print_debug("[artico3-hw] artico3_hw=%p\n", artico3_hw);
+
+    // Get number of DMA channels in the platform
+    if ((ioctl(artico3_fd, ARTICo3_IOC_DMA_NCHANS, &dmachans) < 0) || (dmachans == 0)) {
+        dmachans = 1;
+    }
+    a3_print_debug("[artico3-hw] dmachans=%u\n", dmachans);
+
+    // Get maximum number of ARTICo3 slots in the platform
+    shuffler.nslots = artico3_hw_get_nslots();
+    if (shuffler.nslots == 0) {
+        a3_print_error("[artico3-hw] firmware read (number of slots) failed\n");
+        ret = -ENODEV;
+        goto err_malloc_slots;
+    }
+
+    // Initialize Shuffler structure (software)
+    shuffler.slots = malloc(shuffler.nslots * sizeof (struct a3slot_t));
+    if (!shuffler.slots) {
+        a3_print_error("[artico3-hw] malloc() failed\n");
+        ret = -ENOMEM;
+        goto err_malloc_slots;
+    }
+    for (i = 0; i < shuffler.nslots; i++) {
+        shuffler.slots[i].kernel = NULL;
+        shuffler.slots[i].state = S_EMPTY;
+        shuffler.slots[i].c_version = 0;
+    }
+    a3_print_debug("[artico3-hw] shuffler.slots=%p\n", shuffler.slots);
+
+    // Initialize kernel list (software)
+    kernels = malloc(A3_MAXKERNS * sizeof **kernels);
+    if (!kernels) {
+        a3_print_error("[artico3-hw] malloc() failed\n");
+        ret = -ENOMEM;
+        goto err_malloc_kernels;
+    }
+    for (i = 0; i < A3_MAXKERNS; i++) {
+        kernels[i] = NULL;
+    }
+    a3_print_debug("[artico3-hw] kernels=%p\n", kernels);
+
+    // Initialize delegate threads
+    threads = malloc(A3_MAXKERNS * sizeof *threads);
+    if (!threads) {
+        a3_print_error("[artico3-hw] malloc() failed\n");
+        ret = -ENOMEM;
+        goto err_malloc_threads;
+    }
+    for (i = 0; i < A3_MAXKERNS; i++) {
+        threads[i] = 0;
+    }
+    a3_print_debug("[artico3-hw] threads=%p\n", threads);
+
+    // Initialize user table (software, grows on demand)
+    a3_table_init(&users, sizeof (struct a3userslot_t));
+
+    // Enable clocks in reconfigurable region
+    artico3_hw_enable_clk();
+
+    // Print ARTICo3 control registers
+    artico3_hw_print_regs();
+
+    // Create a shared memory object for coordinator
+    shm_fd = shm_open(A3_COORDINATOR_FILENAME, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if(shm_fd < 0) {
+        a3_print_error("[artico3-hw] shm_open() failed\n");
+        ret = -ENODEV;
+        goto err_shm;
+    }
+
+    // Resize the shared memory object
+    ftruncate(shm_fd, sizeof (struct a3coordinator_t));
+
+    // Allocate memory for application mapped to the shared memory object with mmap()
+    coordinator = mmap(0, sizeof (struct a3coordinator_t), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    if(coordinator == MAP_FAILED) {
+        a3_print_error("[artico3-hw] mmap() failed\n");
+        close(shm_fd);
+        shm_unlink(A3_COORDINATOR_FILENAME);
+        ret = -ENODEV;
+        goto err_shm;
+    }
+    a3_print_debug("[artico3-hw] mmap=%p\n", coordinator);
+
+    // Close shared memory object file descriptor (not needed anymore)
+    close(shm_fd);
+
+    // Initialize mutex and condition variables with shared memory attributes
+    pthread_mutexattr_t mutex_attr;
+    pthread_condattr_t cond_attr;
+
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&coordinator->mutex, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+    pthread_cond_init(&coordinator->cond_request, &cond_attr);
+    pthread_cond_init(&coordinator->cond_free, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+
+    // Initialize flags
+    coordinator->request_available = 0;
+    coordinator->request.user_id = 0;
+    coordinator->request.channel_id = 0;
+    coordinator->request.func = 0;
+    coordinator->sleeping = 0;
+
+    // Create a shared memory object for topology
+    shm_fd = shm_open(A3_TOPOLOGY_FILENAME, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if(shm_fd < 0) {
+        a3_print_error("[artico3-hw] shm_open() failed\n");
+        ret = -ENODEV;
+        goto err_topology;
+    }
+
+    // Resize the shared memory object
+    ftruncate(shm_fd, sizeof (struct a3topology_t));
+
+    // Allocate memory for application mapped to the shared memory object with mmap()
+    topology = mmap(0, sizeof (struct a3topology_t), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    if(topology == MAP_FAILED) {
+        a3_print_error("[artico3-hw] mmap() failed\n");
+        close(shm_fd);
+        shm_unlink(A3_TOPOLOGY_FILENAME);
+        ret = -ENODEV;
+        goto err_topology;
+    }
+    a3_print_debug("[artico3-hw] mmap=%p\n", topology);
+
+    // Close shared memory object file descriptor (not needed anymore)
+    close(shm_fd);
+
+    // Publish initial topology
+    topology->seq = 0;
+    topology->generation = 0;
+    pthread_mutex_lock(&mutex);
+    _artico3_publish_topology();
+    pthread_mutex_unlock(&mutex);
+
+    // Create a shared memory object for request statistics
+    shm_fd = shm_open(A3_STATS_FILENAME, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if(shm_fd < 0) {
+        a3_print_error("[artico3-hw] shm_open() failed\n");
+        ret = -ENODEV;
+        goto err_stats;
+    }
+
+    // Resize the shared memory object
+    ftruncate(shm_fd, sizeof (struct a3stats_t));
+
+    // Allocate memory for application mapped to the shared memory object with mmap()
+    stats = mmap(0, sizeof (struct a3stats_t), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    if(stats == MAP_FAILED) {
+        a3_print_error("[artico3-hw] mmap() failed\n");
+        close(shm_fd);
+        shm_unlink(A3_STATS_FILENAME);
+        ret = -ENODEV;
+        goto err_stats;
+    }
+    a3_print_debug("[artico3-hw] mmap=%p\n", stats);
+
+    // Close shared memory object file descriptor (not needed anymore)
+    close(shm_fd);
+
+    // Initialize request statistics
+    memset(stats, 0, sizeof (struct a3stats_t));
+    stats->version = A3_STATS_VERSION;
+    stats->nfuncs = sizeof artico3_names / sizeof *artico3_names;
+    stats->nbuckets = A3_STATS_BUCKETS;
+    stats->tstart = a3_stats_now();
+    for (i = 0; i < stats->nfuncs; i++) {
+        snprintf(stats->funcs[i].name, sizeof stats->funcs[i].name, "%s", artico3_names[i]);
+    }
+
+	// Initialize kernels thread pool
+    kernels_pool = artico3_pool_init(A3_MAXKERNS, 0);
+	if (!kernels_pool) {
+		a3_print_error("[artico3-hw] kernels thread pool failed\n");
+        ret = -ENODEV;
+        goto err_kernels_pool;
+	}
+    a3_print_debug("[artico3-hw] kernels thread pool=%p\n", kernels_pool);
+
+	// Initialize the requests thread pool
+    requests_pool = artico3_pool_init(A3_MAXKERNS, 1);
+	if(!requests_pool) {
+		a3_print_error("[artico3-hw] request thread pool failed\n");
+        ret = -ENODEV;
+        goto err_requests_pool;
+	}
+    a3_print_debug("[artico3-hw] request thread pool=%p\n", requests_pool);
+
+    // Initialize gather/scatter copy engine
+    ret = a3_copy_init(&copyengine, a3_copy_workers());
+    if (ret) {
+        a3_print_error("[artico3-hw] copy engine failed\n");
+        goto err_copyengine;
+    }
+    a3_print_debug("[artico3-hw] copy engine workers=%u\n", copyengine.nworkers);
+
+    return 0;
+
+err_copyengine:
+    artico3_pool_clean(requests_pool);
+
+err_requests_pool:
+    artico3_pool_clean(kernels_pool);
+
+err_kernels_pool:
+    munmap(stats, sizeof (struct a3stats_t));
+    shm_unlink(A3_STATS_FILENAME);
+
+err_stats:
+    munmap(topology, sizeof (struct a3topology_t));
+    shm_unlink(A3_TOPOLOGY_FILENAME);
+
+err_topology:
+    pthread_mutex_destroy(&coordinator->mutex);
+    pthread_cond_destroy(&coordinator->cond_request);
+
+err_shm:
+    a3_table_clean(&users);
+    free(threads);
+
+err_malloc_threads:
+    free(kernels);
+
+err_malloc_kernels:
+    free(shuffler.slots);
+
+err_malloc_slots:
+    munmap(artico3_hw, 0x100000);
+
+err_mmap:
+    close(artico3_fd);
+
+    return ret;
+}
+
+
+/*
+ * ARTICo3 exit function
+ *
+ * This function cleans the software entities created by artico3_init().
+ *
+ */
+void artico3_exit() {
+    unsigned int i;
+    struct a3userslot_t *slot = NULL;
+
+    // Destroy thread pool
+    artico3_pool_clean(kernels_pool);
+    artico3_pool_clean(requests_pool);
+
+    // Stop gather/scatter copy engine
+    a3_copy_clean(&copyengine);
+
+    // cleanup mutex and conditional variables
+    pthread_mutex_destroy(&coordinator->mutex);
+    pthread_cond_destroy(&coordinator->cond_request);
+    pthread_cond_destroy(&coordinator->cond_free);
+
+    // Cleanup daemon shared memory
+    munmap(coordinator, sizeof (struct a3coordinator_t));
+    shm_unlink(A3_COORDINATOR_FILENAME);
+
+    // Cleanup topology shared memory
+    munmap(topology, sizeof (struct a3topology_t));
+    shm_unlink(A3_TOPOLOGY_FILENAME);
+
+    // Cleanup statistics shared memory
+    munmap(stats, sizeof (struct a3stats_t));
+    shm_unlink(A3_STATS_FILENAME);
+
+    // Print ARTICo3 control registers
+    artico3_hw_print_regs();
+
+    // Disable clocks in reconfigurable region
+    artico3_hw_disable_clk();
+
+    // Release allocated memory for user table
+    for (i = 0; i < users.nslots; i++) {
+        slot = a3_table_entry(&users, i);
+        if (!slot->user) continue;
+        pthread_cond_destroy(&slot->released);
+        pthread_mutex_destroy(&slot->response_mutex);
+    }
+    a3_table_clean(&users);
+
+    // Release DMA staging buffers
+    for (i = 0; i < A3_MAXKERNS; i++) {
+        if (kernels[i]) _artico3_dma_trim(kernels[i], 1);
+    }
+
+    // Release allocated memory for delegate threads
+    free(threads);
+
+    // Release allocated memory for kernel list
+    free(kernels);
+
+    // Release allocated memory for slot info
+    free(shuffler.slots);
+
+    // Release memory obtained with mmap()
+    munmap(artico3_hw, 0x100000);
+
+    // Close ARTICo3 device file
+    close(artico3_fd);
+
+    // Restore Data Shuffler structure
+    shuffler.id_reg      = 0x0000000000000000;
+    shuffler.tmr_reg     = 0x0000000000000000;
+    shuffler.dmr_reg     = 0x0000000000000000;
+    shuffler.blksize_reg = 0x00000000;
+    shuffler.clkgate_reg = 0x00000000;
+    shuffler.nslots      = 0;
+    shuffler.slots       = NULL;
+
+}
+
+
+/*
+ * ARTICo3 add new user
+ *
+ * This function creates the software entities required to manage a new user.
+ * The user table grows on demand, and user IDs (slots) of removed users
+ * are reused.
+ *
+ * @args             : buffer storing the function arguments sent by the user
+ *     @shm_filename : user shared memory object filename
+ *
+ * TODO: create folders and subfolders on /dev/shm for each user and its data (kernels, inputs, etc.)
+ *
+ * Return : user ID on success, error code otherwise
+ */
+int artico3_add_user(void *args) {
+    unsigned int i;
+    int index, shm_fd, ret;
+    struct a3userslot_t *slot = NULL;
+    struct a3user_t *user = NULL;
+
+    // Get function arguments
+    // @shm_filename
+    char *shm_filename = args;
+
+    pthread_mutex_lock(&add_user_mutex);
+
+    // Ensure shm filename do not colision with other users; if so, return with error
+    pthread_mutex_lock(&users_mutex);
+    for (i = 0; i < users.nslots; i++) {
+        slot = a3_table_entry(&users, i);
+        if (!slot->user) continue;
+        if (strcmp(slot->user->shm, shm_filename) == 0) {
+            a3_print_error("[artico3-hw] \"%s\" shm file already in use by user=%u\n", shm_filename, i);
+            pthread_mutex_unlock(&users_mutex);
+            ret = -EINVAL;
+            goto err_unlock;
+        }
+    }
+    pthread_mutex_unlock(&users_mutex);
+
+    // Create the shared memory object
+    shm_fd = shm_open(shm_filename, O_RDWR, S_IRUSR | S_IWUSR);
+    if(shm_fd < 0) {
+        a3_print_error("[artico3-hw] shm_open() failed\n");
+        ret = -ENODEV;
+        goto err_unlock;
+    }
+
+    // Resize the shared memory object
+    ftruncate(shm_fd, sizeof (struct a3user_t));
+
+    // Allocate memory for application mapped to the shared memory object with mmap()
+    user = mmap(0, sizeof (struct a3user_t), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    if(user == MAP_FAILED) {
+        close(shm_fd);
+        a3_print_error("[artico3-hw] mmap() failed\n");
+        ret = -ENOMEM;
+        goto err_unlock;
+    }
+
+    // Close shared memory object file descriptor (not needed anymore)
+    close(shm_fd);
+
+    // Get a free UID (the user table grows on demand)
+    pthread_mutex_lock(&users_mutex);
+    index = a3_table_get(&users);
+    if (index < 0) {
+        pthread_mutex_unlock(&users_mutex);
+        a3_print_error("[artico3-hw] could not allocate user slot\n");
+        ret = index;
+        goto err_munmap;
+    }
+    slot = a3_table_entry(&users, index);
+    pthread_cond_init(&slot->released, NULL);
+    pthread_mutex_init(&slot->response_mutex, NULL);
+
+    // Save the user ID and the user shm (the process ID is read only once,
+    // since the user can modify its shared memory object)
+    user->user_id = index;
+    strcpy(user->shm, shm_filename);
+    slot->pid = user->pid;
+
+    // Publish the user (from now on, its requests are handled), holding a
+    // reference on behalf of the request (released after responding)
+    slot->refs = 1;
+    slot->user = user;
+    pthread_mutex_unlock(&users_mutex);
+    a3_print_debug("[artico3-hw] created new user=%d\n", index);
+
+    pthread_mutex_unlock(&add_user_mutex);
+
+    // Return this current user index
+    // This is required to select the appropriate user within users in the _artico3_handle_request()
+    // to send the response back
+    return index;
+
+err_munmap:
+    munmap(user, sizeof (struct a3user_t));
+
+err_unlock:
+    pthread_mutex_unlock(&add_user_mutex);
+
+    return ret;
+}
+
+
+/*
+ * ARTICo3 get user reference
+ *
+ * This function takes a reference on a user, so that its shared memory
+ * object is not released while it is being used.
+ *
+ * @user_id : ID of the user
+ *
+ * Return : user shared memory object, NULL if the user has been removed
+ *
+ */
+static struct a3user_t *_artico3_user_get(int user_id) {
+    struct a3user_t *user = NULL;
+    struct a3userslot_t *slot = NULL;
+
+    pthread_mutex_lock(&users_mutex);
+    if ((user_id >= 0) && ((unsigned int)user_id < users.nslots)) {
+        slot = a3_table_entry(&users, user_id);
+        user = slot->user;
+        if (user) slot->refs++;
+    }
+    pthread_mutex_unlock(&users_mutex);
+
+    return user;
+}
+
+
+/*
+ * ARTICo3 put user reference
+ *
+ * This function releases a reference taken with _artico3_user_get() (or by
+ * the request dispatcher), waking up artico3_remove_user() if it is waiting
+ * for the user to be released.
+ *
+ * @user_id : ID of the user
+ *
+ */
+static void _artico3_user_put(int user_id) {
+    struct a3userslot_t *slot = a3_table_entry(&users, user_id);
+
+    pthread_mutex_lock(&users_mutex);
+    slot->refs--;
+    pthread_cond_broadcast(&slot->released);
+    pthread_mutex_unlock(&users_mutex);
+}
+
+
+/*
+ * ARTICo3 send response
+ *
+ * This function posts the response of a processed request in the completion
+ * queue of the user, and wakes up the user threads waiting for it.
+ *
+ * @user       : user that sent the request
+ * @user_id    : ID of the user that sent the request
+ * @channel_id : ID of the channel used for handling the request
+ * @response   : processed user request response
+ *
+ * NOTE : the caller has to hold a reference on the user (the completion
+ *        queue lives in the user shared memory object).
+ *
+ */
+static void _artico3_send_response(struct a3user_t *user, int user_id, int channel_id, int response) {
+    struct a3completion_t *completion = NULL;
+    struct a3userslot_t *slot = a3_table_entry(&users, user_id);
+
+    // Post completion (several delegate threads can respond to the same user)
+    pthread_mutex_lock(&slot->response_mutex);
+    if (a3_ring_full(&user->cq.ring)) {
+        // Cannot happen, users keep at most A3_RING_SIZE requests in flight
+        a3_print_error("[artico3-hw] completion queue full (user=%d)\n", user_id);
+        pthread_mutex_unlock(&slot->response_mutex);
+        return;
+    }
+    completion = &user->cq.entries[a3_ring_tail(&user->cq.ring)];
+    completion->channel_id = channel_id;
+    completion->response = response;
+    a3_ring_push(&user->cq.ring);
+    pthread_mutex_unlock(&slot->response_mutex);
+
+    // Wake up the user only if it is sleeping (the fence ensures either
+    // we see the waiters or they see the completion)
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&user->cq.waiters, __ATOMIC_RELAXED)) {
+        a3_futex_wake(&user->cq.ring.tail);
+        a3_print_debug("[artico3-hw] signaled user that response is available\n");
+    }
+}
+
+
+/*
+ * ARTICo3 remove existing user
+ *
+ * This function cleans the software entities created by artico3_add_user().
+ *
+ * @args : request sent by the user to be removed (struct a3request_t)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ * NOTE : the user to be removed is the one that sent the request (the user
+ *        ID is given by the submission queue, not by the user). The
+ *        reference held on behalf of the request is released by this
+ *        function.
+ *
+ */
+int artico3_remove_user(void *args) {
+    struct a3userslot_t *slot = NULL;
+    struct a3user_t *user = NULL;
+
+    // Get function arguments
+    struct a3request_t *request = args;
+    int user_id = request->user_id;
+    int channel_id = request->channel_id;
+
+    pthread_mutex_lock(&users_mutex);
+
+    // Get user slot (the user ID is the slot index)
+    slot = a3_table_entry(&users, user_id);
+    if (!slot->user) {
+        a3_print_error("[artico3-hw] user=%d is already being removed\n", user_id);
+        slot->refs--;
+        pthread_cond_broadcast(&slot->released);
+        pthread_mutex_unlock(&users_mutex);
+        return -ENODEV;
+    }
+
+    // Get user pointer
+    user = slot->user;
+
+    // Set user table entry as empty (new requests of the user are dropped)
+    slot->user = NULL;
+
+    // Wait for the requests and asynchronous executions that are still
+    // using the user (all but this request)
+    while (slot->refs > 1) {
+        pthread_cond_wait(&slot->released, &users_mutex);
+    }
+
+    pthread_mutex_unlock(&users_mutex);
+
+    // Signal the channel that the request has been processed
+    _artico3_send_response(user, user_id, channel_id, 0);
+
+    // Clean shared memory object
+    munmap(user, sizeof (struct a3user_t));
+
+    // Release user slot (it can be reused by new users)
+    pthread_mutex_lock(&users_mutex);
+    slot->refs = 0;
+    pthread_cond_destroy(&slot->released);
+    pthread_mutex_destroy(&slot->response_mutex);
+    a3_table_put(&users, user_id);
+    pthread_mutex_unlock(&users_mutex);
+    a3_print_debug("[artico3-hw] released user (user id=%d)\n", user_id);
+
+    return 0;
+}
+
+
+/*
+ * ARTICo3 get request arguments
+ *
+ * This function checks that the request input arguments lie inside the
+ * user argument arena, copies them to a private buffer (the user can
+ * still write the arena while they are being parsed), and sets up a
+ * cursor to parse them.
+ *
+ * @user    : user that sent the request
+ * @request : request (copied out of the user submission queue)
+ * @args    : argument cursor to parse the request input arguments
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ * NOTE : the private buffer has to be released with _artico3_request_done().
+ *
+ */
+static int _artico3_request_args(struct a3user_t *user, struct a3request_t *request, struct a3args_t *args) {
+    uint32_t offset, size;
+    char *data = NULL;
+
+    // The request is a private copy, the user cannot modify it anymore
+    offset = request->args_offset;
+    size = request->args_size;
+    if ((offset > A3_ARENA_SIZE) || (size > (A3_ARENA_SIZE - offset))) {
+        a3_print_error("[artico3-hw] request arguments out of bounds (user=%d, channel=%d, offset=%u, size=%u)\n", request->user_id, request->channel_id, offset, size);
+        return -EINVAL;
+    }
+
+    // Copy request arguments (parsed values cannot change after being checked)
+    if (size) {
+        data = malloc(size);
+        if (!data) {
+            a3_print_error("[artico3-hw] malloc() failed\n");
+            return -ENOMEM;
+        }
+        memcpy(data, &(user->arena[offset]), size);
+    }
+    a3_args_init(args, data, size);
+    args->user = request->user_id;
+
+    return 0;
+}
+
+
+/*
+ * ARTICo3 release request arguments
+ *
+ * This function releases the private copy of the request input arguments,
+ * copying it back to the user argument arena first for the functions that
+ * return data in place (artico3_kernel_rcfg() and artico3_batch()).
+ *
+ * @user    : user that sent the request
+ * @request : request (copied out of the user submission queue)
+ * @args    : argument cursor set up by _artico3_request_args()
+ *
+ */
+static void _artico3_request_done(struct a3user_t *user, struct a3request_t *request, struct a3args_t *args) {
+
+    if (args->data && ((request->func == A3_F_KERNEL_RCFG) || (request->func == A3_F_BATCH))) {
+        memcpy(&(user->arena[request->args_offset]), args->data, args->size);
+    }
+    free(args->data);
+}
+
+
+/*
+ * ARTICo3 delegate request (request handling thread data)
+ *
+ * @request  : request to be handled
+ * @tdequeue : time at which the request was consumed by the daemon (ns)
+ *
+ */
+struct a3delegate_t {
+    struct a3request_t request;
+    uint64_t tdequeue;
+};
+
+
+/*
+ * ARTICo3 record request statistics
+ *
+ * This function records the queue-wait, dispatch and service time of a
+ * processed request in the statistics shared memory object.
+ *
+ * @request  : processed request
+ * @tdequeue : time at which the request was consumed by the daemon (ns)
+ * @tstart   : time at which the delegate thread started handling the request (ns)
+ * @response : processed user request response
+ *
+ */
+static void _artico3_stats_request(struct a3request_t *request, uint64_t tdequeue, uint64_t tstart, int response) {
+    struct a3funcstats_t *funcstats = NULL;
+
+    if ((unsigned int)request->func >= stats->nfuncs) return;
+    funcstats = &stats->funcs[request->func];
+
+    a3_stats_record(&funcstats->queue, a3_stats_elapsed(request->tsubmit, tdequeue));
+    a3_stats_record(&funcstats->dispatch, a3_stats_elapsed(tdequeue, tstart));
+    a3_stats_record(&funcstats->service, a3_stats_elapsed(tstart, a3_stats_now()));
+    if (response < 0) {
+        __atomic_fetch_add(&funcstats->errors, 1, __ATOMIC_RELAXED);
+    }
+}
+
+
+/*
+ * ARTICo3 delegate handling request thread
+ *
+ * @args : delegate request data (struct a3delegate_t)
+ *
+ */
+void *_artico3_handle_request(void *args) {
+    struct a3userslot_t *slot = NULL;
+    struct a3user_t *user = NULL;
+    void *func_args = NULL;
+    struct a3args_t request_args;
+    int response;
+    uint64_t tdequeue, tstart;
+
+    // Get request data
+    struct a3request_t request = ((struct a3delegate_t *) args)->request;
+    tdequeue = ((struct a3delegate_t *) args)->tdequeue;
+    tstart = a3_stats_now();
+    free(args);
+
+    // Handle request to remove existing users
+    if (request.func == A3_F_REMOVE_USER) {
+        // Set function arguments (the request identifies the user)
+        func_args = &request;
+
+        // Execute user requested ARTICo3 function
+        response = artico3_functions[request.func](func_args);
+        a3_print_debug("[artico3-hw] user request (request=%d, user=%d, response=%d)\n", request.func, request.user_id, response);
+        _artico3_stats_request(&request, tdequeue, tstart, response);
+
+        return NULL;
+    }
+    // Handle new user requests
+    if (request.func == A3_F_ADD_USER) {
+        // Set function arguments
+        func_args = request.shm;
+
+        // Execute user requested ARTICo3 function
+        response = artico3_functions[request.func](func_args);
+        a3_print_debug("[artico3-hw] user request (request=%d, user=%d, response=%d)\n", request.func, request.user_id, response);
+
+        // Return when an error is returned (there is no mechanism to send the response to the user)
+        if (response < 0) {
+            _artico3_stats_request(&request, tdequeue, tstart, response);
+            return NULL;
+        }
+
+        // Send the maximum number of kernels to the new user
+        request.user_id = response;
+        slot = a3_table_entry(&users, request.user_id);
+        pthread_mutex_lock(&users_mutex);
+        user = slot->user;
+        pthread_mutex_unlock(&users_mutex);
+        if (!user) {
+            a3_print_debug("[artico3-hw] user=%d removed, dropped request=%d\n", request.user_id, request.func);
+            _artico3_user_put(request.user_id);
+            _artico3_stats_request(&request, tdequeue, tstart, response);
+            return NULL;
+        }
+        response = A3_MAXKERNS;
+
+    }
+    // Handle known user requests
+    else {
+        slot = a3_table_entry(&users, request.user_id);
+
+        // Drop requests of users that are being removed (the reference held
+        // on behalf of the request keeps the user mapped, but it will not
+        // wait for the response)
+        pthread_mutex_lock(&users_mutex);
+        user = slot->user;
+        pthread_mutex_unlock(&users_mutex);
+        if (!user) {
+            a3_print_debug("[artico3-hw] user=%d removed, dropped request=%d\n", request.user_id, request.func);
+            _artico3_user_put(request.user_id);
+            _artico3_stats_request(&request, tdequeue, tstart, -ENODEV);
+            return NULL;
+        }
+
+        // Set function arguments
+        response = _artico3_request_args(user, &request, &request_args);
+        if (response == 0) {
+            func_args = &request_args;
+
+            // Execute user requested ARTICo3 function
+            response = artico3_functions[request.func](func_args);
+            _artico3_request_done(user, &request, &request_args);
+        }
+        a3_print_debug("[artico3-hw] user request (request=%d, user=%d, channel=%d, response=%d)\n", request.func, request.user_id, request.channel_id, response);
+
+    }
+
+    // Send function response back to the user
+    _artico3_send_response(user, request.user_id, request.channel_id, response);
+    _artico3_stats_request(&request, tdequeue, tstart, response);
+
+    // Release the reference held on behalf of the request
+    _artico3_user_put(request.user_id);
+
+    return NULL;
+}
+
+
+/*
+ * ARTICo3 launch delegate request handling thread
+ *
+ * @request  : request to be handled
+ * @tdequeue : time at which the request was consumed by the daemon (ns)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+static int _artico3_dispatch_request(struct a3request_t *request, uint64_t tdequeue) {
+    struct a3delegate_t *tdata = NULL;
+    int ret;
+
+    // Launch delegate thread to handled user command request
+    tdata = malloc(sizeof (struct a3delegate_t));
+    if (!tdata) {
+        a3_print_error("[artico3-hw] malloc() failed\n");
+        return -ENOMEM;
+    }
+    tdata->request = *request;
+    tdata->tdequeue = tdequeue;
+    ret = artico3_pool_submit_task(requests_pool, 0, _artico3_handle_request, tdata);
+    if(ret) {
+        a3_print_error("[artico3-hw] could not launch delegate request handling worker=%d\n", ret);
+        free(tdata);
+        return ret;
+    }
+    a3_print_debug("[artico3-hw] started delegate request handling thread\n");
+
+    return 0;
+}
+
+
+/*
+ * ARTICo3 check pending user requests
+ *
+ * Return : 1 if any user submission queue has pending requests, 0 otherwise
+ *
+ */
+static int _artico3_pending_requests() {
+    unsigned int index;
+    int pending = 0;
+    struct a3userslot_t *slot = NULL;
+
+    pthread_mutex_lock(&users_mutex);
+    for (index = 0; index < users.nslots; index++) {
+        slot = a3_table_entry(&users, index);
+        if (!slot->user) continue;
+        if (!a3_ring_empty(&slot->user->sq.ring)) {
+            pending = 1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&users_mutex);
+
+    return pending;
+}
+
+
+/*
+ * ARTICo3 wait user hardware-acceleration request
+ *
+ * This function waits a command request from user.
+ *
+ * User requests are consumed from the per-user submission queues in a
+ * round-robin fashion (one request per user and pass), so that a single
+ * user flooding the daemon cannot starve the others. The daemon only
+ * sleeps on the coordinator when every queue is empty.
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_handle_request() {
+    unsigned int index, spins;
+    int ret, dispatched;
+    struct a3request_t request;
+    struct a3userslot_t *slot = NULL;
+
+    // Loop for handling requested commands
+    spins = 0;
+    while (1) {
+
+        // Consume one request per user and pass
+        dispatched = 0;
+        for (index = 0; ; index++) {
+            pthread_mutex_lock(&users_mutex);
+            if (index >= users.nslots) {
+                pthread_mutex_unlock(&users_mutex);
+                break;
+            }
+            slot = a3_table_entry(&users, index);
+            if (!slot->user || a3_ring_empty(&slot->user->sq.ring)) {
+                pthread_mutex_unlock(&users_mutex);
+                continue;
+            }
+            request = slot->user->sq.entries[a3_ring_head(&slot->user->sq.ring)];
+            a3_ring_pop(&slot->user->sq.ring);
+
+            // Hold a reference on behalf of the request (released by the
+            // delegate thread once the request has been responded)
+            slot->refs++;
+            pthread_mutex_unlock(&users_mutex);
+
+            // The user ID is given by the queue, not by the user
+            request.user_id = index;
+            a3_print_debug("[artico3-hw] received user request (user=%d, channel=%d)\n", request.user_id, request.channel_id);
+
+            ret = _artico3_dispatch_request(&request, a3_stats_now());
+            if (ret) {
+                _artico3_user_put(request.user_id);
+                return ret;
+            }
+            dispatched++;
+        }
+
+        pthread_mutex_lock(&coordinator->mutex);
+
+        // Handle new user registrations
+        if (coordinator->request_available) {
+            a3_print_debug("[artico3-hw] received new user request\n");
+            ret = _artico3_dispatch_request(&coordinator->request, a3_stats_now());
+            if (ret) {
+                pthread_mutex_unlock(&coordinator->mutex);
+                return ret;
+            }
+
+            // Signal the users that the request has been processed
+            coordinator->request_available = 0;
+            pthread_cond_signal(&coordinator->cond_free);
+            a3_print_debug("[artico3-hw] indicated the daemon is available again\n");
+            dispatched++;
+        }
+
+        if (termination_flag) {
+            pthread_mutex_unlock(&coordinator->mutex);
+            a3_print_info("[artico3-hw] start termination process\n");
+            break;
+        }
+
+        // Poll for a while before going to sleep (short requests are
+        // usually followed by another one from the same user)
+        if (dispatched) {
+            spins = 0;
+        }
+        else if (spins < spin_budget) {
+            pthread_mutex_unlock(&coordinator->mutex);
+            spins++;
+            a3_cpu_relax();
+            continue;
+        }
+
+        // Wait if no request available
+        if (!dispatched) {
+            // Users check @sleeping after publishing their requests, the
+            // fence ensures either they see the flag or we see the request
+            __atomic_store_n(&coordinator->sleeping, 1, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            if (!_artico3_pending_requests()) {
+                a3_print_debug("[artico3-hw] wait for user request\n");
+                pthread_cond_wait(&coordinator->cond_request, &coordinator->mutex);
+            }
+            __atomic_store_n(&coordinator->sleeping, 0, __ATOMIC_RELAXED);
+            spins = 0;
+        }
+
+        pthread_mutex_unlock(&coordinator->mutex);
+    }
+
+    // Ensure each thread in the thread pool has finished before exiting these thread
+    artico3_pool_wait(requests_pool, 0);
+
+    return 0;
+}
+
+
+/*
+ * ARTICo3 create hardware kernel
+ *
+ * This function creates an ARTICo3 kernel in the current application.
+ *
+ * @args         : buffer storing the function arguments sent by the user
+ *     @name     : name of the hardware kernel to be created
+ *     @membytes : local memory size (in bytes) of the associated accelerator
+ *     @membanks : number of local memory banks in the associated accelerator
+ *     @regs     : number of read/write registers in the associated accelerator
+ *
+ * Return : kernel handle (> 0) on success, error code otherwise
+ *
+ */
+int artico3_kernel_create(void *args) {
+    unsigned int index, i;
+    struct a3kernel_t *kernel = NULL;
+    int ret;
+
+    // Get function arguments
+    const char *name;
+    size_t membytes, membanks, regs;
+    struct a3args_t *args_aux = args;
+
+    // @name
+    name = a3_args_get_str(args_aux);
+    // @membytes
+    a3_args_get(args_aux, &membytes, sizeof (size_t));
+    // @membanks
+    a3_args_get(args_aux, &membanks, sizeof (size_t));
+    // @regs
+    a3_args_get(args_aux, &regs, sizeof (size_t));
+
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
+    }
+
+    // Check that the name can be published in the topology
+    if (strlen(name) >= A3_NAME_SIZE) {
+        a3_print_error("[artico3-hw] kernel name too long (max %d characters)\n", A3_NAME_SIZE - 1);
+        return -ENAMETOOLONG;
+    }
+
+    pthread_mutex_lock(&kernel_create_mutex);
+
+    // Search first available ID; if none, return with error
+    for (index = 0; index < A3_MAXKERNS; index++) {
+        if (kernels[index] == NULL) break;
+    }
+    if (index == A3_MAXKERNS) {
+        a3_print_error("[artico3-hw] kernel list is already full\n");
+        return -EBUSY;
+    }
+
+    // Allocate memory for kernel info
+    kernel = malloc(sizeof *kernel);
+    if (!kernel) {
+        a3_print_error("[artico3-hw] malloc() failed\n");
+        return -ENOMEM;
+    }
+
+    // Set kernel name
+    kernel->name = malloc(strlen(name) + 1);
+    if (!kernel->name) {
+        a3_print_error("[artico3-hw] malloc() failed\n");
+        ret = -ENOMEM;
+        goto err_malloc_kernel_name;
+    }
+    strcpy(kernel->name, name);
+
+    // Set kernel configuration
+    kernel->id = index + 1;
+    kernel->handle = A3_KERNEL_HANDLE(kernel->id, ++kernel_seq);
+    kernel->membytes = ceil(((float)membytes / (float)membanks) / sizeof (a3data_t)) * sizeof (a3data_t) * membanks; // Fix to ensure all banks have integer number of 32-bit words
+    kernel->membanks = membanks;
+    kernel->regs = regs;
+    kernel->vcount = -1;
+
+    // Initialize kernel execution status
+    kernel->running = 0;
+    kernel->result = 0;
+
+    // Initialize kernel constant memory inputs
+    kernel->c_version = 0;
+    kernel->consts = malloc(membanks * sizeof *kernel->consts);
+    if (!kernel->consts) {
+        a3_print_error("[artico3-hw] malloc() failed\n");
+        ret = -ENOMEM;
+        goto err_malloc_kernel_consts;
+    }
+
+    // Initialize kernel inputs
+    kernel->inputs = malloc(membanks * sizeof *kernel->inputs);
+    if (!kernel->inputs) {
+        a3_print_error("[artico3-hw] malloc() failed\n");
+        ret = -ENOMEM;
+        goto err_malloc_kernel_inputs;
+    }
+
+    // Initialize kernel outputs
+    kernel->outputs = malloc(membanks * sizeof *kernel->outputs);
+    if (!kernel->outputs) {
+        a3_print_error("[artico3-hw] malloc() failed\n");
+        ret = -ENOMEM;
+        goto err_malloc_kernel_outputs;
+    }
+
+    // Initialize kernel bidirectional I/O ports
+    kernel->inouts = malloc(membanks * sizeof *kernel->inouts);
+    if (!kernel->inouts) {
+        a3_print_error("[artico3-hw] malloc() failed\n");
+        ret = -ENOMEM;
+        goto err_malloc_kernel_inouts;
+    }
+
+    // Set initial values for inputs and outputs
+    for (i = 0; i < kernel->membanks; i++) {
+        kernel->consts[i] = NULL;
+        kernel->inputs[i] = NULL;
+        kernel->outputs[i] = NULL;
+        kernel->inouts[i] = NULL;
+    }
+
+    // Initialize DMA staging buffer pool and transfer plan cache
+    kernel->dmabufs = NULL;
+    for (i = 0; i < A3_PLANS; i++) kernel->plans[i] = NULL;
+
+    a3_print_debug("[artico3-hw] created kernel (name=%s,id=%x,handle=%d,membytes=%zd,membanks=%zd,regs=%zd)\n", kernel->name, kernel->id, kernel->handle, kernel->membytes, kernel->membanks, kernel->regs);
+
+    // Store kernel configuration in kernel list
+    pthread_mutex_lock(&kernels_mutex);
+    kernels[index] = kernel;
+    pthread_mutex_unlock(&kernels_mutex);
+    ret = kernel->handle;
+
+    pthread_mutex_unlock(&kernel_create_mutex);
+
+    // Update topology
+    pthread_mutex_lock(&mutex);
+    _artico3_publish_topology();
+    pthread_mutex_unlock(&mutex);
+
+    return ret;
+
+err_malloc_kernel_inouts:
+    free(kernel->outputs);
+
+err_malloc_kernel_outputs:
+    free(kernel->inputs);
+
+err_malloc_kernel_inputs:
+    free(kernel->consts);
+
+err_malloc_kernel_consts:
+    free(kernel->name);
+
+err_malloc_kernel_name:
+    free(kernel);
+
+    return ret;
+}
+
+
+/*
+ * ARTICo3 release hardware kernel
+ *
+ * This function deletes an ARTICo3 kernel in the current application.
+ *
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel to be deleted (0 to use @name)
+ *     @name   : name of the hardware kernel to be deleted
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_kernel_release(void *args) {
+    unsigned int index, slot;
+    int ret;
+    struct a3kernel_t *kernel_ptr = NULL;
+
+    // Get function arguments
+    int kernel;
+    const char *name;
+    struct a3args_t *args_aux = args;
+
+    // @kernel
+    kernel = a3_args_get_kernel(args_aux, &name);
+
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
+    }
+
+    pthread_mutex_lock(&kernels_mutex);
+
+    // Search for kernel in kernel list
+    ret = _artico3_kernel_find(kernel, name);
+    if (ret < 0) {
+        pthread_mutex_unlock(&kernels_mutex);
+        return ret;
+    }
+    index = ret;
+
+    // Get kernel pointer
+    kernel_ptr = kernels[index];
+
+    // Set kernel list entry as empty
+    kernels[index] = NULL;
+
+    pthread_mutex_unlock(&kernels_mutex);
+
+    // Update ARTICo3 slot info
+    for (slot = 0; slot < shuffler.nslots; slot++) {
+        if (shuffler.slots[slot].state != S_EMPTY) {
+            if (shuffler.slots[slot].kernel == kernel_ptr) {
+                shuffler.slots[slot].state = S_EMPTY;
+                shuffler.slots[slot].kernel = NULL;
+                shuffler.slots[slot].c_version = 0;
+            }
+        }
+    }
+
+    // Update topology, and release DMA staging buffers and transfer plans
+    pthread_mutex_lock(&mutex);
+    _artico3_publish_topology();
+    _artico3_dma_trim(kernel_ptr, 1);
+    _artico3_plan_invalidate(kernel_ptr);
+    pthread_mutex_unlock(&mutex);
+
+    a3_print_debug("[artico3-hw] released kernel (name=%s,handle=%d)\n", kernel_ptr->name, kernel_ptr->handle);
+
+    // Free allocated memory
+    free(kernel_ptr->inouts);
+    free(kernel_ptr->outputs);
+    free(kernel_ptr->inputs);
+    free(kernel_ptr->consts);
+    free(kernel_ptr->name);
+    free(kernel_ptr);
+    kernel_ptr = NULL;
+
+    return 0;
+}
+
+
+/*
+ * ARTICo3 start hardware kernel
+ *
+ * This function starts all hardware accelerators of a given kernel.
+ *
+ * NOTE: only the runtime can call this function, using it from user
+ *       applications is forbidden (and not possible due to the static
+ *       specifier).
+ *
+ * @id : hardware kernel ID
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+static int _artico3_kernel_start(uint8_t id) {
+
+    a3_print_debug("[artico3-hw] sending kernel start signal to accelerator(s) with ID = %1x\n", id);
+
+    // Setup transfer (blksize needs to be 0 for register-based transactions)
+    artico3_hw_setup_transfer(0);
+    // Perform selective START (requires kernel ID and operation code 0x2
+    // and the value to be written is not used).
+    artico3_hw_regwrite(id, 0x2, 0x000, 0x00000000);
+
+    return 0;
+}
+
+
+/*
+ * ARTICo3 wait for accelerators to finish
+ *
+ * This function blocks until the accelerators of a kernel have finished
+ * their execution (started by a DMA transfer or a software command).
+ *
+ * @id        : current kernel ID
+ * @readymask : expected value of the ready register (busy-wait only)
+ *
+ */
+static void _artico3_wait_irq(uint8_t id, uint32_t readymask) {
+#ifdef A3_BUSY_WAIT
+    // ARTICo3 management using busy-wait on the ready register
+    (void)id;
+    while (!artico3_hw_transfer_isdone(readymask)) ;
+#else
+    // ARTICo3 management using interrupts and blocking system calls
+    struct pollfd pfd = { .fd = artico3_fd, .events = POLLIRQ(id), };
+
+    (void)readymask;
+    poll(&pfd, 1, -1);
+#endif
+}
+
+
+/*
+ * ARTICo3 get accelerators with stale constant memories
+ *
+ * This function gets the slots of a kernel whose local memories do not
+ * hold the current version of its constant memory ports.
+ *
+ * NOTE : @mutex has to be held by the caller.
+ *
+ * @kernel : hardware kernel
+ *
+ * Return : bitmask of the slots that require constant memories to be loaded
+ *
+ */
+static uint32_t _artico3_consts_stale(struct a3kernel_t *kernel) {
+    unsigned int i;
+    uint32_t stale = 0;
+
+    for (i = 0; i < shuffler.nslots; i++) {
+        if (shuffler.slots[i].kernel != kernel) continue;
+        if (shuffler.slots[i].c_version != kernel->c_version) stale |= 0x1 << i;
+    }
+
+    return stale;
+}
+
+
+/*
+ * ARTICo3 mark constant memories as loaded
+ *
+ * NOTE : @mutex has to be held by the caller.
+ *
+ * @kernel : hardware kernel
+ * @slots  : bitmask of the slots whose constant memories have been loaded
+ *
+ */
+static void _artico3_consts_mark(struct a3kernel_t *kernel, uint32_t slots) {
+    unsigned int i;
+
+    for (i = 0; i < shuffler.nslots; i++) {
+        if (shuffler.slots[i].kernel != kernel) continue;
+        if (slots & (0x1 << i)) shuffler.slots[i].c_version = kernel->c_version;
+    }
+}
+
+
+/*
+ * ARTICo3 load constant memories in stale accelerators
+ *
+ * This function sends the constant memory ports of a kernel only to the
+ * accelerators that do not hold them yet (e.g. after loading additional
+ * accelerators), so that the next transfers can skip the constant memory
+ * banks in every accelerator. Stale accelerators are temporarily set up
+ * as simplex accelerators and the remaining ones are masked out.
+ *
+ * When all the accelerators of the kernel are stale, nothing is done:
+ * constant memories are sent along with the inputs of the next transfer.
+ *
+ * NOTE : @mutex has to be held by the caller (the DMA request queue is
+ *        entered here).
+ *
+ * NOTE : DMA transfers to the accelerators always start their execution,
+ *        so the stale accelerators run once on their previous inputs. This
+ *        function waits for them to finish (their results are discarded).
+ *
+ * @id : current kernel ID
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+static int _artico3_consts_load(uint8_t id) {
+    struct a3kernel_t *kernel = kernels[id - 1];
+    struct a3shuffler_t shuffler_shadow;
+    struct a3dmabuf_t *buf = NULL;
+    struct dmaproxy_token token;
+    unsigned int i, j, bank, naccs, nstale, nconsts;
+    uint32_t stale, blksize;
+    size_t bankbytes;
+    uint8_t *mem = NULL;
+
+    // Check which accelerators need constant memories
+    stale = _artico3_consts_stale(kernel);
+    if (!stale) return 0;
+
+    // Count accelerators and constant memory ports
+    naccs = 0;
+    nstale = 0;
+    for (i = 0; i < shuffler.nslots; i++) {
+        if (shuffler.slots[i].kernel != kernel) continue;
+        naccs++;
+        if (stale & (0x1 << i)) nstale++;
+    }
+    nconsts = 0;
+    for (j = 0; j < kernel->membanks; j++) {
+        if (kernel->consts[j]) nconsts++;
+    }
+    if (!nconsts || (nstale == naccs)) return 0;
+
+    // Get DMA physical memory (staging buffer)
+    bankbytes = kernel->membytes / kernel->membanks;
+    blksize = (nconsts * bankbytes) / sizeof (a3data_t);
+    buf = _artico3_dma_get(kernel, nstale * blksize * sizeof (a3data_t));
+    if (!buf) {
+        return -ENOMEM;
+    }
+    mem = buf->mem;
+
+    // Copy constant memories to physical memory (one block per accelerator,
+    // converting typed ports)
+    for (i = 0; i < nstale; i++) {
+        bank = 0;
+        for (j = 0; j < kernel->membanks; j++) {
+            if (!kernel->consts[j]) continue;
+            a3_copy_pack(&mem[(i * blksize * sizeof (a3data_t)) + (bank * bankbytes)], kernel->consts[j]->data, (kernel->consts[j]->size / sizeof (a3data_t)) * sizeof (a3data_t), kernel->consts[j]->dtype);
+            bank++;
+        }
+    }
+
+    // Give the staging buffer to the device (cached DMA memory)
+    if (buf->cached) _artico3_dma_sync(buf->mem, 0, nstale * blksize * sizeof (a3data_t), ARTICo3_IOC_DMA_SYNC_DEV);
+
+    // Wait for the DMA engine
+    _artico3_dma_enter();
+
+    // Copy current shuffler status
+    shuffler_shadow = shuffler;
+
+    // Target stale accelerators only (as simplex accelerators)
+    for (i = 0; i < shuffler.nslots; i++) {
+        if (((shuffler.id_reg >> (4 * i)) & 0xf) != id) continue;
+        if (!(stale & (0x1 << i))) shuffler.id_reg &= ~((uint64_t)0xf << (4 * i));
+        shuffler.tmr_reg &= ~((uint64_t)0xf << (4 * i));
+        shuffler.dmr_reg &= ~((uint64_t)0xf << (4 * i));
+    }
+
+    a3_print_debug("[artico3-hw] id %x | loading constant memories in slots %08x (%u/%u accelerators)\n", id, stale, nstale, naccs);
+
+    // Set up data transfer
+    artico3_hw_setup_transfer(blksize);
+
+    // Start DMA transfer
+    token.memaddr = mem;
+    token.memoff = 0x00000000;
+    token.hwaddr = (void *)A3_SLOTADDR;
+    token.hwoff = (id << 16);
+    token.size = nstale * blksize * sizeof (a3data_t);
+    token.channel = _artico3_dma_channel(id);
+    ioctl(artico3_fd, ARTICo3_IOC_DMA_MEM2HW, &token);
+
+    // Wait for DMA transfer to finish
+    _artico3_dma_wait(token.channel);
+
+    // Wait for the (spurious) execution of the stale accelerators to finish
+    _artico3_wait_irq(id, artico3_hw_get_readymask(id));
+
+    // Restore previous shuffler status
+    shuffler = shuffler_shadow;
+
+    // Release the DMA engine
+    _artico3_dma_leave();
+
+    // Return DMA memory to the kernel pool
+    _artico3_dma_put(kernel, buf);
+
+    // Update constant memory residency
+    _artico3_consts_mark(kernel, stale);
+
+    return 0;
+}
+
+
+/*
+ * ARTICo3 round data transfer
+ *
+ * A data transfer between main memory and the accelerators is split in
+ * several stages, so that the memory copies between user ports and DMA
+ * staging buffers (gather/scatter) can be performed without holding
+ * @mutex, and overlapped with the execution of other rounds. The layout
+ * of the transfer is taken from the (cached) transfer plan of the kernel.
+ *
+ * Transfers involving zero-copy ports use scatter-gather DMA: the slices
+ * of zero-copy ports are transferred straight from/to their own buffers,
+ * and only the remaining ports are copied to/from the staging buffer.
+ *
+ * @id      : kernel ID
+ * @round   : first round involved in the transfer
+ * @nrounds : rounds of the execution (the slices of accelerators beyond
+ *            this bound are not transferred)
+ * @head    : work items in round @round of a stream that have already
+ *            been processed (not transferred)
+ * @tail    : work items in round @nrounds - 1 of a stream (0 to take the
+ *            size of the last round from the transfer plan)
+ * @plan    : transfer plan (referenced until the transfer is released)
+ * @buf     : DMA staging buffer (NULL if not staged)
+ * @mem     : memory involved in the DMA transfer (staging buffer or zero-copy port)
+ * @segs    : scatter-gather DMA segments (NULL if the transfer is contiguous)
+ * @nsegs   : number of scatter-gather DMA segments
+ * @vreg    : valid count register written before the transfer (-1 if none)
+ * @vcount  : valid work items of each (equivalent) accelerator
+ *
+ * NOTE : regular executions transfer rounds [@round, @plan->nrounds), and
+ *        streams (see artico3_kernel_stream()) transfer a window of rounds
+ *        [@round, @nrounds) that wraps around the @plan->nrounds rounds
+ *        held by their ring-buffered ports.
+ *
+ */
+struct a3xfer_t {
+    uint8_t id;
+    unsigned int round;
+    unsigned int nrounds;
+    size_t head;
+    size_t tail;
+    struct a3plan_t *plan;
+    struct a3dmabuf_t *buf;
+    a3data_t *mem;
+    struct dmaproxy_segment *segs;
+    unsigned int nsegs;
+    int vreg;
+    a3data_t vcount[2 * sizeof shuffler.id_reg]; // 4-bit kernel ID per slot
+};
+
+
+/*
+ * ARTICo3 get slice of round data transfer
+ *
+ * This function computes the location of a slice in its port buffer for
+ * the round it is involved in.
+ *
+ * @xfer   : round data transfer
+ * @slice  : slice of the transfer plan
+ * @datoff : offset (bytes) of the slice in the port buffer
+ * @memoff : offset (bytes) of the slice in the DMA memory
+ *
+ * Return : number of bytes to be transferred (0 if the accelerator of the
+ *          slice has no work in this transfer)
+ *
+ * NOTE   : constant memories are transferred to every accelerator, even
+ *          if it has no work in this transfer, since all of them are
+ *          marked as loaded afterwards.
+ *
+ */
+static size_t _artico3_xfer_slice(struct a3xfer_t *xfer, struct a3slice_t *slice, size_t *datoff, size_t *memoff) {
+    struct a3plan_t *plan = xfer->plan;
+    unsigned int round = xfer->round + slice->acc;
+    size_t size, skip;
+
+    *memoff = slice->memoff;
+
+    // Constant memories are transferred whole (they have no stride)
+    if (!slice->stride) {
+        *datoff = 0;
+        return slice->size;
+    }
+
+    // When finishing, there could be more accelerators than rounds left
+    if (round >= xfer->nrounds) return 0;
+
+    // Ring-buffered ports wrap around
+    *datoff = (round % plan->nrounds) * slice->stride;
+
+    // The last round can be partial
+    if (round < (xfer->nrounds - 1)) size = slice->size;
+    else if (!xfer->tail) size = slice->last;
+    else size = (slice->size / plan->lsize) * xfer->tail;
+
+    // Work items already processed in the first round of a stream are skipped
+    if ((round == xfer->round) && xfer->head) {
+        skip = (slice->size / plan->lsize) * xfer->head;
+        *datoff += skip;
+        *memoff += skip;
+        size -= skip;
+    }
+
+    return size;
+}
+
+
+/*
+ * ARTICo3 add scatter-gather segment to round data transfer
+ *
+ * Segments that are contiguous both in memory and in hardware are merged.
+ *
+ * @xfer    : round data transfer
+ * @memaddr : memory address (DMA memory region)
+ * @memoff  : memory address offset (bytes)
+ * @hwoff   : hardware address offset (bytes)
+ * @size    : number of bytes to be transferred
+ *
+ */
+static void _artico3_xfer_segment(struct a3xfer_t *xfer, void *memaddr, size_t memoff, size_t hwoff, size_t size) {
+    struct dmaproxy_segment *seg = NULL;
+
+    if (!size) return;
+
+    // Merge with previous segment
+    if (xfer->nsegs) {
+        seg = &xfer->segs[xfer->nsegs - 1];
+        if ((seg->memaddr == memaddr) && ((seg->memoff + seg->size) == memoff) && ((seg->hwoff + seg->size) == hwoff)) {
+            seg->size += size;
+            return;
+        }
+    }
 
-    // Loop for handling requested commands
-    while (1) {
+    // Append new segment
+    seg = &xfer->segs[xfer->nsegs++];
+    seg->memaddr = memaddr;
+    seg->memoff = memoff;
+    seg->hwoff = hwoff;
+    seg->size = size;
+}
 
-        pthread_mutex_lock(&coordinator->mutex);
 
-        // Wait if no request available
-        while (!coordinator->request_available) {
-            a3_print_debug("[artico3-hw] wait for user request\n");
-            if (termination_flag) {
-                pthread_mutex_unlock(&coordinator->mutex);
-                a3_print_info("[artico3-hw] start termination process\n");
-                return 0;
+/*
+ * ARTICo3 set up scatter-gather segments of round data transfer
+ *
+ * This function builds the segment list of a data transfer that involves
+ * zero-copy ports: their slices are taken from their own buffers, and the
+ * rest of the hardware block (other ports and unused memory) from the
+ * staging buffer. If the segment list cannot be built, the transfer is
+ * left contiguous (i.e. every port is staged).
+ *
+ * @xfer : round data transfer (with staging buffer)
+ *
+ */
+static void _artico3_xfer_segments(struct a3xfer_t *xfer) {
+    unsigned int i, maxsegs;
+    size_t cursor, end, size, datoff, memoff;
+    struct a3plan_t *plan = xfer->plan;
+    struct a3slice_t *slice = NULL;
+
+    // Check if zero-copy ports are involved in the transfer
+    if (!plan->haszc) return;
+
+    // Allocate segment list (at most one staged and one zero-copy segment per slice)
+    maxsegs = (2 * plan->nslices) + 1;
+    if (maxsegs > ARTICo3_DMA_MAXSEGS) return;
+    xfer->segs = malloc(maxsegs * sizeof *xfer->segs);
+    if (!xfer->segs) return;
+    xfer->nsegs = 0;
+
+    // Build segment list (offsets in bytes)
+    cursor = 0;
+    for (i = 0; i < plan->nslices; i++) {
+        slice = &plan->slices[i];
+        // When finishing, there could be more accelerators than rounds left
+        // (their constant memories are still transferred)
+        size = _artico3_xfer_slice(xfer, slice, &datoff, &memoff);
+        if (!size) continue;
+        if (!slice->port->key) continue;
+        // Slices overlapping other ports cannot be transferred separately
+        if (memoff < cursor) goto err_layout;
+        // Staged data (and unused memory) before the zero-copy slice
+        _artico3_xfer_segment(xfer, xfer->mem, cursor, plan->hwoff + cursor, memoff - cursor);
+        // Zero-copy slice (the last round can be partial)
+        _artico3_xfer_segment(xfer, slice->port->data, datoff, plan->hwoff + memoff, size);
+        cursor = memoff + size;
+    }
+    // Staged data (and unused memory) after the last zero-copy slice
+    end = plan->naccs * plan->blksize * sizeof (a3data_t);
+    if (cursor > end) goto err_layout;
+    _artico3_xfer_segment(xfer, xfer->mem, cursor, plan->hwoff + cursor, end - cursor);
+
+    a3_print_debug("[artico3-hw] id %x | round %4d | scatter-gather transfer (%u segments)\n", xfer->id, xfer->round, xfer->nsegs);
+    return;
+
+err_layout:
+    a3_print_debug("[artico3-hw] id %x | round %4d | zero-copy slices overlap, using staged transfer\n", xfer->id, xfer->round);
+    free(xfer->segs);
+    xfer->segs = NULL;
+    xfer->nsegs = 0;
+}
+
+
+/*
+ * ARTICo3 release round data transfer
+ *
+ * This function returns the DMA staging buffer of a data transfer (if
+ * any) to the kernel pool, and releases its transfer plan and its
+ * scatter-gather segments.
+ *
+ * NOTE : @mutex has to be held by the caller.
+ *
+ * @id   : current kernel ID
+ * @xfer : round data transfer
+ *
+ */
+static void _artico3_xfer_release(uint8_t id, struct a3xfer_t *xfer) {
+    if (xfer->buf) _artico3_dma_put(kernels[id - 1], xfer->buf);
+    _artico3_plan_put(xfer->plan);
+    free(xfer->segs);
+    xfer->plan = NULL;
+    xfer->buf = NULL;
+    xfer->mem = NULL;
+    xfer->segs = NULL;
+    xfer->nsegs = 0;
+}
+
+
+/*
+ * ARTICo3 synchronize scatter-gather segments of round data transfer
+ *
+ * This function synchronizes (see _artico3_dma_sync()) the range of a
+ * memory region covered by the scatter-gather segments that target it.
+ *
+ * @xfer : round data transfer
+ * @mem  : user-space map of the cached DMA memory
+ * @cmd  : ARTICo3_IOC_DMA_SYNC_DEV (before DMA) or ARTICo3_IOC_DMA_SYNC_CPU (after DMA)
+ *
+ */
+static void _artico3_xfer_sync_segs(struct a3xfer_t *xfer, void *mem, unsigned long cmd) {
+    size_t lo = SIZE_MAX, hi = 0;
+    unsigned int i;
+
+    for (i = 0; i < xfer->nsegs; i++) {
+        if (xfer->segs[i].memaddr != mem) continue;
+        if (xfer->segs[i].memoff < lo) lo = xfer->segs[i].memoff;
+        if ((xfer->segs[i].memoff + xfer->segs[i].size) > hi) hi = xfer->segs[i].memoff + xfer->segs[i].size;
+    }
+    if (hi > lo) _artico3_dma_sync(mem, lo, hi - lo, cmd);
+}
+
+
+/*
+ * ARTICo3 synchronize round data transfer
+ *
+ * This function performs the cache maintenance of the cached DMA memory
+ * involved in a data transfer (staging buffer and zero-copy ports),
+ * restricted to the ranges actually transferred.
+ *
+ * @xfer : round data transfer
+ * @cmd  : ARTICo3_IOC_DMA_SYNC_DEV (before DMA) or ARTICo3_IOC_DMA_SYNC_CPU (after DMA)
+ *
+ */
+static void _artico3_xfer_sync(struct a3xfer_t *xfer, unsigned long cmd) {
+    struct a3plan_t *plan = xfer->plan;
+    size_t size = plan->naccs * plan->blksize * sizeof (a3data_t);
+    unsigned int i;
+
+    // Contiguous transfers (staging buffer or zero-copy port)
+    if (!xfer->mem) return;
+    if (!xfer->segs) {
+        if (xfer->buf && (xfer->mem == xfer->buf->mem) && xfer->buf->cached) {
+            _artico3_dma_sync(xfer->mem, 0, size, cmd);
+        }
+        else if (plan->zcport && plan->zcport->cached) {
+            _artico3_dma_sync(xfer->mem, xfer->round * plan->blksize * sizeof (a3data_t), size, cmd);
+        }
+        return;
+    }
+
+    // Scatter-gather transfers (one range per memory region, slices of
+    // the first accelerator cover each port once)
+    if (xfer->buf && xfer->buf->cached) _artico3_xfer_sync_segs(xfer, xfer->buf->mem, cmd);
+    for (i = 0; (i < plan->nports) && (i < plan->nslices); i++) {
+        if (plan->slices[i].port->key && plan->slices[i].port->cached) _artico3_xfer_sync_segs(xfer, plan->slices[i].port->data, cmd);
+    }
+}
+
+
+/*
+ * ARTICo3 write accelerator registers
+ *
+ * This function writes one configuration register in each (equivalent)
+ * accelerator of a kernel, following the order in which the hardware
+ * infrastructure sequences register transactions (see
+ * artico3_kernel_wcfg()). Each group of accelerators is targeted by
+ * writing its configuration to the Data Shuffler registers directly, so
+ * the shuffler shadow registers are not modified.
+ *
+ * NOTE : the DMA request queue has to be entered by the caller (@mutex
+ *        is not required).
+ *
+ * @id     : kernel ID
+ * @offset : memory offset of the register to be accessed
+ * @cfg    : array of configuration words to be written, one per
+ *           equivalent accelerator
+ *
+ */
+static void _artico3_kernel_wregs(uint8_t id, uint16_t offset, const a3data_t *cfg) {
+    unsigned int index, i, j;
+
+    uint64_t id_reg, aux_id;
+    uint64_t tmr_reg, aux_tmr;
+    uint64_t dmr_reg, aux_dmr;
+
+    // Get current shadow registers
+    id_reg  = shuffler.id_reg;
+    dmr_reg = shuffler.dmr_reg;
+    tmr_reg = shuffler.tmr_reg;
+
+    // Initialize index variable
+    index = 0;
+
+    // TMR blocks
+    for (i = 1; i < (1 << 4); i++) {           // TODO: make this configurable (now, only 4 bits for ID are used)
+        aux_id  = 0x0000000000000000;
+        aux_dmr = 0x0000000000000000;
+        aux_tmr = 0x0000000000000000;
+        for (j = 0; j < shuffler.nslots; j++) {
+            if ((((id_reg >> (4 * j)) & 0xf) == id) && ((tmr_reg >> (4 * j) & 0xf) == i)) {
+                aux_id  |= ((uint64_t)id << (4 * j));
+                aux_tmr |= ((uint64_t)i << (4 * j));
             }
-            pthread_cond_wait(&coordinator->cond_request, &coordinator->mutex);
         }
-        a3_print_debug("[artico3-hw] received user request (user=%d)\n", coordinator->request.user_id);
+        if (aux_id) {
+            // Perform write operation
+            artico3_hw_setup_shuffler(aux_id, aux_tmr, aux_dmr, 0); // Register operations do not use blksize register
+            artico3_hw_regwrite(id, 0, offset, cfg[index++]);
+            a3_print_debug("[artico3-hw] W TMR | kernel : %1x | id : %016" PRIx64 " | tmr : %016" PRIx64 " | dmr : %016" PRIx64 " | register : %03x | value : %08x\n", id, aux_id, aux_tmr, aux_dmr, offset, cfg[index-1]);
+        }
+    }
 
-        // Launch delegate thread to handled user command request
-        struct a3request_t *tdata = malloc(sizeof (struct a3request_t));
-        *tdata = coordinator->request;
-        ret = artico3_pool_submit_task(requests_pool, 0, _artico3_handle_request, tdata);
-        if(ret) {
-            a3_print_error("[artico3-hw] could not launch delegate request handling worker=%d\n", ret);
-            free(tdata);
-            return ret;
+    // DMR blocks
+    for (i = 1; i < (1 << 4); i++) {           // TODO: make this configurable (now, only 4 bits for ID are used)
+        aux_id  = 0x0000000000000000;
+        aux_dmr = 0x0000000000000000;
+        aux_tmr = 0x0000000000000000;
+        for (j = 0; j < shuffler.nslots; j++) {
+            if ((((id_reg >> (4 * j)) & 0xf) == id) && ((dmr_reg >> (4 * j) & 0xf) == i)) {
+                aux_id  |= ((uint64_t)id << (4 * j));
+                aux_dmr |= ((uint64_t)i << (4 * j));
+            }
         }
-        a3_print_debug("[artico3-hw] started delegate request handling thread\n");
+        if (aux_id) {
+            // Perform write operation
+            artico3_hw_setup_shuffler(aux_id, aux_tmr, aux_dmr, 0); // Register operations do not use blksize register
+            artico3_hw_regwrite(id, 0, offset, cfg[index++]);
+            a3_print_debug("[artico3-hw] W DMR | kernel : %1x | id : %016" PRIx64 " | tmr : %016" PRIx64 " | dmr : %016" PRIx64 " | register : %03x | value : %08x\n", id, aux_id, aux_tmr, aux_dmr, offset, cfg[index-1]);
+        }
+    }
 
-        // Signal the users that the request has been processed
-        coordinator->request_available = 0;
-        pthread_cond_signal(&coordinator->cond_free);
-        pthread_mutex_unlock(&coordinator->mutex);
-        a3_print_debug("[artico3-hw] indicated the daemon is available again\n");
+    // Simplex blocks
+    for (j = 0; j < shuffler.nslots; j++) {
+        aux_id  = 0x0000000000000000;
+        aux_dmr = 0x0000000000000000;
+        aux_tmr = 0x0000000000000000;
+        if ((((id_reg >> (4 * j)) & 0xf) == id) && (((dmr_reg >> (4 * j) & 0xf) == 0x0) && ((tmr_reg >> (4 * j) & 0xf) == 0x0))) {
+            aux_id  |= ((uint64_t)id << (4 * j));
+        }
+        if (aux_id) {
+            // Perform write operation
+            artico3_hw_setup_shuffler(aux_id, aux_tmr, aux_dmr, 0); // Register operations do not use blksize register
+            artico3_hw_regwrite(id, 0, offset, cfg[index++]);
+            a3_print_debug("[artico3-hw] W SMP | kernel : %1x | id : %016" PRIx64 " | tmr : %016" PRIx64 " | dmr : %016" PRIx64 " | register : %03x | value : %08x\n", id, aux_id, aux_tmr, aux_dmr, offset, cfg[index-1]);
+        }
     }
+}
 
-    // Ensure each thread in the thread pool has finished before exiting these thread
-    while(!artico3_pool_isdone(requests_pool, 0));
 
-    return 0;
+/*
+ * ARTICo3 set up valid work item counts
+ *
+ * This function computes, for each (equivalent) accelerator of a kernel,
+ * the number of work items it has to process in the rounds of a data
+ * transfer to the accelerators: @lsize for full rounds, less than @lsize
+ * in the last round (when @gsize is not a multiple of @lsize), and 0 for
+ * accelerators without work in the last transfer. They are written to
+ * the valid count register of the accelerators right before the transfer
+ * (see _artico3_send_dma()). Kernels that have not declared that register
+ * (see artico3_kernel_vcount()) are not notified.
+ *
+ * NOTE : @mutex has to be held by the caller.
+ *
+ * @xfer  : round data transfer to the accelerators
+ * @naccs : current number of (equivalent) accelerators for this kernel
+ * @gsize : global work size (total amount of work to be done)
+ * @lsize : local work size (work that can be done by one accelerator)
+ *
+ */
+static void _artico3_xfer_vcount(struct a3xfer_t *xfer, int naccs, size_t gsize, size_t lsize) {
+    struct a3kernel_t *kernel = kernels[xfer->id - 1];
+    size_t start;
+    int acc;
+
+    xfer->vreg = kernel->vcount;
+    if (xfer->vreg < 0) return;
+
+    // Compute valid work items per accelerator
+    for (acc = 0; acc < naccs; acc++) {
+        start = (xfer->round + acc) * lsize;
+        xfer->vcount[acc] = (start >= gsize) ? 0 : (((gsize - start) < lsize) ? (gsize - start) : lsize);
+        a3_print_debug("[artico3-hw] id %x | round %4d | acc %2d | valid work items %u\n", xfer->id, xfer->round + acc, acc, xfer->vcount[acc]);
+    }
 }
 
 
 /*
- * ARTICo3 create hardware kernel
+ * ARTICo3 set up data transfer to accelerators
  *
- * This function creates an ARTICo3 kernel in the current application.
+ * This function computes the layout of a data transfer to the
+ * accelerators, and gets the DMA staging buffer for it (if required).
  *
- * @args         : buffer storing the function arguments sent by the user
- *     @name     : name of the hardware kernel to be created
- *     @membytes : local memory size (in bytes) of the associated accelerator
- *     @membanks : number of local memory banks in the associated accelerator
- *     @regs     : number of read/write registers in the associated accelerator
+ * NOTE : @mutex has to be held by the caller.
+ *
+ * @id      : current kernel ID
+ * @naccs   : current number of hardware accelerators for this kernel
+ * @round   : current round (global over local work ratio index)
+ * @gsize   : global work size (total amount of work to be done)
+ * @lsize   : local work size (work that can be done by one accelerator)
+ * @xfer    : round data transfer to be set up
  *
  * Return : 0 on success, error code otherwise
  *
  */
-int artico3_kernel_create(void *args) {
-    unsigned int index, i;
-    struct a3kernel_t *kernel = NULL;
-    int ret;
+static int _artico3_send_prepare(uint8_t id, int naccs, unsigned int round, size_t gsize, size_t lsize, struct a3xfer_t *xfer) {
+    struct a3kernel_t *kernel = kernels[id - 1];
+    struct a3plan_t *plan = NULL;
+
+    xfer->id = id;
+    xfer->round = round;
+    xfer->nrounds = 0;
+    xfer->head = 0;
+    xfer->tail = 0;
+    xfer->plan = NULL;
+    xfer->buf = NULL;
+    xfer->mem = NULL;
+    xfer->segs = NULL;
+    xfer->nsegs = 0;
+    xfer->vreg = -1;
+
+    // Get valid work item counts when the last round is partial (in every
+    // transfer, since accelerators can be reconfigured between rounds)
+    if (gsize % lsize) _artico3_xfer_vcount(xfer, naccs, gsize, lsize);
+
+    // Get transfer plan (constant memory ports are only transferred until
+    // loaded in all the accelerators)
+    plan = _artico3_plan_get(kernel, _artico3_consts_stale(kernel) ? A3_PLAN_SEND : A3_PLAN_SEND_LOADED, naccs, gsize, lsize);
+    if (!plan) {
+        return -ENOMEM;
+    }
+    xfer->plan = plan;
+    xfer->nrounds = plan->nrounds;
+    if ((plan->nconsts == 0) && (plan->nports == 0)) {
+        a3_print_error("[artico3-hw] no input ports found for kernel %x\n", id);
+        return -ENODEV;
+    }
 
-    // Get function arguments
-    char name[50];
-    size_t membytes, membanks, regs;
-    unsigned copied_bytes;
-    char *args_aux = args;
+    // If all inputs are constant memories, and they have been already loaded,
+    // there is no data to be transferred
+    if (plan->nports == 0) {
+        return 0;
+    }
 
-    // @name
-    strcpy(name, args_aux);
-    copied_bytes = strlen(name) + 1;
-    // @membytes
-    memcpy(&membytes, &(args_aux[copied_bytes]), sizeof (size_t));
-    copied_bytes += sizeof (size_t);
-    // @membanks
-    memcpy(&membanks, &(args_aux[copied_bytes]), sizeof (size_t));
-    copied_bytes += sizeof (size_t);
-    // @regs
-    memcpy(&regs, &(args_aux[copied_bytes]), sizeof (size_t));
+    // Zero-copy transfer
+    if (plan->zcport) {
+        xfer->mem = plan->zcport->data;
+        return 0;
+    }
 
-    pthread_mutex_lock(&kernel_create_mutex);
+    // Get DMA physical memory (staging buffer)
+    xfer->buf = _artico3_dma_get(kernel, naccs * plan->blksize * sizeof (a3data_t));
+    if (!xfer->buf) {
+        return -ENOMEM;
+    }
+    xfer->mem = xfer->buf->mem;
 
-    // Search first available ID; if none, return with error
-    for (index = 0; index < A3_MAXKERNS; index++) {
-        if (kernels[index] == NULL) break;
+    // Scatter-gather transfer (when zero-copy ports are involved)
+    _artico3_xfer_segments(xfer);
+
+    return 0;
+}
+
+
+/*
+ * ARTICo3 gather data to be transferred to accelerators
+ *
+ * This function copies the data of the input ports to the DMA staging
+ * buffer of a data transfer (except for the zero-copy ports transferred
+ * with scatter-gather DMA). It does not require @mutex to be held.
+ *
+ * @xfer : round data transfer (set up with _artico3_send_prepare())
+ *
+ */
+static void _artico3_send_gather(struct a3xfer_t *xfer) {
+    unsigned int i, ncopies;
+    size_t size, datoff, memoff, bufoff;
+    struct a3plan_t *plan = xfer->plan;
+    struct a3slice_t *slice = NULL;
+    struct a3copy_t copy, *copies = NULL;
+    uint8_t *mem = (uint8_t *)xfer->mem;
+
+    // Zero-copy and empty transfers do not require copies
+    if (!xfer->buf) return;
+
+    // Get copy list (one copy per slice, or per tile row)
+    copies = malloc(plan->ncopies * sizeof *copies);
+    ncopies = 0;
+
+    // Copy inputs to physical memory
+    for (i = 0; i < plan->nslices; i++) {
+        slice = &plan->slices[i];
+
+        // Get slice in userspace memory buffer (when finishing, there could
+        // be more accelerators than rounds left, which only get constant
+        // memories, and the last round can be partial)
+        size = _artico3_xfer_slice(xfer, slice, &datoff, &memoff);
+        if (!size) continue;
+
+        // Zero-copy ports are transferred from their own buffers
+        if (xfer->segs && slice->port->key) continue;
+
+        a3_print_debug("[artico3-hw] id %x | round %4d | acc %2d | i_port %2d | mem %10zd | dat %10zd | size %10zd\n", xfer->id, xfer->round + slice->acc, slice->acc, slice->index, memoff / sizeof (a3data_t), datoff / sizeof (a3data_t), size);
+
+        // Copy data from userspace memory buffer to DMA-allocated memory
+        // buffer, one copy per contiguous segment of the port buffer (typed
+        // ports are larger than the hardware data they are converted to)
+        for (; size; size -= copy.size, datoff += copy.size, memoff += copy.size) {
+            copy.size = _artico3_view_segment(slice, datoff, size, &bufoff);
+            copy.dst = &mem[memoff];
+            copy.src = (uint8_t *)slice->port->data + (bufoff * A3_T_RATIO(slice->port->dtype));
+            copy.flags = A3_COPY_STREAM;
+            copy.dtype = slice->port->dtype;
+            if (copies) {
+                copies[ncopies++] = copy;
+            }
+            else {
+                a3_copy_part(&copy, 1, 0, copy.size);
+            }
+        }
     }
-    if (index == A3_MAXKERNS) {
-        a3_print_error("[artico3-hw] kernel list is already full\n");
-        return -EBUSY;
+
+    // Perform copies
+    if (copies) {
+        a3_copy_run(&copyengine, copies, ncopies);
+        free(copies);
     }
+}
 
-    // Allocate memory for kernel info
-    kernel = malloc(sizeof *kernel);
-    if (!kernel) {
-        a3_print_error("[artico3-hw] malloc() failed\n");
-        return -ENOMEM;
+
+/*
+ * ARTICo3 start data transfer to accelerators
+ *
+ * This function performs the DMA transfer of a data transfer to the
+ * accelerators (which starts their execution), and releases the DMA
+ * staging buffer.
+ *
+ * NOTE : @mutex must not be held by the caller (the DMA request queue is
+ *        entered first, and @mutex is locked afterwards to release the
+ *        DMA staging buffer).
+ *
+ * @id   : current kernel ID
+ * @xfer : round data transfer (gathered with _artico3_send_gather())
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+static int _artico3_send_dma(uint8_t id, struct a3xfer_t *xfer) {
+    struct dmaproxy_token token;
+    struct dmaproxy_sg_token sg_token;
+    struct a3kernel_t *kernel = kernels[id - 1];
+    unsigned int channel = _artico3_dma_channel(id);
+    uint8_t loaded = xfer->plan->loaded;
+    int ret = 0;
+
+    // Give the staging buffer to the device (cached DMA memory)
+    _artico3_xfer_sync(xfer, ARTICo3_IOC_DMA_SYNC_DEV);
+
+    // Wait for the DMA engine
+    _artico3_dma_enter();
+
+    // Send valid work item counts (register accesses use the Data Shuffler)
+    if (xfer->vreg >= 0) _artico3_kernel_wregs(id, xfer->vreg, xfer->vcount);
+
+    // If all inputs are constant memories, and they have been already loaded...
+    if (!xfer->mem) {
+        if (xfer->plan->blksize) {
+            ret = -ENOMEM;
+        }
+        else {
+            // ... set up fake data transfer...
+            artico3_hw_setup_transfer(0);
+            token.memaddr = 0x00000000;
+            token.memoff = 0x00000000;
+            token.hwaddr = (void *)A3_SLOTADDR;
+            token.hwoff = (id << 16);
+            token.size = 0;
+            token.channel = channel;
+            ioctl(artico3_fd, ARTICo3_IOC_DMA_MEM2HW, &token);
+            // ...and launch kernel execution using software command
+            _artico3_kernel_start(id);
+        }
     }
+    else {
+        if (xfer->plan->zcport) {
+            a3_print_debug("[artico3-hw] id %x | round %4d | zero-copy i_port %s\n", id, xfer->round, xfer->plan->zcport->name);
+        }
 
-    // Set kernel name
-    kernel->name = malloc(strlen(name) + 1);
-    if (!kernel->name) {
-        a3_print_error("[artico3-hw] malloc() failed\n");
-        ret = -ENOMEM;
-        goto err_malloc_kernel_name;
+        // Set up data transfer
+        artico3_hw_setup_transfer(xfer->plan->blksize);
+
+        // Start DMA transfer
+        if (xfer->segs) {
+            sg_token.hwaddr = (void *)A3_SLOTADDR;
+            sg_token.nsegs = xfer->nsegs;
+            sg_token.segs = xfer->segs;
+            sg_token.channel = channel;
+            ioctl(artico3_fd, ARTICo3_IOC_DMA_MEM2HW_SG, &sg_token);
+        }
+        else {
+            token.memaddr = xfer->mem;
+            token.memoff = xfer->plan->zcport ? (xfer->round * xfer->plan->blksize * sizeof (a3data_t)) : 0x00000000;
+            token.hwaddr = (void *)A3_SLOTADDR;
+            token.hwoff = xfer->plan->hwoff;
+            token.size = xfer->plan->naccs * xfer->plan->blksize * sizeof (a3data_t);
+            token.channel = channel;
+            ioctl(artico3_fd, ARTICo3_IOC_DMA_MEM2HW, &token);
+        }
+
+        // Wait for DMA transfer to finish
+        _artico3_dma_wait(channel);
+
+        // Print ARTICo3 registers
+        artico3_hw_print_regs();
     }
-    strcpy(kernel->name, name);
 
-    // Set kernel configuration
-    kernel->id = index + 1;
-    kernel->membytes = ceil(((float)membytes / (float)membanks) / sizeof (a3data_t)) * sizeof (a3data_t) * membanks; // Fix to ensure all banks have integer number of 32-bit words
-    kernel->membanks = membanks;
-    kernel->regs = regs;
+    // Release the DMA engine
+    _artico3_dma_leave();
 
-    // Initialize kernel constant memory inputs
-    kernel->c_loaded = 0;
-    kernel->consts = malloc(membanks * sizeof *kernel->consts);
-    if (!kernel->consts) {
-        a3_print_error("[artico3-hw] malloc() failed\n");
-        ret = -ENOMEM;
-        goto err_malloc_kernel_consts;
+    pthread_mutex_lock(&mutex);
+
+    // Return DMA memory to the kernel pool
+    _artico3_xfer_release(id, xfer);
+
+    // Update constant memory residency -> next transfers must not load
+    if (!loaded && !ret) _artico3_consts_mark(kernel, artico3_hw_get_readymask(id));
+
+    pthread_mutex_unlock(&mutex);
+
+    return ret;
+}
+
+
+/*
+ * ARTICo3 data transfer to accelerators
+ *
+ * NOTE : @mutex must not be held by the caller.
+ *
+ * @id      : current kernel ID
+ * @naccs   : current number of hardware accelerators for this kernel
+ * @round   : current round (global over local work ratio index)
+ * @gsize   : global work size (total amount of work to be done)
+ * @lsize   : local work size (work that can be done by one accelerator)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_send(uint8_t id, int naccs, unsigned int round, size_t gsize, size_t lsize) {
+    struct a3xfer_t xfer;
+    int ret;
+
+    pthread_mutex_lock(&mutex);
+    ret = _artico3_send_prepare(id, naccs, round, gsize, lsize, &xfer);
+    if (ret < 0) {
+        _artico3_xfer_release(id, &xfer);
+        pthread_mutex_unlock(&mutex);
+        return ret;
+    }
+    pthread_mutex_unlock(&mutex);
+
+    _artico3_send_gather(&xfer);
+    return _artico3_send_dma(id, &xfer);
+}
+
+
+/*
+ * ARTICo3 set up data transfer from accelerators
+ *
+ * This function computes the layout of a data transfer from the
+ * accelerators, and gets the DMA staging buffer for it (if required).
+ *
+ * NOTE : @mutex has to be held by the caller.
+ *
+ * @id      : current kernel ID
+ * @naccs   : current number of hardware accelerators for this kernel
+ * @round   : current round (global over local work ratio index)
+ * @gsize   : global work size (total amount of work to be done)
+ * @lsize   : local work size (work that can be done by one accelerator)
+ * @xfer    : round data transfer to be set up
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+static int _artico3_recv_prepare(uint8_t id, int naccs, unsigned int round, size_t gsize, size_t lsize, struct a3xfer_t *xfer) {
+    struct a3kernel_t *kernel = kernels[id - 1];
+    struct a3plan_t *plan = NULL;
+
+    xfer->id = id;
+    xfer->round = round;
+    xfer->nrounds = 0;
+    xfer->head = 0;
+    xfer->tail = 0;
+    xfer->plan = NULL;
+    xfer->buf = NULL;
+    xfer->mem = NULL;
+    xfer->segs = NULL;
+    xfer->nsegs = 0;
+    xfer->vreg = -1;
+
+    // Get transfer plan
+    plan = _artico3_plan_get(kernel, A3_PLAN_RECV, naccs, gsize, lsize);
+    if (!plan) {
+        return -ENOMEM;
+    }
+    xfer->plan = plan;
+    xfer->nrounds = plan->nrounds;
+    if (plan->nports == 0) {
+        //~ a3_print_error("[artico3-hw] no output ports found for kernel %x\n", id);
+        //~ return -ENODEV;
+        a3_print_debug("[artico3-hw] no output ports found for kernel %x\n", id);
+        return 0;
     }
 
-    // Initialize kernel inputs
-    kernel->inputs = malloc(membanks * sizeof *kernel->inputs);
-    if (!kernel->inputs) {
-        a3_print_error("[artico3-hw] malloc() failed\n");
-        ret = -ENOMEM;
-        goto err_malloc_kernel_inputs;
+    // Zero-copy transfer
+    if (plan->zcport) {
+        xfer->mem = plan->zcport->data;
+        return 0;
     }
 
-    // Initialize kernel outputs
-    kernel->outputs = malloc(membanks * sizeof *kernel->outputs);
-    if (!kernel->outputs) {
-        a3_print_error("[artico3-hw] malloc() failed\n");
-        ret = -ENOMEM;
-        goto err_malloc_kernel_outputs;
+    // Get DMA physical memory (staging buffer)
+    xfer->buf = _artico3_dma_get(kernel, naccs * plan->blksize * sizeof (a3data_t));
+    if (!xfer->buf) {
+        return -ENOMEM;
     }
+    xfer->mem = xfer->buf->mem;
 
-    // Initialize kernel bidirectional I/O ports
-    kernel->inouts = malloc(membanks * sizeof *kernel->inouts);
-    if (!kernel->inouts) {
-        a3_print_error("[artico3-hw] malloc() failed\n");
-        ret = -ENOMEM;
-        goto err_malloc_kernel_inouts;
-    }
+    // Scatter-gather transfer (when zero-copy ports are involved)
+    _artico3_xfer_segments(xfer);
 
-    // Set initial values for inputs and outputs
-    for (i = 0; i < kernel->membanks; i++) {
-        kernel->consts[i] = NULL;
-        kernel->inputs[i] = NULL;
-        kernel->outputs[i] = NULL;
-        kernel->inouts[i] = NULL;
+    return 0;
+}
+
+
+/*
+ * ARTICo3 start data transfer from accelerators
+ *
+ * This function performs the DMA transfer of a data transfer from the
+ * accelerators to the DMA staging buffer (or to the zero-copy ports).
+ *
+ * NOTE : @mutex does not need to be held by the caller (the DMA request
+ *        queue is entered here).
+ *
+ * @id   : current kernel ID
+ * @xfer : round data transfer (set up with _artico3_recv_prepare())
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+static int _artico3_recv_dma(uint8_t id, struct a3xfer_t *xfer) {
+    struct dmaproxy_token token;
+    struct dmaproxy_sg_token sg_token;
+    unsigned int channel = _artico3_dma_channel(id);
+
+    // Kernels without output ports do not transfer data back
+    if (!xfer->plan->blksize) return 0;
+    if (!xfer->mem) return -ENOMEM;
+
+    if (xfer->plan->zcport) {
+        a3_print_debug("[artico3-hw] id %x | round %4d | zero-copy o_port %s\n", id, xfer->round, xfer->plan->zcport->name);
     }
 
-    a3_print_debug("[artico3-hw] created kernel (name=%s,id=%x,membytes=%zd,membanks=%zd,regs=%zd)\n", kernel->name, kernel->id, kernel->membytes, kernel->membanks, kernel->regs);
+    // Give the staging buffer to the device (cached DMA memory)
+    _artico3_xfer_sync(xfer, ARTICo3_IOC_DMA_SYNC_DEV);
 
-    // Store kernel configuration in kernel list
-    kernels[index] = kernel;
+    // Wait for the DMA engine
+    _artico3_dma_enter();
 
-    pthread_mutex_unlock(&kernel_create_mutex);
+    // Set up data transfer
+    artico3_hw_setup_transfer(xfer->plan->blksize);
 
-    return 0;
+    // Start DMA transfer
+    if (xfer->segs) {
+        sg_token.hwaddr = (void *)A3_SLOTADDR;
+        sg_token.nsegs = xfer->nsegs;
+        sg_token.segs = xfer->segs;
+        sg_token.channel = channel;
+        ioctl(artico3_fd, ARTICo3_IOC_DMA_HW2MEM_SG, &sg_token);
+    }
+    else {
+        token.memaddr = xfer->mem;
+        token.memoff = xfer->plan->zcport ? (xfer->round * xfer->plan->blksize * sizeof (a3data_t)) : 0x00000000;
+        token.hwaddr = (void *)A3_SLOTADDR;
+        token.hwoff = xfer->plan->hwoff;
+        token.size = xfer->plan->naccs * xfer->plan->blksize * sizeof (a3data_t);
+        token.channel = channel;
+        ioctl(artico3_fd, ARTICo3_IOC_DMA_HW2MEM, &token);
+    }
 
-err_malloc_kernel_inouts:
-    free(kernel->outputs);
+    // Wait for DMA transfer to finish
+    _artico3_dma_wait(channel);
 
-err_malloc_kernel_outputs:
-    free(kernel->inputs);
+    // Print ARTICo3 registers
+    artico3_hw_print_regs();
 
-err_malloc_kernel_inputs:
-    free(kernel->consts);
+    // Release the DMA engine
+    _artico3_dma_leave();
 
-err_malloc_kernel_consts:
-    free(kernel->name);
+    // Give the staging buffer back to the CPU (cached DMA memory)
+    _artico3_xfer_sync(xfer, ARTICo3_IOC_DMA_SYNC_CPU);
 
-err_malloc_kernel_name:
-    free(kernel);
+    return 0;
+}
 
-    return ret;
+
+/*
+ * ARTICo3 scatter data transferred from accelerators
+ *
+ * This function copies the data in the DMA staging buffer of a data
+ * transfer to the output ports (except for the zero-copy ports transferred
+ * with scatter-gather DMA). It does not require @mutex to be held.
+ *
+ * @xfer : round data transfer (transferred with _artico3_recv_dma())
+ *
+ */
+static void _artico3_recv_scatter(struct a3xfer_t *xfer) {
+    unsigned int i, ncopies;
+    size_t size, datoff, memoff, bufoff;
+    struct a3plan_t *plan = xfer->plan;
+    struct a3slice_t *slice = NULL;
+    struct a3copy_t copy, *copies = NULL;
+    uint8_t *mem = (uint8_t *)xfer->mem;
+
+    // Zero-copy transfers are already in user memory
+    if (!xfer->buf) return;
+
+    // Get copy list (one copy per slice, or per tile row)
+    copies = malloc(plan->ncopies * sizeof *copies);
+    ncopies = 0;
+
+    // Copy outputs from physical memory
+    for (i = 0; i < plan->nslices; i++) {
+        slice = &plan->slices[i];
+
+        // Get slice in userspace memory buffer (when finishing, there could
+        // be more accelerators than rounds left, and the last round can be
+        // partial, or even empty for some ports)
+        size = _artico3_xfer_slice(xfer, slice, &datoff, &memoff);
+        if (!size) continue;
+
+        // Zero-copy ports are transferred to their own buffers
+        if (xfer->segs && slice->port->key) continue;
+
+        a3_print_debug("[artico3-hw] id %x | round %4d | acc %2d | o_port %2d | mem %10zd | dat %10zd | size %10zd\n", xfer->id, xfer->round + slice->acc, slice->acc, slice->index, memoff / sizeof (a3data_t), datoff / sizeof (a3data_t), size);
+
+        // Copy data from DMA-allocated memory buffer to userspace memory
+        // buffer, one copy per contiguous segment of the port buffer (typed
+        // ports are larger than the hardware data they are converted from)
+        for (; size; size -= copy.size, datoff += copy.size, memoff += copy.size) {
+            copy.size = _artico3_view_segment(slice, datoff, size, &bufoff);
+            copy.dst = (uint8_t *)slice->port->data + (bufoff * A3_T_RATIO(slice->port->dtype));
+            copy.src = &mem[memoff];
+            copy.flags = A3_COPY_UNPACK;
+            copy.dtype = slice->port->dtype;
+            if (copies) {
+                copies[ncopies++] = copy;
+            }
+            else {
+                a3_copy_part(&copy, 1, 0, copy.size);
+            }
+        }
+    }
+
+    // Perform copies
+    if (copies) {
+        a3_copy_run(&copyengine, copies, ncopies);
+        free(copies);
+    }
 }
 
 
 /*
- * ARTICo3 release hardware kernel
+ * ARTICo3 data transfer from accelerators
  *
- * This function deletes an ARTICo3 kernel in the current application.
+ * NOTE : @mutex must not be held by the caller.
  *
- * @args     : buffer storing the function arguments sent by the user
- *     @name : name of the hardware kernel to be deleted
+ * @id      : current kernel ID
+ * @naccs   : current number of hardware accelerators for this kernel
+ * @round   : current round (global over local work ratio index)
+ * @gsize   : global work size (total amount of work to be done)
+ * @lsize   : local work size (work that can be done by one accelerator)
  *
  * Return : 0 on success, error code otherwise
  *
  */
-int artico3_kernel_release(void *args) {
-    unsigned int index, slot;
-    struct a3kernel_t *kernel = NULL;
+int artico3_recv(uint8_t id, int naccs, unsigned int round, size_t gsize, size_t lsize) {
+    struct a3xfer_t xfer;
+    int ret;
 
-    // Get function arguments
-    char name[50];
-    char *args_aux = args;
+    pthread_mutex_lock(&mutex);
+    ret = _artico3_recv_prepare(id, naccs, round, gsize, lsize, &xfer);
+    pthread_mutex_unlock(&mutex);
 
-    // @name
-    strcpy(name, args_aux);
+    if (ret == 0) ret = _artico3_recv_dma(id, &xfer);
+    if (ret == 0) _artico3_recv_scatter(&xfer);
 
-    pthread_mutex_lock(&kernels_mutex);
+    pthread_mutex_lock(&mutex);
+    _artico3_xfer_release(id, &xfer);
+    pthread_mutex_unlock(&mutex);
 
-    // Search for kernel in kernel list
-    for (index = 0; index < A3_MAXKERNS; index++) {
-        if (!kernels[index]) continue;
-        if (strcmp(kernels[index]->name, name) == 0) break;
-    }
-    if (index == A3_MAXKERNS) {
-        a3_print_error("[artico3-hw] no kernel found with name \"%s\"\n", name);
-        pthread_mutex_unlock(&kernels_mutex);
-        return -ENODEV;
-    }
+    return ret;
+}
 
-    // Get kernel pointer
-    kernel = kernels[index];
 
-    // Set kernel list entry as empty
-    kernels[index] = NULL;
+/*
+ * ARTICo3 kernel invocation (delegate scheduling thread data)
+ *
+ * @id      : kernel ID
+ * @index   : kernel index in the kernel list
+ * @nrounds : number of rounds to be executed
+ * @gsize   : global work size (total amount of work to be done)
+ * @lsize   : local work size (work that can be done by one accelerator)
+ * @user_id : ID of the user to be notified on completion (-1 if synchronous)
+ * @handle  : asynchronous completion handle of the user
+ * @stream  : stream control block (NULL if not a streaming execution)
+ *
+ */
+struct a3invocation_t {
+    uint8_t id;
+    unsigned int index;
+    unsigned int nrounds;
+    size_t gsize;
+    size_t lsize;
+    int user_id;
+    int handle;
+    struct a3stream_t *stream;
+};
 
-    pthread_mutex_unlock(&kernels_mutex);
 
-    // Update ARTICo3 slot info
-    for (slot = 0; slot < shuffler.nslots; slot++) {
-        if (shuffler.slots[slot].state != S_EMPTY) {
-            if (shuffler.slots[slot].kernel == kernel) {
-                shuffler.slots[slot].state = S_EMPTY;
-                shuffler.slots[slot].kernel = NULL;
-            }
-        }
+/*
+ * ARTICo3 send asynchronous completion
+ *
+ * This function posts the result of an asynchronous kernel execution in
+ * the shared memory object of the user, and wakes up the user threads
+ * waiting for it.
+ *
+ * @user_id  : ID of the user that launched the execution
+ * @handle   : asynchronous completion handle of the user
+ * @response : kernel execution result
+ *
+ * NOTE : the reference taken on the user when the execution was launched
+ *        is released by this function.
+ *
+ */
+static void _artico3_send_async(int user_id, int handle, int response) {
+    struct a3user_t *user = NULL;
+    struct a3userslot_t *slot = a3_table_entry(&users, user_id);
+
+    // Users being removed are not notified (the reference keeps them mapped)
+    pthread_mutex_lock(&users_mutex);
+    user = slot->user;
+    pthread_mutex_unlock(&users_mutex);
+    if (!user) {
+        a3_print_debug("[artico3-hw] user=%d removed before asynchronous completion\n", user_id);
+        _artico3_user_put(user_id);
+        return;
     }
 
-    // Free allocated memory
-    free(kernel->inouts);
-    free(kernel->outputs);
-    free(kernel->inputs);
-    free(kernel->consts);
-    free(kernel->name);
-    free(kernel);
-    kernel = NULL;
+    // Post completion
+    user->async[handle].response = response;
+    __atomic_store_n(&user->async[handle].done, 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&user->async_seq, 1, __ATOMIC_RELEASE);
 
-    a3_print_debug("[artico3-hw] released kernel (name=%s)\n", name);
+    // Wake up threads waiting for this handle, or for any handle
+    a3_futex_wake(&user->async[handle].done);
+    a3_futex_wake(&user->async_seq);
+    a3_print_debug("[artico3-hw] posted asynchronous completion (user=%d, handle=%d)\n", user_id, handle);
 
-    return 0;
+    // Release the reference taken when the execution was launched
+    _artico3_user_put(user_id);
 }
 
 
 /*
- * ARTICo3 start hardware kernel
- *
- * This function starts all hardware accelerators of a given kernel.
- *
- * NOTE: only the runtime can call this function, using it from user
- *       applications is forbidden (and not possible due to the static
- *       specifier).
- *
- * @name : hardware kernel to start
- *
- * Return : 0 on success, error code otherwise
+ * ARTICo3 delegate scheduling thread
  *
  */
-static int _artico3_kernel_start(const char *name) {
-    unsigned int index;
+void *_artico3_kernel_execute(void *data) {
+    unsigned int i, round, nrounds;
+    size_t gsize, lsize;
+    int naccs, ret;
+
     uint8_t id;
+    uint32_t readymask;
 
-    // Search for kernel in kernel list
-    for (index = 0; index < A3_MAXKERNS; index++) {
-        pthread_mutex_lock(&kernels_mutex);
-        if (!kernels[index]) {
-            pthread_mutex_unlock(&kernels_mutex);
-            continue;
+    struct a3kernel_t *kernel = NULL;
+    struct a3xfer_t tx, rx;
+    int txret = 0, prefetched = 0, pending = 0, pipelined;
+
+    struct timeval t0, tf, tstart;
+    float tsend = 0, texec = 0, trecv = 0, toverlap = 0;
+
+    // Get kernel invocation data
+    struct a3invocation_t *invocation = data;
+    id = invocation->id;
+    kernel = kernels[id - 1];
+    nrounds = invocation->nrounds;
+    gsize = invocation->gsize;
+    lsize = invocation->lsize;
+
+    // Rounds are executed sequentially when the outputs of a round can be
+    // read back as inputs by the next ones (views cannot change while the
+    // kernel is being executed)
+    pthread_mutex_lock(&mutex);
+    pipelined = pipeline && _artico3_kernel_pipelinable(kernel, nrounds);
+    pthread_mutex_unlock(&mutex);
+    a3_print_debug("[artico3-hw] delegate scheduler thread ID:%x | pipeline=%d\n", id, pipelined);
+
+    // Iterate over number of rounds
+    gettimeofday(&tstart, NULL);
+    ret = 0;
+    round = 0;
+    while (round < nrounds) {
+
+        pthread_mutex_lock(&mutex);
+
+        // Mark the kernel as running (configuration changes that affect
+        // its accelerators wait until the current round is finished)
+        kernel->running = 1;
+
+        // For each iteration, compute number of (equivalent) accelerators
+        // and the corresponding expected mask to check the ready register.
+        naccs = artico3_hw_get_naccs(id);
+        readymask = artico3_hw_get_readymask(id);
+
+        // Load constant memories in the accelerators that do not hold them
+        // yet, so that they are not sent again to the remaining ones
+        _artico3_consts_load(id);
+
+        // Set up data transfer
+        gettimeofday(&t0, NULL);
+        if (pipelined) {
+            // Inputs gathered in advance are discarded if the kernel
+            // configuration has changed since they were set up
+            if (prefetched && ((txret < 0) || (tx.plan->naccs != naccs) || (tx.plan->loaded != !_artico3_consts_stale(kernel)))) {
+                _artico3_xfer_release(id, &tx);
+                prefetched = 0;
+            }
+            if (!prefetched) {
+                txret = _artico3_send_prepare(id, naccs, round, gsize, lsize, &tx);
+                if (txret < 0) _artico3_xfer_release(id, &tx);
+            }
         }
-        if (strcmp(kernels[index]->name, name) == 0) {
-            pthread_mutex_unlock(&kernels_mutex);
+
+        pthread_mutex_unlock(&mutex);
+
+        // Send data (memory copies do not hold @mutex, and the DMA engine
+        // is shared with other kernels through the DMA request queue)
+        if (pipelined) {
+            ret = txret;
+            if (ret == 0) {
+                if (!prefetched) _artico3_send_gather(&tx);
+                ret = _artico3_send_dma(id, &tx);
+            }
+            // Set up the transfer of the next round, whose inputs are
+            // gathered while the accelerators compute the current one
+            prefetched = (ret == 0) && ((round + naccs) < nrounds);
+            if (prefetched) {
+                pthread_mutex_lock(&mutex);
+                txret = _artico3_send_prepare(id, naccs, round + naccs, gsize, lsize, &tx);
+                pthread_mutex_unlock(&mutex);
+            }
+        }
+        else {
+            ret = artico3_send(id, naccs, round, gsize, lsize);
+        }
+        gettimeofday(&tf, NULL);
+        tsend += ((tf.tv_sec - t0.tv_sec) * 1000.0) + ((tf.tv_usec - t0.tv_usec) / 1000.0);
+
+        // Abort the execution if the accelerators have not been started
+        // (there is nothing to wait for)
+        if (ret < 0) {
+            a3_print_error("[artico3-hw] id %x | round %4d | could not send data to accelerators (%d)\n", id, round, ret);
             break;
         }
-        pthread_mutex_unlock(&kernels_mutex);
+
+        // Wait until transfer is complete
+        gettimeofday(&t0, NULL);
+        if (pipelined) {
+            // Scatter outputs of the previous round and gather inputs of
+            // the next round while the accelerators are computing
+            if (pending) _artico3_recv_scatter(&rx);
+            if (prefetched && (txret == 0)) _artico3_send_gather(&tx);
+            gettimeofday(&tf, NULL);
+            toverlap += ((tf.tv_sec - t0.tv_sec) * 1000.0) + ((tf.tv_usec - t0.tv_usec) / 1000.0);
+        }
+        _artico3_wait_irq(id, readymask);
+        gettimeofday(&tf, NULL);
+        texec += ((tf.tv_sec - t0.tv_sec) * 1000.0) + ((tf.tv_usec - t0.tv_usec) / 1000.0);
+
+        // Receive data
+        gettimeofday(&t0, NULL);
+        if (pipelined) {
+            // Outputs are scattered while the accelerators compute the
+            // next round (or after the last one)
+            pthread_mutex_lock(&mutex);
+            if (pending) _artico3_xfer_release(id, &rx);
+            ret = _artico3_recv_prepare(id, naccs, round, gsize, lsize, &rx);
+            pthread_mutex_unlock(&mutex);
+            if (ret == 0) ret = _artico3_recv_dma(id, &rx);
+            if (ret < 0) {
+                pthread_mutex_lock(&mutex);
+                _artico3_xfer_release(id, &rx);
+                pthread_mutex_unlock(&mutex);
+            }
+            pending = (ret == 0);
+        }
+        else {
+            ret = artico3_recv(id, naccs, round, gsize, lsize);
+        }
+        gettimeofday(&tf, NULL);
+        trecv += ((tf.tv_sec - t0.tv_sec) * 1000.0) + ((tf.tv_usec - t0.tv_usec) / 1000.0);
+
+        // Abort the execution if the results could not be received
+        if (ret < 0) {
+            a3_print_error("[artico3-hw] id %x | round %4d | could not receive data from accelerators (%d)\n", id, round, ret);
+            break;
+        }
+
+        // Update the round index
+        round += naccs;
+
+        // Mark the kernel as not running, and wake up pending
+        // configuration changes
+        pthread_mutex_lock(&mutex);
+        kernel->running = 0;
+        pthread_cond_broadcast(&quiescent);
+        pthread_mutex_unlock(&mutex);
+
     }
-    if (index == A3_MAXKERNS) {
-        a3_print_error("[artico3-hw] no kernel found with name \"%s\"\n", name);
-        return -ENODEV;
+
+    // Aborted executions leave the kernel marked as running
+    if (ret < 0) {
+        pthread_mutex_lock(&mutex);
+        if (prefetched) _artico3_xfer_release(id, &tx);
+        kernel->running = 0;
+        pthread_cond_broadcast(&quiescent);
+        pthread_mutex_unlock(&mutex);
     }
 
-    // Get kernel id
-    id = kernels[index]->id;
-    a3_print_debug("[artico3-hw] sending kernel start signal to accelerator(s) with ID = %1x\n", id);
+    // Scatter outputs of the last round
+    if (pending) {
+        gettimeofday(&t0, NULL);
+        _artico3_recv_scatter(&rx);
+        gettimeofday(&tf, NULL);
+        trecv += ((tf.tv_sec - t0.tv_sec) * 1000.0) + ((tf.tv_usec - t0.tv_usec) / 1000.0);
+    }
+    gettimeofday(&tf, NULL);
 
-    // Setup transfer (blksize needs to be 0 for register-based transactions)
-    artico3_hw_setup_transfer(0);
-    // Perform selective START (requires kernel ID and operation code 0x2
-    // and the value to be written is not used).
-    artico3_hw_regwrite(id, 0x2, 0x000, 0x00000000);
+    // Release DMA staging buffers that have been idle for too long (the
+    // pools of kernels that are not being executed are only trimmed here)
+    pthread_mutex_lock(&mutex);
+    if (pending) _artico3_xfer_release(id, &rx);
+    pthread_mutex_lock(&kernels_mutex);
+    for (i = 0; i < A3_MAXKERNS; i++) {
+        if (kernels[i]) _artico3_dma_trim(kernels[i], 0);
+    }
+    pthread_mutex_unlock(&kernels_mutex);
+    pthread_mutex_unlock(&mutex);
+
+    // Print elapsed times per stage (send - process - receive), time spent
+    // on memory copies while the accelerators compute, and total time
+    a3_print_info("[artico3-hw] delegate scheduler thread ID : %x | tsend(ms) : %8.3f | texec(ms) : %8.3f | trecv(ms) : %8.3f | toverlap(ms) : %8.3f | ttotal(ms) : %8.3f\n", id, tsend, texec, trecv, toverlap, ((tf.tv_sec - tstart.tv_sec) * 1000.0) + ((tf.tv_usec - tstart.tv_usec) / 1000.0));
+
+    // Notify asynchronous invocations (artico3_kernel_wait() is not
+    // called for them, so the thread is marked as completed here), or
+    // keep the result for artico3_kernel_wait()
+    if (invocation->user_id >= 0) {
+        threads[invocation->index] = 0;
+        _artico3_send_async(invocation->user_id, invocation->handle, ret);
+    }
+    else {
+        kernels[invocation->index]->result = ret;
+    }
+    free(invocation);
 
-    return 0;
+    return NULL;
 }
 
 
 /*
- * ARTICo3 data transfer to accelerators
- *
- * @id      : current kernel ID
- * @naccs   : current number of hardware accelerators for this kernel
- * @round   : current round (global over local work ratio index)
- * @nrounds : total number of rounds (global over local work ratio)
+ * ARTICo3 delegate scheduling thread (streaming execution)
  *
- * Return : 0 on success, error code otherwise
+ * This thread processes the work items of a stream as they are produced:
+ * a transfer is launched as soon as there are enough work items to keep
+ * every accelerator busy (or with the pending ones, when the stream has
+ * been closed or the users would block otherwise), and its work items are
+ * made available to the consumer as soon as their results have been
+ * received. Transfers are not
+ * pipelined, since the inputs of the next transfer have usually not been
+ * produced yet when the current one starts.
  *
  */
-int artico3_send(uint8_t id, int naccs, unsigned int round, unsigned int nrounds) {
-    int acc;
-    unsigned int port, nports, nconsts, ninputs, ninouts;
+void *_artico3_kernel_stream(void *data) {
+    unsigned int round, nrounds, ringrounds;
+    uint32_t produced, closed, flush, events;
+    uint64_t launched;
+    size_t n, head, depth, lsize;
+    int naccs, ret, partial;
 
-    struct dmaproxy_token token;
-    a3data_t *mem = NULL;
+    uint8_t id;
+    uint32_t readymask;
 
-    uint32_t blksize;
-    uint8_t loaded;
+    struct a3kernel_t *kernel = NULL;
+    struct a3stream_t *stream = NULL;
+    struct a3xfer_t tx, rx;
+
+    // Get kernel invocation data (the global work size is the ring depth)
+    struct a3invocation_t *invocation = data;
+    id = invocation->id;
+    kernel = kernels[id - 1];
+    stream = invocation->stream;
+    ringrounds = invocation->nrounds;
+    depth = invocation->gsize;
+    lsize = invocation->lsize;
+    a3_print_debug("[artico3-hw] delegate scheduler thread ID:%x | stream (depth=%zd)\n", id, depth);
+
+    ret = 0;
+    partial = 0;
+    launched = 0;
+    while (1) {
 
-    struct pollfd pfd;
-    pfd.fd = artico3_fd;
-    pfd.events = POLLDMA;
+        // Get work items ready to be processed (the event counter is read
+        // first, so that no event is missed when going to sleep, and flush
+        // requests are cleared before getting the work items to be flushed)
+        events = __atomic_load_n(&stream->events, __ATOMIC_ACQUIRE);
+        flush = __atomic_exchange_n(&stream->flush, 0, __ATOMIC_ACQ_REL);
+        closed = __atomic_load_n(&stream->closed, __ATOMIC_ACQUIRE);
+        produced = __atomic_load_n(&stream->produced, __ATOMIC_ACQUIRE);
+        n = (uint32_t)(produced - (uint32_t)launched);
+        if (n > depth) {
+            a3_print_error("[artico3-hw] stream overrun in kernel %x (%zd work items pending)\n", id, n);
+            ret = -EINVAL;
+            break;
+        }
+        if (!n && closed) break;
 
-    // Check if constant memory ports need to be loaded
-    loaded = kernels[id - 1]->c_loaded;
+        pthread_mutex_lock(&mutex);
 
-    // Get number of input ports
-    nconsts = 0;
-    ninputs = 0;
-    ninouts = 0;
-    for (port = 0; port < kernels[id - 1]->membanks; port++) {
-        if (kernels[id - 1]->consts[port]) nconsts++;
-        if (kernels[id - 1]->inputs[port]) ninputs++;
-        if (kernels[id - 1]->inouts[port]) ninouts++;
-    }
-    nports = loaded ? (ninputs + ninouts) : (nconsts + ninputs + ninouts);
-    if ((nconsts + ninputs + ninouts) == 0) {
-        a3_print_error("[artico3-hw] no input ports found for kernel %x\n", id);
-        return -ENODEV;
-    }
+        // Compute number of (equivalent) accelerators, which bounds the
+        // number of rounds per transfer (as does the ring depth)
+        naccs = artico3_hw_get_naccs(id);
+        if (!naccs) {
+            pthread_mutex_unlock(&mutex);
+            a3_print_error("[artico3-hw] no accelerators found for kernel %x\n", id);
+            ret = -ENODEV;
+            break;
+        }
+        nrounds = ((unsigned int)naccs < ringrounds) ? (unsigned int)naccs : ringrounds;
+
+        // Get the ring position of the first work item (after a partial
+        // transfer, the first round has work items already processed)
+        round = (launched / lsize) % ringrounds;
+        head = launched % lsize;
+
+        // Wait until all the accelerators can be kept busy (partial
+        // transfers are only launched to flush the stream)
+        if (!n || (!closed && !flush && ((head + n) < (nrounds * lsize)))) {
+            pthread_mutex_unlock(&mutex);
+            a3_futex_wait(&stream->events, events);
+            continue;
+        }
+        if ((head + n) > (nrounds * lsize)) n = (nrounds * lsize) - head;
+        nrounds = (head + n + lsize - 1) / lsize;
 
-    // If all inputs are constant memories, and they have been already loaded...
-    if (nports == 0) {
-        // ... set up fake data transfer...
-        artico3_hw_setup_transfer(0);
-        token.memaddr = 0x00000000;
-        token.memoff = 0x00000000;
-        token.hwaddr = (void *)A3_SLOTADDR;
-        token.hwoff = (id << 16);
-        token.size = 0;
-        ioctl(artico3_fd, ARTICo3_IOC_DMA_MEM2HW, &token);
-        // ...launch kernel execution using software command...
-        _artico3_kernel_start(kernels[id - 1]->name);
-        // ...and return
-        return 0;
-    }
+        // Mark the kernel as running (configuration changes that affect
+        // its accelerators wait until the current transfer is finished)
+        kernel->running = 1;
+        readymask = artico3_hw_get_readymask(id);
 
-    // Compute block size (32-bit words per accelerator)
-    blksize = nports * ((kernels[id - 1]->membytes / kernels[id - 1]->membanks) / (sizeof (a3data_t)));
+        // Load constant memories in the accelerators that do not hold them
+        // yet, so that they are not sent again to the remaining ones
+        _artico3_consts_load(id);
 
-    // Allocate DMA physical memory
-    mem = mmap(NULL, naccs * blksize * sizeof *mem, PROT_READ | PROT_WRITE, MAP_SHARED, artico3_fd, sysconf(_SC_PAGESIZE));
-    if (mem == MAP_FAILED) {
-        a3_print_error("[artico3-hw] mmap() failed\n");
-        return -ENOMEM;
-    }
+        // Set up data transfer (window of rounds in the ring-buffered ports)
+        ret = _artico3_send_prepare(id, naccs, round, depth, lsize, &tx);
+        tx.nrounds = round + nrounds;
+        tx.head = head;
+        tx.tail = head + n - ((nrounds - 1) * lsize);
 
-    // Copy inputs to physical memory (TODO: could it be possible to avoid this step?)
-    for (acc = 0; acc < naccs; acc++) {
-        // When finishing, there could be more accelerators than rounds left
-        if ((round + acc) < nrounds) {
-            // Iterate for each port
-            for (port = 0; port < nports; port++) {
-                size_t size, offset;
-                uint32_t idx_mem, idx_dat;
-                a3data_t *data = NULL;
-
-                // Constant memories ARE NOT involved in the DMA transfer
-                if (loaded) {
-                    // Compute offset in DMA-allocated memory buffer
-                    idx_mem = (port * (blksize / nports)) + (acc * blksize);
-                    // Get port data pointer (userspace memory buffer)
-                    if (port < ninputs)
-                        data = kernels[id - 1]->inputs[port]->data;                                                     // Inputs
-                    else
-                        data = kernels[id - 1]->inouts[port - ninputs]->data;                                           // Bidirectional I/O ports
-                    // Compute number of elements (32-bit words) to be copied between buffers
-                    if (port < ninputs)
-                        size = (kernels[id - 1]->inputs[port]->size / sizeof (a3data_t)) / nrounds;                     // Inputs
-                    else
-                        size = (kernels[id - 1]->inouts[port - ninputs]->size / sizeof (a3data_t)) / nrounds;           // Bidirectional I/O ports
-                    // Compute partial offset in userspace memory buffer
-                    offset = round * size;
-                    // Compute final offset in userspace memory buffer
-                    idx_dat = (acc * size) + offset;
-                }
-                // Constant memories ARE involved in the DMA transfer
-                else {
-                    // Compute offset in DMA-allocated memory buffer
-                    idx_mem = (port * (blksize / nports)) + (acc * blksize);
-                    // Get port data pointer (userspace memory buffer)
-                    if (port < nconsts)
-                        data = kernels[id - 1]->consts[port]->data;                                                     // Constant memory inputs
-                    else if (port < nconsts + ninputs)
-                        data = kernels[id - 1]->inputs[port - nconsts]->data;                                           // Inputs
-                    else
-                        data = kernels[id - 1]->inouts[port - nconsts - ninputs]->data;                                 // Bidirectional I/O ports
-                    // Compute number of elements (32-bit words) to be copied between buffers
-                    if (port < nconsts)
-                        size = (kernels[id - 1]->consts[port]->size / sizeof (a3data_t));                               // Constant memory inputs
-                    else if (port < nconsts + ninputs)
-                        size = (kernels[id - 1]->inputs[port - nconsts]->size / sizeof (a3data_t)) / nrounds;           // Inputs
-                    else
-                        size = (kernels[id - 1]->inouts[port - nconsts - ninputs]->size / sizeof (a3data_t)) / nrounds; // Bidirectional I/O ports
-                    // Compute partial offset in userspace memory buffer
-                    offset = round * size;
-                    // Compute final offset in userspace memory buffer
-                    if (port < nconsts)
-                        idx_dat = 0;                                                                                    // Constant memory inputs
-                    else
-                        idx_dat = (acc * size) + offset;                                                                // Inputs and Bidirectional I/O ports
-                }
+        // Send valid work item counts when the transfer is partial (or
+        // the previous one was, to restore them)
+        if (partial || ((head + n) < (naccs * lsize))) _artico3_xfer_vcount(&tx, naccs, (round * lsize) + head + n, lsize);
+        partial = (head + n) < (naccs * lsize);
+        if (ret < 0) _artico3_xfer_release(id, &tx);
 
-                // Copy data from userspace memory buffer to DMA-allocated memory buffer
-                memcpy(&mem[idx_mem], &data[idx_dat], size * sizeof (a3data_t));
-                //~ unsigned int i;
-                //~ for (i = 0; i < size; i++) {
-                    //~ mem[idx_mem + i] = data[idx_dat + i];
-                //~ }
+        pthread_mutex_unlock(&mutex);
 
-                a3_print_debug("[artico3-hw] id %x | round %4d | acc %2d | i_port %2d | mem %10d | dat %10d | size %10zd\n", id, round + acc, acc, port, idx_mem, idx_dat, size * sizeof (a3data_t));
-            }
+        // Send data
+        if (ret == 0) {
+            _artico3_send_gather(&tx);
+            ret = _artico3_send_dma(id, &tx);
         }
-    }
 
-    // Set up data transfer
-    artico3_hw_setup_transfer(blksize);
+        if (ret == 0) {
 
-    // Start DMA transfer
-    token.memaddr = mem;
-    token.memoff = 0x00000000;
-    token.hwaddr = (void *)A3_SLOTADDR;
-    token.hwoff = (id << 16) + (loaded ? (nconsts * (kernels[id - 1]->membytes / kernels[id - 1]->membanks)) : 0);
-    token.size = naccs * blksize * sizeof *mem;
-    ioctl(artico3_fd, ARTICo3_IOC_DMA_MEM2HW, &token);
+            // Wait until transfer is complete
+            _artico3_wait_irq(id, readymask);
 
-    // Wait for DMA transfer to finish
-    poll(&pfd, 1, -1);
+            // Receive data
+            pthread_mutex_lock(&mutex);
+            ret = _artico3_recv_prepare(id, naccs, round, depth, lsize, &rx);
+            rx.nrounds = round + nrounds;
+            rx.head = head;
+            rx.tail = head + n - ((nrounds - 1) * lsize);
+            pthread_mutex_unlock(&mutex);
+            if (ret == 0) ret = _artico3_recv_dma(id, &rx);
+            if (ret == 0) _artico3_recv_scatter(&rx);
+            pthread_mutex_lock(&mutex);
+            _artico3_xfer_release(id, &rx);
+            pthread_mutex_unlock(&mutex);
 
-    // Release allocated DMA memory
-    munmap(mem, naccs * blksize * sizeof *mem);
+        }
 
-    // Set constant memory flag to 1 -> next transfer must not load
-    kernels[id - 1]->c_loaded = 1;
+        // Mark the kernel as not running, and wake up pending
+        // configuration changes
+        pthread_mutex_lock(&mutex);
+        kernel->running = 0;
+        pthread_cond_broadcast(&quiescent);
+        pthread_mutex_unlock(&mutex);
 
-    // Print ARTICo3 registers
-    artico3_hw_print_regs();
+        if (ret < 0) break;
 
-    return 0;
+        // Make the results available to the consumer
+        launched += n;
+        __atomic_store_n(&stream->done, (uint32_t)launched, __ATOMIC_RELEASE);
+        __atomic_fetch_add(&stream->seq, 1, __ATOMIC_RELEASE);
+        a3_futex_wake(&stream->seq);
+        a3_print_debug("[artico3-hw] id %x | stream | processed %zd work items (done=%" PRIu64 ")\n", id, n, launched);
+
+    }
+
+    // Release DMA staging buffers that have been idle for too long
+    pthread_mutex_lock(&mutex);
+    _artico3_dma_trim(kernel, 0);
+    pthread_mutex_unlock(&mutex);
+
+    // Notify stream completion (the control block is not accessed anymore)
+    a3_print_info("[artico3-hw] delegate scheduler thread ID : %x | stream finished (ret=%d, work items=%" PRIu64 ")\n", id, ret, launched);
+    stream->response = ret;
+    __atomic_store_n(&stream->finished, 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&stream->seq, 1, __ATOMIC_RELEASE);
+    a3_futex_wake(&stream->seq);
+    munmap(stream, sizeof *stream);
+    free(invocation);
+
+    return NULL;
 }
 
 
 /*
- * ARTICo3 data transfer from accelerators
+ * ARTICo3 launch hardware kernel
  *
- * @id      : current kernel ID
- * @naccs   : current number of hardware accelerators for this kernel
- * @round   : current round (global over local work ratio index)
- * @nrounds : total number of rounds (global over local work ratio)
+ * This function starts the delegate scheduling thread of an ARTICo3 kernel.
  *
- * Return : 0 on success, error code otherwise
+ * @kernel  : handle of the hardware kernel to execute (0 to use @name)
+ * @name    : name of the hardware kernel to execute
+ * @gsize   : global work size (total amount of work to be done, or ring
+ *            depth of a streaming execution)
+ * @lsize   : local work size (work that can be done by one accelerator)
+ * @user_id : ID of the user to be notified on completion (-1 if synchronous)
+ * @handle  : asynchronous completion handle of the user
+ * @stream  : stream control block (NULL if not a streaming execution)
+ *
+ * Return : 0 on success, error code otherwisw
  *
  */
-int artico3_recv(uint8_t id, int naccs, unsigned int round, unsigned int nrounds) {
-    int acc;
-    unsigned int port, nports, noutputs, ninouts;
+static int _artico3_kernel_launch(int kernel, const char *name, size_t gsize, size_t lsize, int user_id, int handle, struct a3stream_t *stream) {
+    unsigned int index, nrounds;
+    int ret;
 
-    struct dmaproxy_token token;
-    a3data_t *mem = NULL;
+    uint8_t id;
+    struct a3invocation_t *invocation = NULL;
 
-    uint32_t blksize;
+    // Search for kernel in kernel list
+    pthread_mutex_lock(&kernels_mutex);
+    ret = _artico3_kernel_find(kernel, name);
+    pthread_mutex_unlock(&kernels_mutex);
+    if (ret < 0) {
+        return ret;
+    }
+    index = ret;
 
-    struct pollfd pfd;
-    pfd.fd = artico3_fd;
-    pfd.events = POLLDMA;
+    // Get kernel name (requests can reference kernels by handle)
+    name = kernels[index]->name;
 
-    // Get number of output ports
-    ninouts = 0;
-    noutputs = 0;
-    for (port = 0; port < kernels[id - 1]->membanks; port++) {
-        if (kernels[id - 1]->inouts[port]) ninouts++;
-        if (kernels[id - 1]->outputs[port]) noutputs++;
-    }
-    nports = ninouts + noutputs;
-    if (nports == 0) {
-        //~ a3_print_error("[artico3-hw] no output ports found for kernel %x\n", id);
-        //~ return -ENODEV;
-        a3_print_debug("[artico3-hw] no output ports found for kernel %x\n", id);
-        return 0;
+    // Check if kernel is being executed currently
+    if (threads[index]) {
+        a3_print_error("[artico3-hw] kernel \"%s\" is already being executed\n", name);
+        return -EBUSY;
     }
 
-    // Compute block size (32-bit words per accelerator)
-    blksize = nports * ((kernels[id - 1]->membytes / kernels[id - 1]->membanks) / (sizeof (a3data_t)));
+    // Get kernel ID
+    id = kernels[index]->id;
 
-    // Allocate DMA physical memory
-    mem = mmap(NULL, naccs * blksize * sizeof *mem, PROT_READ | PROT_WRITE, MAP_SHARED, artico3_fd, sysconf(_SC_PAGESIZE));
-    if (mem == MAP_FAILED) {
-        a3_print_error("[artico3-hw] mmap() failed\n");
-        return -ENOMEM;
+    // Given current configuration, compute number of rounds (the last one
+    // is partial when gsize is not an integer multiple of lsize)
+    if (!lsize) {
+        a3_print_error("[artico3-hw] invalid lsize (%zd)\n", lsize);
+        return -EINVAL;
     }
+    nrounds = (gsize + lsize - 1) / lsize;
 
-    // Set up data transfer
-    artico3_hw_setup_transfer(blksize);
+    // Check that the accelerators can be told how many work items are
+    // valid in the last round (streams only notify kernels that declare
+    // the valid count register, and process whole rounds otherwise)
+    if (!stream && (gsize % lsize) && (kernels[index]->vcount < 0)) {
+        a3_print_error("[artico3-hw] kernel \"%s\" has no valid count register, gsize=%zd has to be a multiple of lsize=%zd\n", name, gsize, lsize);
+        return -EINVAL;
+    }
 
-    // Start DMA transfer
-    token.memaddr = mem;
-    token.memoff = 0x00000000;
-    token.hwaddr = (void *)A3_SLOTADDR;
-    token.hwoff = (id << 16) + (kernels[id - 1]->membytes - (blksize * sizeof (a3data_t)));
-    token.size = naccs * blksize * sizeof *mem;
-    ioctl(artico3_fd, ARTICo3_IOC_DMA_HW2MEM, &token);
+    // Check that the work size fits in the port views (streams do not
+    // support views)
+    if (!stream) {
+        pthread_mutex_lock(&mutex);
+        ret = _artico3_kernel_views_check(kernels[index], gsize, lsize);
+        pthread_mutex_unlock(&mutex);
+        if (ret < 0) {
+            return ret;
+        }
+    }
 
-    // Wait for DMA transfer to finish
-    poll(&pfd, 1, -1);
+    a3_print_debug("[artico3-hw] executing kernel \"%s\" (gsize=%zd,lsize=%zd,rounds=%d)\n", name, gsize, lsize, nrounds);
 
-    // Copy outputs from physical memory (TODO: could it be possible to avoid this step?)
-    for (acc = 0; acc < naccs; acc++) {
-        // When finishing, there could be more accelerators than rounds left
-        if ((round + acc) < nrounds) {
-            // Iterate for each port
-            for (port = 0; port < nports; port++) {
-                size_t size, offset;
-                uint32_t idx_mem, idx_dat;
-                a3data_t *data = NULL;
-
-                // Compute offset in DMA-allocated memory buffer
-                idx_mem = (port * (blksize / nports)) + (acc * blksize);
-                // Get port data pointer (userspace memory buffer)
-                if (port < ninouts)
-                    data = kernels[id - 1]->inouts[port]->data;                                            // Bidirectional I/O ports
-                else
-                    data = kernels[id - 1]->outputs[port - ninouts]->data;                                 // Outputs
-                // Compute number of elements (32-bit words) to be copied between buffers
-                if (port < ninouts)
-                    size = (kernels[id - 1]->inouts[port]->size / sizeof (a3data_t)) / nrounds;            // Bidirectional I/O ports
-                else
-                    size = (kernels[id - 1]->outputs[port - ninouts]->size / sizeof (a3data_t)) / nrounds; // Outputs
-                // Compute partial offset in userspace memory buffer
-                offset = round * size;
-                // Compute final offset in userspace memory buffer
-                idx_dat = (acc * size) + offset;
-
-                // Copy data from DMA-allocated memory buffer to userspace memory buffer
-                memcpy(&data[idx_dat], &mem[idx_mem], size * sizeof (a3data_t));
-                //~ unsigned int i;
-                //~ for (i = 0; i < size; i++) {
-                    //~ data[idx_dat + i] = mem[idx_mem + i];
-                //~ }
-
-                a3_print_debug("[artico3-hw] id %x | round %4d | acc %2d | o_port %2d | mem %10d | dat %10d | size %10zd\n", id, round + acc, acc, port, idx_mem, idx_dat, size * sizeof (a3data_t));
-            }
-        }
+    // Set kernel invocation data
+    invocation = malloc(sizeof *invocation);
+    if (!invocation) {
+        a3_print_error("[artico3-hw] malloc() failed\n");
+        return -ENOMEM;
+    }
+    invocation->id = id;
+    invocation->index = index;
+    invocation->nrounds = nrounds;
+    invocation->gsize = gsize;
+    invocation->lsize = lsize;
+    invocation->user_id = user_id;
+    invocation->handle = handle;
+    invocation->stream = stream;
+
+    // Asynchronous invocations keep the user mapped until they complete
+    if ((user_id >= 0) && !_artico3_user_get(user_id)) {
+        a3_print_error("[artico3-hw] user=%d is being removed\n", user_id);
+        free(invocation);
+        return -ENODEV;
     }
 
-    // Release allocated DMA memory
-    munmap(mem, naccs * blksize * sizeof *mem);
+    // Thread is marked as running (storing the kernel id) before it is
+    // launched, since asynchronous invocations clear the mark on completion
+    kernels[index]->result = 0;
+    threads[index] = id;
 
-    // Print ARTICo3 registers
-    artico3_hw_print_regs();
+    // Launch delegate thread to manage work scheduling/dispatching
+    ret = artico3_pool_submit_task(kernels_pool, id, stream ? _artico3_kernel_stream : _artico3_kernel_execute, invocation);
+    if (ret == -1) {
+        a3_print_error("[artico3-hw] could not launch delegate scheduler thread for kernel \"%s\"\n", name);
+        threads[index] = 0;
+        if (user_id >= 0) _artico3_user_put(user_id);
+        free(invocation);
+        return -ret;
+    }
+    a3_print_debug("[artico3-hw] started delegate scheduler thread for kernel \"%s\"\n", name);
 
     return 0;
 }
 
 
 /*
- * ARTICo3 delegate scheduling thread
+ * ARTICo3 execute hardware kernel
+ *
+ * This function executes an ARTICo3 kernel in the current application.
+ *
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel to execute (0 to use @name)
+ *     @name   : name of the hardware kernel to execute
+ *     @gsize  : global work size (total amount of work to be done)
+ *     @lsize  : local work size (work that can be done by one accelerator)
+ *
+ * Return : 0 on success, error code otherwisw
  *
  */
-void *_artico3_kernel_execute(void *data) {
-    unsigned int round, nrounds;
-    int naccs;
-
-    uint8_t id;
-#ifdef A3_BUSY_WAIT
-    uint32_t readymask;
-#endif
-
-    struct timeval t0, tf;
-    float tsend = 0, texec = 0, trecv = 0;
-
-    // Get kernel invocation data
-    unsigned int *tdata = data;
-    id = tdata[0];
-    nrounds = tdata[1];
-    free(tdata);
-    a3_print_debug("[artico3-hw] delegate scheduler thread ID:%x\n", id);
-
-    // Iterate over number of rounds
-    round = 0;
-    while (round < nrounds) {
-
-        pthread_mutex_lock(&mutex);
+int artico3_kernel_execute(void *args) {
 
-        // Increase "running" count
-        running++;
+    // Get function arguments
+    int kernel;
+    const char *name;
+    size_t gsize, lsize;
+    struct a3args_t *args_aux = args;
 
-        // For each iteration, compute number of (equivalent) accelerators
-        // and the corresponding expected mask to check the ready register.
-        naccs = artico3_hw_get_naccs(id);
-#ifdef A3_BUSY_WAIT
-        readymask = artico3_hw_get_readymask(id);
-#endif
+    // @kernel
+    kernel = a3_args_get_kernel(args_aux, &name);
+    // @gsize
+    a3_args_get(args_aux, &gsize, sizeof (size_t));
+    // @lsize
+    a3_args_get(args_aux, &lsize, sizeof (size_t));
 
-        // Send data
-        gettimeofday(&t0, NULL);
-        artico3_send(id, naccs, round, nrounds);
-        gettimeofday(&tf, NULL);
-        tsend += ((tf.tv_sec - t0.tv_sec) * 1000.0) + ((tf.tv_usec - t0.tv_usec) / 1000.0);
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
+    }
 
-        pthread_mutex_unlock(&mutex);
+    return _artico3_kernel_launch(kernel, name, gsize, lsize, -1, 0, NULL);
+}
 
-        // Wait until transfer is complete
-        gettimeofday(&t0, NULL);
-#ifdef A3_BUSY_WAIT
-        // ARTICo3 management using busy-wait on the ready register
-        while (!artico3_hw_transfer_isdone(readymask)) ;
-#else
-        // ARTICo3 management using interrupts and blocking system calls
-        { struct pollfd pfd = { .fd = artico3_fd, .events = POLLIRQ(id), };  poll(&pfd, 1, -1); }
-#endif
-        gettimeofday(&tf, NULL);
-        texec += ((tf.tv_sec - t0.tv_sec) * 1000.0) + ((tf.tv_usec - t0.tv_usec) / 1000.0);
 
-        pthread_mutex_lock(&mutex);
+/*
+ * ARTICo3 execute hardware kernel asynchronously
+ *
+ * This function executes an ARTICo3 kernel in the current application,
+ * and posts its completion in the given user handle.
+ *
+ * @args        : buffer storing the function arguments sent by the user
+ *     @kernel  : handle of the hardware kernel to execute (0 to use @name)
+ *     @name    : name of the hardware kernel to execute
+ *     @gsize   : global work size (total amount of work to be done)
+ *     @lsize   : local work size (work that can be done by one accelerator)
+ *     @handle  : asynchronous completion handle of the user
+ *
+ * Return : 0 on success, error code otherwisw
+ *
+ * NOTE : the user to be notified on completion is the one that sent the
+ *        request (the user ID is given by the submission queue).
+ *
+ */
+int artico3_kernel_execute_async(void *args) {
 
-        // Receive data
-        gettimeofday(&t0, NULL);
-        artico3_recv(id, naccs, round, nrounds);
-        gettimeofday(&tf, NULL);
-        trecv += ((tf.tv_sec - t0.tv_sec) * 1000.0) + ((tf.tv_usec - t0.tv_usec) / 1000.0);
+    // Get function arguments
+    int kernel;
+    const char *name;
+    size_t gsize, lsize;
+    int user_id, handle;
+    struct a3args_t *args_aux = args;
 
-        // Update the round index
-        round += naccs;
+    // @kernel
+    kernel = a3_args_get_kernel(args_aux, &name);
+    // @gsize
+    a3_args_get(args_aux, &gsize, sizeof (size_t));
+    // @lsize
+    a3_args_get(args_aux, &lsize, sizeof (size_t));
+    // @handle
+    a3_args_get(args_aux, &handle, sizeof (int));
 
-        // Decrease "running" count
-        running--;
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
+    }
 
-        pthread_mutex_unlock(&mutex);
+    // Get the user that sent the request
+    user_id = args_aux->user;
 
+    if ((user_id < 0) || (handle < 0) || (handle >= A3_MAXHANDLES)) {
+        a3_print_error("[artico3-hw] invalid asynchronous execution (user=%d, handle=%d)\n", user_id, handle);
+        return -EINVAL;
     }
 
-    // Print elapsed times per stage (send - process - receive)
-    a3_print_info("[artico3-hw] delegate scheduler thread ID : %x | tsend(ms) : %8.3f | texec(ms) : %8.3f | trecv(ms) : %8.3f\n", id, tsend, texec, trecv);
-
-    return NULL;
+    return _artico3_kernel_launch(kernel, name, gsize, lsize, user_id, handle, NULL);
 }
 
 
 /*
- * ARTICo3 execute hardware kernel
+ * ARTICo3 execute hardware kernel as a stream
  *
- * This function executes an ARTICo3 kernel in the current application.
+ * This function starts the streaming execution of an ARTICo3 kernel. The
+ * ports of the kernel are used as ring buffers that hold the data of
+ * @depth work items, and the work items are processed as the user
+ * produces them (see struct a3stream_t), until the stream is closed. The
+ * execution is waited for with artico3_kernel_wait().
  *
- * @args      : buffer storing the function arguments sent by the user
- *     @name  : name of the hardware kernel to execute
- *     @gsize : global work size (total amount of work to be done)
- *     @lsize : local work size (work that can be done by one accelerator)
+ * Ring-buffered ports have to hold the same amount of data per work item
+ * (i.e. their size has to be a multiple of @depth words), and cannot be
+ * zero-copy ports (their data is always moved through the DMA staging
+ * buffers). Constant memories are transferred as in regular executions.
  *
- * Return : 0 on success, error code otherwisw
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel to execute (0 to use @name)
+ *     @name   : name of the hardware kernel to execute
+ *     @depth  : number of work items held by the ring-buffered ports
+ *     @lsize  : local work size (work that can be done by one accelerator)
+ *
+ * Return : 0 on success, error code otherwise
  *
  */
-int artico3_kernel_execute(void *args) {
-    unsigned int index, nrounds;
+int artico3_kernel_stream(void *args) {
+    unsigned int index, i;
     int ret;
-
-    uint8_t id;
+    char *filename = NULL;
+    struct a3kernel_t *kernel_aux = NULL;
+    struct a3port_t **lists[4];
+    struct a3port_t *port = NULL;
+    struct a3stream_t *stream = NULL;
 
     // Get function arguments
-    char name[50];
-    size_t gsize, lsize;
-    unsigned copied_bytes;
-    char *args_aux = args;
-
-    // @name
-    strcpy(name, args_aux);
-    copied_bytes = strlen(name) + 1;
-    // @gsize
-    memcpy(&gsize, &(args_aux[copied_bytes]), sizeof (size_t));
-    copied_bytes += sizeof (size_t);
+    int kernel;
+    const char *name;
+    size_t depth, lsize;
+    struct a3args_t *args_aux = args;
+
+    // @kernel
+    kernel = a3_args_get_kernel(args_aux, &name);
+    // @depth
+    a3_args_get(args_aux, &depth, sizeof (size_t));
     // @lsize
-    memcpy(&lsize, &(args_aux[copied_bytes]), sizeof (size_t));
+    a3_args_get(args_aux, &lsize, sizeof (size_t));
+
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
+    }
+
+    // The ring has to hold an integer number of rounds
+    if (!lsize || !depth || (depth % lsize) || (depth > UINT32_MAX / 2)) {
+        a3_print_error("[artico3-hw] invalid stream (depth=%zd,lsize=%zd)\n", depth, lsize);
+        return -EINVAL;
+    }
 
     // Search for kernel in kernel list
-    for (index = 0; index < A3_MAXKERNS; index++) {
-        pthread_mutex_lock(&kernels_mutex);
-        if (!kernels[index]) {
-            pthread_mutex_unlock(&kernels_mutex);
-            continue;
+    pthread_mutex_lock(&kernels_mutex);
+    ret = _artico3_kernel_find(kernel, name);
+    pthread_mutex_unlock(&kernels_mutex);
+    if (ret < 0) {
+        return ret;
+    }
+    index = ret;
+    kernel_aux = kernels[index];
+
+    // Check ring-buffered ports (every port but constant memories)
+    lists[0] = kernel_aux->consts;
+    lists[1] = kernel_aux->inputs;
+    lists[2] = kernel_aux->inouts;
+    lists[3] = kernel_aux->outputs;
+    pthread_mutex_lock(&mutex);
+    for (i = 0; (i < (4 * kernel_aux->membanks)) && (ret >= 0); i++) {
+        port = lists[i % 4][i / 4];
+        if (!port) continue;
+        if (port->key || port->view.rows) {
+            a3_print_error("[artico3-hw] %s port %s cannot be used in a stream\n", port->key ? "zero-copy" : "viewed", port->name);
+            ret = -EINVAL;
         }
-        if (strcmp(kernels[index]->name, name) == 0) {
-            pthread_mutex_unlock(&kernels_mutex);
-            break;
+        else if ((i % 4) && (port->size % (depth * sizeof (a3data_t)))) {
+            a3_print_error("[artico3-hw] port %s cannot hold %zd work items (size=%zd)\n", port->name, depth, port->size);
+            ret = -EINVAL;
         }
-        pthread_mutex_unlock(&kernels_mutex);
     }
-    if (index == A3_MAXKERNS) {
-        a3_print_error("[artico3-hw] no kernel found with name \"%s\"\n", name);
-        return -ENODEV;
+    pthread_mutex_unlock(&mutex);
+    if (ret < 0) {
+        return ret;
     }
 
-    // Check if kernel is being executed currently
-    if (threads[index]) {
-        a3_print_error("[artico3-hw] kernel \"%s\" is already being executed\n", name);
-        return -EBUSY;
+    // Map stream control block (created by the user)
+    filename = malloc(strlen(kernel_aux->name) + strlen(A3_STREAM_SUFFIX) + 1);
+    if (!filename) {
+        a3_print_error("[artico3-hw] malloc() failed\n");
+        return -ENOMEM;
     }
-
-    // Get kernel ID
-    id = kernels[index]->id;
-
-    // Given current configuration, compute number of rounds
-    if (gsize % lsize) {
-        a3_print_error("[artico3-hw] gsize (%zd) not integer multiple of lsize (%zd)\n", gsize, lsize);
-        return -EINVAL;
+    strcpy(filename, kernel_aux->name);
+    strcat(filename, A3_STREAM_SUFFIX);
+    stream = a3_shm_map(filename, sizeof *stream, 0);
+    free(filename);
+    if (stream == MAP_FAILED) {
+        a3_print_error("[artico3-hw] stream control mmap() failed\n");
+        return -ENOMEM;
     }
-    nrounds = gsize / lsize;
 
-    a3_print_debug("[artico3-hw] executing kernel \"%s\" (gsize=%zd,lsize=%zd,rounds=%d)\n", name, gsize, lsize, nrounds);
+    a3_print_debug("[artico3-hw] streaming kernel \"%s\" (depth=%zd,lsize=%zd)\n", kernel_aux->name, depth, lsize);
 
-    // Launch delegate thread to manage work scheduling/dispatching
-    unsigned int *tdata = malloc(2 * sizeof *tdata);
-    tdata[0] = id;
-    tdata[1] = nrounds;
-    ret = artico3_pool_submit_task(kernels_pool, id, _artico3_kernel_execute, tdata);
-    if (ret == -1) {
-        a3_print_error("[artico3-hw] could not launch delegate scheduler thread for kernel \"%s\"\n", name);
-        return -ret;
-    }
-    else {
-        // Thread is marked as running (storing the returned kernel id)
-        threads[index] = ret;
+    // Launch delegate thread (the control block is released by the thread)
+    ret = _artico3_kernel_launch(kernel_aux->handle, kernel_aux->name, depth, lsize, -1, 0, stream);
+    if (ret < 0) {
+        munmap(stream, sizeof *stream);
     }
-    a3_print_debug("[artico3-hw] started delegate scheduler thread for kernel \"%s\"\n", name);
 
-    return 0;
+    return ret;
 }
 
 
 /*
  * ARTICo3 wait for kernel completion
  *
- * This function waits until the kernel has finished.
+ * This function waits until the kernel has finished, and gets the result
+ * of its execution (executions are aborted when data cannot be
+ * transferred to or from the accelerators).
  *
- * @args     : buffer storing the function arguments sent by the user
- *     @name : hardware kernel to wait for
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel to wait for (0 to use @name)
+ *     @name   : hardware kernel to wait for
  *
  * Return : 0 on success, error code otherwise
  *
  */
 int artico3_kernel_wait(void *args) {
     unsigned int index;
+    int thread_id, ret;
 
     // Get function arguments
-    char name[50];
-    char *args_aux = args;
+    int kernel;
+    const char *name;
+    struct a3args_t *args_aux = args;
 
-    // @name
-    strcpy(name, args_aux);
+    // @kernel
+    kernel = a3_args_get_kernel(args_aux, &name);
 
-    // Search for kernel in kernel list
-    for (index = 0; index < A3_MAXKERNS; index++) {
-        pthread_mutex_lock(&kernels_mutex);
-        if (!kernels[index]) {
-            pthread_mutex_unlock(&kernels_mutex);
-            continue;
-        }
-        if (strcmp(kernels[index]->name, name) == 0) {
-            pthread_mutex_unlock(&kernels_mutex);
-            break;
-        }
-        pthread_mutex_unlock(&kernels_mutex);
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
     }
-    if (index == A3_MAXKERNS) {
-        a3_print_error("[artico3-hw] no kernel found with name \"%s\"\n", name);
-        return -ENODEV;
+
+    // Search for kernel in kernel list
+    pthread_mutex_lock(&kernels_mutex);
+    ret = _artico3_kernel_find(kernel, name);
+    pthread_mutex_unlock(&kernels_mutex);
+    if (ret < 0) {
+        return ret;
     }
+    index = ret;
+
+    // Nothing to wait for (not launched, or asynchronous invocation already completed)
+    thread_id = __atomic_load_n(&threads[index], __ATOMIC_RELAXED);
+    if (!thread_id) return 0;
 
     // Wait for thread completion
-    while(!artico3_pool_isdone(kernels_pool, threads[index]));
+    artico3_pool_wait(kernels_pool, thread_id);
 
     // Mark thread as completed
     threads[index] = 0;
 
-    return 0;
+    return kernels[index]->result;
 }
 
 
@@ -1458,51 +4276,57 @@ int artico3_kernel_wait(void *args) {
  *
  * This function resets all hardware accelerators of a given kernel.
  *
- * @args     : buffer storing the function arguments sent by the user
- *     @name : hardware kernel to reset
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel to reset (0 to use @name)
+ *     @name   : hardware kernel to reset
  *
  * Return : 0 on success, error code otherwise
  *
  */
 int artico3_kernel_reset(void *args) {
     unsigned int index;
+    int ret;
     uint8_t id;
 
     // Get function arguments
-    char name[50];
-    char *args_aux = args;
+    int kernel;
+    const char *name;
+    struct a3args_t *args_aux = args;
 
-    // @name
-    strcpy(name, args_aux);
+    // @kernel
+    kernel = a3_args_get_kernel(args_aux, &name);
 
-    // Search for kernel in kernel list
-    for (index = 0; index < A3_MAXKERNS; index++) {
-        pthread_mutex_lock(&kernels_mutex);
-        if (!kernels[index]) {
-            pthread_mutex_unlock(&kernels_mutex);
-            continue;
-        }
-        if (strcmp(kernels[index]->name, name) == 0) {
-            pthread_mutex_unlock(&kernels_mutex);
-            break;
-        }
-        pthread_mutex_unlock(&kernels_mutex);
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
     }
-    if (index == A3_MAXKERNS) {
-        a3_print_error("[artico3-hw] no kernel found with name \"%s\"\n", name);
-        return -ENODEV;
+
+    // Search for kernel in kernel list
+    pthread_mutex_lock(&kernels_mutex);
+    ret = _artico3_kernel_find(kernel, name);
+    pthread_mutex_unlock(&kernels_mutex);
+    if (ret < 0) {
+        return ret;
     }
+    index = ret;
 
     // Get kernel id
     id = kernels[index]->id;
     a3_print_debug("[artico3-hw] sending kernel reset signal to accelerator(s) with ID = %1x\n", id);
 
+    // Wait for the DMA engine (register accesses use the Data Shuffler)
+    _artico3_dma_enter();
+
     // Setup transfer (blksize needs to be 0 for register-based transactions)
     artico3_hw_setup_transfer(0);
     // Perform selective RESET (requires kernel ID and operation code 0x1
     // and the value to be written is not used).
     artico3_hw_regwrite(id, 0x1, 0x000, 0x00000000);
 
+    // Release the DMA engine
+    _artico3_dma_leave();
+
     return 0;
 }
 
@@ -1512,13 +4336,15 @@ int artico3_kernel_reset(void *args) {
  *
  * This function writes configuration data to ARTICo3 kernel registers.
  *
- * @args       : buffer storing the function arguments sent by the user
- *     @name   : hardware kernel to be addressed
- *     @offset : memory offset of the register to be accessed
- *     @cfg    : array of configuration words to be written, one per
- *               equivalent accelerator
+ * @args           : buffer storing the function arguments sent by the user
+ *     @kernel     : handle of the hardware kernel to be addressed (0 to use @name)
+ *     @name       : hardware kernel to be addressed
+ *     @offset     : memory offset of the register to be accessed
+ *     @generation : topology generation used to size @cfg
+ *     @cfg        : array of configuration words to be written, one per
+ *                   equivalent accelerator
  *
- * Return : 0 on success, error code otherwise
+ * Return : 0 on success, -EAGAIN if the topology changed, error code otherwise
  *
  * NOTE : configuration registers need to be handled taking into account
  *        execution priorities.
@@ -1532,47 +4358,43 @@ int artico3_kernel_reset(void *args) {
  *
  */
 int artico3_kernel_wcfg(void *args) {
-    unsigned int index, i, j;
-    struct a3shuffler_t shuffler_shadow;
+    unsigned int index;
+    int ret;
     uint8_t id;
 
-    uint64_t id_reg;
-    uint64_t tmr_reg;
-    uint64_t dmr_reg;
-
     // Get function arguments
-    char name[50];
+    int kernel;
+    const char *name;
     uint16_t offset;
+    uint32_t generation;
+    uint32_t cfg_size;
     a3data_t *cfg;
-    unsigned copied_bytes;
-    char *args_aux = args;
+    struct a3args_t *args_aux = args;
 
-    // @name
-    strcpy(name, args_aux);
-    copied_bytes = strlen(name) + 1;
+    // @kernel
+    kernel = a3_args_get_kernel(args_aux, &name);
     // @offset
-    memcpy(&offset, &(args_aux[copied_bytes]), sizeof (uint16_t));
-    copied_bytes += sizeof (uint16_t);
+    a3_args_get(args_aux, &offset, sizeof (uint16_t));
+    // @generation
+    a3_args_get(args_aux, &generation, sizeof (uint32_t));
     // @cfg
-    cfg = (a3data_t*) &(args_aux[copied_bytes]);
+    cfg_size = a3_args_left(args_aux);
+    cfg = a3_args_reserve(args_aux, cfg_size);
 
-    // Search for kernel in kernel list
-    for (index = 0; index < A3_MAXKERNS; index++) {
-        pthread_mutex_lock(&kernels_mutex);
-        if (!kernels[index]) {
-            pthread_mutex_unlock(&kernels_mutex);
-            continue;
-        }
-        if (strcmp(kernels[index]->name, name) == 0) {
-            pthread_mutex_unlock(&kernels_mutex);
-            break;
-        }
-        pthread_mutex_unlock(&kernels_mutex);
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
     }
-    if (index == A3_MAXKERNS) {
-        a3_print_error("[artico3-hw] no kernel found with name \"%s\"\n", name);
-        return -ENODEV;
+
+    // Search for kernel in kernel list
+    pthread_mutex_lock(&kernels_mutex);
+    ret = _artico3_kernel_find(kernel, name);
+    pthread_mutex_unlock(&kernels_mutex);
+    if (ret < 0) {
+        return ret;
     }
+    index = ret;
 
     // Get kernel id
     id = kernels[index]->id;
@@ -1580,73 +4402,25 @@ int artico3_kernel_wcfg(void *args) {
     // Lock mutex, avoid interference with other processes
     pthread_mutex_lock(&mutex);
 
-    // Copy current shuffler status
-    shuffler_shadow = shuffler;
-
-    // Get current shadow registers
-    id_reg  = shuffler.id_reg;
-    dmr_reg = shuffler.dmr_reg;
-    tmr_reg = shuffler.tmr_reg;
-
-    // Initialize index variable
-    index = 0;
-
-    // TMR blocks
-    for (i = 1; i < (1 << 4); i++) {           // TODO: make this configurable (now, only 4 bits for ID are used)
-        shuffler.id_reg  = 0x0000000000000000;
-        shuffler.dmr_reg = 0x0000000000000000;
-        shuffler.tmr_reg = 0x0000000000000000;
-        for (j = 0; j < shuffler.nslots; j++) {
-            if ((((id_reg >> (4 * j)) & 0xf) == id) && ((tmr_reg >> (4 * j) & 0xf) == i)) {
-                shuffler.id_reg  |= (id << (4 * j));
-                shuffler.tmr_reg |= (i << (4 * j));
-            }
-        }
-        if (shuffler.id_reg) {
-            // Perform write operation
-            artico3_hw_setup_transfer(0); // Register operations do not use blksize register
-            artico3_hw_regwrite(id, 0, offset, cfg[index++]);
-            a3_print_debug("[artico3-hw] W TMR | kernel : %1x | id : %016" PRIx64 " | tmr : %016" PRIx64 " | dmr : %016" PRIx64 " | register : %03x | value : %08x\n", id, shuffler.id_reg, shuffler.tmr_reg, shuffler.dmr_reg, offset, cfg[index-1]);
-        }
-    }
-
-    // DMR blocks
-    for (i = 1; i < (1 << 4); i++) {           // TODO: make this configurable (now, only 4 bits for ID are used)
-        shuffler.id_reg  = 0x0000000000000000;
-        shuffler.dmr_reg = 0x0000000000000000;
-        shuffler.tmr_reg = 0x0000000000000000;
-        for (j = 0; j < shuffler.nslots; j++) {
-            if ((((id_reg >> (4 * j)) & 0xf) == id) && ((dmr_reg >> (4 * j) & 0xf) == i)) {
-                shuffler.id_reg  |= (id << (4 * j));
-                shuffler.dmr_reg |= (i << (4 * j));
-            }
-        }
-        if (shuffler.id_reg) {
-            // Perform write operation
-            artico3_hw_setup_transfer(0); // Register operations do not use blksize register
-            artico3_hw_regwrite(id, 0, offset, cfg[index++]);
-            a3_print_debug("[artico3-hw] W DMR | kernel : %1x | id : %016" PRIx64 " | tmr : %016" PRIx64 " | dmr : %016" PRIx64 " | register : %03x | value : %08x\n", id, shuffler.id_reg, shuffler.tmr_reg, shuffler.dmr_reg, offset, cfg[index-1]);
-        }
+    // Check that @cfg was sized with the current topology
+    if (generation != topology->generation) {
+        a3_print_debug("[artico3-hw] stale topology (generation=%u, current=%u)\n", generation, topology->generation);
+        pthread_mutex_unlock(&mutex);
+        return -EAGAIN;
     }
 
-    // Simplex blocks
-    for (j = 0; j < shuffler.nslots; j++) {
-        shuffler.id_reg  = 0x0000000000000000;
-        shuffler.dmr_reg = 0x0000000000000000;
-        shuffler.tmr_reg = 0x0000000000000000;
-        if ((((id_reg >> (4 * j)) & 0xf) == id) && (((dmr_reg >> (4 * j) & 0xf) == 0x0) && ((tmr_reg >> (4 * j) & 0xf) == 0x0))) {
-            shuffler.id_reg  |= (id << (4 * j));
-        }
-        if (shuffler.id_reg) {
-            // Perform write operation
-            artico3_hw_setup_transfer(0); // Register operations do not use blksize register
-            artico3_hw_regwrite(id, 0, offset, cfg[index++]);
-            a3_print_debug("[artico3-hw] W SMP | kernel : %1x | id : %016" PRIx64 " | tmr : %016" PRIx64 " | dmr : %016" PRIx64 " | register : %03x | value : %08x\n", id, shuffler.id_reg, shuffler.tmr_reg, shuffler.dmr_reg, offset, cfg[index-1]);
-        }
+    // Check that @cfg holds one word per equivalent accelerator
+    if ((artico3_hw_get_naccs(id) * sizeof (a3data_t)) > cfg_size) {
+        a3_print_error("[artico3-hw] invalid configuration size (%u bytes)\n", cfg_size);
+        pthread_mutex_unlock(&mutex);
+        return -EINVAL;
     }
 
-    // Restore previous shuffler status
-    shuffler = shuffler_shadow;
+    // Write configuration registers (register accesses use the Data
+    // Shuffler)
+    _artico3_dma_enter();
+    _artico3_kernel_wregs(id, offset, cfg);
+    _artico3_dma_leave();
 
     // Release mutex
     pthread_mutex_unlock(&mutex);
@@ -1660,13 +4434,15 @@ int artico3_kernel_wcfg(void *args) {
  *
  * This function reads configuration data from ARTICo3 kernel registers.
  *
- * @args       : buffer storing the function arguments sent by the user
- *     @name   : hardware kernel to be addressed
- *     @offset : memory offset of the register to be accessed
- *     @cfg    : array of configuration words to be read, one per
- *               equivalent accelerator
+ * @args           : buffer storing the function arguments sent by the user
+ *     @kernel     : handle of the hardware kernel to be addressed (0 to use @name)
+ *     @name       : hardware kernel to be addressed
+ *     @offset     : memory offset of the register to be accessed
+ *     @generation : topology generation used to size @cfg
+ *     @cfg        : array of configuration words to be read, one per
+ *                   equivalent accelerator
  *
- * Return : 0 on success, error code otherwise
+ * Return : 0 on success, -EAGAIN if the topology changed, error code otherwise
  *
  * NOTE : configuration registers need to be handled taking into account
  *        execution priorities.
@@ -1681,6 +4457,7 @@ int artico3_kernel_wcfg(void *args) {
  */
 int artico3_kernel_rcfg(void *args) {
     unsigned int index, i, j;
+    int ret;
     struct a3shuffler_t shuffler_shadow;
     uint8_t id;
 
@@ -1689,38 +4466,38 @@ int artico3_kernel_rcfg(void *args) {
     uint64_t dmr_reg;
 
     // Get function arguments
-    char name[50];
+    int kernel;
+    const char *name;
     uint16_t offset;
+    uint32_t generation;
+    uint32_t cfg_size;
     a3data_t *cfg;
-    unsigned copied_bytes;
-    char *args_aux = args;
+    struct a3args_t *args_aux = args;
 
-    // @name
-    strcpy(name, args_aux);
-    copied_bytes = strlen(name) + 1;
+    // @kernel
+    kernel = a3_args_get_kernel(args_aux, &name);
     // @offset
-    memcpy(&offset, &(args_aux[copied_bytes]), sizeof (uint16_t));
-    copied_bytes += sizeof (uint16_t);
+    a3_args_get(args_aux, &offset, sizeof (uint16_t));
+    // @generation
+    a3_args_get(args_aux, &generation, sizeof (uint32_t));
     // @cfg
-    cfg = (a3data_t*) &(args_aux[copied_bytes]);
+    cfg_size = a3_args_left(args_aux);
+    cfg = a3_args_reserve(args_aux, cfg_size);
 
-    // Search for kernel in kernel list
-    for (index = 0; index < A3_MAXKERNS; index++) {
-        pthread_mutex_lock(&kernels_mutex);
-        if (!kernels[index]) {
-            pthread_mutex_unlock(&kernels_mutex);
-            continue;
-        }
-        if (strcmp(kernels[index]->name, name) == 0) {
-            pthread_mutex_unlock(&kernels_mutex);
-            break;
-        }
-        pthread_mutex_unlock(&kernels_mutex);
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
     }
-    if (index == A3_MAXKERNS) {
-        a3_print_error("[artico3-hw] no kernel found with name \"%s\"\n", name);
-        return -ENODEV;
+
+    // Search for kernel in kernel list
+    pthread_mutex_lock(&kernels_mutex);
+    ret = _artico3_kernel_find(kernel, name);
+    pthread_mutex_unlock(&kernels_mutex);
+    if (ret < 0) {
+        return ret;
     }
+    index = ret;
 
     // Get kernel id
     id = kernels[index]->id;
@@ -1728,6 +4505,23 @@ int artico3_kernel_rcfg(void *args) {
     // Lock mutex, avoid interference with other processes
     pthread_mutex_lock(&mutex);
 
+    // Check that @cfg was sized with the current topology
+    if (generation != topology->generation) {
+        a3_print_debug("[artico3-hw] stale topology (generation=%u, current=%u)\n", generation, topology->generation);
+        pthread_mutex_unlock(&mutex);
+        return -EAGAIN;
+    }
+
+    // Check that @cfg holds one word per equivalent accelerator
+    if ((artico3_hw_get_naccs(id) * sizeof (a3data_t)) > cfg_size) {
+        a3_print_error("[artico3-hw] invalid configuration size (%u bytes)\n", cfg_size);
+        pthread_mutex_unlock(&mutex);
+        return -EINVAL;
+    }
+
+    // Wait for the DMA engine (register accesses use the Data Shuffler)
+    _artico3_dma_enter();
+
     // Copy current shuffler status
     shuffler_shadow = shuffler;
 
@@ -1796,6 +4590,9 @@ int artico3_kernel_rcfg(void *args) {
     // Restore previous shuffler status
     shuffler = shuffler_shadow;
 
+    // Release the DMA engine
+    _artico3_dma_leave();
+
     // Release mutex
     pthread_mutex_unlock(&mutex);
 
@@ -1804,67 +4601,192 @@ int artico3_kernel_rcfg(void *args) {
 
 
 /*
- * ARTICo3 allocate buffer memory
+ * ARTICo3 declare valid count register
  *
- * This function allocates dynamic memory to be used as a buffer between
- * the application and the local memories in the hardware kernels.
+ * This function declares the register of a kernel that gets, before each
+ * round, the number of valid work items of each accelerator. Executions
+ * whose global work size is not a multiple of the local work size are
+ * only allowed for kernels that declare it.
  *
- * @args      : buffer storing the function arguments sent by the user
- *     @size  : amount of memory (in bytes) to be allocated for the buffer
- *     @kname : hardware kernel name to associate this buffer with
- *     @pname : port name to associate this buffer with
- *     @dir   : data direction of the port
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel to be addressed (0 to use @name)
+ *     @name   : hardware kernel to be addressed
+ *     @reg    : register index (-1 to remove the declaration)
  *
- * Return : pointer to allocated memory on success, NULL otherwise
+ * Return : 0 on success, error code otherwise
  *
- * NOTE   : the dynamically allocated buffer is mapped via mmap() to a
- *          POSIX shared memory object in the "/dev/shm" tmpfs to make it
- *          accessible from different processes
+ */
+int artico3_kernel_vcount(void *args) {
+    unsigned int index;
+    int ret;
+
+    // Get function arguments
+    int kernel;
+    const char *name;
+    int32_t reg;
+    struct a3args_t *args_aux = args;
+
+    // @kernel
+    kernel = a3_args_get_kernel(args_aux, &name);
+    // @reg
+    a3_args_get(args_aux, &reg, sizeof (int32_t));
+
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
+    }
+
+    // Search for kernel in kernel list
+    pthread_mutex_lock(&kernels_mutex);
+    ret = _artico3_kernel_find(kernel, name);
+    pthread_mutex_unlock(&kernels_mutex);
+    if (ret < 0) {
+        return ret;
+    }
+    index = ret;
+
+    // Check register index
+    if ((reg >= 0) && ((size_t)reg >= kernels[index]->regs)) {
+        a3_print_error("[artico3-hw] invalid valid count register %d (kernel \"%s\" has %zd registers)\n", reg, kernels[index]->name, kernels[index]->regs);
+        return -EINVAL;
+    }
+
+    // The register cannot change while the kernel is being executed (the
+    // work size has been checked against it)
+    if (threads[index]) {
+        a3_print_error("[artico3-hw] kernel \"%s\" is being executed, cannot change its valid count register\n", kernels[index]->name);
+        return -EBUSY;
+    }
+
+    // Set valid count register
+    pthread_mutex_lock(&mutex);
+    kernels[index]->vcount = (reg < 0) ? -1 : reg;
+    pthread_mutex_unlock(&mutex);
+
+    a3_print_debug("[artico3-hw] kernel \"%s\" valid count register %d\n", kernels[index]->name, kernels[index]->vcount);
+
+    return 0;
+}
+
+
+/*
+ * ARTICo3 get shared DMA region key
  *
- * TODO   : implement optimized version using qsort();
- * TODO   : create folders and subfolders on /dev/shm for each user and its data (kernels, inputs, etc.)
+ * This function gets a shared DMA region key that is not used by any
+ * zero-copy port, and that is not mapped by any process (regions freed
+ * by the daemon are kept while users still map them, and a new port
+ * would silently share them).
+ *
+ * Return : shared DMA region key on success, 0 if every key is in use
  *
  */
-int artico3_alloc(void *args) {
-    int fd;
+static unsigned long _artico3_dma_key() {
+    static unsigned long seq = 0;
+    unsigned int index, p, tries;
+    unsigned long key;
+    int used;
+    struct dmaproxy_share_token token;
+
+    for (tries = 0; tries < A3_DMA_MAXKEYS; tries++) {
+        key = ARTICo3_MMAP_SHARED + (seq++ % A3_DMA_MAXKEYS);
+        used = 0;
+        for (index = 0; index < A3_MAXKERNS; index++) {
+            if (!kernels[index]) continue;
+            for (p = 0; p < kernels[index]->membanks; p++) {
+                if (kernels[index]->inputs[p] && (kernels[index]->inputs[p]->key == key)) used = 1;
+                if (kernels[index]->outputs[p] && (kernels[index]->outputs[p]->key == key)) used = 1;
+                if (kernels[index]->inouts[p] && (kernels[index]->inouts[p]->key == key)) used = 1;
+            }
+        }
+        if (used) continue;
+
+        // Check that the region is not mapped anymore
+        token.key = key;
+        token.pid = 0;
+        token.refs = 0;
+        if (ioctl(artico3_fd, ARTICo3_IOC_DMA_REFS, &token) < 0) {
+            a3_print_error("[artico3-hw] could not get mappings of shared DMA region (key=%lu)\n", key);
+            return 0;
+        }
+        if (!token.refs) return key;
+    }
+
+    return 0;
+}
+
+
+/*
+ * ARTICo3 allocate buffer memory (POSIX shared memory or zero-copy)
+ *
+ * @size   : amount of memory (in bytes) to be allocated for the buffer
+ * @kernel : handle of the hardware kernel to associate this buffer with (0 to use @kname)
+ * @kname  : hardware kernel name to associate this buffer with
+ * @pname  : port name to associate this buffer with
+ * @dir    : data direction of the port (A3_P_CACHED flag for cached zero-copy
+ *           ports, A3_P_HUGE flag for huge page-backed shared memory ports)
+ * @nbanks : number of local memory banks used by the port (0 for POSIX
+ *           shared memory ports, which always use one bank)
+ * @dtype  : data type of the application buffer (A3_T_*, A3_T_RAW for
+ *           zero-copy ports)
+ * @pid    : process allowed to map the shared DMA region (zero-copy ports)
+ *
+ * Return : shared DMA region key, OR-ed with ARTICo3_MMAP_CACHED if the
+ *          region is cached (zero-copy ports) or 0 (POSIX shared memory
+ *          ports) on success, error code otherwise
+ *
+ */
+static int _artico3_alloc(size_t size, int kernel, const char *kname, const char *pname, enum a3pdir_t dir, unsigned int nbanks, unsigned int dtype, pid_t pid) {
+    int ret, cached, huge, typed;
     unsigned int index, p, i, j;
     struct a3port_t *port = NULL;
+    struct dmaproxy_share_token token;
 
-    // Get function arguments
-    char kname[50], pname[50];
-    size_t size;
-    enum a3pdir_t dir;
-    unsigned copied_bytes;
-    char *args_aux = args;
+    // Search for kernel in kernel list
+    pthread_mutex_lock(&kernels_mutex);
+    ret = _artico3_kernel_find(kernel, kname);
+    pthread_mutex_unlock(&kernels_mutex);
+    if (ret < 0) {
+        return -1;
+    }
+    index = ret;
 
-    // @name
-    memcpy(&size, args_aux, sizeof (size_t));
-    copied_bytes = sizeof (size_t);
-    // @kname
-    strcpy(kname, &(args_aux[copied_bytes]));
-    copied_bytes += strlen(kname) + 1;
-    // @pname
-    strcpy(pname, &(args_aux[copied_bytes]));
-    copied_bytes += strlen(pname) + 1;
-    // @dir
-    memcpy(&dir, &(args_aux[copied_bytes]), sizeof (enum a3pdir_t));
+    // Get kernel name (requests can reference kernels by handle)
+    kname = kernels[index]->name;
 
-    // Search for kernel in kernel list
-    for (index = 0; index < A3_MAXKERNS; index++) {
-        pthread_mutex_lock(&kernels_mutex);
-        if (!kernels[index]) {
-            pthread_mutex_unlock(&kernels_mutex);
-            continue;
-        }
-        if (strcmp(kernels[index]->name, kname) == 0) {
-            pthread_mutex_unlock(&kernels_mutex);
+    // Get port direction flags
+    cached = (dir & A3_P_CACHED) != 0;
+    huge = (dir & A3_P_HUGE) != 0;
+    dir = (enum a3pdir_t)(dir & ~(A3_P_CACHED | A3_P_HUGE));
+
+    // Check zero-copy port configuration
+    if ((cached && !nbanks) || (huge && nbanks) || (nbanks && ((dir == A3_P_C) || (nbanks > kernels[index]->membanks)))) {
+        a3_print_error("[artico3-hw] invalid zero-copy port configuration (dir=%d,nbanks=%u)\n", dir, nbanks);
+        return -EINVAL;
+    }
+
+    // Check port data type (typed ports are converted when copying them
+    // to/from the DMA staging buffers, hence they cannot be zero-copy, and
+    // they have to hold whole elements and hardware words)
+    switch (A3_T_KIND(dtype)) {
+        case A3_T_RAW:
+        case A3_T_F32:
+        case A3_T_I16X2:
+            typed = (A3_T_FRAC(dtype) == 0);
+            break;
+        case A3_T_Q(0):
+            typed = (A3_T_FRAC(dtype) <= 31);
+            break;
+        case A3_T_Q16X2(0):
+            typed = (A3_T_FRAC(dtype) <= 15);
+            break;
+        default:
+            typed = 0;
             break;
-        }
-        pthread_mutex_unlock(&kernels_mutex);
     }
-    if (index == A3_MAXKERNS) {
-        a3_print_error("[artico3-hw] no kernel found with name \"%s\"\n", kname);
-        return -1;
+    if (!typed || (dtype & ~0xfffu) || ((dtype != A3_T_RAW) && (nbanks || (size % A3_T_ESIZE(dtype)) || ((size / A3_T_RATIO(dtype)) % sizeof (a3data_t))))) {
+        a3_print_error("[artico3-hw] invalid port data type (dtype=%#x,size=%zd,nbanks=%u)\n", dtype, size, nbanks);
+        return -EINVAL;
     }
 
     // Allocate memory for kernel port configuration
@@ -1882,39 +4804,73 @@ int artico3_alloc(void *args) {
     }
     strcpy(port->name, pname);
 
-    // Set port size
-    port->size = size;
-
-    // Set port filename (concatenation of kname and pname)
-    port->filename = malloc(strlen(kname) + strlen(pname) + 1);
-    if (!port->filename) {
-        a3_print_error("[artico3-hw] port->filename malloc() failed\n");
-        goto err_malloc_port_filename;
-    }
-    strcpy(port->filename, kname);
-    strcpy(port->filename + strlen(kname), pname);
+    // Set port size (hardware data)
+    port->size = size / A3_T_RATIO(dtype);
+    port->nbanks = nbanks ? nbanks : 1;
+    port->key = 0;
+    port->mapsize = 0;
+    port->cached = 0;
+    port->dtype = dtype;
+    memset(&port->view, 0, sizeof port->view);
+    port->filename = NULL;
+
+    // Zero-copy ports are backed by a shared DMA region, padded so that
+    // the last round can always transfer one block per accelerator (cached
+    // regions fall back to coherent memory if they cannot be allocated)
+    if (nbanks) {
+        port->key = _artico3_dma_key();
+        if (!port->key) {
+            a3_print_error("[artico3-hw] no shared DMA region key available\n");
+            goto err_shm_open_port_filename;
+        }
+        port->mapsize = size + (shuffler.nslots * nbanks * (kernels[index]->membytes / kernels[index]->membanks));
+        port->mapsize = ((port->mapsize + sysconf(_SC_PAGESIZE) - 1) / sysconf(_SC_PAGESIZE)) * sysconf(_SC_PAGESIZE);
+        port->data = MAP_FAILED;
+        if (cached) {
+            port->data = mmap(0, port->mapsize, PROT_READ | PROT_WRITE, MAP_SHARED, artico3_fd, (port->key | ARTICo3_MMAP_CACHED) * sysconf(_SC_PAGESIZE));
+            port->cached = (port->data != MAP_FAILED);
+        }
+        if (port->data == MAP_FAILED) {
+            port->data = mmap(0, port->mapsize, PROT_READ | PROT_WRITE, MAP_SHARED, artico3_fd, port->key * sysconf(_SC_PAGESIZE));
+        }
+        if (port->data == MAP_FAILED) {
+            a3_print_error("[artico3-hw] port->data mmap() failed\n");
+            goto err_shm_open_port_filename;
+        }
 
-    // Create a shared memory object
-    fd = shm_open(port->filename, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
-    if(fd < 0) {
-        a3_print_error("[artico3-hw] fd shm_open() failed\n");
-        goto err_shm_open_port_filename;
+        // Share the region only with the user that allocates the port
+        token.key = port->key;
+        token.pid = pid;
+        token.refs = 0;
+        if (ioctl(artico3_fd, ARTICo3_IOC_DMA_SHARE, &token) < 0) {
+            a3_print_error("[artico3-hw] could not share DMA region (key=%lu,pid=%d)\n", port->key, (int)pid);
+            goto err_noport;
+        }
+        a3_print_debug("[artico3-hw] zero-copy port %s (key=%lu,nbanks=%u,mapsize=%zd,cached=%d)\n", pname, port->key, port->nbanks, port->mapsize, port->cached);
     }
+    else {
 
-    // Resize the shared memory object
-    ftruncate(fd, port->size);
+        // Set port filename (concatenation of kname and pname)
+        port->filename = malloc(strlen(kname) + strlen(pname) + 1);
+        if (!port->filename) {
+            a3_print_error("[artico3-hw] port->filename malloc() failed\n");
+            goto err_malloc_port_filename;
+        }
+        strcpy(port->filename, kname);
+        strcpy(port->filename + strlen(kname), pname);
+
+        // Map the shared memory object (huge page-backed objects are
+        // padded to the huge page size, and locked or pre-faulted)
+        port->mapsize = a3_shm_size(size, huge);
+        port->data = a3_shm_map(port->filename, port->mapsize, huge);
+        if(port->data == MAP_FAILED) {
+            a3_print_error("[artico3-hw] port->data mmap() failed\n");
+            goto err_mmap_port_filename;
+        }
+        a3_print_debug("[artico3-hw] shared memory port %s (mapsize=%zd,huge=%d,dtype=%#x)\n", pname, port->mapsize, huge, dtype);
 
-    // Allocate memory for application mapped to the shared memory object with mmap()
-    port->data = mmap(0, port->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-    if(port->data == MAP_FAILED) {
-        a3_print_error("[artico3-hw] port->data mmap() failed\n");
-        close(fd);
-        goto err_mmap_port_filename;
     }
 
-    // Close shared memory object file descriptor (not needed anymore)
-    close(fd);
-
     // Check port direction flag : CONSTANTS
     if (dir == A3_P_C) {
 
@@ -1939,9 +4895,6 @@ int artico3_alloc(void *args) {
             }
         }
 
-        // Set constant memory flag to 0 -> next transfer must load
-        kernels[index]->c_loaded = 0;
-
         // Print sorted list
         a3_print_debug("[artico3-hw] constant memory input ports after sorting: ");
         for (p = 0; p < kernels[index]->membanks; p++) {
@@ -2054,13 +5007,20 @@ int artico3_alloc(void *args) {
 
     }
 
-    return 0;
+    // Invalidate transfer plans (port set has changed), and update the
+    // constant memory version -> next transfer must load
+    pthread_mutex_lock(&mutex);
+    _artico3_plan_invalidate(kernels[index]);
+    if (dir == A3_P_C) kernels[index]->c_version = ++const_seq;
+    pthread_mutex_unlock(&mutex);
+
+    return port->cached ? (int)(port->key | ARTICo3_MMAP_CACHED) : (int)port->key;
 
 err_noport:
-    munmap(port->data, port->size);
+    munmap(port->data, port->mapsize);
 
 err_mmap_port_filename:
-    shm_unlink(port->filename);
+    if (port->filename) shm_unlink(port->filename);
 
 err_shm_open_port_filename:
     free(port->filename);
@@ -2076,57 +5036,288 @@ err_malloc_port_name:
 
 
 /*
- * ARTICo3 release buffer memory
+ * ARTICo3 allocate buffer memory
  *
- * This function frees dynamic memory allocated as a buffer between the
- * application and the hardware kernel.
+ * This function allocates dynamic memory to be used as a buffer between
+ * the application and the local memories in the hardware kernels.
  *
- * @args      : buffer storing the function arguments sent by the user
- *     @kname : hardware kernel name this buffer is associanted with
- *     @pname : port name this buffer is associated with
+ * @args       : buffer storing the function arguments sent by the user
+ *     @size   : amount of memory (in bytes) to be allocated for the buffer
+ *     @kernel : handle of the hardware kernel to associate this buffer with (0 to use @kname)
+ *     @kname  : hardware kernel name to associate this buffer with
+ *     @pname  : port name to associate this buffer with
+ *     @dir    : data direction of the port (A3_P_HUGE flag for huge page-backed buffers)
+ *     @dtype  : data type of the application buffer (A3_T_*)
  *
  * Return : 0 on success, error code otherwise
  *
+ * NOTE   : the dynamically allocated buffer is mapped via mmap() to a
+ *          POSIX shared memory object in the "/dev/shm" tmpfs to make it
+ *          accessible from different processes
+ *
+ * TODO   : implement optimized version using qsort();
+ * TODO   : create folders and subfolders on /dev/shm for each user and its data (kernels, inputs, etc.)
+ *
  */
-int artico3_free(void *args) {
+int artico3_alloc(void *args) {
+
+    // Get function arguments
+    int kernel;
+    const char *kname, *pname;
+    size_t size;
+    enum a3pdir_t dir;
+    unsigned int dtype;
+    struct a3args_t *args_aux = args;
+
+    // @size
+    a3_args_get(args_aux, &size, sizeof (size_t));
+    // @kernel
+    kernel = a3_args_get_kernel(args_aux, &kname);
+    // @pname
+    pname = a3_args_get_str(args_aux);
+    // @dir
+    a3_args_get(args_aux, &dir, sizeof (enum a3pdir_t));
+    // @dtype
+    a3_args_get(args_aux, &dtype, sizeof (unsigned int));
+
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
+    }
+
+    return _artico3_alloc(size, kernel, kname, pname, dir, 0, dtype, 0);
+}
+
+
+/*
+ * ARTICo3 allocate zero-copy buffer memory
+ *
+ * This function allocates DMA-capable memory, shared between the Daemon
+ * and the application, to be used as a buffer between the application
+ * and @nbanks consecutive local memories in the hardware kernels. The
+ * buffer stores, for each work-group, the contents of the @nbanks banks
+ * one after the other (i.e. the hardware layout of a DMA transfer), so
+ * that rounds can be transferred straight from/to it.
+ *
+ * @args       : buffer storing the function arguments sent by the user
+ *     @size   : amount of memory (in bytes) to be allocated for the buffer
+ *     @kernel : handle of the hardware kernel to associate this buffer with (0 to use @kname)
+ *     @kname  : hardware kernel name to associate this buffer with
+ *     @pname  : port name to associate this buffer with
+ *     @dir    : data direction of the port (A3_P_I, A3_P_O, A3_P_IO), optionally
+ *               OR-ed with A3_P_CACHED to request cached DMA memory
+ *     @nbanks : number of local memory banks used by the port
+ *
+ * Return : shared DMA region key (to be used as mmap() page offset on
+ *          the ARTICo3 device, including ARTICo3_MMAP_CACHED for cached
+ *          regions) on success, error code otherwise
+ *
+ * NOTE : the shared DMA region can only be mapped by the process of the
+ *        user that sent the request.
+ *
+ */
+int artico3_alloc_zc(void *args) {
+
+    // Get function arguments
+    int kernel;
+    const char *kname, *pname;
+    size_t size;
+    enum a3pdir_t dir;
+    unsigned int nbanks;
+    pid_t pid;
+    struct a3args_t *args_aux = args;
+
+    // @size
+    a3_args_get(args_aux, &size, sizeof (size_t));
+    // @kernel
+    kernel = a3_args_get_kernel(args_aux, &kname);
+    // @pname
+    pname = a3_args_get_str(args_aux);
+    // @dir
+    a3_args_get(args_aux, &dir, sizeof (enum a3pdir_t));
+    // @nbanks
+    a3_args_get(args_aux, &nbanks, sizeof (unsigned int));
+
+    // Check that arguments lie inside the request payload
+    if (args_aux->error || (nbanks == 0)) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
+    }
+
+    // Get the process of the user that sent the request (the one that
+    // maps the shared DMA region)
+    pthread_mutex_lock(&users_mutex);
+    pid = ((struct a3userslot_t *)a3_table_entry(&users, args_aux->user))->pid;
+    pthread_mutex_unlock(&users_mutex);
+
+    return _artico3_alloc(size, kernel, kname, pname, dir, nbanks, A3_T_RAW, pid);
+}
+
+
+/*
+ * ARTICo3 set port view
+ *
+ * This function sets the access descriptor of a port, which describes how
+ * the data of each work-group is extracted from (or stored into) the port
+ * buffer (see struct a3view_t). The view is used by the kernel executions
+ * started after this call.
+ *
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel the port is associated with (0 to use @kname)
+ *     @kname  : hardware kernel name the port is associated with
+ *     @pname  : port name
+ *     @view   : port view (rows set to 0 to remove the view)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ * NOTE   : views are only supported on input, output and bidirectional
+ *          I/O ports backed by POSIX shared memory (zero-copy ports
+ *          already use the hardware layout)
+ *
+ */
+int artico3_port_view(void *args) {
     unsigned int index, p;
+    int ret;
+    size_t words;
     struct a3port_t *port = NULL;
 
     // Get function arguments
-    char kname[50], pname[50];
-    unsigned copied_bytes;
-    char *args_aux = args;
+    int kernel;
+    const char *kname, *pname;
+    struct a3view_t view;
+    struct a3args_t *args_aux = args;
 
-    // @kname
-    strcpy(kname, args_aux);
-    copied_bytes = strlen(kname) + 1;
+    // @kernel
+    kernel = a3_args_get_kernel(args_aux, &kname);
     // @pname
-    strcpy(pname, &(args_aux[copied_bytes]));
+    pname = a3_args_get_str(args_aux);
+    // @view
+    a3_args_get(args_aux, &view, sizeof (struct a3view_t));
+
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
+    }
 
     // Search for kernel in kernel list
-    for (index = 0; index < A3_MAXKERNS; index++) {
-        pthread_mutex_lock(&kernels_mutex);
-        if (!kernels[index]) {
-            pthread_mutex_unlock(&kernels_mutex);
-            continue;
+    pthread_mutex_lock(&kernels_mutex);
+    ret = _artico3_kernel_find(kernel, kname);
+    pthread_mutex_unlock(&kernels_mutex);
+    if (ret < 0) {
+        return ret;
+    }
+    index = ret;
+
+    // Search for port in port lists (constant memories are transferred whole)
+    for (p = 0; p < kernels[index]->membanks; p++) {
+        if (kernels[index]->inputs[p] && (strcmp(kernels[index]->inputs[p]->name, pname) == 0)) {
+            port = kernels[index]->inputs[p];
+            break;
         }
-        if (strcmp(kernels[index]->name, kname) == 0) {
-            pthread_mutex_unlock(&kernels_mutex);
+        if (kernels[index]->outputs[p] && (strcmp(kernels[index]->outputs[p]->name, pname) == 0)) {
+            port = kernels[index]->outputs[p];
+            break;
+        }
+        if (kernels[index]->inouts[p] && (strcmp(kernels[index]->inouts[p]->name, pname) == 0)) {
+            port = kernels[index]->inouts[p];
             break;
         }
-        pthread_mutex_unlock(&kernels_mutex);
     }
-    if (index == A3_MAXKERNS) {
-        a3_print_error("[artico3-hw] no kernel found with name \"%s\"\n", kname);
+    if (!port) {
+        a3_print_error("[artico3-hw] no input/output port found with name %s\n", pname);
         return -ENODEV;
     }
 
+    // Check view (tiles have to be made of whole rows inside the buffer,
+    // the bounds of the whole execution are checked with the work size)
+    words = port->size / sizeof (a3data_t);
+    if (view.rows && (port->key || !view.cols || !view.ntiles || (view.cols > words) || (view.offset > words) || ((view.rows > 1) && (view.cols > view.stride)))) {
+        a3_print_error("[artico3-hw] invalid view for port %s (rows=%zd,cols=%zd,stride=%zd,ntiles=%zd)\n", pname, view.rows, view.cols, view.stride, view.ntiles);
+        return -EINVAL;
+    }
+    if (!view.rows) memset(&view, 0, sizeof view);
+
+    // Views cannot change while the kernel is being executed (the bounds
+    // of its tiles have been checked for the current work size)
+    if (threads[index]) {
+        a3_print_error("[artico3-hw] kernel \"%s\" is being executed, cannot change view of port %s\n", kernels[index]->name, pname);
+        return -EBUSY;
+    }
+
+    // Set view, and invalidate transfer plans (slice layout has changed)
+    pthread_mutex_lock(&mutex);
+    port->view = view;
+    _artico3_plan_invalidate(kernels[index]);
+    pthread_mutex_unlock(&mutex);
+
+    a3_print_debug("[artico3-hw] port %s view (offset=%zd,stride=%zd,rows=%zd,cols=%zd,ntiles=%zd,tstep=%zd,gstep=%zd)\n", pname, view.offset, view.stride, view.rows, view.cols, view.ntiles, view.tstep, view.gstep);
+
+    return 0;
+}
+
+
+/*
+ * ARTICo3 release buffer memory
+ *
+ * This function frees dynamic memory allocated as a buffer between the
+ * application and the hardware kernel.
+ *
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel this buffer is associated with (0 to use @kname)
+ *     @kname  : hardware kernel name this buffer is associanted with
+ *     @pname  : port name this buffer is associated with
+ *
+ * Return : 0 on success, -EBUSY if the kernel is being executed, error
+ *          code otherwise
+ *
+ */
+int artico3_free(void *args) {
+    unsigned int index, p;
+    int ret;
+    struct a3port_t *port = NULL;
+    uint8_t isconst = 0;
+
+    // Get function arguments
+    int kernel;
+    const char *kname, *pname;
+    struct a3args_t *args_aux = args;
+
+    // @kernel
+    kernel = a3_args_get_kernel(args_aux, &kname);
+    // @pname
+    pname = a3_args_get_str(args_aux);
+
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
+    }
+
+    // Search for kernel in kernel list
+    pthread_mutex_lock(&kernels_mutex);
+    ret = _artico3_kernel_find(kernel, kname);
+    pthread_mutex_unlock(&kernels_mutex);
+    if (ret < 0) {
+        return ret;
+    }
+    index = ret;
+
+    // Ports cannot be released while the kernel is being executed (their
+    // buffers are being transferred by the delegate scheduler thread)
+    if (threads[index]) {
+        a3_print_error("[artico3-hw] kernel \"%s\" is being executed, cannot free port %s\n", kernels[index]->name, pname);
+        return -EBUSY;
+    }
+
     // Search for port in port lists
     for (p = 0; p < kernels[index]->membanks; p++) {
         if (kernels[index]->consts[p]) {
             if (strcmp(kernels[index]->consts[p]->name, pname) == 0) {
                 port = kernels[index]->consts[p];
                 kernels[index]->consts[p] = NULL;
+                isconst = 1;
                 break;
             }
         }
@@ -2157,9 +5348,16 @@ int artico3_free(void *args) {
         return -ENODEV;
     }
 
+    // Invalidate transfer plans (port set has changed), and update the
+    // constant memory version -> next transfer must load
+    pthread_mutex_lock(&mutex);
+    _artico3_plan_invalidate(kernels[index]);
+    if (isconst) kernels[index]->c_version = ++const_seq;
+    pthread_mutex_unlock(&mutex);
+
     // Free application memory
-    munmap(port->data, port->size);
-    shm_unlink(port->filename);
+    munmap(port->data, port->mapsize);
+    if (port->filename) shm_unlink(port->filename);
     free(port->filename);
     free(port->name);
     free(port);
@@ -2174,44 +5372,48 @@ int artico3_free(void *args) {
  * This function loads a hardware accelerator and/or sets its specific
  * configuration.
  *
- * @args      : buffer storing the function arguments sent by the user
- *     @name  : hardware kernel name
- *     @slot  : reconfigurable slot in which the accelerator is to be loaded
- *     @tmr   : TMR group ID (0x1-0xf)
- *     @dmr   : DMR group ID (0x1-0xf)
- *     @force : force reconfiguration even if the accelerator is already present
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : hardware kernel handle (0 to use @name)
+ *     @name   : hardware kernel name
+ *     @slot   : reconfigurable slot in which the accelerator is to be loaded
+ *     @tmr    : TMR group ID (0x1-0xf)
+ *     @dmr    : DMR group ID (0x1-0xf)
+ *     @force  : force reconfiguration even if the accelerator is already present
  *
  * Return : 0 on success, error code otherwise
  *
  */
 int artico3_load(void *args) {
     unsigned int index;
-    char filename[128];
+    char filename[A3_NAME_SIZE + 64];
     int ret;
+    struct a3kernel_t *kernel_ptr = NULL;
 
     uint8_t id;
     uint8_t reconf;
 
     // Get function arguments
-    char name[50];
+    int kernel;
+    const char *name;
     uint8_t slot, tmr, dmr, force;
-    unsigned copied_bytes;
-    char *args_aux = args;
+    struct a3args_t *args_aux = args;
 
-    // @name
-    strcpy(name, args_aux);
-    copied_bytes = strlen(name) + 1;
+    // @kernel
+    kernel = a3_args_get_kernel(args_aux, &name);
     // @slot
-    memcpy(&slot, &(args_aux[copied_bytes]), sizeof (uint8_t));
-    copied_bytes += sizeof (uint8_t);
+    a3_args_get(args_aux, &slot, sizeof (uint8_t));
     // @tmr
-    memcpy(&tmr, &(args_aux[copied_bytes]), sizeof (uint8_t));
-    copied_bytes += sizeof (uint8_t);
+    a3_args_get(args_aux, &tmr, sizeof (uint8_t));
     // @dmr
-    memcpy(&dmr, &(args_aux[copied_bytes]), sizeof (uint8_t));
-    copied_bytes += sizeof (uint8_t);
+    a3_args_get(args_aux, &dmr, sizeof (uint8_t));
     // @force
-    memcpy(&force, &(args_aux[copied_bytes]), sizeof (uint8_t));
+    a3_args_get(args_aux, &force, sizeof (uint8_t));
+
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
+    }
 
     // Check if slot is within range
     if (slot >= shuffler.nslots) {
@@ -2220,90 +5422,116 @@ int artico3_load(void *args) {
     }
 
     // Search for kernel in kernel list
-    for (index = 0; index < A3_MAXKERNS; index++) {
-        pthread_mutex_lock(&kernels_mutex);
-        if (!kernels[index]) {
-            pthread_mutex_unlock(&kernels_mutex);
-            continue;
-        }
-        if (strcmp(kernels[index]->name, name) == 0) {
-            pthread_mutex_unlock(&kernels_mutex);
-            break;
-        }
-        pthread_mutex_unlock(&kernels_mutex);
+    pthread_mutex_lock(&kernels_mutex);
+    ret = _artico3_kernel_find(kernel, name);
+    pthread_mutex_unlock(&kernels_mutex);
+    if (ret < 0) {
+        return ret;
     }
-    if (index == A3_MAXKERNS) {
-        a3_print_error("[artico3-hw] no kernel found with name \"%s\"\n", name);
-        return -ENODEV;
+    index = ret;
+
+    // Get kernel id and name (requests can reference kernels by handle)
+    kernel_ptr = kernels[index];
+    id = kernel_ptr->id;
+    name = kernel_ptr->name;
+
+    pthread_mutex_lock(&mutex);
+
+    // Only change configuration when the slot is not being reconfigured,
+    // and neither the accelerator in the slot nor the new one are being
+    // executed (other slots and kernels are not affected)
+    while ((shuffler.slots[slot].state == S_LOAD) ||
+           (shuffler.slots[slot].kernel && shuffler.slots[slot].kernel->running) ||
+           kernel_ptr->running) {
+        pthread_cond_wait(&quiescent, &mutex);
     }
 
-    // Get kernel id
-    id = kernels[index]->id;
+    // Check if partial reconfiguration is required
+    if (shuffler.slots[slot].state == S_EMPTY) {
+        reconf = 1;
+    }
+    else {
+        if (strcmp(shuffler.slots[slot].kernel->name, name) != 0) {
+            reconf = 1;
+        }
+        else {
+            reconf = 0;
+        }
+    }
 
-    while (1) {
-        pthread_mutex_lock(&mutex);
+    // Even if reconfiguration is not required, it can be forced
+    //~ reconf |= force;
+    reconf = reconf || force;
 
-        // Only change configuration when no kernel is being executed
-        if (!running) {
+    // Invalidate transfer plans (accelerator set has changed)
+    if (shuffler.slots[slot].kernel) _artico3_plan_invalidate(shuffler.slots[slot].kernel);
+    _artico3_plan_invalidate(kernel_ptr);
 
-            // Check if partial reconfiguration is required
-            if (shuffler.slots[slot].state == S_EMPTY) {
-                reconf = 1;
-            }
-            else {
-                if (strcmp(shuffler.slots[slot].kernel->name, name) != 0) {
-                    reconf = 1;
-                }
-                else {
-                    reconf = 0;
-                }
-            }
+    // Perform DPR
+    if (reconf) {
 
-            // Even if reconfiguration is not required, it can be forced
-            //~ reconf |= force;
-            reconf = reconf || force;
+        // Remove the slot from the current configuration
+        _artico3_dma_enter();
+        shuffler.id_reg ^= (shuffler.id_reg & ((uint64_t)0xf << (4 * slot)));
+        shuffler.tmr_reg ^= (shuffler.tmr_reg & ((uint64_t)0xf << (4 * slot)));
+        shuffler.dmr_reg ^= (shuffler.dmr_reg & ((uint64_t)0xf << (4 * slot)));
+        _artico3_dma_leave();
+        shuffler.slots[slot].kernel = NULL;
 
-            // Perform DPR
-            if (reconf) {
+        // Set slot flag (local memories are lost -> next transfer must load)
+        shuffler.slots[slot].state = S_LOAD;
+        shuffler.slots[slot].c_version = 0;
+        _artico3_publish_topology();
 
-                // Set slot flag
-                shuffler.slots[slot].state = S_LOAD;
+        // Load partial bitstream (the remaining slots can be used meanwhile)
+        pthread_mutex_unlock(&mutex);
+        snprintf(filename, sizeof filename, "pbs/a3_%s_a3_slot_%d_partial.bin", name, slot);
+        ret = fpga_load(filename, 1);
+        pthread_mutex_lock(&mutex);
+        if (ret) {
+            goto err_fpga;
+        }
 
-                // Load partial bitstream
-                sprintf(filename, "pbs/a3_%s_a3_slot_%d_partial.bin", name, slot);
-                ret = fpga_load(filename, 1);
-                if (ret) {
-                    goto err_fpga;
-                }
+        // Check that the kernel has not been released during DPR
+        pthread_mutex_lock(&kernels_mutex);
+        ret = (kernels[index] == kernel_ptr) ? 0 : -ENODEV;
+        pthread_mutex_unlock(&kernels_mutex);
+        if (ret) {
+            goto err_fpga;
+        }
 
-                // Set slot flag
-                shuffler.slots[slot].state = S_IDLE;
+        // Wait until the kernel finishes its current round (if any)
+        while (kernel_ptr->running) {
+            pthread_cond_wait(&quiescent, &mutex);
+        }
+        _artico3_plan_invalidate(kernel_ptr);
 
-            }
+        // Set slot flag
+        shuffler.slots[slot].state = S_IDLE;
 
-            // Update ARTICo3 slot info
-            shuffler.slots[slot].kernel = kernels[index];
+    }
 
-            // Update ARTICo3 configuration registers
-            shuffler.id_reg ^= (shuffler.id_reg & ((uint64_t)0xf << (4 * slot)));
-            shuffler.id_reg |= (uint64_t)id << (4 * slot);
+    // Update ARTICo3 slot info
+    shuffler.slots[slot].kernel = kernel_ptr;
 
-            shuffler.tmr_reg ^= (shuffler.tmr_reg & ((uint64_t)0xf << (4 * slot)));
-            shuffler.tmr_reg |= (uint64_t)tmr << (4 * slot);
+    // Update ARTICo3 configuration registers
+    _artico3_dma_enter();
+    shuffler.id_reg ^= (shuffler.id_reg & ((uint64_t)0xf << (4 * slot)));
+    shuffler.id_reg |= (uint64_t)id << (4 * slot);
 
-            shuffler.dmr_reg ^= (shuffler.dmr_reg & ((uint64_t)0xf << (4 * slot)));
-            shuffler.dmr_reg |= (uint64_t)dmr << (4 * slot);
+    shuffler.tmr_reg ^= (shuffler.tmr_reg & ((uint64_t)0xf << (4 * slot)));
+    shuffler.tmr_reg |= (uint64_t)tmr << (4 * slot);
 
-            // Set constant memory flag to 0 -> next transfer must load
-            kernels[index]->c_loaded = 0;
+    shuffler.dmr_reg ^= (shuffler.dmr_reg & ((uint64_t)0xf << (4 * slot)));
+    shuffler.dmr_reg |= (uint64_t)dmr << (4 * slot);
+    _artico3_dma_leave();
 
-            // Exit infinite loop
-            break;
+    // Update topology
+    _artico3_publish_topology();
 
-        }
+    // Wake up configuration changes waiting for this slot
+    pthread_cond_broadcast(&quiescent);
 
-        pthread_mutex_unlock(&mutex);
-    }
     pthread_mutex_unlock(&mutex);
 
     a3_print_debug("[artico3-hw] loaded accelerator \"%s\" on slot %d\n", name, slot);
@@ -2311,6 +5539,9 @@ int artico3_load(void *args) {
     return 0;
 
 err_fpga:
+    // The slot is left empty
+    shuffler.slots[slot].state = S_EMPTY;
+    pthread_cond_broadcast(&quiescent);
     pthread_mutex_unlock(&mutex);
 
     return ret;
@@ -2332,10 +5563,16 @@ int artico3_unload(void *args) {
 
     // Get function arguments
     uint8_t slot;
-    char *args_aux = args;
+    struct a3args_t *args_aux = args;
 
     // @slot
-    memcpy(&slot, args_aux, sizeof (uint8_t));
+    a3_args_get(args_aux, &slot, sizeof (uint8_t));
+
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
+    }
 
     // Check if slot is within range
     if (slot >= shuffler.nslots) {
@@ -2343,28 +5580,33 @@ int artico3_unload(void *args) {
         return -ENODEV;
     }
 
-    while (1) {
-        pthread_mutex_lock(&mutex);
+    pthread_mutex_lock(&mutex);
 
-        // Only change configuration when no kernel is being executed
-        if (!running) {
+    // Only change configuration when the slot is not being reconfigured,
+    // and the accelerator in the slot is not being executed
+    while ((shuffler.slots[slot].state == S_LOAD) ||
+           (shuffler.slots[slot].kernel && shuffler.slots[slot].kernel->running)) {
+        pthread_cond_wait(&quiescent, &mutex);
+    }
 
-            // Update ARTICo3 slot info
-            shuffler.slots[slot].state = S_EMPTY;
-            shuffler.slots[slot].kernel = NULL;
+    // Invalidate transfer plans (accelerator set has changed)
+    if (shuffler.slots[slot].kernel) _artico3_plan_invalidate(shuffler.slots[slot].kernel);
 
-            // Update ARTICo3 configuration registers
-            shuffler.id_reg ^= (shuffler.id_reg & ((uint64_t)0xf << (4 * slot)));
-            shuffler.tmr_reg ^= (shuffler.tmr_reg & ((uint64_t)0xf << (4 * slot)));
-            shuffler.dmr_reg ^= (shuffler.dmr_reg & ((uint64_t)0xf << (4 * slot)));
+    // Update ARTICo3 slot info
+    shuffler.slots[slot].state = S_EMPTY;
+    shuffler.slots[slot].kernel = NULL;
+    shuffler.slots[slot].c_version = 0;
 
-            // Exit infinite loop
-            break;
+    // Update ARTICo3 configuration registers
+    _artico3_dma_enter();
+    shuffler.id_reg ^= (shuffler.id_reg & ((uint64_t)0xf << (4 * slot)));
+    shuffler.tmr_reg ^= (shuffler.tmr_reg & ((uint64_t)0xf << (4 * slot)));
+    shuffler.dmr_reg ^= (shuffler.dmr_reg & ((uint64_t)0xf << (4 * slot)));
+    _artico3_dma_leave();
 
-        }
+    // Update topology
+    _artico3_publish_topology();
 
-        pthread_mutex_unlock(&mutex);
-    }
     pthread_mutex_unlock(&mutex);
 
     a3_print_debug("[artico3-hw] removed accelerator from slot %d\n", slot);
@@ -2379,40 +5621,135 @@ int artico3_unload(void *args) {
  * This function gets the current number of available hardware accelerators
  * for a given kernel ID tag.
  *
- * @args      : buffer storing the function arguments sent by the user
- *     @name  : name of the hardware kernel to get the naccs from
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel to get the naccs from (0 to use @name)
+ *     @name   : name of the hardware kernel to get the naccs from
  *
  * Return : number of accelerators on success, error code otherwise
  *
  */
 int artico3_get_naccs(void *args) {
     unsigned int index;
+    int ret;
 
     // Get function arguments
-    char name[50];
-    char *args_aux = args;
+    int kernel;
+    const char *name;
+    struct a3args_t *args_aux = args;
 
-    // @name
-    strcpy(name, args_aux);
+    // @kernel
+    kernel = a3_args_get_kernel(args_aux, &name);
+
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
+    }
 
     // Search for kernel in kernel list
-    for (index = 0; index < A3_MAXKERNS; index++) {
-        pthread_mutex_lock(&kernels_mutex);
-        if (!kernels[index]) {
-            pthread_mutex_unlock(&kernels_mutex);
+    pthread_mutex_lock(&kernels_mutex);
+    ret = _artico3_kernel_find(kernel, name);
+    pthread_mutex_unlock(&kernels_mutex);
+    if (ret < 0) {
+        return ret;
+    }
+    index = ret;
+
+    // Return the number of accelerators
+    return artico3_hw_get_naccs(kernels[index]->id);
+}
+
+
+/*
+ * ARTICo3 execute batch request
+ *
+ * This function executes, in order, the runtime calls packed by the user
+ * in a single batch request. Execution stops at the first failing call,
+ * and the remaining ones are marked as canceled.
+ *
+ * @args          : buffer storing the function arguments sent by the user
+ *     @nrecords  : number of runtime calls in the batch
+ *     @records   : runtime calls (struct a3record_t followed by its arguments)
+ *
+ * Return : 0 if the batch could be parsed (the result of each call is
+ *          stored in its record), error code otherwise
+ *
+ */
+int artico3_batch(void *args) {
+    unsigned int index;
+    int ret, response;
+    struct a3record_t *record = NULL;
+    struct a3args_t record_args;
+    void *record_data = NULL;
+    enum a3func_t func;
+    uint32_t size;
+
+    // Get function arguments
+    uint32_t nrecords;
+    struct a3args_t *args_aux = args;
+
+    // @nrecords
+    a3_args_get(args_aux, &nrecords, sizeof (uint32_t));
+
+    // Check that arguments lie inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid request arguments\n");
+        return -EINVAL;
+    }
+
+    // Execute runtime calls in order
+    ret = 0;
+    for (index = 0; index < nrecords; index++) {
+
+        // @records (the record header is read only once, since the user
+        // can modify it while it is being processed)
+        record = a3_args_reserve(args_aux, sizeof *record);
+        if (!record) break;
+        func = __atomic_load_n(&record->func, __ATOMIC_RELAXED);
+        size = __atomic_load_n(&record->size, __ATOMIC_RELAXED);
+        record_data = a3_args_reserve(args_aux, size);
+        if (!record_data) break;
+        a3_args_reserve(args_aux, a3_args_align(sizeof *record + size) - (sizeof *record + size));
+        a3_args_init(&record_args, record_data, size);
+        record_args.user = args_aux->user;
+
+        // Cancel remaining calls after the first failure
+        if (ret < 0) {
+            record->response = -ECANCELED;
             continue;
         }
-        if (strcmp(kernels[index]->name, name) == 0) {
-            pthread_mutex_unlock(&kernels_mutex);
-            break;
+
+        // Only calls that do not manage users or return data can be batched
+        switch (func) {
+            case A3_F_LOAD:
+            case A3_F_UNLOAD:
+            case A3_F_KERNEL_CREATE:
+            case A3_F_KERNEL_RELEASE:
+            case A3_F_KERNEL_EXECUTE:
+            case A3_F_KERNEL_WAIT:
+            case A3_F_KERNEL_RESET:
+            case A3_F_ALLOC:
+            case A3_F_FREE:
+            case A3_F_KERNEL_VCOUNT:
+            case A3_F_PORT_VIEW:
+                response = artico3_functions[func](&record_args);
+                break;
+            default:
+                a3_print_error("[artico3-hw] function %d cannot be batched\n", func);
+                response = -EINVAL;
+                break;
         }
-        pthread_mutex_unlock(&kernels_mutex);
+        record->response = response;
+        a3_print_debug("[artico3-hw] batch call %u (request=%d, response=%d)\n", index, func, response);
+
+        if (response < 0) ret = response;
     }
-    if (index == A3_MAXKERNS) {
-        a3_print_error("[artico3-hw] no kernel found with name \"%s\"\n", name);
-        return -ENODEV;
+
+    // Check that every record lies inside the request payload
+    if (args_aux->error) {
+        a3_print_error("[artico3-hw] invalid batch request (nrecords=%u)\n", nrecords);
+        return -EINVAL;
     }
 
-    // Return the number of accelerators
-    return artico3_hw_get_naccs(kernels[index]->id);
+    return 0;
 }
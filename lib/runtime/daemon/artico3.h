@@ -19,8 +19,6 @@
 
 #include "artico3_data.h"
 
-#define A3_MAXUSERS (10)  // Max number of simultaneous ARTTCo3 users
-
 /*
  * SYSTEM INITIALIZATION
  *
@@ -59,12 +57,13 @@ void artico3_exit();
  * This function loads a hardware accelerator and/or sets its specific
  * configuration.
  *
- * @args      : buffer storing the function arguments sent by the user
- *     @name  : hardware kernel name
- *     @slot  : reconfigurable slot in which the accelerator is to be loaded
- *     @tmr   : TMR group ID (0x1-0xf)
- *     @dmr   : DMR group ID (0x1-0xf)
- *     @force : force reconfiguration even if the accelerator is already present
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : hardware kernel handle (0 to use @name)
+ *     @name   : hardware kernel name
+ *     @slot   : reconfigurable slot in which the accelerator is to be loaded
+ *     @tmr    : TMR group ID (0x1-0xf)
+ *     @dmr    : DMR group ID (0x1-0xf)
+ *     @force  : force reconfiguration even if the accelerator is already present
  *
  * Return : 0 on success, error code otherwise
  *
@@ -90,13 +89,15 @@ int artico3_unload(void *args);
  * ARTICo3 add new user
  *
  * This function creates the software entities required to manage a new user.
+ * The user table grows on demand, and user IDs (slots) of removed users
+ * are reused.
  *
  * @args             : buffer storing the function arguments sent by the user
  *     @shm_filename : user shared memory object filename
  *
  * TODO: create folders and subfolders on /dev/shm for each user and its data (kernels, inputs, etc.)
  *
- * Return : A3_MAXKERNS on success, error code otherwise
+ * Return : user ID on success, error code otherwise
  */
 int artico3_add_user(void *args);
 
@@ -106,9 +107,9 @@ int artico3_add_user(void *args);
  *
  * This function cleans the software entities created by artico3_add_user().
  *
- * @args           : buffer storing the function arguments sent by the user
- *     @user_id    : ID of the user to be removed
- *     @channel_id : ID of the channel used for handling daemon/user communication
+ * @args : request sent by the user to be removed (struct a3request_t)
+ *
+ * Return : 0 on success, error code otherwise
  *
  */
 int artico3_remove_user(void *args);
@@ -143,7 +144,7 @@ int artico3_handle_request();
  *     @membanks : number of local memory banks in the associated accelerator
  *     @regs     : number of read/write registers in the associated accelerator
  *
- * Return : 0 on success, error code otherwise
+ * Return : kernel handle (> 0) on success, error code otherwise
  *
  */
 int artico3_kernel_create(void *args);
@@ -154,8 +155,9 @@ int artico3_kernel_create(void *args);
  *
  * This function deletes an ARTICo3 kernel in the current application.
  *
- * @args     : buffer storing the function arguments sent by the user
- *     @name : name of the hardware kernel to be deleted
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel to be deleted (0 to use @name)
+ *     @name   : name of the hardware kernel to be deleted
  *
  * Return : 0 on success, error code otherwise
  *
@@ -168,10 +170,11 @@ int artico3_kernel_release(void *args);
  *
  * This function executes an ARTICo3 kernel in the current application.
  *
- * @args      : buffer storing the function arguments sent by the user
- *     @name  : name of the hardware kernel to execute
- *     @gsize : global work size (total amount of work to be done)
- *     @lsize : local work size (work that can be done by one accelerator)
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel to execute (0 to use @name)
+ *     @name   : name of the hardware kernel to execute
+ *     @gsize  : global work size (total amount of work to be done)
+ *     @lsize  : local work size (work that can be done by one accelerator)
  *
  * Return : 0 on success, error code otherwisw
  *
@@ -179,13 +182,75 @@ int artico3_kernel_release(void *args);
 int artico3_kernel_execute(void *args);
 
 
+/*
+ * ARTICo3 execute hardware kernel asynchronously
+ *
+ * This function executes an ARTICo3 kernel in the current application,
+ * and posts its completion in the given user handle.
+ *
+ * @args        : buffer storing the function arguments sent by the user
+ *     @kernel  : handle of the hardware kernel to execute (0 to use @name)
+ *     @name    : name of the hardware kernel to execute
+ *     @gsize   : global work size (total amount of work to be done)
+ *     @lsize   : local work size (work that can be done by one accelerator)
+ *     @handle  : asynchronous completion handle of the user
+ *
+ * Return : 0 on success, error code otherwisw
+ *
+ * NOTE : the user to be notified on completion is the one that sent the
+ *        request.
+ *
+ */
+int artico3_kernel_execute_async(void *args);
+
+
+/*
+ * ARTICo3 execute hardware kernel as a stream
+ *
+ * This function starts the streaming execution of an ARTICo3 kernel, in
+ * which its ports are used as ring buffers that hold the data of @depth
+ * work items. Work items are processed as they are produced, until the
+ * stream is closed (see struct a3stream_t).
+ *
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel to execute (0 to use @name)
+ *     @name   : name of the hardware kernel to execute
+ *     @depth  : number of work items held by the ring-buffered ports
+ *     @lsize  : local work size (work that can be done by one accelerator)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_kernel_stream(void *args);
+
+
+/*
+ * ARTICo3 set port view
+ *
+ * This function sets the access descriptor of a port, which describes how
+ * the data of each work-group is extracted from (or stored into) the port
+ * buffer (see struct a3view_t).
+ *
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel the port is associated with (0 to use @kname)
+ *     @kname  : hardware kernel name the port is associated with
+ *     @pname  : port name
+ *     @view   : port view (rows set to 0 to remove the view)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_port_view(void *args);
+
+
 /*
  * ARTICo3 wait for kernel completion
  *
  * This function waits until the kernel has finished.
  *
- * @args     : buffer storing the function arguments sent by the user
- *     @name : hardware kernel to wait for
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel to wait for (0 to use @name)
+ *     @name   : hardware kernel to wait for
  *
  * Return : 0 on success, error code otherwise
  *
@@ -198,8 +263,9 @@ int artico3_kernel_wait(void *args);
  *
  * This function resets all hardware accelerators of a given kernel.
  *
- * @args     : buffer storing the function arguments sent by the user
- *     @name : hardware kernel to reset
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel to reset (0 to use @name)
+ *     @name   : hardware kernel to reset
  *
  * Return : 0 on success, error code otherwise
  *
@@ -212,13 +278,15 @@ int artico3_kernel_reset(void *args);
  *
  * This function writes configuration data to ARTICo3 kernel registers.
  *
- * @args       : buffer storing the function arguments sent by the user
- *     @name   : hardware kernel to be addressed
- *     @offset : memory offset of the register to be accessed
- *     @cfg    : array of configuration words to be written, one per
- *               equivalent accelerator
+ * @args           : buffer storing the function arguments sent by the user
+ *     @kernel     : handle of the hardware kernel to be addressed (0 to use @name)
+ *     @name       : hardware kernel to be addressed
+ *     @offset     : memory offset of the register to be accessed
+ *     @generation : topology generation used to size @cfg
+ *     @cfg        : array of configuration words to be written, one per
+ *                   equivalent accelerator
  *
- * Return : 0 on success, error code otherwise
+ * Return : 0 on success, -EAGAIN if the topology changed, error code otherwise
  *
  * NOTE : configuration registers need to be handled taking into account
  *        execution priorities.
@@ -239,13 +307,15 @@ int artico3_kernel_wcfg(void *args);
  *
  * This function reads configuration data from ARTICo3 kernel registers.
  *
- * @args       : buffer storing the function arguments sent by the user
- *     @name   : hardware kernel to be addressed
- *     @offset : memory offset of the register to be accessed
- *     @cfg    : array of configuration words to be read, one per
- *               equivalent accelerator
+ * @args           : buffer storing the function arguments sent by the user
+ *     @kernel     : handle of the hardware kernel to be addressed (0 to use @name)
+ *     @name       : hardware kernel to be addressed
+ *     @offset     : memory offset of the register to be accessed
+ *     @generation : topology generation used to size @cfg
+ *     @cfg        : array of configuration words to be read, one per
+ *                   equivalent accelerator
  *
- * Return : 0 on success, error code otherwise
+ * Return : 0 on success, -EAGAIN if the topology changed, error code otherwise
  *
  * NOTE : configuration registers need to be handled taking into account
  *        execution priorities.
@@ -261,6 +331,23 @@ int artico3_kernel_wcfg(void *args);
 int artico3_kernel_rcfg(void *args);
 
 
+/*
+ * ARTICo3 declare valid count register
+ *
+ * This function declares the register of a kernel that gets, before each
+ * round, the number of valid work items of each accelerator.
+ *
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel to be addressed (0 to use @name)
+ *     @name   : hardware kernel to be addressed
+ *     @reg    : register index (-1 to remove the declaration)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_kernel_vcount(void *args);
+
+
 /*
  * MEMORY MANAGEMENT
  *
@@ -310,11 +397,12 @@ int artico3_kernel_rcfg(void *args);
  * This function allocates dynamic memory to be used as a buffer between
  * the application and the local memories in the hardware kernels.
  *
- * @args      : buffer storing the function arguments sent by the user
- *     @size  : amount of memory (in bytes) to be allocated for the buffer
- *     @kname : hardware kernel name to associate this buffer with
- *     @pname : port name to associate this buffer with
- *     @dir   : data direction of the port
+ * @args       : buffer storing the function arguments sent by the user
+ *     @size   : amount of memory (in bytes) to be allocated for the buffer
+ *     @kernel : handle of the hardware kernel to associate this buffer with (0 to use @kname)
+ *     @kname  : hardware kernel name to associate this buffer with
+ *     @pname  : port name to associate this buffer with
+ *     @dir    : data direction of the port
  *
  * Return : pointer to allocated memory on success, NULL otherwise
  *
@@ -329,15 +417,41 @@ int artico3_kernel_rcfg(void *args);
 int artico3_alloc(void *args);
 
 
+/*
+ * ARTICo3 allocate zero-copy buffer memory
+ *
+ * This function allocates DMA-capable memory, shared between the Daemon
+ * and the application, to be used as a buffer between the application
+ * and @nbanks consecutive local memories in the hardware kernels. The
+ * buffer stores, for each work-group, the contents of the @nbanks banks
+ * one after the other (i.e. the hardware layout of a DMA transfer), so
+ * that rounds can be transferred straight from/to it.
+ *
+ * @args       : buffer storing the function arguments sent by the user
+ *     @size   : amount of memory (in bytes) to be allocated for the buffer
+ *     @kernel : handle of the hardware kernel to associate this buffer with (0 to use @kname)
+ *     @kname  : hardware kernel name to associate this buffer with
+ *     @pname  : port name to associate this buffer with
+ *     @dir    : data direction of the port (A3_P_I, A3_P_O, A3_P_IO)
+ *     @nbanks : number of local memory banks used by the port
+ *
+ * Return : shared DMA region key (to be used as mmap() page offset on
+ *          the ARTICo3 device) on success, error code otherwise
+ *
+ */
+int artico3_alloc_zc(void *args);
+
+
 /*
  * ARTICo3 release buffer memory
  *
  * This function frees dynamic memory allocated as a buffer between the
  * application and the hardware kernel.
  *
- * @args      : buffer storing the function arguments sent by the user
- *     @kname : hardware kernel name this buffer is associanted with
- *     @pname : port name this buffer is associated with
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel this buffer is associated with (0 to use @kname)
+ *     @kname  : hardware kernel name this buffer is associanted with
+ *     @pname  : port name this buffer is associated with
  *
  * Return : 0 on success, error code otherwise
  *
@@ -351,8 +465,9 @@ int artico3_free(void *args);
  * This function gets the current number of available hardware accelerators
  * for a given kernel ID tag.
  *
- * @args      : buffer storing the function arguments sent by the user
- *     @name  : name of the hardware kernel to get the naccs from
+ * @args       : buffer storing the function arguments sent by the user
+ *     @kernel : handle of the hardware kernel to get the naccs from (0 to use @name)
+ *     @name   : name of the hardware kernel to get the naccs from
  *
  * Return : number of accelerators on success, error code otherwise
  *
@@ -360,6 +475,24 @@ int artico3_free(void *args);
 int artico3_get_naccs(void *args);
 
 
+/*
+ * ARTICo3 execute batch request
+ *
+ * This function executes, in order, the runtime calls packed by the user
+ * in a single batch request. Execution stops at the first failing call,
+ * and the remaining ones are marked as canceled.
+ *
+ * @args          : buffer storing the function arguments sent by the user
+ *     @nrecords  : number of runtime calls in the batch
+ *     @records   : runtime calls (struct a3record_t followed by its arguments)
+ *
+ * Return : 0 if the batch could be parsed (the result of each call is
+ *          stored in its record), error code otherwise
+ *
+ */
+int artico3_batch(void *args);
+
+
 /*
  * ARTICo3 data reinterpretation: float to a3data_t (32 bits)
  *
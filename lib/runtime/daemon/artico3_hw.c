@@ -179,13 +179,31 @@ void artico3_hw_print_regs() {
  *
  */
 void artico3_hw_setup_transfer(uint32_t blksize) {
-    artico3_hw[A3_ID_REG_LOW]     = shuffler.id_reg & 0xFFFFFFFF;          // ID register low
-    artico3_hw[A3_ID_REG_HIGH]    = (shuffler.id_reg >> 32) & 0xFFFFFFFF;  // ID register high
-    artico3_hw[A3_TMR_REG_LOW]    = shuffler.tmr_reg & 0xFFFFFFFF;         // TMR register low
-    artico3_hw[A3_TMR_REG_HIGH]   = (shuffler.tmr_reg >> 32) & 0xFFFFFFFF; // TMR register high
-    artico3_hw[A3_DMR_REG_LOW]    = shuffler.dmr_reg & 0xFFFFFFFF;         // DMR register low
-    artico3_hw[A3_DMR_REG_HIGH]   = (shuffler.dmr_reg >> 32) & 0xFFFFFFFF; // DMR register high
-    artico3_hw[A3_BLOCK_SIZE_REG] = blksize;                               // Block size (# 32-bit words)
+    artico3_hw_setup_shuffler(shuffler.id_reg, shuffler.tmr_reg, shuffler.dmr_reg, blksize);
+}
+
+
+/*
+ * ARTICo3 low-level hardware function
+ *
+ * Sets up a data transfer by writing to the ARTICo3 configuration
+ * registers (ID, TMR, DMR, block size) a given configuration, instead of
+ * the one in the shadow registers (which are not modified).
+ *
+ * @id_reg  : ID register
+ * @tmr_reg : TMR register
+ * @dmr_reg : DMR register
+ * @blksize : block size (32-bit words to be sent to each accelerator)
+ *
+ */
+void artico3_hw_setup_shuffler(uint64_t id_reg, uint64_t tmr_reg, uint64_t dmr_reg, uint32_t blksize) {
+    artico3_hw[A3_ID_REG_LOW]     = id_reg & 0xFFFFFFFF;          // ID register low
+    artico3_hw[A3_ID_REG_HIGH]    = (id_reg >> 32) & 0xFFFFFFFF;  // ID register high
+    artico3_hw[A3_TMR_REG_LOW]    = tmr_reg & 0xFFFFFFFF;         // TMR register low
+    artico3_hw[A3_TMR_REG_HIGH]   = (tmr_reg >> 32) & 0xFFFFFFFF; // TMR register high
+    artico3_hw[A3_DMR_REG_LOW]    = dmr_reg & 0xFFFFFFFF;         // DMR register low
+    artico3_hw[A3_DMR_REG_HIGH]   = (dmr_reg >> 32) & 0xFFFFFFFF; // DMR register high
+    artico3_hw[A3_BLOCK_SIZE_REG] = blksize;                      // Block size (# 32-bit words)
 }
 
 
@@ -12,6 +12,9 @@
 #ifndef _ARTICO3_HW_H_
 #define _ARTICO3_HW_H_
 
+#include "artico3_data.h" // struct a3view_t
+
+
 extern uint32_t *artico3_hw;
 extern struct a3shuffler_t shuffler;
 
@@ -21,6 +24,10 @@ extern struct a3shuffler_t shuffler;
  *
  */
 #define A3_MAXKERNS (0xF) // TODO: maybe make it configurable? Would also require additional VHDL parsing in Shuffler...
+#define A3_DMA_HYSTERESIS (1000) // Default time (ms) idle DMA staging buffers are kept before being released
+#define A3_PIPELINE (1) // Default execution mode (1: overlap memory copies with computation, 0: sequential rounds)
+#define A3_DMA_MAXKEYS (0x10000) // Number of shared DMA region keys used for zero-copy ports
+#define A3_DMA_CACHED (0) // Default DMA staging buffer memory (1: cached, with explicit cache maintenance, 0: coherent)
 
 #ifdef ZYNQMP
 #define A3_SLOTADDR (0xb0000000)
@@ -51,9 +58,16 @@ extern struct a3shuffler_t shuffler;
  * ARTICo3 kernel port
  *
  * @name     : name of the kernel port
- * @size     : size of the virtual memory
- * @filename : filename of the shared memory
+ * @size     : size of the virtual memory (hardware data, i.e. after conversion for typed ports)
+ * @filename : filename of the shared memory (NULL for zero-copy ports)
  * @data     : virtual memory of input
+ * @nbanks   : number of local memory banks used by the port
+ * @key      : shared DMA region key (0 for POSIX shared memory ports)
+ * @mapsize  : size of the mapping (shared DMA region including padding, or
+ *             shared memory object, padded to the huge page size if required)
+ * @cached   : shared DMA region in cached memory (requires cache maintenance around transfers)
+ * @dtype    : data type of the application buffer (A3_T_*, converted when copying)
+ * @view     : access descriptor of the buffer (no view if @view.rows is 0)
  *
  */
 struct a3port_t {
@@ -61,35 +75,152 @@ struct a3port_t {
     size_t size;
     char *filename;
     void *data;
+    unsigned int nbanks;
+    unsigned long key;
+    size_t mapsize;
+    uint8_t cached;
+    unsigned int dtype;
+    struct a3view_t view;
+};
+
+
+/*
+ * ARTICo3 DMA staging buffer
+ *
+ * @mem    : user-space map of the DMA-allocated memory
+ * @size   : size of the DMA-allocated memory (size class), in bytes
+ * @cached : cached DMA memory (requires cache maintenance around transfers)
+ * @tidle  : time (ns) at which the buffer was released to the pool
+ * @next   : next buffer in the pool
+ *
+ */
+struct a3dmabuf_t {
+    void *mem;
+    size_t size;
+    uint8_t cached;
+    uint64_t tidle;
+    struct a3dmabuf_t *next;
+};
+
+
+/*
+ * ARTICo3 transfer plan slice (one accelerator and port)
+ *
+ * @port   : kernel port (userspace memory buffer)
+ * @index  : port index in the transfer
+ * @acc    : accelerator index in the transfer
+ * @memoff : offset of the slice in the DMA staging buffer, in bytes
+ * @datoff : offset of the slice in the port for the first round, in bytes
+ * @stride : offset increment per round, in bytes (0 for constant memories)
+ * @size   : size of the slice, in bytes
+ * @last   : size of the slice in the last round, in bytes (can be partial)
+ * @view   : port view when the plan was built (tiles are @stride bytes)
+ *
+ */
+struct a3slice_t {
+    struct a3port_t *port;
+    unsigned int index;
+    int acc;
+    size_t memoff;
+    size_t datoff;
+    size_t stride;
+    size_t size;
+    size_t last;
+    struct a3view_t view;
 };
 
 
+/*
+ * ARTICo3 transfer plan
+ *
+ * Transfer plans store the layout of the data transfers of a kernel for a
+ * given port set, number of accelerators and work size, so that it is not
+ * recomputed in every round. They are cached in the kernel (see A3_PLAN_*), and
+ * invalidated when its ports or accelerators change.
+ *
+ * @refs    : number of references (kernel cache and ongoing transfers)
+ * @loaded  : constant memories were already loaded (send plans only)
+ * @naccs   : number of (equivalent) accelerators
+ * @gsize   : global work size (total amount of work to be done)
+ * @lsize   : local work size (work that can be done by one accelerator)
+ * @nrounds : total number of rounds (global over local work ratio, rounded up)
+ * @nconsts : number of constant memory ports of the kernel (send plans only)
+ * @nports  : number of ports involved in each transfer
+ * @blksize : block size (32-bit words per accelerator), 0 if there is no data to transfer
+ * @hwoff   : hardware address offset of the transfers
+ * @zcport  : zero-copy port transferred straight from/to user memory (NULL if staged)
+ * @haszc   : zero-copy ports are involved in the transfers (scatter-gather DMA)
+ * @nslices : number of slices (accelerators times ports)
+ * @ncopies : maximum number of copies per transfer (one per slice, or per
+ *            tile row for ports with view)
+ * @slices  : slices, ordered by accelerator and then by port (hardware layout)
+ *
+ */
+struct a3plan_t {
+    unsigned int refs;
+    uint8_t loaded;
+    int naccs;
+    size_t gsize;
+    size_t lsize;
+    unsigned int nrounds;
+    unsigned int nconsts;
+    unsigned int nports;
+    uint32_t blksize;
+    size_t hwoff;
+    struct a3port_t *zcport;
+    uint8_t haszc;
+    unsigned int nslices;
+    unsigned int ncopies;
+    struct a3slice_t slices[];
+};
+
+#define A3_PLAN_SEND        (0) // Send plan (constant memories not loaded)
+#define A3_PLAN_SEND_LOADED (1) // Send plan (constant memories loaded)
+#define A3_PLAN_RECV        (2) // Receive plan
+#define A3_PLANS            (3) // Number of cached transfer plans per kernel
+
+
 /*
  * ARTICo3 kernel (hardware accelerator)
  *
- * @name     : kernel name
- * @id       : kernel ID (0x1 - 0xF)
- * @membytes : local memory inside kernel, in bytes
- * @membanks : number of local memory banks inside kernel
- * @regs     : number of read/write registers inside kernel
- * @c_loaded : flag to check whether constant memories have been loaded
- * @consts   : constant input port configuration for this kernel
- * @inputs   : input port configuration for this kernel
- * @outputs  : output port configuration for this kernel
- * @inouts   : inout port configuration for this kernel
+ * @name      : kernel name
+ * @id        : kernel ID (0x1 - 0xF)
+ * @handle    : kernel handle (kernel ID + creation sequence number)
+ * @membytes  : local memory inside kernel, in bytes
+ * @membanks  : number of local memory banks inside kernel
+ * @regs      : number of read/write registers inside kernel
+ * @vcount    : register that gets the number of valid work items of each
+ *             accelerator (-1 if not declared, see artico3_kernel_vcount())
+ * @running   : the kernel is in the middle of a round (write/run/read)
+ * @result    : result of the last synchronous execution (0 on success,
+ *             error code if it was aborted)
+ * @c_version : version of the constant memory ports (it changes whenever
+ *             they are allocated or released, 0 if never allocated)
+ * @consts    : constant input port configuration for this kernel
+ * @inputs    : input port configuration for this kernel
+ * @outputs   : output port configuration for this kernel
+ * @inouts    : inout port configuration for this kernel
+ * @dmabufs   : pool of idle DMA staging buffers for this kernel
+ * @plans     : cached transfer plans for this kernel (see A3_PLAN_*)
  *
  */
 struct a3kernel_t {
     char *name;
     uint8_t id;
+    int handle;
     size_t membytes;
     size_t membanks;
     size_t regs;
-    uint8_t c_loaded;
+    int vcount;
+    uint8_t running;
+    int result;
+    unsigned long c_version;
     struct a3port_t **consts;
     struct a3port_t **inputs;
     struct a3port_t **outputs;
     struct a3port_t **inouts;
+    struct a3dmabuf_t *dmabufs;
+    struct a3plan_t *plans[A3_PLANS];
 };
 
 
@@ -111,13 +242,16 @@ enum a3state_t {S_EMPTY, S_IDLE, S_LOAD, S_WRITE, S_RUN, S_READY, S_READ};
 /*
  * ARTICo3 slot
  *
- * @kernel : pointer to the kernel entity currently loaded in this slot
- * @state  : current state of this slot (see a3_state_t)
+ * @kernel    : pointer to the kernel entity currently loaded in this slot
+ * @state     : current state of this slot (see a3_state_t)
+ * @c_version : version of the constant memories held by the accelerator
+ *              in this slot (0 if none, see a3kernel_t)
  *
  */
 struct a3slot_t {
     struct a3kernel_t *kernel;
     enum a3state_t state;
+    unsigned long c_version;
 };
 
 
@@ -205,6 +339,22 @@ void artico3_hw_print_regs();
 void artico3_hw_setup_transfer(uint32_t blksize);
 
 
+/*
+ * ARTICo3 low-level hardware function
+ *
+ * Sets up a data transfer by writing to the ARTICo3 configuration
+ * registers (ID, TMR, DMR, block size) a given configuration, instead of
+ * the one in the shadow registers (which are not modified).
+ *
+ * @id_reg  : ID register
+ * @tmr_reg : TMR register
+ * @dmr_reg : DMR register
+ * @blksize : block size (32-bit words to be sent to each accelerator)
+ *
+ */
+void artico3_hw_setup_shuffler(uint64_t id_reg, uint64_t tmr_reg, uint64_t dmr_reg, uint32_t blksize);
+
+
 /*
  * ARTICo3 low-level hardware function
  *
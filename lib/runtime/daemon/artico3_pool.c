@@ -62,6 +62,7 @@ static void* _artico3_pool_worker(void *p) {
     pthread_mutex_t *pool_lock;
     pthread_cond_t *pool_cond;
     pthread_cond_t *pool_ack;
+    pthread_cond_t *pool_done;
     struct a3task_t **pool_task;
     long int *pool_t_id;
     int *pool_wake_up, *pool_running, *pool_shutdown, *pool_executed_task_per_thread;
@@ -73,6 +74,7 @@ static void* _artico3_pool_worker(void *p) {
         pool_task = pool->task;
         pool_wake_up = pool->wake_up;
         pool_ack = pool->ack;
+        pool_done = pool->done;
     }
     else {
         pool_lock = &pool->lock[t_info->id];
@@ -81,6 +83,7 @@ static void* _artico3_pool_worker(void *p) {
         pool_wake_up = &pool->wake_up[t_info->id];
         *pool_wake_up = 0;
         pool_ack = &pool->ack[t_info->id];
+        pool_done = &pool->done[t_info->id];
     }
     pool_executed_task_per_thread = &pool->executed_task_per_thread[t_info->id];
     pool_t_id = &pool->t_ids[t_info->id];
@@ -102,6 +105,7 @@ static void* _artico3_pool_worker(void *p) {
         while(*pool_wake_up == 0) {
             // Indicate the thread is not running
             *pool_running = 0;
+            pthread_cond_broadcast(pool_done);
 
             // Finishing each thread when the thread pool is cleaned
             if(*pool_shutdown) {
@@ -241,6 +245,41 @@ int artico3_pool_isdone(const struct a3pool_t *pool, const int thread_id) {
 }
 
 
+/*
+ * ARTICo3 wait for thread commanded function
+ *
+ * This function blocks until the workers on the thread pool have finished
+ * their assigned task (same semantics as artico3_pool_isdone(), without
+ * busy-waiting).
+ *
+ * @pool      : pointer to the thread pool
+ * @thread_id : ID of the thread to wait for. Wait for every thread when ID == 0
+ *
+ */
+void artico3_pool_wait(struct a3pool_t *pool, const int thread_id) {
+
+    pthread_mutex_t *pool_lock;
+    pthread_cond_t *pool_done;
+
+    // Get local variables based on the pool type (multiple sync resources vs one sycn resource)
+    if (pool->sync_resources == 1) {
+        pool_lock = pool->lock;
+        pool_done = pool->done;
+    }
+    else {
+        pool_lock = &pool->lock[thread_id-1];
+        pool_done = &pool->done[thread_id-1];
+    }
+
+    // Workers update their running flag with the lock held
+    pthread_mutex_lock(pool_lock);
+    while(!artico3_pool_isdone(pool, thread_id))
+        pthread_cond_wait(pool_done, pool_lock);
+    pthread_mutex_unlock(pool_lock);
+
+}
+
+
 /*
  * ARTICo3 initialized the thread pool
  *
@@ -337,6 +376,14 @@ struct a3pool_t* artico3_pool_init(const int num_threads, const int type) {
     }
     a3_print_debug("[artico3-hw] pool->ack=%p\n", pool->ack);
 
+    // Allocate the array of conds
+    pool->done = malloc(pool->sync_resources * sizeof *pool->done);
+    if (pool->done == NULL) {
+        a3_print_error("[artico3-hw] pool malloc() failed\n");
+		goto done_malloc_err;
+    }
+    a3_print_debug("[artico3-hw] pool->done=%p\n", pool->done);
+
     // Allocate the array of tasks
     pool->task = malloc(pool->sync_resources * sizeof *pool->task);
     if (pool->task == NULL) {
@@ -359,6 +406,10 @@ struct a3pool_t* artico3_pool_init(const int num_threads, const int type) {
             a3_print_error("[artico3-hw] pool pthread_cond_init() failed\n");
             goto err_thread_create;
         }
+        if(pthread_cond_init(&(pool->done[i]),NULL)) {
+            a3_print_error("[artico3-hw] pool pthread_cond_init() failed\n");
+            goto err_thread_create;
+        }
         pool->wake_up[i] = 0;
     }
     a3_print_debug("[artico3-hw] pool mutexes and conditional variables initialized\n");
@@ -384,6 +435,9 @@ struct a3pool_t* artico3_pool_init(const int num_threads, const int type) {
     free(pool->task);
 
     task_malloc_err:
+    free(pool->done);
+
+    done_malloc_err:
     free(pool->ack);
 
     ack_malloc_err:
@@ -464,10 +518,15 @@ void artico3_pool_clean(struct a3pool_t *pool) {
             a3_print_error("[artico3-hw] pthread_cond_destroy() failed\n");
             exit(1);
         }
+        if(pthread_cond_destroy(&(pool->done[i])) < 0){
+            a3_print_error("[artico3-hw] pthread_cond_destroy() failed\n");
+            exit(1);
+        }
     }
 	free(pool->lock);
 	free(pool->cond);
 	free(pool->ack);
+	free(pool->done);
 
     // Clean the thread pool structure
     free(pool);
@@ -49,6 +49,7 @@ struct a3task_t{
  * @lock;                    : mutex used to synchronize the threads
  * @cond                     : CV used by the user to signal the workers that a task is waiting
  * @ack                      : CV used by a worker to indicate the user it is handling the task
+ * @done                     : CV used by a worker to indicate the user it has become idle
  * @wake_up                  : flag associated with the field "cond" used to command a worker to wake up
  * @shutdown                 : flag associated with the field "cond" used to command a worker to shutdown
  * @task                     : pointer to a task that needs to be executed
@@ -64,6 +65,7 @@ struct a3pool_t {
 	pthread_mutex_t *lock;
 	pthread_cond_t *cond;
     pthread_cond_t *ack;
+    pthread_cond_t *done;
     int *wake_up;
     int shutdown;
 	struct a3task_t **task;
@@ -112,6 +114,20 @@ int artico3_pool_submit_task(struct a3pool_t *pool, const int thread_id, a3pool_
 int artico3_pool_isdone(const struct a3pool_t *pool, const int thread_id);
 
 
+/*
+ * ARTICo3 wait for thread commanded function
+ *
+ * This function blocks until the workers on the thread pool have finished
+ * their assigned task (same semantics as artico3_pool_isdone(), without
+ * busy-waiting).
+ *
+ * @pool      : pointer to the thread pool
+ * @thread_id : ID of the thread to wait for. Wait for every thread when ID == 0
+ *
+ */
+void artico3_pool_wait(struct a3pool_t *pool, const int thread_id);
+
+
 /*
  * ARTICo3 initialized the thread pool
  *
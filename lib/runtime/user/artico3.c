@@ -30,10 +30,17 @@
 #include <sys/time.h>    // struct timeval, gettimeofday()
 #include <sys/stat.h>    // stat(), S_IRUSR, S_IWUSR
 #include <sys/syscall.h> // syscall()
+#include <sys/eventfd.h> // eventfd()
 
 #include "artico3.h"
 #include "artico3_dbg.h"
 #include "artico3_data.h"
+#include "artico3_ring.h"
+#include "artico3_sync.h"
+#include "artico3_args.h"
+#include "artico3_table.h"
+#include "artico3_stats.h"
+#include "artico3_shm.h"
 
 #include <inttypes.h>
 
@@ -60,12 +67,14 @@ const char * __shm_directory(size_t * len) {
  *
  * @name     : name of the kernel buffer
  * @size     : size of the virtual memory
+ * @mapsize  : size of the mapping (padded to the huge page size if required)
  * @data     : virtual memory of input
  *
  */
 struct a3buf_t {
     char *name;
     size_t size;
+    size_t mapsize;
     void *data;
 };
 
@@ -74,46 +83,514 @@ struct a3buf_t {
  * ARTICo3 kernel (hardware accelerator)
  *
  * @name     : kernel name
+ * @handle   : kernel handle (0 until known, for kernels created in a batch)
  * @membanks : number of local memory banks inside kernel
  * @ports   : port configuration for this kernel
  *
  */
 struct a3kernel_t {
     char *name;
+    int handle;
     size_t membanks;
     struct a3buf_t **bufs;
 };
 
 
+/*
+ * ARTICo3 channel (each channel handles a single request)
+ *
+ * @response_available : processed user request signaling flag
+ * @response           : processed user request response
+ * @busy               : channel in use flag
+ * @args_offset        : offset of the request input arguments in the user arena
+ * @args_size          : size (in bytes) of the request input arguments
+ *
+ * NOTE : channels are private to the user process (the Daemon only gets
+ *        the channel ID and the location of the request input arguments).
+ *
+ */
+struct a3channel_t {
+    int response_available;
+    int response;
+    int busy;
+    uint32_t args_offset;
+    uint32_t args_size;
+};
+
+
+/*
+ * ARTICo3 batch (runtime calls recorded before sending them to the Daemon)
+ *
+ * @active     : batch recording flag
+ * @nrecords   : number of recorded runtime calls
+ * @maxrecords : number of allocated record offsets
+ * @offsets    : offset of each recorded runtime call in @records
+ * @size       : size (in bytes) of the recorded runtime calls
+ * @maxsize    : size (in bytes) of the allocated record buffer
+ * @records    : recorded runtime calls (same layout as in batch requests)
+ *
+ */
+struct a3batch_t {
+    int active;
+    unsigned int nrecords;
+    unsigned int maxrecords;
+    uint32_t *offsets;
+    uint32_t size;
+    uint32_t maxsize;
+    char *records;
+};
+
+
+/*
+ * ARTICo3 pending request (posted without waiting for its response)
+ *
+ * @tag        : request tag (returned by artico3_queue_tag())
+ * @channel_id : ID of the channel used for handling the request
+ * @func       : function requested by the user
+ *
+ */
+struct a3pending_t {
+    int tag;
+    int channel_id;
+    enum a3func_t func;
+};
+
+
+/*
+ * ARTICo3 request queue (runtime calls posted before reaping their responses)
+ *
+ * @active     : queueing flag
+ * @tag        : tag of the last posted runtime call
+ * @npending   : number of posted runtime calls not reaped yet
+ * @maxpending : number of allocated pending requests
+ * @pending    : posted runtime calls not reaped yet
+ *
+ */
+struct a3queue_t {
+    int active;
+    int tag;
+    unsigned int npending;
+    unsigned int maxpending;
+    struct a3pending_t *pending;
+};
+
+
+/*
+ * ARTICo3 asynchronous execution handle (user-side data)
+ *
+ * @used     : handle in use flag
+ * @fd       : eventfd signaled on completion (-1 if not requested)
+ * @signaled : flag indicating that @fd has already been signaled
+ *
+ */
+struct a3handle_t {
+    int used;
+    int fd;
+    int signaled;
+};
+
+
+/*
+ * ARTICo3 stream (user-side data)
+ *
+ * @used     : stream in use flag
+ * @closed   : stream closed flag
+ * @kernel   : handle of the hardware kernel (0 if referenced by name)
+ * @name     : name of the hardware kernel
+ * @filename : stream control shared memory object filename
+ * @ctrl     : stream control block (shared with the Daemon)
+ * @depth    : number of work items held by the ring-buffered ports
+ * @produced : work items pushed by the producer
+ * @consumed : work items released by the consumer
+ *
+ * NOTE : @produced and @consumed are not wrapped, so that they can be
+ *        used to compute ring positions (the counters in @ctrl wrap
+ *        around, and are only used to compute differences).
+ *
+ */
+struct a3userstream_t {
+    int used;
+    int closed;
+    int kernel;
+    char *name;
+    char *filename;
+    struct a3stream_t *ctrl;
+    size_t depth;
+    uint64_t produced;
+    uint64_t consumed;
+};
+
+
 /*
  * ARTICo3 global variables
  *
  * @kernels             : current kernel list
  *
  * @coordinator         : current ARTICo3 Daemon coordinator
+ * @topology            : current ARTICo3 topology (published by the Daemon)
  * @user                : current user
+ * @channels            : user channels (struct a3channel_t entries, grows on demand)
+ * @inflight            : number of requests submitted and not reaped yet (<= A3_RING_SIZE)
  *
- * @args_mutex          : synchronization primitive for handling request input argumetns
+ * @args_mutex          : synchronization primitive for handling request input argumetns and @channels
+ * @submit_mutex        : synchronization primitive for producing requests in the submission queue
+ * @reap_mutex          : synchronization primitive for consuming responses from the completion queue
  * @kernel_create_mutex : synchronization primitive for creating a new kernel
  * @kernels_mutex       : synchronization primitive for accessing @kernels
+ * @batch_mutex         : synchronization primitive for accessing the user batch area
+ * @handles_mutex       : synchronization primitive for accessing @handles
+ * @streams_mutex       : synchronization primitive for accessing @streams
+ *
+ * @batch               : runtime calls recorded by the current thread (thread-local)
+ * @queue               : runtime calls posted by the current thread (thread-local)
+ *
+ * @handles             : asynchronous execution handles
+ * @notifier            : thread that signals handle eventfds on completion
+ * @notifier_running    : flag indicating that @notifier has been started
+ *
+ * @streams             : streaming executions
  *
  * @user_shm            : user shared memory object filename
  *
  * @max_kernels         : maximum number of kernels
+ * @spin_budget         : polling iterations before sleeping when waiting for responses
  *
  */
 // TODO : remove this array of structures to avoid replicating code between user and daemon
 static struct a3kernel_t **kernels;
 
 static struct a3coordinator_t *coordinator = NULL;
+static const struct a3topology_t *topology = NULL;
 static struct a3user_t *user = NULL;
+static struct a3table_t channels;
+static uint32_t inflight = 0;
 
 static pthread_mutex_t args_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t submit_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t reap_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t kernel_create_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t kernels_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t batch_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_mutex_t handles_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t streams_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread struct a3batch_t batch = {0, 0, 0, NULL, 0, 0, NULL};
+static __thread struct a3queue_t queue = {0, 0, 0, 0, NULL};
+
+static struct a3handle_t handles[A3_MAXHANDLES];
+static pthread_t notifier;
+static int notifier_running = 0;
+
+static struct a3userstream_t streams[A3_MAXSTREAMS];
 
 static char user_shm[13];
 unsigned int max_kernels = 0;
+static unsigned int spin_budget = A3_SPIN_BUDGET;
+
+
+/*
+ * ARTICo3 reap completions
+ *
+ * This function consumes every available entry in the completion queue,
+ * storing each response in the channel that sent the request, and
+ * releasing the in-flight request credits.
+ *
+ * NOTE : this function has to be called with reap_mutex locked (it is
+ *        the single consumer of the completion queue).
+ *
+ */
+static void _artico3_reap_completions() {
+    struct a3completion_t *completion = NULL;
+    struct a3channel_t *channel = NULL;
+    int reaped = 0;
+
+    while (!a3_ring_empty(&user->cq.ring)) {
+        completion = &user->cq.entries[a3_ring_head(&user->cq.ring)];
+        channel = a3_table_entry(&channels, completion->channel_id);
+        channel->response = completion->response;
+        __atomic_store_n(&channel->response_available, 1, __ATOMIC_RELEASE);
+        a3_ring_pop(&user->cq.ring);
+        reaped++;
+    }
+    if (reaped) {
+        __atomic_fetch_sub(&inflight, reaped, __ATOMIC_RELEASE);
+    }
+
+    // Responses may belong to sleeping threads, wake them up
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (reaped && __atomic_load_n(&user->cq.waiters, __ATOMIC_RELAXED)) {
+        a3_futex_wake(&user->cq.ring.tail);
+    }
+}
+
+
+/*
+ * ARTICo3 wait for completions
+ *
+ * This function waits until a condition that depends on the responses
+ * sent by the Daemon holds. The caller polls the condition (reaping
+ * completions when possible) during spin_budget iterations, and then
+ * sleeps on the completion queue using FUTEX_WAIT, so that short requests
+ * do not pay for kernel wakeups.
+ *
+ * @ready : condition to wait for (returns non-zero when it holds)
+ * @arg   : argument passed to @ready
+ *
+ */
+static void _artico3_wait(int (*ready)(void *), void *arg) {
+    unsigned int spins;
+    uint32_t tail;
+
+    // Spin phase
+    for (spins = 0; spins < spin_budget; spins++) {
+        if (ready(arg)) return;
+        if (!a3_ring_empty(&user->cq.ring) && (pthread_mutex_trylock(&reap_mutex) == 0)) {
+            _artico3_reap_completions();
+            pthread_mutex_unlock(&reap_mutex);
+            continue;
+        }
+        a3_cpu_relax();
+    }
+
+    // Sleep phase
+    while (1) {
+        pthread_mutex_lock(&reap_mutex);
+        _artico3_reap_completions();
+        pthread_mutex_unlock(&reap_mutex);
+        if (ready(arg)) break;
+
+        // Register as waiter before checking again (the daemon, or other
+        // reaping threads, check the waiters after publishing responses)
+        __atomic_fetch_add(&user->cq.waiters, 1, __ATOMIC_SEQ_CST);
+        tail = __atomic_load_n(&user->cq.ring.tail, __ATOMIC_SEQ_CST);
+        if (!ready(arg) && (tail == __atomic_load_n(&user->cq.ring.head, __ATOMIC_RELAXED))) {
+            a3_print_debug("[artico3u-hw] wait for server command response\n");
+            a3_futex_wait(&user->cq.ring.tail, tail);
+        }
+        __atomic_fetch_sub(&user->cq.waiters, 1, __ATOMIC_RELAXED);
+    }
+}
+
+
+/*
+ * ARTICo3 response ready check
+ *
+ * @arg : channel used to send the request
+ *
+ * Return : 1 if the response for the channel is available, 0 otherwise
+ *
+ */
+static int _artico3_response_ready(void *arg) {
+    struct a3channel_t *channel = arg;
+
+    return __atomic_load_n(&channel->response_available, __ATOMIC_ACQUIRE);
+}
+
+
+/*
+ * ARTICo3 in-flight request credit check
+ *
+ * @arg : unused
+ *
+ * Return : 1 if the number of in-flight requests is below A3_RING_SIZE, 0 otherwise
+ *
+ */
+static int _artico3_credit_ready(void *arg) {
+    (void)arg;
+
+    return __atomic_load_n(&inflight, __ATOMIC_ACQUIRE) < A3_RING_SIZE;
+}
+
+
+/*
+ * ARTICo3 release channel
+ *
+ * @index : channel index (returned by _artico3_channel_get())
+ *
+ */
+static void _artico3_channel_put(int index) {
+    struct a3channel_t *channel = NULL;
+
+    pthread_mutex_lock(&args_mutex);
+    channel = a3_table_entry(&channels, index);
+    channel->busy = 0;
+    a3_table_put(&channels, index);
+    pthread_mutex_unlock(&args_mutex);
+}
+
+
+/*
+ * ARTICo3 deferrable request check
+ *
+ * Only calls that do not manage users or return data through their
+ * arguments can be deferred (recorded in a batch, or posted without
+ * waiting for their responses).
+ *
+ * @func : function requested by the user
+ *
+ * Return : 1 if the request can be deferred, 0 otherwise
+ *
+ */
+static int _artico3_deferrable(enum a3func_t func) {
+    switch (func) {
+        case A3_F_LOAD:
+        case A3_F_UNLOAD:
+        case A3_F_KERNEL_CREATE:
+        case A3_F_KERNEL_RELEASE:
+        case A3_F_KERNEL_EXECUTE:
+        case A3_F_KERNEL_WAIT:
+        case A3_F_KERNEL_RESET:
+        case A3_F_ALLOC:
+        case A3_F_FREE:
+        case A3_F_KERNEL_VCOUNT:
+        case A3_F_PORT_VIEW:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+
+/*
+ * ARTICo3 record request
+ *
+ * This function appends a request to the batch of the calling thread
+ * instead of sending it to the Daemon, and releases its channel.
+ *
+ * @request : request to be recorded
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+static int _artico3_batch_record(struct a3request_t request) {
+    char *records = NULL;
+    uint32_t *offsets = NULL;
+    uint32_t size, maxsize;
+    struct a3record_t record;
+    struct a3channel_t *channel = a3_table_entry(&channels, request.channel_id);
+
+    // Only calls that do not manage users or return data can be batched
+    if (!_artico3_deferrable(request.func)) {
+        a3_print_error("[artico3u-hw] request=%d cannot be batched\n", request.func);
+        _artico3_channel_put(request.channel_id);
+        return -EINVAL;
+    }
+
+    // Check that the call fits in a batch request
+    size = a3_args_align(sizeof record + channel->args_size);
+    if ((sizeof (uint32_t) + size) > A3_BATCH_MAXSIZE) {
+        a3_print_error("[artico3u-hw] request=%d too large to be batched\n", request.func);
+        _artico3_channel_put(request.channel_id);
+        return -E2BIG;
+    }
+
+    // Grow record offset list if required
+    if (batch.nrecords == batch.maxrecords) {
+        offsets = realloc(batch.offsets, (batch.maxrecords ? (2 * batch.maxrecords) : 32) * sizeof *offsets);
+        if (!offsets) {
+            a3_print_error("[artico3u-hw] realloc() failed\n");
+            _artico3_channel_put(request.channel_id);
+            return -ENOMEM;
+        }
+        batch.offsets = offsets;
+        batch.maxrecords = batch.maxrecords ? (2 * batch.maxrecords) : 32;
+    }
+
+    // Grow record buffer if required
+    if ((batch.size + size) > batch.maxsize) {
+        maxsize = batch.maxsize ? batch.maxsize : A3_BATCH_MAXSIZE;
+        while (maxsize < (batch.size + size)) maxsize *= 2;
+        records = realloc(batch.records, maxsize);
+        if (!records) {
+            a3_print_error("[artico3u-hw] realloc() failed\n");
+            _artico3_channel_put(request.channel_id);
+            return -ENOMEM;
+        }
+        batch.records = records;
+        batch.maxsize = maxsize;
+    }
+
+    // Copy request (calls not executed by the Daemon are reported as canceled)
+    record.func = request.func;
+    record.response = -ECANCELED;
+    record.size = channel->args_size;
+    memcpy(&(batch.records[batch.size]), &record, sizeof record);
+    memcpy(&(batch.records[batch.size + sizeof record]), &(user->arena[channel->args_offset]), channel->args_size);
+    batch.offsets[batch.nrecords] = batch.size;
+    batch.size += size;
+    batch.nrecords++;
+    _artico3_channel_put(request.channel_id);
+    a3_print_debug("[artico3u-hw] request recorded (request=%d, nrecords=%u, size=%u)\n", request.func, batch.nrecords, batch.size);
+
+    return 0;
+}
+
+
+/*
+ * ARTICo3 get channel
+ *
+ * This function reserves a free channel (the channel list grows on demand),
+ * and room for its request input arguments in the user argument arena
+ * (first fit, avoiding the ranges used by the other busy channels).
+ *
+ * @size : size (in bytes) of the request input arguments
+ * @args : argument cursor to pack the request input arguments
+ *
+ * Return : channel index on success, error code otherwise
+ *
+ */
+static int _artico3_channel_get(uint32_t size, struct a3args_t *args) {
+    unsigned int i;
+    int index;
+    uint32_t offset;
+    struct a3channel_t *channel = NULL;
+
+    // Check request size
+    if (size > A3_ARENA_SIZE) {
+        a3_print_error("[artico3u-hw] request arguments do not fit in arena (%u bytes)\n", size);
+        return -E2BIG;
+    }
+
+    pthread_mutex_lock(&args_mutex);
+
+    // Search for room in the arena (restart after every overlap)
+    offset = 0;
+    i = 0;
+    while (i < channels.nslots) {
+        channel = a3_table_entry(&channels, i++);
+        if (!channel->busy) continue;
+        if ((channel->args_offset < (offset + size)) && (offset < (channel->args_offset + channel->args_size))) {
+            offset = a3_args_align(channel->args_offset + channel->args_size);
+            i = 0;
+        }
+    }
+    if ((offset + size) > A3_ARENA_SIZE) {
+        pthread_mutex_unlock(&args_mutex);
+        a3_print_error("[artico3u-hw] no room in argument arena (%u bytes)\n", size);
+        return -EBUSY;
+    }
+
+    // Reserve channel
+    index = a3_table_get(&channels);
+    if (index < 0) {
+        pthread_mutex_unlock(&args_mutex);
+        a3_print_error("[artico3u-hw] no available channel\n");
+        return index;
+    }
+    channel = a3_table_entry(&channels, index);
+    channel->busy = 1;
+    channel->response = 0;
+    channel->response_available = 0;
+    channel->args_offset = offset;
+    channel->args_size = size;
+
+    pthread_mutex_unlock(&args_mutex);
+
+    a3_args_init(args, &(user->arena[offset]), size);
+
+    return index;
+}
 
 
 /*
@@ -121,51 +598,132 @@ unsigned int max_kernels = 0;
  *
  * This function makes command requests to the ARTICo3 Daemon.
  *
+ * Requests are posted in the user submission queue, and the Daemon is
+ * only signaled when it is sleeping. New users (A3_F_ADD_USER) are not
+ * known by the Daemon yet, and therefore use the coordinator instead.
+ *
+ * When the calling thread is recording a batch, the request is stored
+ * and 0 is returned right away (see artico3_batch_begin()). When the
+ * calling thread is queueing requests, deferrable requests are posted
+ * and 0 is returned without waiting for the response, which is reaped
+ * later (see artico3_queue_begin()).
+ *
+ * Pass-by-reference arguments are copied back from the channel before
+ * releasing it, so that other threads cannot overwrite them.
+ *
  * NOTE : only the runtime can call this function, using it from user
  *       applications is forbidden (and not possible due to the static
  *       specifier).
  *
  * @request : request to be sent to the Daemon
+ * @out     : buffer to store pass-by-reference arguments (NULL if none)
+ * @offset  : offset (in bytes) of the pass-by-reference arguments in the request
+ * @size    : size (in bytes) of the pass-by-reference arguments
  *
  * Return : 0 on success, error code otherwise
  *
  */
-static int _artico3_send_request(struct a3request_t request) {
-    int ack;
+static int _artico3_send_request_out(struct a3request_t request, void *out, size_t offset, size_t size) {
+    int ack, queued;
+    unsigned int maxpending;
+    struct a3pending_t *pending = NULL;
     struct a3channel_t *channel = NULL;
 
-    pthread_mutex_lock(&coordinator->mutex);
+    // Defer request if batching
+    if (batch.active) {
+        return _artico3_batch_record(request);
+    }
+
+    // Grow pending request list if queueing (before posting the request)
+    queued = queue.active && _artico3_deferrable(request.func);
+    if (queued && (queue.npending == queue.maxpending)) {
+        maxpending = queue.maxpending ? (2 * queue.maxpending) : 32;
+        pending = realloc(queue.pending, maxpending * sizeof *pending);
+        if (!pending) {
+            a3_print_error("[artico3u-hw] realloc() failed\n");
+            _artico3_channel_put(request.channel_id);
+            return -ENOMEM;
+        }
+        queue.pending = pending;
+        queue.maxpending = maxpending;
+    }
+
+    // Get the channel to be used for communication
+    channel = a3_table_entry(&channels, request.channel_id);
+    request.args_offset = channel->args_offset;
+    request.args_size = channel->args_size;
+
+    if (request.func == A3_F_ADD_USER) {
+        __atomic_fetch_add(&inflight, 1, __ATOMIC_RELAXED);
+
+        pthread_mutex_lock(&coordinator->mutex);
+
+        // Wait for server available
+        while (coordinator->request_available) {
+            a3_print_debug("[artico3u-hw] wait until server is free\n");
+            pthread_cond_wait(&coordinator->cond_free, &coordinator->mutex);
+        }
+
+        // Signal the request
+        request.tsubmit = a3_stats_now();
+        coordinator->request = request;
+        coordinator->request_available = 1;
+        pthread_cond_signal(&coordinator->cond_request);
 
-    // Wait for server available
-    while (coordinator->request_available) {
-        a3_print_debug("[artico3u-hw] wait until server is free\n");
-        pthread_cond_wait(&coordinator->cond_free, &coordinator->mutex);
+        pthread_mutex_unlock(&coordinator->mutex);
     }
+    else {
+        pthread_mutex_lock(&submit_mutex);
 
-    // Signal the request
-    coordinator->request = request;
-    coordinator->request_available = 1;
-    pthread_cond_signal(&coordinator->cond_request);
+        // Get an in-flight request credit (neither the submission nor the
+        // completion queue can overflow, regardless of the number of channels)
+        while (!_artico3_credit_ready(NULL)) {
+            pthread_mutex_unlock(&submit_mutex);
+            _artico3_wait(_artico3_credit_ready, NULL);
+            pthread_mutex_lock(&submit_mutex);
+        }
+        __atomic_fetch_add(&inflight, 1, __ATOMIC_RELAXED);
+
+        // Post the request
+        request.tsubmit = a3_stats_now();
+        user->sq.entries[a3_ring_tail(&user->sq.ring)] = request;
+        a3_ring_push(&user->sq.ring);
+
+        pthread_mutex_unlock(&submit_mutex);
+
+        // Wake up the server only if it is sleeping (the fence ensures
+        // either we see the flag or the server sees the request)
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&coordinator->sleeping, __ATOMIC_RELAXED)) {
+            pthread_mutex_lock(&coordinator->mutex);
+            pthread_cond_signal(&coordinator->cond_request);
+            pthread_mutex_unlock(&coordinator->mutex);
+        }
+    }
     a3_print_debug("[artico3u-hw] request signaled to the server (request=%d, user=%d, channel=%d)\n", request.func, request.user_id, request.channel_id);
 
-    pthread_mutex_unlock(&coordinator->mutex);
-
-    // Get the channel to be used for communication
-    channel = &user->channels[request.channel_id];
+    // Do not wait for the response if queueing (the channel is released when reaped)
+    if (queued) {
+        queue.tag = (queue.tag == INT32_MAX) ? 1 : (queue.tag + 1);
+        pending = &queue.pending[queue.npending++];
+        pending->tag = queue.tag;
+        pending->channel_id = request.channel_id;
+        pending->func = request.func;
+        return 0;
+    }
 
     // Wait for response
-    pthread_mutex_lock(&channel->mutex);
-    while (!channel->response_available) {
-        a3_print_debug("[artico3u-hw] wait for server command response\n");
-        pthread_cond_wait(&channel->cond_response, &channel->mutex);
-    }
+    _artico3_wait(_artico3_response_ready, channel);
 
     // Get the return of the requested command
     ack = channel->response;
     channel->response_available = 0;
-    channel->free = 1;
 
-    pthread_mutex_unlock(&channel->mutex);
+    // Copy back pass-by-reference arguments
+    if (out && (ack >= 0)) {
+        memcpy(out, &(user->arena[channel->args_offset + offset]), size);
+    }
+    _artico3_channel_put(request.channel_id);
 
     a3_print_debug("[artico3u-hw] request processed (request=%d, user=%d, channel=%d, ack=%d)\n", request.func, user->user_id, request.channel_id, ack);
 
@@ -173,6 +731,107 @@ static int _artico3_send_request(struct a3request_t request) {
 }
 
 
+/*
+ * ARTICo3 send request (no pass-by-reference arguments)
+ *
+ * @request : request to be sent to the Daemon
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+static int _artico3_send_request(struct a3request_t request) {
+    return _artico3_send_request_out(request, NULL, 0, 0);
+}
+
+
+/*
+ * ARTICo3 topology lookup
+ *
+ * This function gets the number of equivalent accelerators of a kernel
+ * from the topology published by the Daemon, without sending requests.
+ *
+ * @kernel     : hardware kernel handle
+ * @generation : topology generation the returned value belongs to
+ *
+ * Return : number of equivalent accelerators on success, error code otherwise
+ *
+ */
+static int _artico3_topology_naccs(int kernel, uint32_t *generation) {
+    const struct a3topokernel_t *entry = NULL;
+    uint8_t id;
+    uint32_t seq;
+    int naccs;
+
+    // Get topology entry (the kernel ID is encoded in the handle)
+    id = A3_KERNEL_HANDLE_ID(kernel);
+    if ((kernel <= 0) || (id == 0)) {
+        return -ENODEV;
+    }
+    entry = &topology->kernels[id - 1];
+
+    do {
+        seq = a3_seqlock_read_begin(&topology->seq);
+        *generation = topology->generation;
+        naccs = (entry->handle == kernel) ? entry->naccs : -ENODEV;
+    } while (a3_seqlock_read_retry(&topology->seq, seq));
+
+    return naccs;
+}
+
+
+/*
+ * ARTICo3 kernel handle lookup (name-based compatibility layer)
+ *
+ * This function gets the handle to be sent in requests issued through
+ * the name-based API. Kernels are referenced by name (handle 0) when
+ * recording a batch, since they might be created in the same batch.
+ *
+ * @name : hardware kernel name
+ *
+ * Return : kernel handle if found, 0 otherwise (the Daemon searches by name)
+ *
+ */
+static int _artico3_kernel_lookup(const char *name) {
+    int kernel;
+
+    if (batch.active) return 0;
+    kernel = artico3_kernel_get(name);
+
+    return (kernel > 0) ? kernel : 0;
+}
+
+
+/*
+ * ARTICo3 find kernel in kernel list
+ *
+ * This function gets the position of a kernel in the (user-side) kernel
+ * list, using its handle or, if not known, its name.
+ *
+ * NOTE : this function has to be called with kernels_mutex locked.
+ *
+ * @kernel : hardware kernel handle (0 to search by name)
+ * @name   : hardware kernel name (only used when @kernel is 0)
+ *
+ * Return : kernel list index on success, error code otherwise
+ *
+ */
+static int _artico3_kernel_find(int kernel, const char *name) {
+    unsigned int index;
+
+    for (index = 0; index < max_kernels; index++) {
+        if (!kernels[index]) continue;
+        if (kernel ? (kernels[index]->handle == kernel) : (strcmp(kernels[index]->name, name) == 0)) break;
+    }
+    if (index == max_kernels) {
+        if (kernel) a3_print_error("[artico3u-hw] no kernel found with handle %d\n", kernel);
+        else a3_print_error("[artico3u-hw] no kernel found with name \"%s\"\n", name);
+        return -ENODEV;
+    }
+
+    return index;
+}
+
+
 /*
  * ARTICo3 user init function
  *
@@ -197,8 +856,8 @@ int artico3_init() {
     struct stat stat_buffer;
     pid_t tid;
     char a3u_shm_check_path[50];
+    struct a3args_t args;
     struct a3request_t request;
-    struct a3channel_t *channel = NULL;
     enum a3func_t type = A3_F_ADD_USER;
 
     // Create a shared memory object for daemon data
@@ -223,6 +882,27 @@ int artico3_init() {
     // Close shared memory object file descriptor (not needed anymore)
     close(shm_fd);
 
+    // Open the shared memory object for topology (read-only)
+    shm_fd = shm_open(A3_TOPOLOGY_FILENAME, O_RDONLY, S_IRUSR | S_IWUSR);
+    if(shm_fd < 0) {
+        a3_print_error("[artico3u-hw] shm_open() failed\n");
+        ret = -ENODEV;
+        goto err_munmap_daemon;
+    }
+
+    // Allocate memory for application mapped to the shared memory object with mmap()
+    topology = mmap(0, sizeof (struct a3topology_t), PROT_READ, MAP_SHARED, shm_fd, 0);
+    if(topology == MAP_FAILED) {
+        a3_print_error("[artico3u-hw] mmap() failed\n");
+        close(shm_fd);
+        ret = -ENODEV;
+        goto err_munmap_daemon;
+    }
+    a3_print_debug("[artico3u-hw] mmap=%p\n", topology);
+
+    // Close shared memory object file descriptor (not needed anymore)
+    close(shm_fd);
+
     // Create the shared memory object filename (based on thread ID)
     tid = gettid();
     snprintf(user_shm, sizeof user_shm, "user_%07d", tid);
@@ -232,7 +912,7 @@ int artico3_init() {
     if (stat(a3u_shm_check_path, &stat_buffer) == 0) {
         a3_print_error("[artico3u-hw] \"%s\" already exist\n", a3u_shm_check_path);
         ret = -EINVAL;
-        goto err_munmap_daemon;
+        goto err_munmap_topology;
     }
 
     // Create a shared memory object for arguments passing
@@ -240,7 +920,7 @@ int artico3_init() {
     if(shm_fd < 0) {
         a3_print_error("[artico3u-hw] shm_open() failed\n");
         ret = -ENODEV;
-        goto err_munmap_daemon;
+        goto err_munmap_topology;
     }
 
     // Resize the shared memory object
@@ -253,42 +933,51 @@ int artico3_init() {
         close(shm_fd);
         shm_unlink(user_shm);
         ret = -ENODEV;
-        goto err_munmap_daemon;
+        goto err_munmap_topology;
     }
     a3_print_debug("[artico3u-hw] mmap=%p\n", user);
 
     // Close shared memory object file descriptor (not needed anymore)
     close(shm_fd);
 
-    // Initialize mutex and condition variables with shared memory attributes
-    for (index = 0; index < A3_MAXCHANNELS_PER_CLIENT; index++) {
-        channel = &user->channels[index];
-        a3_print_debug("[artico3u-hw] init channel=%p\n", channel);
-
-        pthread_mutexattr_t mutex_attr;
-        pthread_condattr_t cond_attr;
-
-        pthread_mutexattr_init(&mutex_attr);
-        pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
-        pthread_mutex_init(&channel->mutex, &mutex_attr);
-        pthread_mutexattr_destroy(&mutex_attr);
-
-        pthread_condattr_init(&cond_attr);
-        pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
-        pthread_cond_init(&channel->cond_response, &cond_attr);
-        pthread_condattr_destroy(&cond_attr);
-
-        // Initialize flags
-        channel->free = 1;
-        channel->response = 0;
-        channel->response_available = 0;
-    }
-    a3_print_debug("[artico3u-hw] initialized mutex and conditional variables\n");
+    // Get spin-then-sleep configuration
+    spin_budget = a3_spin_budget();
+    a3_print_debug("[artico3u-hw] spin_budget=%u\n", spin_budget);
+
+    // Initialize submission and completion queues
+    user->sq.ring.head = 0;
+    user->sq.ring.tail = 0;
+    user->cq.ring.head = 0;
+    user->cq.ring.tail = 0;
+    user->cq.waiters = 0;
+
+    // Initialize asynchronous execution handles
+    for (index = 0; index < A3_MAXHANDLES; index++) {
+        user->async[index].done = 0;
+        user->async[index].response = 0;
+        handles[index].used = 0;
+        handles[index].fd = -1;
+        handles[index].signaled = 0;
+    }
+    user->async_seq = 0;
+
+    // Set process ID (zero-copy ports are only shared with this process)
+    user->pid = getpid();
+
+    // Initialize channels (the channel list grows on demand)
+    a3_table_init(&channels, sizeof (struct a3channel_t));
+    inflight = 0;
+
+    // Get channel (no request input arguments)
+    ret = _artico3_channel_get(0, &args);
+    if (ret < 0) {
+        goto err_munmap_user;
+    }
 
     // Write request data
     request.func = type;
     request.user_id = -1;
-    request.channel_id = 0;
+    request.channel_id = ret;
     strcpy(request.shm, user_shm);
 
     // Make request
@@ -318,9 +1007,13 @@ int artico3_init() {
     return 0;
 
 err_munmap_user:
+    a3_table_clean(&channels);
     munmap(user, sizeof (struct a3user_t));
     shm_unlink(user_shm);
 
+err_munmap_topology:
+    munmap((void *)topology, sizeof (struct a3topology_t));
+
 err_munmap_daemon:
     munmap(coordinator, sizeof (struct a3coordinator_t));
 
@@ -337,37 +1030,23 @@ err_munmap_daemon:
 int artico3_exit() {
     int ret;
     unsigned int index;
-    unsigned num_bytes;
+    struct a3args_t args;
     struct a3request_t request;
-    char *args_ptr = NULL;
-    struct a3channel_t *channel = NULL;
     enum a3func_t type = A3_F_REMOVE_USER;
 
-    pthread_mutex_lock(&args_mutex);
-    // Search for channel in channel list
-    for (index = 0; index < A3_MAXCHANNELS_PER_CLIENT; index++) {
-        if (user->channels[index].free == 1) {
-            user->channels[index].free = 0;
-            break;
-        }
-    }
-    pthread_mutex_unlock(&args_mutex);
-    if (index == A3_MAXCHANNELS_PER_CLIENT) {
-        a3_print_error("[artico3-hw] no available channel\n");
-        return -EBUSY;
+    // Get channel (no request input arguments, the daemon removes the user
+    // that sends the request)
+    ret = _artico3_channel_get(0, &args);
+    if (ret < 0) {
+        return ret;
     }
+    index = ret;
 
     // Write request data
     request.func = type;
     request.user_id = user->user_id;
     request.channel_id = index;
 
-    // Copy request arguments
-    args_ptr = user->channels[index].args;
-    memcpy(args_ptr, &user->user_id, sizeof (int));
-    num_bytes = sizeof (int);
-    memcpy(&(args_ptr[num_bytes]), &index, sizeof (int));
-
     // Make request
     ret = _artico3_send_request(request);
     if (ret < 0){
@@ -375,23 +1054,39 @@ int artico3_exit() {
         return ret;
     }
 
-    // Destroy mutex and condition variables with shared memory attributes
-    for (index = 0; index < A3_MAXCHANNELS_PER_CLIENT; index++) {
-        channel = &user->channels[index];
+    // Release channels (and the pending request list of the calling thread)
+    a3_table_clean(&channels);
+    free(queue.pending);
+    queue.pending = NULL;
+    queue.npending = 0;
+    queue.maxpending = 0;
+    queue.active = 0;
 
-        pthread_mutex_destroy(&channel->mutex);
-        pthread_cond_destroy(&channel->cond_response);
+    // Stop asynchronous completion notifier
+    pthread_mutex_lock(&handles_mutex);
+    if (notifier_running) {
+        notifier_running = 0;
+        pthread_mutex_unlock(&handles_mutex);
+        __atomic_fetch_add(&user->async_seq, 1, __ATOMIC_RELEASE);
+        a3_futex_wake(&user->async_seq);
+        pthread_join(notifier, NULL);
+        pthread_mutex_lock(&handles_mutex);
+    }
 
-        // Initialize flags
-        channel->response = 0;
-        channel->response_available = 0;
+    // Release asynchronous execution handles
+    for (index = 0; index < A3_MAXHANDLES; index++) {
+        if (handles[index].fd >= 0) close(handles[index].fd);
+        handles[index].used = 0;
+        handles[index].fd = -1;
     }
+    pthread_mutex_unlock(&handles_mutex);
 
     // Cleanup user list
     munmap(user, sizeof (struct a3user_t));
     shm_unlink(user_shm);
 
     // Cleanup daemon structure
+    munmap((void *)topology, sizeof (struct a3topology_t));
     munmap(coordinator, sizeof (struct a3coordinator_t));
 
     // Cleanup kernel list
@@ -411,30 +1106,28 @@ int artico3_exit() {
  * @membanks : number of local memory banks in the associated accelerator
  * @regs     : number of read/write registers in the associated accelerator
  *
- * Return : 0 on success, error code otherwise
+ * Return : kernel handle (> 0) on success, error code otherwise
+ *
+ * NOTE : kernel names can have up to (A3_NAME_SIZE - 1) characters.
+ *
+ * NOTE : kernels created while recording a batch return 0, and their
+ *        handles are reported by artico3_batch_submit().
  *
  */
 int artico3_kernel_create(const char *name, size_t membytes, size_t membanks, size_t regs) {
     int ret;
-    unsigned num_bytes;
+    struct a3args_t args;
     unsigned int index, i;
     struct a3request_t request;
     struct a3kernel_t *kernel = NULL;
     enum a3func_t type = A3_F_KERNEL_CREATE;
 
-    pthread_mutex_lock(&args_mutex);
-    // Search for channel in channel list
-    for (index = 0; index < A3_MAXCHANNELS_PER_CLIENT; index++) {
-        if (user->channels[index].free == 1) {
-            user->channels[index].free = 0;
-            break;
-        }
-    }
-    pthread_mutex_unlock(&args_mutex);
-    if (index == A3_MAXCHANNELS_PER_CLIENT) {
-        a3_print_error("[artico3-hw] no available channel\n");
-        return -EBUSY;
+    // Get channel (and room in the argument arena)
+    ret = _artico3_channel_get(a3_args_strsize(name) + (3 * sizeof (size_t)), &args);
+    if (ret < 0) {
+        return ret;
     }
+    index = ret;
 
     // Write request data
     request.func = type;
@@ -442,19 +1135,14 @@ int artico3_kernel_create(const char *name, size_t membytes, size_t membanks, si
     request.channel_id = index;
 
     // Copy arguments
-    char *args_ptr = user->channels[index].args;
     // @name
-    memcpy(args_ptr, name, strlen(name));
-    num_bytes = strlen(name);
-    args_ptr[num_bytes++] = '\0';
+    a3_args_put_str(&args, name);
     // @membytes
-    memcpy(&(args_ptr[num_bytes]), &membytes, sizeof (size_t));
-    num_bytes += sizeof (size_t);
+    a3_args_put(&args, &membytes, sizeof (size_t));
     // @membanks
-    memcpy(&(args_ptr[num_bytes]), &membanks, sizeof (size_t));
-    num_bytes += sizeof (size_t);
+    a3_args_put(&args, &membanks, sizeof (size_t));
     // @regs
-    memcpy(&(args_ptr[num_bytes]), &regs, sizeof (size_t));
+    a3_args_put(&args, &regs, sizeof (size_t));
 
     // Make request
     ret = _artico3_send_request(request);
@@ -491,7 +1179,8 @@ int artico3_kernel_create(const char *name, size_t membytes, size_t membanks, si
     }
     strcpy(kernel->name, name);
 
-    // Set kernel configuration
+    // Set kernel configuration (handle is 0 if batching)
+    kernel->handle = ret;
     kernel->membanks = membanks;
 
     // Initialize kernel buffers
@@ -507,7 +1196,7 @@ int artico3_kernel_create(const char *name, size_t membytes, size_t membanks, si
         kernel->bufs[i] = NULL;
     }
 
-    a3_print_debug("[artico3u-hw] created kernel (name=%s,membytes=%zd,membanks=%zd,regs=%zd)\n", name, membytes, membanks, regs);
+    a3_print_debug("[artico3u-hw] created kernel (name=%s,handle=%d,membytes=%zd,membanks=%zd,regs=%zd)\n", name, kernel->handle, membytes, membanks, regs);
 
     // Store kernel configuration in kernel list
     kernels[index] = kernel;
@@ -530,120 +1219,73 @@ err_malloc_kernel:
 
 
 /*
- * ARTICo3 release hardware kernel
+ * ARTICo3 remove kernel from kernel list
  *
- * This function deletes an ARTICo3 kernel in the current application.
+ * This function releases the user-side data of an ARTICo3 kernel.
  *
- * @name : name of the hardware kernel to be deleted
+ * @kernel : handle of the hardware kernel to be removed (0 to use @name)
+ * @name   : name of the hardware kernel to be removed
  *
  * Return : 0 on success, error code otherwise
  *
  */
-int artico3_kernel_release(const char *name) {
-    unsigned num_bytes;
+static int _artico3_kernel_remove(int kernel, const char *name) {
     unsigned int index;
     int ret;
-    struct a3request_t request;
-    struct a3kernel_t *kernel = NULL;
-    enum a3func_t type = A3_F_KERNEL_RELEASE;
-
-    pthread_mutex_lock(&args_mutex);
-    // Search for channel in channel list
-    for (index = 0; index < A3_MAXCHANNELS_PER_CLIENT; index++) {
-        if (user->channels[index].free == 1) {
-            user->channels[index].free = 0;
-            break;
-        }
-    }
-    pthread_mutex_unlock(&args_mutex);
-    if (index == A3_MAXCHANNELS_PER_CLIENT) {
-        a3_print_error("[artico3-hw] no available channel\n");
-        return -EBUSY;
-    }
-
-    // Write request data
-    request.func = type;
-    request.user_id = user->user_id;
-    request.channel_id = index;
-
-    // Copy arguments
-    char *args_ptr = user->channels[index].args;
-    // @name
-    memcpy(args_ptr, name, strlen(name));
-    num_bytes = strlen(name);
-    args_ptr[num_bytes++] = '\0';
-
-    // Make request
-    ret = _artico3_send_request(request);
-    if (ret < 0){
-        a3_print_error("[artico3u-hw] send request failed\n");
-        return ret;
-    }
+    struct a3kernel_t *kernel_ptr = NULL;
 
     pthread_mutex_lock(&kernels_mutex);
 
     // Search for kernel in kernel list
-    for (index = 0; index < max_kernels; index++) {
-        if (!kernels[index]) continue;
-        if (strcmp(kernels[index]->name, name) == 0) break;
-    }
-    if (index == max_kernels) {
-        a3_print_error("[artico3u-hw] no kernel found with name \"%s\"\n", name);
+    ret = _artico3_kernel_find(kernel, name);
+    if (ret < 0) {
         pthread_mutex_unlock(&kernels_mutex);
-        return -ENODEV;
+        return ret;
     }
+    index = ret;
 
     // Get kernel pointer
-    kernel = kernels[index];
+    kernel_ptr = kernels[index];
 
     // Set kernel list entry as empty
     kernels[index] = NULL;
 
     pthread_mutex_unlock(&kernels_mutex);
 
+    a3_print_debug("[artico3u-hw] released kernel (name=%s,handle=%d)\n", kernel_ptr->name, kernel_ptr->handle);
+
     // Free allocated memory
-    free(kernel->bufs);
-    free(kernel->name);
-    free(kernel);
-    kernel = NULL;
-    a3_print_debug("[artico3u-hw] released kernel (name=%s)\n", name);
+    free(kernel_ptr->bufs);
+    free(kernel_ptr->name);
+    free(kernel_ptr);
+    kernel_ptr = NULL;
 
-    return ret;
+    return 0;
 }
 
 
 /*
- * ARTICo3 execute hardware kernel
+ * ARTICo3 release hardware kernel (kernel handle or name)
  *
- * This function executes an ARTICo3 kernel in the current application.
- *
- * @name  : name of the hardware kernel to execute
- * @gsize : global work size (total amount of work to be done)
- * @lsize : local work size (work that can be done by one accelerator)
+ * @kernel : handle of the hardware kernel to be deleted (0 to use @name)
+ * @name   : name of the hardware kernel to be deleted
  *
- * Return : 0 on success, error code otherwisw
+ * Return : 0 on success, error code otherwise
  *
  */
-int artico3_kernel_execute(const char *name, size_t gsize, size_t lsize) {
-    unsigned num_bytes;
+static int _artico3_kernel_release(int kernel, const char *name) {
+    struct a3args_t args;
     unsigned int index;
     int ret;
     struct a3request_t request;
-    enum a3func_t type = A3_F_KERNEL_EXECUTE;
+    enum a3func_t type = A3_F_KERNEL_RELEASE;
 
-    pthread_mutex_lock(&args_mutex);
-    // Search for channel in channel list
-    for (index = 0; index < A3_MAXCHANNELS_PER_CLIENT; index++) {
-        if (user->channels[index].free == 1) {
-            user->channels[index].free = 0;
-            break;
-        }
-    }
-    pthread_mutex_unlock(&args_mutex);
-    if (index == A3_MAXCHANNELS_PER_CLIENT) {
-        a3_print_error("[artico3-hw] no available channel\n");
-        return -EBUSY;
+    // Get channel (and room in the argument arena)
+    ret = _artico3_channel_get(a3_args_kernsize(kernel, name), &args);
+    if (ret < 0) {
+        return ret;
     }
+    index = ret;
 
     // Write request data
     request.func = type;
@@ -651,18 +1293,9 @@ int artico3_kernel_execute(const char *name, size_t gsize, size_t lsize) {
     request.channel_id = index;
 
     // Copy arguments
-    char *args_ptr = user->channels[index].args;
-    // @name
-    memcpy(args_ptr, name, strlen(name));
-    num_bytes = strlen(name);
-    args_ptr[num_bytes++] = '\0';
-    // @gsize
-    memcpy(&(args_ptr[num_bytes]), &gsize, sizeof (size_t));
-    num_bytes += sizeof (size_t);
-    // @lsize
-    memcpy(&(args_ptr[num_bytes]), &lsize, sizeof (size_t));
+    // @kernel
+    a3_args_put_kernel(&args, kernel, name);
 
-    // printf("[artico3u-hw] [id=%d] name: %s | gsize : %lu | lsize: %lu\n", user->user_id, name, gsize, lsize);
     // Make request
     ret = _artico3_send_request(request);
     if (ret < 0){
@@ -670,40 +1303,66 @@ int artico3_kernel_execute(const char *name, size_t gsize, size_t lsize) {
         return ret;
     }
 
-    return ret;
+    // Remove kernel from kernel list
+    return _artico3_kernel_remove(kernel, name);
 }
 
 
 /*
- * ARTICo3 wait for kernel completion
+ * ARTICo3 release hardware kernel
  *
- * This function waits until the kernel has finished.
+ * This function deletes an ARTICo3 kernel in the current application.
  *
- * @name : hardware kernel to wait for
+ * @name : name of the hardware kernel to be deleted
  *
  * Return : 0 on success, error code otherwise
  *
  */
-int artico3_kernel_wait(const char *name) {
-    unsigned num_bytes;
+int artico3_kernel_release(const char *name) {
+    return _artico3_kernel_release(_artico3_kernel_lookup(name), name);
+}
+
+
+/*
+ * ARTICo3 release hardware kernel (handle-based)
+ *
+ * This function deletes an ARTICo3 kernel in the current application.
+ *
+ * @kernel : handle of the hardware kernel to be deleted
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_kernel_release_h(int kernel) {
+    if (kernel <= 0) return -EINVAL;
+    return _artico3_kernel_release(kernel, NULL);
+}
+
+
+/*
+ * ARTICo3 execute hardware kernel (kernel handle or name)
+ *
+ * @kernel : handle of the hardware kernel to execute (0 to use @name)
+ * @name   : name of the hardware kernel to execute
+ * @gsize  : global work size (total amount of work to be done)
+ * @lsize  : local work size (work that can be done by one accelerator)
+ *
+ * Return : 0 on success, error code otherwisw
+ *
+ */
+static int _artico3_kernel_execute(int kernel, const char *name, size_t gsize, size_t lsize) {
+    struct a3args_t args;
     unsigned int index;
     int ret;
     struct a3request_t request;
-    enum a3func_t type = A3_F_KERNEL_WAIT;
+    enum a3func_t type = A3_F_KERNEL_EXECUTE;
 
-    pthread_mutex_lock(&args_mutex);
-    // Search for channel in channel list
-    for (index = 0; index < A3_MAXCHANNELS_PER_CLIENT; index++) {
-        if (user->channels[index].free == 1) {
-            user->channels[index].free = 0;
-            break;
-        }
-    }
-    pthread_mutex_unlock(&args_mutex);
-    if (index == A3_MAXCHANNELS_PER_CLIENT) {
-        a3_print_error("[artico3-hw] no available channel\n");
-        return -EBUSY;
+    // Get channel (and room in the argument arena)
+    ret = _artico3_channel_get(a3_args_kernsize(kernel, name) + (2 * sizeof (size_t)), &args);
+    if (ret < 0) {
+        return ret;
     }
+    index = ret;
 
     // Write request data
     request.func = type;
@@ -711,11 +1370,12 @@ int artico3_kernel_wait(const char *name) {
     request.channel_id = index;
 
     // Copy arguments
-    char *args_ptr = user->channels[index].args;
-    // @name
-    memcpy(args_ptr, name, strlen(name));
-    num_bytes = strlen(name);
-    args_ptr[num_bytes++] = '\0';
+    // @kernel
+    a3_args_put_kernel(&args, kernel, name);
+    // @gsize
+    a3_args_put(&args, &gsize, sizeof (size_t));
+    // @lsize
+    a3_args_put(&args, &lsize, sizeof (size_t));
 
     // Make request
     ret = _artico3_send_request(request);
@@ -729,223 +1389,353 @@ int artico3_kernel_wait(const char *name) {
 
 
 /*
- * ARTICo3 reset hardware kernel
+ * ARTICo3 execute hardware kernel
  *
- * This function resets all hardware accelerators of a given kernel.
+ * This function executes an ARTICo3 kernel in the current application.
  *
- * @name : hardware kernel to reset
+ * @name  : name of the hardware kernel to execute
+ * @gsize : global work size (total amount of work to be done)
+ * @lsize : local work size (work that can be done by one accelerator)
  *
- * Return : 0 on success, error code otherwise
+ * Return : 0 on success, error code otherwisw
  *
  */
-int artico3_kernel_reset(const char *name) {
-    unsigned num_bytes;
+int artico3_kernel_execute(const char *name, size_t gsize, size_t lsize) {
+    return _artico3_kernel_execute(_artico3_kernel_lookup(name), name, gsize, lsize);
+}
+
+
+/*
+ * ARTICo3 execute hardware kernel (handle-based)
+ *
+ * This function executes an ARTICo3 kernel in the current application.
+ *
+ * @kernel : handle of the hardware kernel to execute
+ * @gsize  : global work size (total amount of work to be done)
+ * @lsize  : local work size (work that can be done by one accelerator)
+ *
+ * Return : 0 on success, error code otherwisw
+ *
+ */
+int artico3_kernel_execute_h(int kernel, size_t gsize, size_t lsize) {
+    if (kernel <= 0) return -EINVAL;
+    return _artico3_kernel_execute(kernel, NULL, gsize, lsize);
+}
+
+
+/*
+ * ARTICo3 execute hardware kernel asynchronously (kernel handle or name)
+ *
+ * @kernel : handle of the hardware kernel to execute (0 to use @name)
+ * @name   : name of the hardware kernel to execute
+ * @gsize  : global work size (total amount of work to be done)
+ * @lsize  : local work size (work that can be done by one accelerator)
+ *
+ * Return : completion handle (>= 0) on success, error code otherwise
+ *
+ */
+static int _artico3_kernel_execute_async(int kernel, const char *name, size_t gsize, size_t lsize) {
+    struct a3args_t args;
     unsigned int index;
-    int ret;
+    int ret, handle;
     struct a3request_t request;
-    enum a3func_t type = A3_F_KERNEL_RESET;
-
-    pthread_mutex_lock(&args_mutex);
-    // Search for channel in channel list
-    for (index = 0; index < A3_MAXCHANNELS_PER_CLIENT; index++) {
-        if (user->channels[index].free == 1) {
-            user->channels[index].free = 0;
+    enum a3func_t type = A3_F_KERNEL_EXECUTE_ASYNC;
+
+    pthread_mutex_lock(&handles_mutex);
+    // Search for handle in handle list
+    for (handle = 0; handle < A3_MAXHANDLES; handle++) {
+        if (!handles[handle].used) {
+            handles[handle].used = 1;
+            handles[handle].fd = -1;
+            handles[handle].signaled = 0;
             break;
         }
     }
-    pthread_mutex_unlock(&args_mutex);
-    if (index == A3_MAXCHANNELS_PER_CLIENT) {
-        a3_print_error("[artico3-hw] no available channel\n");
+    pthread_mutex_unlock(&handles_mutex);
+    if (handle == A3_MAXHANDLES) {
+        a3_print_error("[artico3u-hw] no available handle\n");
         return -EBUSY;
     }
 
+    // Reset completion (before the Daemon can post it)
+    user->async[handle].response = 0;
+    __atomic_store_n(&user->async[handle].done, 0, __ATOMIC_RELEASE);
+
+    // Get channel (and room in the argument arena)
+    ret = _artico3_channel_get(a3_args_kernsize(kernel, name) + (2 * sizeof (size_t)) + sizeof (int), &args);
+    if (ret < 0) {
+        goto err_handle;
+    }
+    index = ret;
+
     // Write request data
     request.func = type;
     request.user_id = user->user_id;
     request.channel_id = index;
 
     // Copy arguments
-    char *args_ptr = user->channels[index].args;
-    // @name
-    memcpy(args_ptr, name, strlen(name));
-    num_bytes = strlen(name);
-    args_ptr[num_bytes++] = '\0';
+    // @kernel
+    a3_args_put_kernel(&args, kernel, name);
+    // @gsize
+    a3_args_put(&args, &gsize, sizeof (size_t));
+    // @lsize
+    a3_args_put(&args, &lsize, sizeof (size_t));
+    // @handle
+    a3_args_put(&args, &handle, sizeof (int));
 
     // Make request
     ret = _artico3_send_request(request);
     if (ret < 0){
         a3_print_error("[artico3u-hw] send request failed\n");
-        return ret;
+        goto err_handle;
     }
+    a3_print_debug("[artico3u-hw] asynchronous execution started (kernel=%d, handle=%d)\n", kernel, handle);
+
+    return handle;
+
+err_handle:
+    pthread_mutex_lock(&handles_mutex);
+    handles[handle].used = 0;
+    pthread_mutex_unlock(&handles_mutex);
 
     return ret;
 }
 
 
 /*
- * ARTICo3 configuration register write
+ * ARTICo3 execute hardware kernel asynchronously
  *
- * This function writes configuration data to ARTICo3 kernel registers.
+ * This function executes an ARTICo3 kernel in the current application
+ * without waiting for it to finish.
  *
- * @name   : hardware kernel to be addressed
- * @offset : memory offset of the register to be accessed
- * @cfg    : array of configuration words to be written, one per
- *           equivalent accelerator
+ * @name  : name of the hardware kernel to execute
+ * @gsize : global work size (total amount of work to be done)
+ * @lsize : local work size (work that can be done by one accelerator)
  *
- * Return : 0 on success, error code otherwise
+ * Return : completion handle (>= 0) on success, error code otherwise
  *
- * NOTE : configuration registers need to be handled taking into account
- *        execution priorities.
+ */
+int artico3_kernel_execute_async(const char *name, size_t gsize, size_t lsize) {
+    return _artico3_kernel_execute_async(_artico3_kernel_lookup(name), name, gsize, lsize);
+}
+
+
+/*
+ * ARTICo3 execute hardware kernel asynchronously (handle-based)
  *
- *        TMR == (0x1-0xf) > DMR == (0x1-0xf) > Simplex (TMR == 0 && DMR == 0)
+ * This function executes an ARTICo3 kernel in the current application
+ * without waiting for it to finish.
  *
- *        The way in which the hardware infrastructure has been implemented
- *        sequences first TMR transactions (in ascending group order), then
- *        DMR transactions (in ascending group order) and finally, Simplex
- *        transactions.
+ * @kernel : handle of the hardware kernel to execute
+ * @gsize  : global work size (total amount of work to be done)
+ * @lsize  : local work size (work that can be done by one accelerator)
+ *
+ * Return : completion handle (>= 0) on success, error code otherwise
  *
  */
-int artico3_kernel_wcfg(const char *name, uint16_t offset, a3data_t *cfg) {
-    unsigned num_bytes;
-    unsigned int index;
-    int ret, naccs;
-    struct a3request_t request;
-    enum a3func_t type = A3_F_KERNEL_WCFG;
-
-    // Ask for naccs
-    pthread_mutex_lock(&args_mutex);
-    // Search for channel in channel list
-    for (index = 0; index < A3_MAXCHANNELS_PER_CLIENT; index++) {
-        if (user->channels[index].free == 1) {
-            user->channels[index].free = 0;
-            break;
-        }
-    }
-    pthread_mutex_unlock(&args_mutex);
-    if (index == A3_MAXCHANNELS_PER_CLIENT) {
-        a3_print_error("[artico3-hw] no available channel\n");
-        return -EBUSY;
-    }
+int artico3_kernel_execute_async_h(int kernel, size_t gsize, size_t lsize) {
+    if (kernel <= 0) return -EINVAL;
+    return _artico3_kernel_execute_async(kernel, NULL, gsize, lsize);
+}
 
-    // Write request data
-    request.func = A3_F_GET_NACCS;
-    request.user_id = user->user_id;
-    request.channel_id = index;
 
-    // Copy arguments
-    char *args_ptr = user->channels[index].args;
-    // @name
-    memcpy(args_ptr, name, strlen(name));
-    num_bytes = strlen(name);
-    args_ptr[num_bytes++] = '\0';
+/*
+ * ARTICo3 asynchronous completion notifier thread
+ *
+ * This thread sleeps until the Daemon posts asynchronous completions, and
+ * then signals the eventfds of the handles that have been completed.
+ *
+ * @args : unused
+ *
+ */
+static void *_artico3_async_notifier(void *args) {
+    unsigned int index;
+    uint32_t seq;
+    uint64_t value = 1;
 
-    // Make request
-    ret = _artico3_send_request(request);
-    if (ret < 0){
-        a3_print_error("[artico3u-hw] send request failed\n");
-        return ret;
-    }
+    (void)args;
 
-    // Store returned naccs
-    naccs = ret;
+    while (1) {
+        // Get current sequence number before checking the handles
+        seq = __atomic_load_n(&user->async_seq, __ATOMIC_ACQUIRE);
 
-    // Write configuration registers
-    pthread_mutex_lock(&args_mutex);
-    // Search for channel in channel list
-    for (index = 0; index < A3_MAXCHANNELS_PER_CLIENT; index++) {
-        if (user->channels[index].free == 1) {
-            user->channels[index].free = 0;
+        pthread_mutex_lock(&handles_mutex);
+        if (!notifier_running) {
+            pthread_mutex_unlock(&handles_mutex);
             break;
         }
-    }
-    pthread_mutex_unlock(&args_mutex);
-    if (index == A3_MAXCHANNELS_PER_CLIENT) {
-        a3_print_error("[artico3-hw] no available channel\n");
-        return -EBUSY;
-    }
-
-    // Write request data
-    request.func = type;
-    request.user_id = user->user_id;
-    request.channel_id = index;
 
-    // Copy arguments
-    // @name
-    memcpy(args_ptr, name, strlen(name));
-    num_bytes = strlen(name);
-    args_ptr[num_bytes++] = '\0';
-    // @offset
-    memcpy(&(args_ptr[num_bytes]), &offset, sizeof (uint16_t));
-    num_bytes += sizeof (uint16_t);
-    // @cfg
-    memcpy(&(args_ptr[num_bytes]), cfg, naccs * sizeof (a3data_t));
+        // Signal completed handles
+        for (index = 0; index < A3_MAXHANDLES; index++) {
+            if (!handles[index].used || (handles[index].fd < 0) || handles[index].signaled) continue;
+            if (!__atomic_load_n(&user->async[index].done, __ATOMIC_ACQUIRE)) continue;
+            if (write(handles[index].fd, &value, sizeof value) != sizeof value) {
+                a3_print_error("[artico3u-hw] write() failed (handle=%u)\n", index);
+            }
+            handles[index].signaled = 1;
+        }
+        pthread_mutex_unlock(&handles_mutex);
 
-    // Make request
-    ret = _artico3_send_request(request);
-    if (ret < 0){
-        a3_print_error("[artico3u-hw] send request failed\n");
-        return ret;
+        // Wait for new completions
+        a3_futex_wait(&user->async_seq, seq);
     }
 
-    return ret;
+    return NULL;
 }
 
 
 /*
- * ARTICo3 configuration register read
+ * ARTICo3 get completion file descriptor
  *
- * This function reads configuration data from ARTICo3 kernel registers.
+ * This function returns a file descriptor that becomes readable when the
+ * asynchronous kernel execution associated with a handle finishes.
  *
- * @name   : hardware kernel to be addressed
- * @offset : memory offset of the register to be accessed
- * @cfg    : array of configuration words to be read, one per
- *           equivalent accelerator
+ * @handle : completion handle returned by artico3_kernel_execute_async()
  *
- * Return : 0 on success, error code otherwise
+ * Return : file descriptor on success, error code otherwise
  *
- * NOTE : configuration registers need to be handled taking into account
- *        execution priorities.
+ */
+int artico3_handle_fd(int handle) {
+    int fd;
+    uint64_t value = 1;
+
+    if ((handle < 0) || (handle >= A3_MAXHANDLES)) return -EINVAL;
+
+    pthread_mutex_lock(&handles_mutex);
+
+    if (!handles[handle].used) {
+        a3_print_error("[artico3u-hw] handle=%d not in use\n", handle);
+        pthread_mutex_unlock(&handles_mutex);
+        return -EINVAL;
+    }
+
+    // Create eventfd (only once per handle)
+    if (handles[handle].fd < 0) {
+        handles[handle].fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (handles[handle].fd < 0) {
+            a3_print_error("[artico3u-hw] eventfd() failed\n");
+            pthread_mutex_unlock(&handles_mutex);
+            return -errno;
+        }
+    }
+    fd = handles[handle].fd;
+
+    // Start completion notifier (only once per user)
+    if (!notifier_running) {
+        if (pthread_create(&notifier, NULL, _artico3_async_notifier, NULL)) {
+            a3_print_error("[artico3u-hw] pthread_create() failed\n");
+            pthread_mutex_unlock(&handles_mutex);
+            return -ENOMEM;
+        }
+        notifier_running = 1;
+    }
+
+    // The execution might have finished before the eventfd was created
+    if (!handles[handle].signaled && __atomic_load_n(&user->async[handle].done, __ATOMIC_ACQUIRE)) {
+        if (write(fd, &value, sizeof value) != sizeof value) {
+            a3_print_error("[artico3u-hw] write() failed (handle=%d)\n", handle);
+        }
+        handles[handle].signaled = 1;
+    }
+
+    pthread_mutex_unlock(&handles_mutex);
+
+    return fd;
+}
+
+
+/*
+ * ARTICo3 test asynchronous kernel completion
  *
- *        TMR == (0x1-0xf) > DMR == (0x1-0xf) > Simplex (TMR == 0 && DMR == 0)
+ * This function checks, without blocking, whether the asynchronous kernel
+ * execution associated with a handle has finished.
  *
- *        The way in which the hardware infrastructure has been implemented
- *        sequences first TMR transactions (in ascending group order), then
- *        DMR transactions (in ascending group order) and finally, Simplex
- *        transactions.
+ * @handle : completion handle returned by artico3_kernel_execute_async()
+ *
+ * Return : 1 if finished, 0 if still running, error code otherwise
  *
  */
-int artico3_kernel_rcfg(const char *name, uint16_t offset, a3data_t *cfg) {
-    unsigned num_bytes;
+int artico3_handle_test(int handle) {
+
+    if ((handle < 0) || (handle >= A3_MAXHANDLES) || !handles[handle].used) return -EINVAL;
+
+    return __atomic_load_n(&user->async[handle].done, __ATOMIC_ACQUIRE) ? 1 : 0;
+}
+
+
+/*
+ * ARTICo3 wait for asynchronous kernel completion
+ *
+ * This function waits until the asynchronous kernel execution associated
+ * with a handle has finished, and releases the handle (and its file
+ * descriptor, if any).
+ *
+ * @handle : completion handle returned by artico3_kernel_execute_async()
+ *
+ * Return : kernel execution result (0 on success), error code otherwise
+ *
+ */
+int artico3_handle_wait(int handle) {
+    unsigned int spins;
+    int ret;
+
+    if ((handle < 0) || (handle >= A3_MAXHANDLES) || !handles[handle].used) return -EINVAL;
+
+    // Spin phase
+    for (spins = 0; spins < spin_budget; spins++) {
+        if (__atomic_load_n(&user->async[handle].done, __ATOMIC_ACQUIRE)) break;
+        a3_cpu_relax();
+    }
+
+    // Sleep phase
+    while (!__atomic_load_n(&user->async[handle].done, __ATOMIC_ACQUIRE)) {
+        a3_futex_wait(&user->async[handle].done, 0);
+    }
+    ret = user->async[handle].response;
+
+    // Release handle
+    pthread_mutex_lock(&handles_mutex);
+    if (handles[handle].fd >= 0) close(handles[handle].fd);
+    handles[handle].fd = -1;
+    handles[handle].used = 0;
+    pthread_mutex_unlock(&handles_mutex);
+    a3_print_debug("[artico3u-hw] asynchronous execution finished (handle=%d, ret=%d)\n", handle, ret);
+
+    return ret;
+}
+
+
+/*
+ * ARTICo3 wait for kernel completion (kernel handle or name)
+ *
+ * @kernel : handle of the hardware kernel to wait for (0 to use @name)
+ * @name   : hardware kernel to wait for
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+static int _artico3_kernel_wait(int kernel, const char *name) {
+    struct a3args_t args;
     unsigned int index;
-    int ret, naccs;
+    int ret;
     struct a3request_t request;
-    enum a3func_t type = A3_F_KERNEL_RCFG;
+    enum a3func_t type = A3_F_KERNEL_WAIT;
 
-    pthread_mutex_lock(&args_mutex);
-    // Search for channel in channel list
-    for (index = 0; index < A3_MAXCHANNELS_PER_CLIENT; index++) {
-        if (user->channels[index].free == 1) {
-            user->channels[index].free = 0;
-            break;
-        }
-    }
-    pthread_mutex_unlock(&args_mutex);
-    if (index == A3_MAXCHANNELS_PER_CLIENT) {
-        a3_print_error("[artico3-hw] no available channel\n");
-        return -EBUSY;
+    // Get channel (and room in the argument arena)
+    ret = _artico3_channel_get(a3_args_kernsize(kernel, name), &args);
+    if (ret < 0) {
+        return ret;
     }
+    index = ret;
 
     // Write request data
-    request.func = A3_F_GET_NACCS;
+    request.func = type;
     request.user_id = user->user_id;
     request.channel_id = index;
 
     // Copy arguments
-    char *args_ptr = user->channels[index].args;
-    // @name
-    memcpy(args_ptr, name, strlen(name));
-    num_bytes = strlen(name);
-    args_ptr[num_bytes++] = '\0';
+    // @kernel
+    a3_args_put_kernel(&args, kernel, name);
 
     // Make request
     ret = _artico3_send_request(request);
@@ -954,22 +1744,63 @@ int artico3_kernel_rcfg(const char *name, uint16_t offset, a3data_t *cfg) {
         return ret;
     }
 
-    // Store returned naccs
-    naccs = ret;
+    return ret;
+}
+
 
-    pthread_mutex_lock(&args_mutex);
-    // Search for channel in channel list
-    for (index = 0; index < A3_MAXCHANNELS_PER_CLIENT; index++) {
-        if (user->channels[index].free == 1) {
-            user->channels[index].free = 0;
-            break;
-        }
-    }
-    pthread_mutex_unlock(&args_mutex);
-    if (index == A3_MAXCHANNELS_PER_CLIENT) {
-        a3_print_error("[artico3-hw] no available channel\n");
-        return -EBUSY;
+/*
+ * ARTICo3 wait for kernel completion
+ *
+ * This function waits until the kernel has finished.
+ *
+ * @name : hardware kernel to wait for
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_kernel_wait(const char *name) {
+    return _artico3_kernel_wait(_artico3_kernel_lookup(name), name);
+}
+
+
+/*
+ * ARTICo3 wait for kernel completion (handle-based)
+ *
+ * This function waits until the kernel has finished.
+ *
+ * @kernel : handle of the hardware kernel to wait for
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_kernel_wait_h(int kernel) {
+    if (kernel <= 0) return -EINVAL;
+    return _artico3_kernel_wait(kernel, NULL);
+}
+
+
+/*
+ * ARTICo3 reset hardware kernel (kernel handle or name)
+ *
+ * @kernel : handle of the hardware kernel to reset (0 to use @name)
+ * @name   : hardware kernel to reset
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+static int _artico3_kernel_reset(int kernel, const char *name) {
+    struct a3args_t args;
+    unsigned int index;
+    int ret;
+    struct a3request_t request;
+    enum a3func_t type = A3_F_KERNEL_RESET;
+
+    // Get channel (and room in the argument arena)
+    ret = _artico3_channel_get(a3_args_kernsize(kernel, name), &args);
+    if (ret < 0) {
+        return ret;
     }
+    index = ret;
 
     // Write request data
     request.func = type;
@@ -977,13 +1808,8 @@ int artico3_kernel_rcfg(const char *name, uint16_t offset, a3data_t *cfg) {
     request.channel_id = index;
 
     // Copy arguments
-    // @name
-    memcpy(args_ptr, name, strlen(name));
-    num_bytes = strlen(name);
-    args_ptr[num_bytes++] = '\0';
-    // @offset
-    memcpy(&(args_ptr[num_bytes]), &offset, sizeof (uint16_t));
-    num_bytes += sizeof (uint16_t);
+    // @kernel
+    a3_args_put_kernel(&args, kernel, name);
 
     // Make request
     ret = _artico3_send_request(request);
@@ -992,56 +1818,1701 @@ int artico3_kernel_rcfg(const char *name, uint16_t offset, a3data_t *cfg) {
         return ret;
     }
 
-    // Copy back pass-by-reference arguments
-    // @cfg
-    memcpy(cfg, &(args_ptr[num_bytes]), naccs * sizeof (a3data_t));
-
     return ret;
 }
 
 
 /*
- * ARTICo3 allocate buffer memory
+ * ARTICo3 reset hardware kernel
  *
- * This function allocates dynamic memory to be used as a buffer between
- * the application and the local memories in the hardware kernels.
+ * This function resets all hardware accelerators of a given kernel.
  *
- * @size  : amount of memory (in bytes) to be allocated for the buffer
- * @kname : hardware kernel name to associate this buffer with
- * @pname : port name to associate this buffer with
- * @dir   : data direction of the port
+ * @name : hardware kernel to reset
  *
- * Return : pointer to allocated memory on success, NULL otherwise
+ * Return : 0 on success, error code otherwise
  *
- * NOTE   : the dynamically allocated buffer is mapped via mmap() to a
- *          POSIX shared memory object in the "/dev/shm" tmpfs to make it
- *          accessible from different processes
+ */
+int artico3_kernel_reset(const char *name) {
+    return _artico3_kernel_reset(_artico3_kernel_lookup(name), name);
+}
+
+
+/*
+ * ARTICo3 reset hardware kernel (handle-based)
  *
- * TODO   : implement optimized version using qsort();
+ * This function resets all hardware accelerators of a given kernel.
+ *
+ * @kernel : handle of the hardware kernel to reset
+ *
+ * Return : 0 on success, error code otherwise
  *
  */
-void *artico3_alloc(size_t size, const char *kname, const char *pname, enum a3pdir_t dir) {
-    int fd, ret;
-    unsigned num_bytes;
-    unsigned int index, b;
-    char *buf_filename = NULL;
+int artico3_kernel_reset_h(int kernel) {
+    if (kernel <= 0) return -EINVAL;
+    return _artico3_kernel_reset(kernel, NULL);
+}
+
+
+/*
+ * ARTICo3 configuration register write
+ *
+ * This function writes configuration data to ARTICo3 kernel registers.
+ *
+ * @name   : hardware kernel to be addressed
+ * @offset : memory offset of the register to be accessed
+ * @cfg    : array of configuration words to be written, one per
+ *           equivalent accelerator
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ * NOTE : see artico3_kernel_wcfg_h().
+ *
+ */
+int artico3_kernel_wcfg(const char *name, uint16_t offset, a3data_t *cfg) {
+    int kernel;
+
+    // Configuration register accesses cannot be batched
+    if (batch.active) {
+        a3_print_error("[artico3u-hw] request=%d cannot be batched\n", A3_F_KERNEL_WCFG);
+        return -EINVAL;
+    }
+
+    // Get kernel handle from the published topology
+    kernel = artico3_kernel_get(name);
+    if (kernel < 0) {
+        a3_print_error("[artico3u-hw] no kernel found with name \"%s\"\n", name);
+        return kernel;
+    }
+
+    return artico3_kernel_wcfg_h(kernel, offset, cfg);
+}
+
+
+/*
+ * ARTICo3 configuration register write (handle-based)
+ *
+ * This function writes configuration data to ARTICo3 kernel registers.
+ *
+ * @kernel : handle of the hardware kernel to be addressed
+ * @offset : memory offset of the register to be accessed
+ * @cfg    : array of configuration words to be written, one per
+ *           equivalent accelerator
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ * NOTE : the number of configuration words is taken from the topology
+ *        published by the Daemon. If the topology changes before the
+ *        request is processed, the request is sent again.
+ *
+ * NOTE : configuration registers need to be handled taking into account
+ *        execution priorities.
+ *
+ *        TMR == (0x1-0xf) > DMR == (0x1-0xf) > Simplex (TMR == 0 && DMR == 0)
+ *
+ *        The way in which the hardware infrastructure has been implemented
+ *        sequences first TMR transactions (in ascending group order), then
+ *        DMR transactions (in ascending group order) and finally, Simplex
+ *        transactions.
+ *
+ */
+int artico3_kernel_wcfg_h(int kernel, uint16_t offset, a3data_t *cfg) {
+    struct a3args_t args;
+    unsigned int index;
+    int ret, naccs;
+    uint32_t generation;
     struct a3request_t request;
-    struct a3buf_t *buf = NULL;
-    enum a3func_t type = A3_F_ALLOC;
+    enum a3func_t type = A3_F_KERNEL_WCFG;
+
+    // Configuration register accesses cannot be batched
+    if (batch.active) {
+        a3_print_error("[artico3u-hw] request=%d cannot be batched\n", type);
+        return -EINVAL;
+    }
+
+    // Retry if the topology changes before the request is processed
+    do {
+
+        // Get naccs from the published topology (no round trip required)
+        naccs = _artico3_topology_naccs(kernel, &generation);
+        if (naccs < 0) {
+            a3_print_error("[artico3u-hw] no kernel found with handle %d\n", kernel);
+            return naccs;
+        }
+
+        // Get channel (and room in the argument arena)
+        ret = _artico3_channel_get(a3_args_kernsize(kernel, NULL) + sizeof (uint16_t) + sizeof (uint32_t) + (naccs * sizeof (a3data_t)), &args);
+        if (ret < 0) {
+            return ret;
+        }
+        index = ret;
+
+        // Write request data
+        request.func = type;
+        request.user_id = user->user_id;
+        request.channel_id = index;
+
+        // Copy arguments
+        // @kernel
+        a3_args_put_kernel(&args, kernel, NULL);
+        // @offset
+        a3_args_put(&args, &offset, sizeof (uint16_t));
+        // @generation
+        a3_args_put(&args, &generation, sizeof (uint32_t));
+        // @cfg
+        a3_args_put(&args, cfg, naccs * sizeof (a3data_t));
+
+        // Make request
+        ret = _artico3_send_request(request);
+
+    } while (ret == -EAGAIN);
+
+    if (ret < 0){
+        a3_print_error("[artico3u-hw] send request failed\n");
+        return ret;
+    }
+
+    return ret;
+}
+
+
+/*
+ * ARTICo3 configuration register read
+ *
+ * This function reads configuration data from ARTICo3 kernel registers.
+ *
+ * @name   : hardware kernel to be addressed
+ * @offset : memory offset of the register to be accessed
+ * @cfg    : array of configuration words to be read, one per
+ *           equivalent accelerator
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ * NOTE : see artico3_kernel_rcfg_h().
+ *
+ */
+int artico3_kernel_rcfg(const char *name, uint16_t offset, a3data_t *cfg) {
+    int kernel;
+
+    // Configuration register accesses cannot be batched
+    if (batch.active) {
+        a3_print_error("[artico3u-hw] request=%d cannot be batched\n", A3_F_KERNEL_RCFG);
+        return -EINVAL;
+    }
+
+    // Get kernel handle from the published topology
+    kernel = artico3_kernel_get(name);
+    if (kernel < 0) {
+        a3_print_error("[artico3u-hw] no kernel found with name \"%s\"\n", name);
+        return kernel;
+    }
+
+    return artico3_kernel_rcfg_h(kernel, offset, cfg);
+}
+
+
+/*
+ * ARTICo3 configuration register read (handle-based)
+ *
+ * This function reads configuration data from ARTICo3 kernel registers.
+ *
+ * @kernel : handle of the hardware kernel to be addressed
+ * @offset : memory offset of the register to be accessed
+ * @cfg    : array of configuration words to be read, one per
+ *           equivalent accelerator
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ * NOTE : the number of configuration words is taken from the topology
+ *        published by the Daemon. If the topology changes before the
+ *        request is processed, the request is sent again.
+ *
+ * NOTE : configuration registers need to be handled taking into account
+ *        execution priorities.
+ *
+ *        TMR == (0x1-0xf) > DMR == (0x1-0xf) > Simplex (TMR == 0 && DMR == 0)
+ *
+ *        The way in which the hardware infrastructure has been implemented
+ *        sequences first TMR transactions (in ascending group order), then
+ *        DMR transactions (in ascending group order) and finally, Simplex
+ *        transactions.
+ *
+ */
+int artico3_kernel_rcfg_h(int kernel, uint16_t offset, a3data_t *cfg) {
+    struct a3args_t args;
+    unsigned int index;
+    int ret, naccs;
+    uint32_t generation;
+    struct a3request_t request;
+    enum a3func_t type = A3_F_KERNEL_RCFG;
+
+    // Configuration register accesses cannot be batched
+    if (batch.active) {
+        a3_print_error("[artico3u-hw] request=%d cannot be batched\n", type);
+        return -EINVAL;
+    }
+
+    // Retry if the topology changes before the request is processed
+    do {
+
+        // Get naccs from the published topology (no round trip required)
+        naccs = _artico3_topology_naccs(kernel, &generation);
+        if (naccs < 0) {
+            a3_print_error("[artico3u-hw] no kernel found with handle %d\n", kernel);
+            return naccs;
+        }
+
+        // Get channel (and room in the argument arena)
+        ret = _artico3_channel_get(a3_args_kernsize(kernel, NULL) + sizeof (uint16_t) + sizeof (uint32_t) + (naccs * sizeof (a3data_t)), &args);
+        if (ret < 0) {
+            return ret;
+        }
+        index = ret;
+
+        // Write request data
+        request.func = type;
+        request.user_id = user->user_id;
+        request.channel_id = index;
+
+        // Copy arguments
+        // @kernel
+        a3_args_put_kernel(&args, kernel, NULL);
+        // @offset
+        a3_args_put(&args, &offset, sizeof (uint16_t));
+        // @generation
+        a3_args_put(&args, &generation, sizeof (uint32_t));
+
+        // Make request (@cfg is copied back before releasing the channel)
+        ret = _artico3_send_request_out(request, cfg, args.pos, naccs * sizeof (a3data_t));
+
+    } while (ret == -EAGAIN);
+
+    if (ret < 0){
+        a3_print_error("[artico3u-hw] send request failed\n");
+        return ret;
+    }
+
+    return ret;
+}
+
+
+/*
+ * ARTICo3 get kernel handle
+ *
+ * This function gets the handle of a kernel from its name, so that the
+ * handle-based API (artico3_*_h()) can be used by applications that did
+ * not create the kernel themselves.
+ *
+ * @name : hardware kernel name
+ *
+ * Return : kernel handle (> 0) on success, error code otherwise
+ *
+ * NOTE : this value is read from the topology published by the Daemon
+ *        in shared memory, and therefore does not require any request.
+ *
+ */
+int artico3_kernel_get(const char *name) {
+    unsigned int index;
+    uint32_t seq;
+    int kernel;
+
+    do {
+        seq = a3_seqlock_read_begin(&topology->seq);
+        kernel = -ENODEV;
+        for (index = 0; index < A3_TOPOLOGY_MAXKERNS; index++) {
+            if (!topology->kernels[index].id) continue;
+            if (strncmp(topology->kernels[index].name, name, A3_NAME_SIZE) == 0) {
+                kernel = topology->kernels[index].handle;
+                break;
+            }
+        }
+    } while (a3_seqlock_read_retry(&topology->seq, seq));
+
+    return kernel;
+}
+
+
+/*
+ * ARTICo3 get number of equivalent accelerators
+ *
+ * This function gets the number of equivalent accelerators of a kernel
+ * (i.e. the number of configuration words expected by
+ * artico3_kernel_wcfg() and artico3_kernel_rcfg()).
+ *
+ * @name : hardware kernel to be addressed
+ *
+ * Return : number of equivalent accelerators on success, error code otherwise
+ *
+ * NOTE : this value is read from the topology published by the Daemon
+ *        in shared memory, and therefore does not require any request.
+ *
+ */
+int artico3_kernel_get_naccs(const char *name) {
+    int kernel;
+
+    kernel = artico3_kernel_get(name);
+    if (kernel < 0) {
+        return kernel;
+    }
+
+    return artico3_kernel_get_naccs_h(kernel);
+}
+
+
+/*
+ * ARTICo3 get number of equivalent accelerators (handle-based)
+ *
+ * @kernel : handle of the hardware kernel to be addressed
+ *
+ * Return : number of equivalent accelerators on success, error code otherwise
+ *
+ */
+int artico3_kernel_get_naccs_h(int kernel) {
+    uint32_t generation;
+
+    return _artico3_topology_naccs(kernel, &generation);
+}
+
+
+/*
+ * ARTICo3 declare valid count register (kernel handle or name)
+ *
+ * @kernel : handle of the hardware kernel to be addressed (0 to use @name)
+ * @name   : hardware kernel to be addressed
+ * @reg    : register index (-1 to remove the declaration)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+static int _artico3_kernel_vcount(int kernel, const char *name, int reg) {
+    struct a3args_t args;
+    unsigned int index;
+    int ret;
+    int32_t reg_aux = reg;
+    struct a3request_t request;
+    enum a3func_t type = A3_F_KERNEL_VCOUNT;
+
+    // Get channel (and room in the argument arena)
+    ret = _artico3_channel_get(a3_args_kernsize(kernel, name) + sizeof (int32_t), &args);
+    if (ret < 0) {
+        return ret;
+    }
+    index = ret;
+
+    // Write request data
+    request.func = type;
+    request.user_id = user->user_id;
+    request.channel_id = index;
+
+    // Copy arguments
+    // @kernel
+    a3_args_put_kernel(&args, kernel, name);
+    // @reg
+    a3_args_put(&args, &reg_aux, sizeof (int32_t));
+
+    // Make request
+    ret = _artico3_send_request(request);
+    if (ret < 0){
+        a3_print_error("[artico3u-hw] send request failed\n");
+    }
+
+    return ret;
+}
+
+
+/*
+ * ARTICo3 declare valid count register
+ *
+ * This function declares the register of a kernel that gets, before each
+ * round, the number of valid work items of each accelerator (see
+ * artico3_kernel_execute()).
+ *
+ * @name : hardware kernel to be addressed
+ * @reg  : register index (-1 to remove the declaration)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_kernel_vcount(const char *name, int reg) {
+    return _artico3_kernel_vcount(_artico3_kernel_lookup(name), name, reg);
+}
+
+
+/*
+ * ARTICo3 declare valid count register (handle-based)
+ *
+ * @kernel : handle of the hardware kernel to be addressed
+ * @reg    : register index (-1 to remove the declaration)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_kernel_vcount_h(int kernel, int reg) {
+    if (kernel <= 0) return -EINVAL;
+    return _artico3_kernel_vcount(kernel, NULL, reg);
+}
+
+
+/*
+ * ARTICo3 allocate buffer memory (kernel handle or name)
+ *
+ * @size   : amount of memory (in bytes) to be allocated for the buffer
+ * @kernel : handle of the hardware kernel to associate this buffer with (0 to use @kname)
+ * @kname  : hardware kernel name to associate this buffer with
+ * @pname  : port name to associate this buffer with
+ * @dir    : data direction of the port
+ * @dtype  : data type of the buffer (A3_T_*)
+ *
+ * Return : pointer to allocated memory on success, NULL otherwise
+ *
+ */
+static void *_artico3_alloc(size_t size, int kernel, const char *kname, const char *pname, enum a3pdir_t dir, unsigned int dtype) {
+    int ret;
+    struct a3args_t args;
+    unsigned int index, b;
+    char *buf_filename = NULL;
+    struct a3request_t request;
+    struct a3buf_t *buf = NULL;
+    enum a3func_t type = A3_F_ALLOC;
+
+    // Get channel (and room in the argument arena)
+    ret = _artico3_channel_get(sizeof (size_t) + a3_args_kernsize(kernel, kname) + a3_args_strsize(pname) + sizeof (enum a3pdir_t) + sizeof (unsigned int), &args);
+    if (ret < 0) {
+        return NULL;
+    }
+    index = ret;
+
+    // Write request data
+    request.func = type;
+    request.user_id = user->user_id;
+    request.channel_id = index;
+
+    // Copy arguments
+    // @size
+    a3_args_put(&args, &size, sizeof (size_t));
+    // @kernel
+    a3_args_put_kernel(&args, kernel, kname);
+    // @pname
+    a3_args_put_str(&args, pname);
+    // @dir
+    a3_args_put(&args, &dir, sizeof (enum a3pdir_t));
+    // @dtype
+    a3_args_put(&args, &dtype, sizeof (unsigned int));
+
+    // Make request
+    ret = _artico3_send_request(request);
+    if (ret < 0){
+        a3_print_error("[artico3u-hw] send request failed\n");
+        return NULL;
+    }
+
+    // Search for kernel in kernel list
+    pthread_mutex_lock(&kernels_mutex);
+    ret = _artico3_kernel_find(kernel, kname);
+    pthread_mutex_unlock(&kernels_mutex);
+    if (ret < 0) {
+        return NULL;
+    }
+    index = ret;
+
+    // Get kernel name (buffers can be allocated using kernel handles)
+    kname = kernels[index]->name;
+
+    // Allocate memory for kernel buf configuration
+    buf = malloc(sizeof *buf);
+    if (!buf) {
+        return NULL;
+    }
+
+    // Set buf name
+    buf->name = malloc(strlen(pname) + 1);
+    if (!buf->name) {
+        goto err_malloc_buf_name;
+    }
+    strcpy(buf->name, pname);
+
+    // Set buf size
+    buf->size = size;
+
+    // Set buf filename (concatenation of kname and pname)
+    buf_filename = malloc(strlen(kname) + strlen(pname) + 1);
+    if (!buf_filename) {
+        goto err_malloc_buf_filename;
+    }
+    strcpy(buf_filename, kname);
+    strcpy(buf_filename + strlen(kname), pname);
+
+    // Map the shared memory object (it might not exist yet if batching)
+    buf->mapsize = a3_shm_size(buf->size, (dir & A3_P_HUGE) != 0);
+    buf->data = a3_shm_map(buf_filename, buf->mapsize, (dir & A3_P_HUGE) != 0);
+    if(buf->data == MAP_FAILED) {
+        goto err_shm_open_mmap_buf_filename;
+    }
+
+    // Add port to ports
+    b = 0;
+    while (kernels[index]->bufs[b] && (b < kernels[index]->membanks)) b++;
+    if (b == kernels[index]->membanks) {
+        a3_print_error("[artico3u-hw] no empty bank found for buf\n");
+        goto err_nobuf;
+    }
+    kernels[index]->bufs[b] = buf;
+
+    free(buf_filename);
+
+    return buf->data;
+
+err_nobuf:
+    munmap(buf->data, buf->mapsize);
+
+err_shm_open_mmap_buf_filename:
+    free(buf_filename);
+
+err_malloc_buf_filename:
+    free(buf->name);
+
+err_malloc_buf_name:
+    free(buf);
+
+    return NULL;
+}
+
+
+/*
+ * ARTICo3 allocate buffer memory
+ *
+ * This function allocates dynamic memory to be used as a buffer between
+ * the application and the local memories in the hardware kernels.
+ *
+ * @size  : amount of memory (in bytes) to be allocated for the buffer
+ * @kname : hardware kernel name to associate this buffer with
+ * @pname : port name to associate this buffer with
+ * @dir   : data direction of the port, optionally OR-ed with A3_P_HUGE
+ *
+ * Return : pointer to allocated memory on success, NULL otherwise
+ *
+ * NOTE   : the dynamically allocated buffer is mapped via mmap() to a
+ *          POSIX shared memory object in the "/dev/shm" tmpfs to make it
+ *          accessible from different processes
+ *
+ * NOTE   : A3_P_HUGE buffers are backed by transparent huge pages, and
+ *          locked (or pre-faulted) in memory by both the application and
+ *          the Daemon, which avoids page-fault storms when copying large
+ *          datasets (see artico3_shm.h)
+ *
+ * TODO   : implement optimized version using qsort();
+ *
+ */
+void *artico3_alloc(size_t size, const char *kname, const char *pname, enum a3pdir_t dir) {
+    return _artico3_alloc(size, _artico3_kernel_lookup(kname), kname, pname, dir, A3_T_RAW);
+}
+
+
+/*
+ * ARTICo3 allocate buffer memory (handle-based)
+ *
+ * This function allocates dynamic memory to be used as a buffer between
+ * the application and the local memories in the hardware kernels.
+ *
+ * @size   : amount of memory (in bytes) to be allocated for the buffer
+ * @kernel : handle of the hardware kernel to associate this buffer with
+ * @pname  : port name to associate this buffer with
+ * @dir    : data direction of the port
+ *
+ * Return : pointer to allocated memory on success, NULL otherwise
+ *
+ */
+void *artico3_alloc_h(size_t size, int kernel, const char *pname, enum a3pdir_t dir) {
+    if (kernel <= 0) return NULL;
+    return _artico3_alloc(size, kernel, NULL, pname, dir, A3_T_RAW);
+}
+
+
+/*
+ * ARTICo3 allocate typed buffer memory
+ *
+ * This function allocates dynamic memory to be used as a buffer between
+ * the application and the local memories in the hardware kernels, whose
+ * elements are converted by the Daemon between @dtype and the data
+ * format of the accelerators (see TYPED PORTS in artico3.h).
+ *
+ * @size  : amount of memory (in bytes) to be allocated for the buffer
+ * @kname : hardware kernel name to associate this buffer with
+ * @pname : port name to associate this buffer with
+ * @dir   : data direction of the port, optionally OR-ed with A3_P_HUGE
+ * @dtype : data type of the buffer (A3_T_*)
+ *
+ * Return : pointer to allocated memory on success, NULL otherwise
+ *
+ */
+void *artico3_alloc_typed(size_t size, const char *kname, const char *pname, enum a3pdir_t dir, unsigned int dtype) {
+    return _artico3_alloc(size, _artico3_kernel_lookup(kname), kname, pname, dir, dtype);
+}
+
+
+/*
+ * ARTICo3 allocate typed buffer memory (handle-based)
+ *
+ * @size   : amount of memory (in bytes) to be allocated for the buffer
+ * @kernel : handle of the hardware kernel to associate this buffer with
+ * @pname  : port name to associate this buffer with
+ * @dir    : data direction of the port, optionally OR-ed with A3_P_HUGE
+ * @dtype  : data type of the buffer (A3_T_*)
+ *
+ * Return : pointer to allocated memory on success, NULL otherwise
+ *
+ */
+void *artico3_alloc_typed_h(size_t size, int kernel, const char *pname, enum a3pdir_t dir, unsigned int dtype) {
+    if (kernel <= 0) return NULL;
+    return _artico3_alloc(size, kernel, NULL, pname, dir, dtype);
+}
+
+
+/*
+ * ARTICo3 remove buffer from kernel buffer list
+ *
+ * This function releases the user-side data of a buffer allocated with
+ * artico3_alloc() (i.e. the application mapping of the buffer).
+ *
+ * @kernel : handle of the hardware kernel this buffer is associated with (0 to use @kname)
+ * @kname  : hardware kernel name this buffer is associanted with
+ * @pname  : port name this buffer is associated with
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+static int _artico3_buf_remove(int kernel, const char *kname, const char *pname) {
+    unsigned int index, p;
+    int ret;
+    struct a3buf_t *buf = NULL;
+
+    // Search for kernel in kernel list
+    pthread_mutex_lock(&kernels_mutex);
+    ret = _artico3_kernel_find(kernel, kname);
+    pthread_mutex_unlock(&kernels_mutex);
+    if (ret < 0) {
+        return ret;
+    }
+    index = ret;
+
+    // Search for port in port lists
+    for (p = 0; p < kernels[index]->membanks; p++) {
+        if (kernels[index]->bufs[p]) {
+            if (strcmp(kernels[index]->bufs[p]->name, pname) == 0) {
+                buf = kernels[index]->bufs[p];
+                kernels[index]->bufs[p] = NULL;
+                break;
+            }
+        }
+    }
+    if (p == kernels[index]->membanks) {
+        a3_print_error("[artico3u-hw] no port found with name %s\n", pname);
+        return -ENODEV;
+    }
+
+    // Free application memory
+    munmap(buf->data, buf->mapsize);
+    free(buf->name);
+    free(buf);
+
+    return 0;
+}
+
+
+/*
+ * ARTICo3 release buffer memory (kernel handle or name)
+ *
+ * @kernel : handle of the hardware kernel this buffer is associated with (0 to use @kname)
+ * @kname  : hardware kernel name this buffer is associanted with
+ * @pname  : port name this buffer is associated with
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+static int _artico3_free(int kernel, const char *kname, const char *pname) {
+    struct a3args_t args;
+    unsigned int index;
+    int ret;
+    struct a3request_t request;
+    enum a3func_t type = A3_F_FREE;
+
+    // Get channel (and room in the argument arena)
+    ret = _artico3_channel_get(a3_args_kernsize(kernel, kname) + a3_args_strsize(pname), &args);
+    if (ret < 0) {
+        return ret;
+    }
+    index = ret;
+
+    // Write request data
+    request.func = type;
+    request.user_id = user->user_id;
+    request.channel_id = index;
+
+    // Copy arguments
+    // @kernel
+    a3_args_put_kernel(&args, kernel, kname);
+    // @pname
+    a3_args_put_str(&args, pname);
+
+    // Make request
+    ret = _artico3_send_request(request);
+    if (ret < 0){
+        a3_print_error("[artico3u-hw] send request failed\n");
+        return ret;
+    }
+
+    // Remove buffer from kernel buffer list
+    return _artico3_buf_remove(kernel, kname, pname);
+}
+
+
+/*
+ * ARTICo3 release buffer memory
+ *
+ * This function frees dynamic memory allocated as a buffer between the
+ * application and the hardware kernel.
+ *
+ * @kname : hardware kernel name this buffer is associanted with
+ * @pname : port name this buffer is associated with
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_free(const char *kname, const char *pname) {
+    return _artico3_free(_artico3_kernel_lookup(kname), kname, pname);
+}
+
+
+/*
+ * ARTICo3 release buffer memory (handle-based)
+ *
+ * This function frees dynamic memory allocated as a buffer between the
+ * application and the hardware kernel.
+ *
+ * @kernel : handle of the hardware kernel this buffer is associated with
+ * @pname  : port name this buffer is associated with
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_free_h(int kernel, const char *pname) {
+    if (kernel <= 0) return -EINVAL;
+    return _artico3_free(kernel, NULL, pname);
+}
+
+
+/*
+ * ARTICo3 allocate zero-copy buffer memory (kernel handle or name)
+ *
+ * @size   : amount of memory (in bytes) to be allocated for the buffer
+ * @kernel : handle of the hardware kernel to associate this buffer with (0 to use @kname)
+ * @kname  : hardware kernel name to associate this buffer with
+ * @pname  : port name to associate this buffer with
+ * @dir    : data direction of the port (A3_P_I, A3_P_O, A3_P_IO)
+ * @nbanks : number of local memory banks used by the port
+ *
+ * Return : pointer to allocated memory on success, NULL otherwise
+ *
+ */
+static void *_artico3_alloc_zc(size_t size, int kernel, const char *kname, const char *pname, enum a3pdir_t dir, unsigned int nbanks) {
+    int fd, ret;
+    struct a3args_t args;
+    unsigned int index, b;
+    unsigned long key;
+    struct a3request_t request;
+    struct a3buf_t *buf = NULL;
+    enum a3func_t type = A3_F_ALLOC_ZC;
+
+    // Get channel (and room in the argument arena)
+    ret = _artico3_channel_get(sizeof (size_t) + a3_args_kernsize(kernel, kname) + a3_args_strsize(pname) + sizeof (enum a3pdir_t) + sizeof (unsigned int), &args);
+    if (ret < 0) {
+        return NULL;
+    }
+    index = ret;
+
+    // Write request data
+    request.func = type;
+    request.user_id = user->user_id;
+    request.channel_id = index;
+
+    // Copy arguments
+    // @size
+    a3_args_put(&args, &size, sizeof (size_t));
+    // @kernel
+    a3_args_put_kernel(&args, kernel, kname);
+    // @pname
+    a3_args_put_str(&args, pname);
+    // @dir
+    a3_args_put(&args, &dir, sizeof (enum a3pdir_t));
+    // @nbanks
+    a3_args_put(&args, &nbanks, sizeof (unsigned int));
+
+    // Make request (the Daemon returns the shared DMA region key)
+    ret = _artico3_send_request(request);
+    if (ret <= 0){
+        a3_print_error("[artico3u-hw] send request failed\n");
+        return NULL;
+    }
+    key = ret;
+
+    // Search for kernel in kernel list
+    pthread_mutex_lock(&kernels_mutex);
+    ret = _artico3_kernel_find(kernel, kname);
+    pthread_mutex_unlock(&kernels_mutex);
+    if (ret < 0) {
+        return NULL;
+    }
+    index = ret;
+
+    // Allocate memory for kernel buf configuration
+    buf = malloc(sizeof *buf);
+    if (!buf) {
+        goto err_malloc_buf;
+    }
+
+    // Set buf name
+    buf->name = malloc(strlen(pname) + 1);
+    if (!buf->name) {
+        goto err_malloc_buf_name;
+    }
+    strcpy(buf->name, pname);
+
+    // Set buf size
+    buf->size = size;
+    buf->mapsize = size;
+
+    // Map the shared DMA region allocated by the Daemon
+    fd = open("/dev/artico3", O_RDWR);
+    if (fd < 0) {
+        a3_print_error("[artico3u-hw] open() /dev/artico3 failed\n");
+        goto err_open_mmap;
+    }
+    buf->data = mmap(0, buf->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, key * sysconf(_SC_PAGESIZE));
+    if (buf->data == MAP_FAILED) {
+        a3_print_error("[artico3u-hw] mmap() failed\n");
+        close(fd);
+        goto err_open_mmap;
+    }
+
+    // Close ARTICo3 device file (not needed anymore)
+    close(fd);
+
+    // Add port to ports
+    b = 0;
+    while (kernels[index]->bufs[b] && (b < kernels[index]->membanks)) b++;
+    if (b == kernels[index]->membanks) {
+        a3_print_error("[artico3u-hw] no empty bank found for buf\n");
+        goto err_nobuf;
+    }
+    kernels[index]->bufs[b] = buf;
+
+    return buf->data;
+
+err_nobuf:
+    munmap(buf->data, buf->mapsize);
+
+err_open_mmap:
+    free(buf->name);
+
+err_malloc_buf_name:
+    free(buf);
+
+err_malloc_buf:
+    // Release Daemon-side buffer (the port is not in the buffer list yet)
+    _artico3_free(kernel, kname, pname);
+
+    return NULL;
+}
+
+
+/*
+ * ARTICo3 allocate zero-copy buffer memory
+ *
+ * This function allocates DMA-capable memory, shared between the
+ * application and the Daemon, to be used as a buffer for @nbanks
+ * consecutive local memories in the hardware kernels (see ZERO-COPY
+ * PORTS in artico3.h).
+ *
+ * @size   : amount of memory (in bytes) to be allocated for the buffer
+ * @kname  : hardware kernel name to associate this buffer with
+ * @pname  : port name to associate this buffer with
+ * @dir    : data direction of the port (A3_P_I, A3_P_O, A3_P_IO)
+ * @nbanks : number of local memory banks used by the port
+ *
+ * Return : pointer to allocated memory on success, NULL otherwise
+ *
+ */
+void *artico3_alloc_zc(size_t size, const char *kname, const char *pname, enum a3pdir_t dir, unsigned int nbanks) {
+    return _artico3_alloc_zc(size, _artico3_kernel_lookup(kname), kname, pname, dir, nbanks);
+}
+
+
+/*
+ * ARTICo3 allocate zero-copy buffer memory (handle-based)
+ *
+ * @size   : amount of memory (in bytes) to be allocated for the buffer
+ * @kernel : handle of the hardware kernel to associate this buffer with
+ * @pname  : port name to associate this buffer with
+ * @dir    : data direction of the port (A3_P_I, A3_P_O, A3_P_IO)
+ * @nbanks : number of local memory banks used by the port
+ *
+ * Return : pointer to allocated memory on success, NULL otherwise
+ *
+ */
+void *artico3_alloc_zc_h(size_t size, int kernel, const char *pname, enum a3pdir_t dir, unsigned int nbanks) {
+    if (kernel <= 0) return NULL;
+    return _artico3_alloc_zc(size, kernel, NULL, pname, dir, nbanks);
+}
+
+
+/*
+ * ARTICo3 set port view (kernel handle or name)
+ *
+ * @kernel : handle of the hardware kernel the port is associated with (0 to use @kname)
+ * @kname  : hardware kernel name the port is associated with
+ * @pname  : port name
+ * @view   : port view (NULL to remove the view)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+static int _artico3_port_view(int kernel, const char *kname, const char *pname, const struct a3view_t *view) {
+    struct a3args_t args;
+    unsigned int index;
+    int ret;
+    struct a3view_t noview;
+    struct a3request_t request;
+    enum a3func_t type = A3_F_PORT_VIEW;
+
+    // Views are removed by setting 0 rows
+    if (!view) {
+        memset(&noview, 0, sizeof noview);
+        view = &noview;
+    }
+
+    // Get channel (and room in the argument arena)
+    ret = _artico3_channel_get(a3_args_kernsize(kernel, kname) + a3_args_strsize(pname) + sizeof (struct a3view_t), &args);
+    if (ret < 0) {
+        return ret;
+    }
+    index = ret;
+
+    // Write request data
+    request.func = type;
+    request.user_id = user->user_id;
+    request.channel_id = index;
+
+    // Copy arguments
+    // @kernel
+    a3_args_put_kernel(&args, kernel, kname);
+    // @pname
+    a3_args_put_str(&args, pname);
+    // @view
+    a3_args_put(&args, view, sizeof (struct a3view_t));
+
+    // Make request
+    ret = _artico3_send_request(request);
+    if (ret < 0){
+        a3_print_error("[artico3u-hw] send request failed\n");
+    }
+
+    return ret;
+}
+
+
+/*
+ * ARTICo3 set port view
+ *
+ * This function sets the access descriptor of a port, which describes how
+ * the data of each work-group is extracted from (or stored into) the port
+ * buffer (see PORT VIEWS in artico3.h).
+ *
+ * @kname : hardware kernel name the port is associated with
+ * @pname : port name
+ * @view  : port view (NULL to remove the view)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_port_view(const char *kname, const char *pname, const struct a3view_t *view) {
+    return _artico3_port_view(_artico3_kernel_lookup(kname), kname, pname, view);
+}
+
+
+/*
+ * ARTICo3 set port view (handle-based)
+ *
+ * @kernel : handle of the hardware kernel the port is associated with
+ * @pname  : port name
+ * @view   : port view (NULL to remove the view)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_port_view_h(int kernel, const char *pname, const struct a3view_t *view) {
+    if (kernel <= 0) return -EINVAL;
+    return _artico3_port_view(kernel, NULL, pname, view);
+}
+
+
+/*
+ * ARTICo3 load accelerator / change accelerator configuration (kernel handle or name)
+ *
+ * @kernel : hardware kernel handle (0 to use @name)
+ * @name   : hardware kernel name
+ * @slot   : reconfigurable slot in which the accelerator is to be loaded
+ * @tmr    : TMR group ID (0x1-0xf)
+ * @dmr    : DMR group ID (0x1-0xf)
+ * @force  : force reconfiguration even if the accelerator is already present
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+static int _artico3_load(int kernel, const char *name, uint8_t slot, uint8_t tmr, uint8_t dmr, uint8_t force) {
+    struct a3args_t args;
+    unsigned int index;
+    int ret;
+    struct a3request_t request;
+    enum a3func_t type = A3_F_LOAD;
+
+    // Get channel (and room in the argument arena)
+    ret = _artico3_channel_get(a3_args_kernsize(kernel, name) + (4 * sizeof (uint8_t)), &args);
+    if (ret < 0) {
+        return ret;
+    }
+    index = ret;
+
+    // Write request data
+    request.func = type;
+    request.user_id = user->user_id;
+    request.channel_id = index;
+
+    // Copy arguments
+    // @kernel
+    a3_args_put_kernel(&args, kernel, name);
+    // @slot
+    a3_args_put(&args, &slot, sizeof (uint8_t));
+    // @tmr
+    a3_args_put(&args, &tmr, sizeof (uint8_t));
+    // @dmr
+    a3_args_put(&args, &dmr, sizeof (uint8_t));
+    // @force
+    a3_args_put(&args, &force, sizeof (uint8_t));
+
+    // Make request
+    ret = _artico3_send_request(request);
+    if (ret < 0){
+        a3_print_error("[artico3u-hw] send request failed\n");
+        return ret;
+    }
+
+    return ret;
+}
+
+
+/*
+ * ARTICo3 load accelerator / change accelerator configuration
+ *
+ * This function loads a hardware accelerator and/or sets its specific
+ * configuration.
+ *
+ * @name  : hardware kernel name
+ * @slot  : reconfigurable slot in which the accelerator is to be loaded
+ * @tmr   : TMR group ID (0x1-0xf)
+ * @dmr   : DMR group ID (0x1-0xf)
+ * @force : force reconfiguration even if the accelerator is already present
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_load(const char *name, uint8_t slot, uint8_t tmr, uint8_t dmr, uint8_t force) {
+    return _artico3_load(_artico3_kernel_lookup(name), name, slot, tmr, dmr, force);
+}
+
+
+/*
+ * ARTICo3 load accelerator / change accelerator configuration (handle-based)
+ *
+ * This function loads a hardware accelerator and/or sets its specific
+ * configuration.
+ *
+ * @kernel : hardware kernel handle
+ * @slot   : reconfigurable slot in which the accelerator is to be loaded
+ * @tmr    : TMR group ID (0x1-0xf)
+ * @dmr    : DMR group ID (0x1-0xf)
+ * @force  : force reconfiguration even if the accelerator is already present
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_load_h(int kernel, uint8_t slot, uint8_t tmr, uint8_t dmr, uint8_t force) {
+    if (kernel <= 0) return -EINVAL;
+    return _artico3_load(kernel, NULL, slot, tmr, dmr, force);
+}
+
+
+/*
+ * ARTICo3 remove accelerator
+ *
+ * This function removes a hardware accelerator from a reconfigurable slot.
+ *
+ * @slot  : reconfigurable slot from which the accelerator is to be removed
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_unload(uint8_t slot) {
+    struct a3args_t args;
+    unsigned int index;
+    int ret;
+    struct a3request_t request;
+    enum a3func_t type = A3_F_UNLOAD;
+
+    // Get channel (and room in the argument arena)
+    ret = _artico3_channel_get(sizeof (uint8_t), &args);
+    if (ret < 0) {
+        return ret;
+    }
+    index = ret;
+
+    // Write request data
+    request.func = type;
+    request.user_id = user->user_id;
+    request.channel_id = index;
+
+    // Copy arguments
+    // @slot
+    a3_args_put(&args, &slot, sizeof (uint8_t));
+
+    // Make request
+    ret = _artico3_send_request(request);
+    if (ret < 0){
+        a3_print_error("[artico3u-hw] send request failed\n");
+        return ret;
+    }
+
+    return ret;
+}
+
+
+/*
+ * ARTICo3 begin batch
+ *
+ * This function starts recording the runtime calls made by the calling
+ * thread, so that they can be sent to the Daemon in a single request.
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_batch_begin() {
+
+    // Check if already recording
+    if (batch.active) {
+        a3_print_error("[artico3u-hw] batch already started\n");
+        return -EBUSY;
+    }
+
+    // Start recording
+    batch.nrecords = 0;
+    batch.size = 0;
+    batch.active = 1;
+    a3_print_debug("[artico3u-hw] batch started\n");
+
+    return 0;
+}
+
+
+/*
+ * ARTICo3 undo batched call
+ *
+ * This function reverts the user-side effects of a recorded (or queued)
+ * runtime call that has not been successfully executed by the Daemon.
+ *
+ * @record : recorded runtime call
+ * @data   : recorded runtime call input arguments
+ *
+ */
+static void _artico3_batch_undo(const struct a3record_t *record, char *data) {
+    const char *kname = NULL, *pname = NULL;
+    char buf_filename[2 * A3_NAME_SIZE];
+    struct a3args_t args;
+    size_t size;
+    int kernel, ret;
+
+    a3_args_init(&args, data, record->size);
+
+    // Kernels are created in the user before the Daemon executes the call
+    if (record->func == A3_F_KERNEL_CREATE) {
+        // @name
+        kname = a3_args_get_str(&args);
+        if (kname) _artico3_kernel_remove(0, kname);
+    }
+
+    // Buffers are created and mapped in the user before the Daemon executes the call
+    if (record->func == A3_F_ALLOC) {
+        // @size
+        a3_args_get(&args, &size, sizeof (size_t));
+        // @kernel
+        kernel = a3_args_get_kernel(&args, &kname);
+        // @pname
+        pname = a3_args_get_str(&args);
+        if (args.error) return;
+
+        // Get buffer filename (the kernel can be referenced by handle)
+        pthread_mutex_lock(&kernels_mutex);
+        ret = _artico3_kernel_find(kernel, kname);
+        if (ret >= 0) snprintf(buf_filename, sizeof buf_filename, "%s%s", kernels[ret]->name, pname);
+        pthread_mutex_unlock(&kernels_mutex);
+        if (ret < 0) return;
+
+        _artico3_buf_remove(kernel, kname, pname);
+        shm_unlink(buf_filename);
+    }
+}
+
+
+/*
+ * ARTICo3 complete batched call
+ *
+ * This function applies the user-side effects of a recorded (or queued)
+ * runtime call that depend on its result, once it has been executed by
+ * the Daemon.
+ *
+ * @record : recorded runtime call
+ * @data   : recorded runtime call input arguments
+ *
+ */
+static void _artico3_batch_complete(const struct a3record_t *record, char *data) {
+    const char *name = NULL;
+    struct a3args_t args;
+    int ret;
+
+    a3_args_init(&args, data, record->size);
+
+    // Kernel handles are only known after the Daemon executes the call
+    if (record->func == A3_F_KERNEL_CREATE) {
+        // @name
+        name = a3_args_get_str(&args);
+        if (!name) return;
+
+        pthread_mutex_lock(&kernels_mutex);
+        ret = _artico3_kernel_find(0, name);
+        if (ret >= 0) kernels[ret]->handle = record->response;
+        pthread_mutex_unlock(&kernels_mutex);
+    }
+}
+
+
+/*
+ * ARTICo3 submit batch
+ *
+ * This function stops recording runtime calls and sends them to the
+ * Daemon, which executes them in order. Execution stops at the first
+ * failing call (the remaining ones are canceled, -ECANCELED).
+ *
+ * @results : array to store the return value of each recorded call (can be NULL)
+ *           (i.e. the handles of the kernels created in the batch)
+ * @n       : number of elements in @results
+ *
+ * Return : 0 on success, error code of the first failing call otherwise
+ *
+ */
+int artico3_batch_submit(int *results, size_t n) {
+    struct a3args_t args;
+    unsigned int index;
+    uint32_t first, size, offset, nrecords;
+    int ret;
+    struct a3request_t request;
+    struct a3record_t record;
+    enum a3func_t type = A3_F_BATCH;
+
+    // Check if recording
+    if (!batch.active) {
+        a3_print_error("[artico3u-hw] batch not started\n");
+        return -EINVAL;
+    }
+
+    // Stop recording (the batch request itself has to be sent)
+    batch.active = 0;
+
+    // Send recorded calls (in chunks of up to A3_BATCH_MAXSIZE bytes)
+    ret = 0;
+    pthread_mutex_lock(&batch_mutex);
+    for (first = 0; (first < batch.size) && (ret == 0); first += size) {
+
+        // Get the records that fit in the batch request
+        nrecords = 0;
+        for (size = 0; (first + size) < batch.size; size += offset) {
+            memcpy(&record, &(batch.records[first + size]), sizeof record);
+            offset = a3_args_align(sizeof record + record.size);
+            if ((sizeof (uint32_t) + size + offset) > A3_BATCH_MAXSIZE) break;
+            nrecords++;
+        }
+
+        // Get channel (and room in the argument arena)
+        ret = _artico3_channel_get(sizeof (uint32_t) + size, &args);
+        if (ret < 0) {
+            break;
+        }
+        index = ret;
+
+        // Write request data
+        request.func = type;
+        request.user_id = user->user_id;
+        request.channel_id = index;
+
+        // Copy arguments
+        // @nrecords
+        a3_args_put(&args, &nrecords, sizeof (uint32_t));
+        // @records
+        a3_args_put(&args, &(batch.records[first]), size);
+
+        // Make request (responses are copied back before releasing the channel)
+        ret = _artico3_send_request_out(request, &(batch.records[first]), sizeof (uint32_t), size);
+        if (ret < 0) {
+            a3_print_error("[artico3u-hw] batch request failed\n");
+            break;
+        }
+
+        // Get the first failing call (if any)
+        for (offset = first; offset < (first + size); offset += a3_args_align(sizeof record + record.size)) {
+            memcpy(&record, &(batch.records[offset]), sizeof record);
+            if (record.response < 0) {
+                ret = record.response;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&batch_mutex);
+
+    // Complete calls executed by the Daemon (in order)
+    for (index = 0; index < batch.nrecords; index++) {
+        memcpy(&record, &(batch.records[batch.offsets[index]]), sizeof record);
+        if (record.response >= 0) {
+            _artico3_batch_complete(&record, &(batch.records[batch.offsets[index] + sizeof record]));
+        }
+    }
+
+    // Revert calls not executed by the Daemon (in reverse order)
+    for (index = batch.nrecords; index > 0; index--) {
+        memcpy(&record, &(batch.records[batch.offsets[index - 1]]), sizeof record);
+        if (record.response < 0) {
+            _artico3_batch_undo(&record, &(batch.records[batch.offsets[index - 1] + sizeof record]));
+        }
+    }
+
+    // Return per-call results
+    if (results) {
+        for (index = 0; (index < batch.nrecords) && (index < n); index++) {
+            memcpy(&record, &(batch.records[batch.offsets[index]]), sizeof record);
+            results[index] = record.response;
+        }
+    }
+    a3_print_debug("[artico3u-hw] batch submitted (nrecords=%u, ret=%d)\n", batch.nrecords, ret);
+
+    // Release record buffer
+    free(batch.offsets);
+    free(batch.records);
+    batch.offsets = NULL;
+    batch.records = NULL;
+    batch.maxrecords = 0;
+    batch.maxsize = 0;
+    batch.size = 0;
+    batch.nrecords = 0;
+
+    return ret;
+}
+
+
+/*
+ * ARTICo3 begin request queue
+ *
+ * This function makes the runtime calls of the calling thread return as
+ * soon as their requests are posted, without waiting for the responses.
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_queue_begin() {
+
+    // Check if already queueing
+    if (queue.active) {
+        a3_print_error("[artico3u-hw] request queue already started\n");
+        return -EBUSY;
+    }
+
+    // Start queueing
+    queue.active = 1;
+    a3_print_debug("[artico3u-hw] request queue started\n");
+
+    return 0;
+}
+
+
+/*
+ * ARTICo3 end request queue
+ *
+ * This function makes the runtime calls of the calling thread wait for
+ * their responses again. Requests already posted can still be reaped.
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_queue_end() {
+
+    // Check if queueing
+    if (!queue.active) {
+        a3_print_error("[artico3u-hw] request queue not started\n");
+        return -EINVAL;
+    }
+
+    // Stop queueing
+    queue.active = 0;
+    a3_print_debug("[artico3u-hw] request queue ended (npending=%u)\n", queue.npending);
+
+    return 0;
+}
+
+
+/*
+ * ARTICo3 get request tag
+ *
+ * Return : tag (> 0) of the last request posted by the calling thread,
+ *          0 if none
+ *
+ */
+int artico3_queue_tag() {
+    return queue.tag;
+}
+
+
+/*
+ * ARTICo3 find completed queued request
+ *
+ * Return : index of a completed request in the pending request list of
+ *          the calling thread, -1 if none
+ *
+ */
+static int _artico3_queue_find() {
+    unsigned int index;
+    struct a3channel_t *channel = NULL;
+
+    for (index = 0; index < queue.npending; index++) {
+        channel = a3_table_entry(&channels, queue.pending[index].channel_id);
+        if (__atomic_load_n(&channel->response_available, __ATOMIC_ACQUIRE)) return index;
+    }
+
+    return -1;
+}
+
+
+/*
+ * ARTICo3 completed queued request check
+ *
+ * @arg : unused
+ *
+ * Return : 1 if any request posted by the calling thread has completed, 0 otherwise
+ *
+ */
+static int _artico3_queue_ready(void *arg) {
+    (void)arg;
+
+    return _artico3_queue_find() >= 0;
+}
+
+
+/*
+ * ARTICo3 reap queued request
+ *
+ * @response : return value of the reaped runtime call (can be NULL)
+ * @block    : wait for completions if none is available
+ *
+ * Return : tag of the reaped request on success, error code otherwise
+ *
+ */
+static int _artico3_queue_reap(int *response, int block) {
+    int index, ret;
+    struct a3pending_t pending;
+    struct a3channel_t *channel = NULL;
+    struct a3record_t record;
+
+    // Check if there are requests to be reaped
+    if (queue.npending == 0) {
+        return -ENOENT;
+    }
+
+    // Get a completed request (in any order)
+    index = _artico3_queue_find();
+    if (index < 0) {
+        if (!block) {
+            if (pthread_mutex_trylock(&reap_mutex) == 0) {
+                _artico3_reap_completions();
+                pthread_mutex_unlock(&reap_mutex);
+            }
+            index = _artico3_queue_find();
+            if (index < 0) return -EAGAIN;
+        }
+        else {
+            _artico3_wait(_artico3_queue_ready, NULL);
+            index = _artico3_queue_find();
+        }
+    }
+    pending = queue.pending[index];
+    queue.pending[index] = queue.pending[--queue.npending];
+
+    // Get the return of the requested command
+    channel = a3_table_entry(&channels, pending.channel_id);
+    ret = channel->response;
+    channel->response_available = 0;
+
+    // Apply (or revert) user-side effects
+    record.func = pending.func;
+    record.response = ret;
+    record.size = channel->args_size;
+    if (ret >= 0) _artico3_batch_complete(&record, &(user->arena[channel->args_offset]));
+    else _artico3_batch_undo(&record, &(user->arena[channel->args_offset]));
+    _artico3_channel_put(pending.channel_id);
+    a3_print_debug("[artico3u-hw] request reaped (request=%d, tag=%d, ack=%d)\n", pending.func, pending.tag, ret);
+
+    if (response) *response = ret;
+
+    return pending.tag;
+}
+
+
+/*
+ * ARTICo3 reap request
+ *
+ * This function waits until any of the requests posted by the calling
+ * thread has completed, and gets its return value.
+ *
+ * @response : return value of the reaped runtime call (can be NULL)
+ *
+ * Return : tag of the reaped request on success, error code otherwise
+ *          (-ENOENT if there are no requests to be reaped)
+ *
+ */
+int artico3_queue_reap(int *response) {
+    return _artico3_queue_reap(response, 1);
+}
+
+
+/*
+ * ARTICo3 poll request
+ *
+ * This function gets the return value of any of the requests posted by
+ * the calling thread that has completed, without waiting.
+ *
+ * @response : return value of the reaped runtime call (can be NULL)
+ *
+ * Return : tag of the reaped request on success, error code otherwise
+ *          (-EAGAIN if none has completed, -ENOENT if there are no
+ *          requests to be reaped)
+ *
+ */
+int artico3_queue_poll(int *response) {
+    return _artico3_queue_reap(response, 0);
+}
+
+
+/*
+ * ARTICo3 start streaming execution (kernel handle or name)
+ *
+ * @kernel : handle of the hardware kernel to execute (0 to use @name)
+ * @name   : name of the hardware kernel to execute
+ * @depth  : number of work items held by the ring-buffered ports
+ * @lsize  : local work size (work that can be done by one accelerator)
+ *
+ * Return : stream descriptor (>= 0) on success, error code otherwise
+ *
+ */
+static int _artico3_stream_start(int kernel, const char *name, size_t depth, size_t lsize) {
+    struct a3args_t args;
+    unsigned int index;
+    int ret, stream;
+    struct a3request_t request;
+    struct a3userstream_t *aux = NULL;
+    enum a3func_t type = A3_F_KERNEL_STREAM;
+
+    // Streams cannot be recorded in batches (the control block is mapped
+    // by the Daemon when the execution starts)
+    if (batch.active) {
+        a3_print_error("[artico3u-hw] streams cannot be started in a batch\n");
+        return -EBUSY;
+    }
+
+    // The ring has to hold an integer number of rounds
+    if (!lsize || !depth || (depth % lsize) || (depth > UINT32_MAX / 2)) {
+        a3_print_error("[artico3u-hw] invalid stream (depth=%zd,lsize=%zd)\n", depth, lsize);
+        return -EINVAL;
+    }
+
+    // Get a free stream (only one stream per kernel can be running)
+    pthread_mutex_lock(&kernels_mutex);
+    ret = _artico3_kernel_find(kernel, name);
+    if (ret < 0) {
+        pthread_mutex_unlock(&kernels_mutex);
+        return ret;
+    }
+    index = ret;
+    pthread_mutex_lock(&streams_mutex);
+    for (stream = 0; stream < A3_MAXSTREAMS; stream++) {
+        if (streams[stream].used && (strcmp(streams[stream].name, kernels[index]->name) == 0)) {
+            a3_print_error("[artico3u-hw] kernel \"%s\" is already being streamed\n", kernels[index]->name);
+            stream = -EBUSY;
+            break;
+        }
+    }
+    if (stream >= 0) {
+        for (stream = 0; stream < A3_MAXSTREAMS; stream++) {
+            if (!streams[stream].used) break;
+        }
+        if (stream == A3_MAXSTREAMS) {
+            a3_print_error("[artico3u-hw] no streams available\n");
+            stream = -EBUSY;
+        }
+    }
+    if (stream < 0) {
+        pthread_mutex_unlock(&streams_mutex);
+        pthread_mutex_unlock(&kernels_mutex);
+        return stream;
+    }
+    aux = &streams[stream];
+    memset(aux, 0, sizeof *aux);
+    aux->used = 1;
+    aux->kernel = kernels[index]->handle;
+    aux->depth = depth;
+
+    // Set kernel name and stream control filename (concatenation of kname and suffix)
+    aux->name = malloc(strlen(kernels[index]->name) + 1);
+    aux->filename = malloc(strlen(kernels[index]->name) + strlen(A3_STREAM_SUFFIX) + 1);
+    if (aux->name && aux->filename) {
+        strcpy(aux->name, kernels[index]->name);
+        strcpy(aux->filename, kernels[index]->name);
+        strcat(aux->filename, A3_STREAM_SUFFIX);
+    }
+    pthread_mutex_unlock(&streams_mutex);
+    pthread_mutex_unlock(&kernels_mutex);
+    if (!aux->name || !aux->filename) {
+        a3_print_error("[artico3u-hw] malloc() failed\n");
+        ret = -ENOMEM;
+        goto err_malloc;
+    }
 
-    pthread_mutex_lock(&args_mutex);
-    // Search for channel in channel list
-    for (index = 0; index < A3_MAXCHANNELS_PER_CLIENT; index++) {
-        if (user->channels[index].free == 1) {
-            user->channels[index].free = 0;
-            break;
-        }
+    // Create stream control block (mapped by the Daemon when started)
+    aux->ctrl = a3_shm_map(aux->filename, sizeof *aux->ctrl, 0);
+    if (aux->ctrl == MAP_FAILED) {
+        a3_print_error("[artico3u-hw] stream control mmap() failed\n");
+        ret = -ENOMEM;
+        goto err_mmap;
     }
-    pthread_mutex_unlock(&args_mutex);
-    if (index == A3_MAXCHANNELS_PER_CLIENT) {
-        a3_print_error("[artico3-hw] no available channel\n");
-        return NULL;
+    memset(aux->ctrl, 0, sizeof *aux->ctrl);
+
+    // Get channel (and room in the argument arena)
+    ret = _artico3_channel_get(a3_args_kernsize(aux->kernel, aux->name) + (2 * sizeof (size_t)), &args);
+    if (ret < 0) {
+        goto err_request;
     }
+    index = ret;
 
     // Write request data
     request.func = type;
@@ -1049,332 +3520,322 @@ void *artico3_alloc(size_t size, const char *kname, const char *pname, enum a3pd
     request.channel_id = index;
 
     // Copy arguments
-    char *args_ptr = user->channels[index].args;
-    // @name
-    memcpy(args_ptr, &size, sizeof (size_t));
-    num_bytes = sizeof (size_t);
-    // @kname
-    memcpy(&(args_ptr[num_bytes]), kname, strlen(kname));
-    num_bytes += strlen(kname);
-    args_ptr[num_bytes++] = '\0';
-    // @pname
-    memcpy(&(args_ptr[num_bytes]), pname, strlen(pname));
-    num_bytes += strlen(pname);
-    args_ptr[num_bytes++] = '\0';
-    // @dir
-    memcpy(&(args_ptr[num_bytes]), &dir, sizeof (enum a3pdir_t));
+    // @kernel
+    a3_args_put_kernel(&args, aux->kernel, aux->name);
+    // @depth
+    a3_args_put(&args, &depth, sizeof (size_t));
+    // @lsize
+    a3_args_put(&args, &lsize, sizeof (size_t));
 
     // Make request
     ret = _artico3_send_request(request);
     if (ret < 0){
         a3_print_error("[artico3u-hw] send request failed\n");
-        return NULL;
-    }
-    // Allocate memory for kernel buf configuration
-    buf = malloc(sizeof *buf);
-    if (!buf) {
-        return NULL;
+        goto err_request;
     }
+    a3_print_debug("[artico3u-hw] started stream %d (kernel=%s,depth=%zd,lsize=%zd)\n", stream, aux->name, depth, lsize);
 
-    // Set buf name
-    buf->name = malloc(strlen(pname) + 1);
-    if (!buf->name) {
-        goto err_malloc_buf_name;
-    }
-    strcpy(buf->name, pname);
+    return stream;
 
-    // Set buf size
-    buf->size = size;
+err_request:
+    munmap(aux->ctrl, sizeof *aux->ctrl);
+    shm_unlink(aux->filename);
 
-    // Set buf filename (concatenation of kname and pname)
-    buf_filename = malloc(strlen(kname) + strlen(pname) + 1);
-    if (!buf_filename) {
-        goto err_malloc_buf_filename;
-    }
-    strcpy(buf_filename, kname);
-    strcpy(buf_filename + strlen(kname), pname);
+err_mmap:
+err_malloc:
+    free(aux->filename);
+    free(aux->name);
+    pthread_mutex_lock(&streams_mutex);
+    aux->used = 0;
+    pthread_mutex_unlock(&streams_mutex);
 
-    // Create a shared memory object
-    fd = shm_open(buf_filename, O_RDWR, S_IRUSR | S_IWUSR);
-    if(fd < 0) {
-        goto err_shm_open_mmap_buf_filename;
-    }
+    return ret;
+}
 
-    // Resize the shared memory object
-    ftruncate(fd, buf->size);
 
-    // Allocate memory for application mapped to the shared memory object with mmap()
-    buf->data = mmap(0, buf->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-    if(buf->data == MAP_FAILED) {
-        close(fd);
-        goto err_shm_open_mmap_buf_filename;
-    }
+/*
+ * ARTICo3 start streaming execution
+ *
+ * This function starts the streaming execution of an ARTICo3 kernel, in
+ * which the ports of the kernel are used as ring buffers that hold the
+ * data of @depth work items.
+ *
+ * @name  : name of the hardware kernel to execute
+ * @depth : number of work items held by the ring-buffered ports
+ * @lsize : local work size (work that can be done by one accelerator)
+ *
+ * Return : stream descriptor (>= 0) on success, error code otherwise
+ *
+ */
+int artico3_stream_start(const char *name, size_t depth, size_t lsize) {
+    return _artico3_stream_start(_artico3_kernel_lookup(name), name, depth, lsize);
+}
 
-    // Close shared memory object file descriptor (not needed anymore)
-    close(fd);
 
-    // Search for kernel in kernel list
-    for (index = 0; index < max_kernels; index++) {
-        pthread_mutex_lock(&kernels_mutex);
-        if (!kernels[index]) {
-            pthread_mutex_unlock(&kernels_mutex);
-            continue;
-        }
-        if (strcmp(kernels[index]->name, kname) == 0) {
-            pthread_mutex_unlock(&kernels_mutex);
-            break;
-        }
-        pthread_mutex_unlock(&kernels_mutex);
-    }
-    if (index == max_kernels) {
-        a3_print_error("[artico3u-hw] no kernel found with name \"%s\"\n", kname);
-        return NULL;
-    }
+/*
+ * ARTICo3 start streaming execution (handle-based)
+ *
+ * @kernel : handle of the hardware kernel to execute
+ * @depth  : number of work items held by the ring-buffered ports
+ * @lsize  : local work size (work that can be done by one accelerator)
+ *
+ * Return : stream descriptor (>= 0) on success, error code otherwise
+ *
+ */
+int artico3_stream_start_h(int kernel, size_t depth, size_t lsize) {
+    if (kernel <= 0) return -EINVAL;
+    return _artico3_stream_start(kernel, NULL, depth, lsize);
+}
 
-    // Add port to ports
-    b = 0;
-    while (kernels[index]->bufs[b] && (b < kernels[index]->membanks)) b++;
-    if (b == kernels[index]->membanks) {
-        a3_print_error("[artico3u-hw] no empty bank found for buf\n");
-        goto err_nobuf;
-    }
-    kernels[index]->bufs[b] = buf;
 
-    free(buf_filename);
+/*
+ * ARTICo3 get stream
+ *
+ * @stream : stream descriptor
+ *
+ * Return : user-side stream data, NULL if @stream is not a valid stream
+ *
+ */
+static struct a3userstream_t *_artico3_stream_get(int stream) {
+    if ((stream < 0) || (stream >= A3_MAXSTREAMS) || !streams[stream].used) return NULL;
+    return &streams[stream];
+}
 
-    return buf->data;
 
-err_nobuf:
-    munmap(buf->data, buf->size);
+/*
+ * ARTICo3 request stream flush
+ *
+ * This function is called by the producer and the consumer of a stream
+ * before sleeping, so that the Daemon processes the pending work items
+ * even if they do not keep every accelerator busy (otherwise, they could
+ * wait for each other forever).
+ *
+ * @ctrl : stream control block
+ *
+ */
+static void _artico3_stream_flush(struct a3stream_t *ctrl) {
 
-err_shm_open_mmap_buf_filename:
-    free(buf_filename);
+    // Nothing to flush (every work item produced has been processed)
+    if (__atomic_load_n(&ctrl->produced, __ATOMIC_ACQUIRE) == __atomic_load_n(&ctrl->done, __ATOMIC_ACQUIRE)) return;
 
-err_malloc_buf_filename:
-    free(buf->name);
+    __atomic_store_n(&ctrl->flush, 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&ctrl->events, 1, __ATOMIC_RELEASE);
+    a3_futex_wake(&ctrl->events);
+}
 
-err_malloc_buf_name:
-    free(buf);
 
-    return NULL;
+/*
+ * ARTICo3 reserve stream work items
+ *
+ * This function waits until there is room in the ring-buffered ports for
+ * @n work items (i.e. until the consumer has released enough of them).
+ *
+ * @stream : stream descriptor
+ * @n      : number of work items to be produced (up to the ring depth)
+ *
+ * Return : ring position of the first work item on success, error code
+ *          otherwise (-EPIPE if the stream has been closed or has failed)
+ *
+ */
+int artico3_stream_reserve(int stream, size_t n) {
+    unsigned int spins;
+    uint32_t seq, pending;
+    struct a3userstream_t *aux = _artico3_stream_get(stream);
+
+    if (!aux || (n > aux->depth)) return -EINVAL;
+    if (aux->closed) return -EPIPE;
+
+    for (spins = 0; ; spins++) {
+        seq = __atomic_load_n(&aux->ctrl->seq, __ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&aux->ctrl->finished, __ATOMIC_ACQUIRE)) return -EPIPE;
+        pending = (uint32_t)aux->produced - __atomic_load_n(&aux->ctrl->consumed, __ATOMIC_ACQUIRE);
+        if ((pending + n) <= aux->depth) break;
+        // Spin phase, then sleep until the consumer (or the Daemon) updates the stream
+        if (spins < spin_budget) {
+            a3_cpu_relax();
+            continue;
+        }
+        _artico3_stream_flush(aux->ctrl);
+        a3_futex_wait(&aux->ctrl->seq, seq);
+    }
+
+    return aux->produced % aux->depth;
 }
 
 
 /*
- * ARTICo3 release buffer memory
+ * ARTICo3 push stream work items
  *
- * This function frees dynamic memory allocated as a buffer between the
- * application and the hardware kernel.
+ * This function hands @n work items, already written in the ring-buffered
+ * input ports, over to the Daemon.
  *
- * @kname : hardware kernel name this buffer is associanted with
- * @pname : port name this buffer is associated with
+ * @stream : stream descriptor
+ * @n      : number of work items produced (previously reserved)
  *
  * Return : 0 on success, error code otherwise
  *
  */
-int artico3_free(const char *kname, const char *pname) {
-    unsigned num_bytes;
-    unsigned int index, p;
-    int ret;
-    struct a3request_t request;
-    struct a3buf_t *buf = NULL;
-    enum a3func_t type = A3_F_FREE;
+int artico3_stream_push(int stream, size_t n) {
+    uint32_t pending;
+    struct a3userstream_t *aux = _artico3_stream_get(stream);
 
-    pthread_mutex_lock(&args_mutex);
-    // Search for channel in channel list
-    for (index = 0; index < A3_MAXCHANNELS_PER_CLIENT; index++) {
-        if (user->channels[index].free == 1) {
-            user->channels[index].free = 0;
-            break;
-        }
-    }
-    pthread_mutex_unlock(&args_mutex);
-    if (index == A3_MAXCHANNELS_PER_CLIENT) {
-        a3_print_error("[artico3-hw] no available channel\n");
-        return -EBUSY;
-    }
+    if (!aux) return -EINVAL;
+    if (aux->closed) return -EPIPE;
 
-    // Write request data
-    request.func = type;
-    request.user_id = user->user_id;
-    request.channel_id = index;
+    // Work items have to fit in the ring (see artico3_stream_reserve())
+    pending = (uint32_t)aux->produced - __atomic_load_n(&aux->ctrl->consumed, __ATOMIC_ACQUIRE);
+    if ((pending + n) > aux->depth) return -EINVAL;
 
-    // Copy arguments
-    char *args_ptr = user->channels[index].args;
-    // @kname
-    memcpy(args_ptr, kname, strlen(kname));
-    num_bytes = strlen(kname);
-    args_ptr[num_bytes++] = '\0';
-    // @pname
-    memcpy(&(args_ptr[num_bytes]), pname, strlen(pname));
-    num_bytes += strlen(pname);
-    args_ptr[num_bytes++] = '\0';
+    // Publish work items, and wake up the delegate scheduling thread
+    aux->produced += n;
+    __atomic_store_n(&aux->ctrl->produced, (uint32_t)aux->produced, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&aux->ctrl->events, 1, __ATOMIC_RELEASE);
+    a3_futex_wake(&aux->ctrl->events);
 
-    // Make request
-    ret = _artico3_send_request(request);
-    if (ret < 0){
-        a3_print_error("[artico3u-hw] send request failed\n");
-        return ret;
-    }
+    return 0;
+}
 
-    // Search for kernel in kernel list
-    for (index = 0; index < max_kernels; index++) {
-        pthread_mutex_lock(&kernels_mutex);
-        if (!kernels[index]) {
-            pthread_mutex_unlock(&kernels_mutex);
-            continue;
-        }
-        if (strcmp(kernels[index]->name, kname) == 0) {
-            pthread_mutex_unlock(&kernels_mutex);
+
+/*
+ * ARTICo3 fetch stream work items
+ *
+ * This function waits until @n work items have been processed (i.e. their
+ * results are available in the ring-buffered output ports), or until the
+ * stream has finished.
+ *
+ * @stream : stream descriptor
+ * @n      : number of work items to wait for (up to the ring depth); on
+ *           return, number of work items available (more than requested,
+ *           or fewer if the stream has finished, 0 once it is drained)
+ *
+ * Return : ring position of the first work item on success, error code
+ *          otherwise (stream execution result if it has failed)
+ *
+ * NOTE   : @n should not exceed the work items the producer keeps in the
+ *          ring while waiting for room (it could block forever otherwise)
+ *
+ */
+int artico3_stream_fetch(int stream, size_t *n) {
+    unsigned int spins;
+    uint32_t seq, available, finished;
+    struct a3userstream_t *aux = _artico3_stream_get(stream);
+
+    if (!aux || !n || (*n > aux->depth)) return -EINVAL;
+
+    for (spins = 0; ; spins++) {
+        seq = __atomic_load_n(&aux->ctrl->seq, __ATOMIC_ACQUIRE);
+        finished = __atomic_load_n(&aux->ctrl->finished, __ATOMIC_ACQUIRE);
+        available = __atomic_load_n(&aux->ctrl->done, __ATOMIC_ACQUIRE) - (uint32_t)aux->consumed;
+        if (available && (available >= *n)) break;
+        if (finished) {
+            if (!available && (aux->ctrl->response < 0)) return aux->ctrl->response;
             break;
         }
-        pthread_mutex_unlock(&kernels_mutex);
-    }
-    if (index == max_kernels) {
-        a3_print_error("[artico3u-hw] no kernel found with name \"%s\"\n", kname);
-        return -ENODEV;
-    }
-
-    // Search for port in port lists
-    for (p = 0; p < kernels[index]->membanks; p++) {
-        if (kernels[index]->bufs[p]) {
-            if (strcmp(kernels[index]->bufs[p]->name, pname) == 0) {
-                buf = kernels[index]->bufs[p];
-                kernels[index]->bufs[p] = NULL;
-                break;
-            }
+        // Spin phase, then sleep until the Daemon updates the stream
+        if (spins < spin_budget) {
+            a3_cpu_relax();
+            continue;
         }
+        _artico3_stream_flush(aux->ctrl);
+        a3_futex_wait(&aux->ctrl->seq, seq);
     }
-    if (p == kernels[index]->membanks) {
-        a3_print_error("[artico3u-hw] no port found with name %s\n", pname);
-        return -ENODEV;
-    }
-
-    // Free application memory
-    munmap(buf->data, buf->size);
-    free(buf->name);
-    free(buf);
+    *n = available;
 
-    return 0;
+    return aux->consumed % aux->depth;
 }
 
 
 /*
- * ARTICo3 load accelerator / change accelerator configuration
+ * ARTICo3 release stream work items
  *
- * This function loads a hardware accelerator and/or sets its specific
- * configuration.
+ * This function makes the room used by @n work items, whose results have
+ * already been read from the ring-buffered output ports, available to the
+ * producer.
  *
- * @name  : hardware kernel name
- * @slot  : reconfigurable slot in which the accelerator is to be loaded
- * @tmr   : TMR group ID (0x1-0xf)
- * @dmr   : DMR group ID (0x1-0xf)
- * @force : force reconfiguration even if the accelerator is already present
+ * @stream : stream descriptor
+ * @n      : number of work items consumed (previously fetched)
  *
  * Return : 0 on success, error code otherwise
  *
  */
-int artico3_load(const char *name, uint8_t slot, uint8_t tmr, uint8_t dmr, uint8_t force) {
-    unsigned num_bytes;
-    unsigned int index;
-    int ret;
-    struct a3request_t request;
-    enum a3func_t type = A3_F_LOAD;
-
-    pthread_mutex_lock(&args_mutex);
-    // Search for channel in channel list
-    for (index = 0; index < A3_MAXCHANNELS_PER_CLIENT; index++) {
-        if (user->channels[index].free == 1) {
-            user->channels[index].free = 0;
-            break;
-        }
-    }
-    pthread_mutex_unlock(&args_mutex);
-    if (index == A3_MAXCHANNELS_PER_CLIENT) {
-        a3_print_error("[artico3-hw] no available channel\n");
-        return -EBUSY;
-    }
+int artico3_stream_release(int stream, size_t n) {
+    uint32_t available;
+    struct a3userstream_t *aux = _artico3_stream_get(stream);
 
-    // Write request data
-    request.func = type;
-    request.user_id = user->user_id;
-    request.channel_id = index;
+    if (!aux) return -EINVAL;
 
-    // Copy arguments
-    char *args_ptr = user->channels[index].args;
-    // @name
-    memcpy(args_ptr, name, strlen(name));
-    num_bytes = strlen(name);
-    args_ptr[num_bytes++] = '\0';
-    // @slot
-    memcpy(&(args_ptr[num_bytes]), &slot, sizeof (uint8_t));
-    num_bytes += sizeof (uint8_t);
-    // @tmr
-    memcpy(&(args_ptr[num_bytes]), &tmr, sizeof (uint8_t));
-    num_bytes += sizeof (uint8_t);
-    // @dmr
-    memcpy(&(args_ptr[num_bytes]), &dmr, sizeof (uint8_t));
-    num_bytes += sizeof (uint8_t);
-    // @force
-    memcpy(&(args_ptr[num_bytes]), &force, sizeof (uint8_t));
+    // Work items have to be processed (see artico3_stream_fetch())
+    available = __atomic_load_n(&aux->ctrl->done, __ATOMIC_ACQUIRE) - (uint32_t)aux->consumed;
+    if (n > available) return -EINVAL;
 
-    // Make request
-    ret = _artico3_send_request(request);
-    if (ret < 0){
-        a3_print_error("[artico3u-hw] send request failed\n");
-        return ret;
-    }
+    // Publish consumed work items, and wake up the producer
+    aux->consumed += n;
+    __atomic_store_n(&aux->ctrl->consumed, (uint32_t)aux->consumed, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&aux->ctrl->seq, 1, __ATOMIC_RELEASE);
+    a3_futex_wake(&aux->ctrl->seq);
 
-    return ret;
+    return 0;
 }
 
 
 /*
- * ARTICo3 remove accelerator
+ * ARTICo3 close stream
  *
- * This function removes a hardware accelerator from a reconfigurable slot.
+ * This function notifies the Daemon that no more work items will be
+ * produced, so that the pending ones are processed even if they do not
+ * keep every accelerator busy. Processed work items can still be fetched.
  *
- * @slot  : reconfigurable slot from which the accelerator is to be removed
+ * @stream : stream descriptor
  *
  * Return : 0 on success, error code otherwise
  *
  */
-int artico3_unload(uint8_t slot) {
-    unsigned int index;
-    int ret;
-    struct a3request_t request;
-    enum a3func_t type = A3_F_UNLOAD;
+int artico3_stream_close(int stream) {
+    struct a3userstream_t *aux = _artico3_stream_get(stream);
 
-    pthread_mutex_lock(&args_mutex);
-    // Search for channel in channel list
-    for (index = 0; index < A3_MAXCHANNELS_PER_CLIENT; index++) {
-        if (user->channels[index].free == 1) {
-            user->channels[index].free = 0;
-            break;
-        }
-    }
-    pthread_mutex_unlock(&args_mutex);
-    if (index == A3_MAXCHANNELS_PER_CLIENT) {
-        a3_print_error("[artico3-hw] no available channel\n");
-        return -EBUSY;
-    }
+    if (!aux) return -EINVAL;
+    if (aux->closed) return 0;
 
-    // Write request data
-    request.func = type;
-    request.user_id = user->user_id;
-    request.channel_id = index;
+    aux->closed = 1;
+    __atomic_store_n(&aux->ctrl->closed, 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&aux->ctrl->events, 1, __ATOMIC_RELEASE);
+    a3_futex_wake(&aux->ctrl->events);
 
-    // Copy arguments
-    char *args_ptr = user->channels[index].args;
-    // @slot
-    memcpy(args_ptr, &slot, sizeof (uint8_t));
+    return 0;
+}
 
-    // Make request
-    ret = _artico3_send_request(request);
-    if (ret < 0){
-        a3_print_error("[artico3u-hw] send request failed\n");
-        return ret;
-    }
+
+/*
+ * ARTICo3 stop stream
+ *
+ * This function closes a stream (if not closed yet), waits until every
+ * work item has been processed, and releases the stream.
+ *
+ * @stream : stream descriptor
+ *
+ * Return : stream execution result (0 on success), error code otherwise
+ *
+ */
+int artico3_stream_stop(int stream) {
+    int ret;
+    struct a3userstream_t *aux = _artico3_stream_get(stream);
+
+    if (!aux) return -EINVAL;
+
+    // Close stream, and wait for the delegate scheduling thread
+    artico3_stream_close(stream);
+    ret = _artico3_kernel_wait(aux->kernel, aux->name);
+    if ((ret == 0) && __atomic_load_n(&aux->ctrl->finished, __ATOMIC_ACQUIRE)) ret = aux->ctrl->response;
+    a3_print_debug("[artico3u-hw] stopped stream %d (kernel=%s,work items=%" PRIu64 ",ret=%d)\n", stream, aux->name, aux->produced, ret);
+
+    // Release stream
+    munmap(aux->ctrl, sizeof *aux->ctrl);
+    shm_unlink(aux->filename);
+    free(aux->filename);
+    free(aux->name);
+    pthread_mutex_lock(&streams_mutex);
+    aux->used = 0;
+    pthread_mutex_unlock(&streams_mutex);
 
     return ret;
 }
@@ -9,6 +9,7 @@
  *               hardware acceleration.
  *
  * TODO: implement query function to ask info to the daemon (A3U_MAXSLOTS, etc.)
+ *       (artico3_kernel_get_naccs() already reads the published topology)
  *
  */
 
@@ -41,6 +42,10 @@
  *       It is done this way since there is no mechanism for new users to receive response from a3d.
  *       A timeout when shm filename already in use could be a solution.
  *
+ * NOTE: Requests to the Daemon are completed by polling for a short while
+ *       before sleeping. The number of polling iterations can be set with
+ *       the A3_SPIN_BUDGET environment variable (0 to sleep right away).
+ *
  * Return : 0 on success, error code otherwise
  *
  */
@@ -107,7 +112,12 @@ int artico3_unload(uint8_t slot);
  * @membanks : number of local memory banks in the associated accelerator
  * @regs     : number of read/write registers in the associated accelerator
  *
- * Return : 0 on success, error code otherwise
+ * Return : kernel handle (> 0) on success, error code otherwise
+ *
+ * NOTE : kernel names can have up to (A3_NAME_SIZE - 1) characters.
+ *
+ * NOTE : kernels created while recording a batch return 0, and their
+ *        handles are reported by artico3_batch_submit().
  *
  */
 int artico3_kernel_create(const char *name, size_t membytes, size_t membanks, size_t regs);
@@ -130,6 +140,12 @@ int artico3_kernel_release(const char *name);
  * ARTICo3 execute hardware kernel
  *
  * This function executes an ARTICo3 kernel in the current application.
+ * Ports hold the data of @gsize work items, which are processed in rounds
+ * of @lsize work items per accelerator. When @gsize is not a multiple of
+ * @lsize, only the valid data are transferred in the last round, and each
+ * accelerator gets its number of valid work items in the register declared
+ * with artico3_kernel_vcount(). Such executions are rejected (-EINVAL) for
+ * kernels that have not declared it.
  *
  * @name  : name of the hardware kernel to execute
  * @gsize : global work size (total amount of work to be done)
@@ -154,6 +170,80 @@ int artico3_kernel_execute(const char *name, size_t gsize, size_t lsize);
 int artico3_kernel_wait(const char *name);
 
 
+/*
+ * ARTICo3 execute hardware kernel asynchronously
+ *
+ * This function executes an ARTICo3 kernel in the current application
+ * without waiting for it to finish. The returned handle can be waited on
+ * (artico3_handle_wait()), polled (artico3_handle_test()) or integrated
+ * in poll()/epoll() event loops (artico3_handle_fd()).
+ *
+ *     handle = artico3_kernel_execute_async("addvector", gsize, lsize);
+ *     ...
+ *     ret = artico3_handle_wait(handle);
+ *
+ * @name  : name of the hardware kernel to execute
+ * @gsize : global work size (total amount of work to be done)
+ * @lsize : local work size (work that can be done by one accelerator)
+ *
+ * Return : completion handle (>= 0) on success, error code otherwise
+ *
+ * NOTE : @gsize does not need to be a multiple of @lsize for kernels
+ *        that declare a valid count register (see
+ *        artico3_kernel_execute()).
+ *
+ * NOTE : each handle must be released with artico3_handle_wait(), which
+ *        returns right away if the execution has already finished.
+ *
+ */
+int artico3_kernel_execute_async(const char *name, size_t gsize, size_t lsize);
+
+
+/*
+ * ARTICo3 get completion file descriptor
+ *
+ * This function returns a file descriptor (eventfd) that becomes readable
+ * when the asynchronous kernel execution associated with a handle finishes.
+ * The file descriptor is owned by the runtime, and is closed when the
+ * handle is released with artico3_handle_wait().
+ *
+ * @handle : completion handle returned by artico3_kernel_execute_async()
+ *
+ * Return : file descriptor on success, error code otherwise
+ *
+ */
+int artico3_handle_fd(int handle);
+
+
+/*
+ * ARTICo3 test asynchronous kernel completion
+ *
+ * This function checks, without blocking, whether the asynchronous kernel
+ * execution associated with a handle has finished.
+ *
+ * @handle : completion handle returned by artico3_kernel_execute_async()
+ *
+ * Return : 1 if finished, 0 if still running, error code otherwise
+ *
+ */
+int artico3_handle_test(int handle);
+
+
+/*
+ * ARTICo3 wait for asynchronous kernel completion
+ *
+ * This function waits until the asynchronous kernel execution associated
+ * with a handle has finished, and releases the handle (and its file
+ * descriptor, if any).
+ *
+ * @handle : completion handle returned by artico3_kernel_execute_async()
+ *
+ * Return : kernel execution result (0 on success), error code otherwise
+ *
+ */
+int artico3_handle_wait(int handle);
+
+
 /*
  * ARTICo3 reset hardware kernel
  *
@@ -179,6 +269,10 @@ int artico3_kernel_reset(const char *name);
  *
  * Return : 0 on success, error code otherwise
  *
+ * NOTE : the number of configuration words is taken from the topology
+ *        published by the Daemon. If the topology changes before the
+ *        request is processed, the request is sent again.
+ *
  * NOTE : configuration registers need to be handled taking into account
  *        execution priorities.
  *
@@ -205,6 +299,10 @@ int artico3_kernel_wcfg(const char *name, uint16_t offset, a3data_t *cfg);
  *
  * Return : 0 on success, error code otherwise
  *
+ * NOTE : the number of configuration words is taken from the topology
+ *        published by the Daemon. If the topology changes before the
+ *        request is processed, the request is sent again.
+ *
  * NOTE : configuration registers need to be handled taking into account
  *        execution priorities.
  *
@@ -219,6 +317,40 @@ int artico3_kernel_wcfg(const char *name, uint16_t offset, a3data_t *cfg);
 int artico3_kernel_rcfg(const char *name, uint16_t offset, a3data_t *cfg);
 
 
+/*
+ * ARTICo3 get number of equivalent accelerators
+ *
+ * This function gets the number of equivalent accelerators of a kernel
+ * (i.e. the number of configuration words expected by
+ * artico3_kernel_wcfg() and artico3_kernel_rcfg()).
+ *
+ * @name : hardware kernel to be addressed
+ *
+ * Return : number of equivalent accelerators on success, error code otherwise
+ *
+ * NOTE : this value is read from the topology published by the Daemon
+ *        in shared memory, and therefore does not require any request.
+ *
+ */
+int artico3_kernel_get_naccs(const char *name);
+
+
+/*
+ * ARTICo3 declare valid count register
+ *
+ * This function declares the register of a kernel that gets, before each
+ * round, the number of valid work items of each accelerator (see
+ * artico3_kernel_execute()). Kernels do not declare it by default.
+ *
+ * @name : hardware kernel to be addressed
+ * @reg  : register index (-1 to remove the declaration)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_kernel_vcount(const char *name, int reg);
+
+
 /*
  * MEMORY MANAGEMENT
  *
@@ -271,7 +403,7 @@ int artico3_kernel_rcfg(const char *name, uint16_t offset, a3data_t *cfg);
  * @size  : amount of memory (in bytes) to be allocated for the buffer
  * @kname : hardware kernel name to associate this buffer with
  * @pname : port name to associate this buffer with
- * @dir   : data direction of the port
+ * @dir   : data direction of the port, optionally OR-ed with A3_P_HUGE
  *
  * Return : pointer to allocated memory on success, NULL otherwise
  *
@@ -279,6 +411,11 @@ int artico3_kernel_rcfg(const char *name, uint16_t offset, a3data_t *cfg);
  *          POSIX shared memory object in the "/dev/shm" tmpfs to make it
  *          accessible from different processes
  *
+ * NOTE   : A3_P_HUGE buffers are backed by transparent huge pages, and
+ *          locked (or pre-faulted) in memory by both the application and
+ *          the Daemon, which avoids page-fault storms when copying large
+ *          datasets (see artico3_shm.h)
+ *
  * TODO   : implement optimized version using qsort();
  *
  */
@@ -296,10 +433,640 @@ void *artico3_alloc(size_t size, const char *kname, const char *pname, enum a3pd
  *
  * Return : 0 on success, error code otherwise
  *
+ * NOTE   : buffers cannot be released while their kernel is being
+ *          executed (-EBUSY is returned until artico3_kernel_wait() has
+ *          been called)
+ *
  */
 int artico3_free(const char *kname, const char *pname);
 
 
+/*
+ * TYPED PORTS
+ *
+ * Buffers allocated with artico3_alloc() store raw 32-bit words (a3data_t),
+ * which are transferred to/from the accelerators as they are. Typed buffers
+ * declare the element type used by the application instead, and the Daemon
+ * converts (and packs) their elements while copying them to/from its DMA
+ * staging buffers, using vector instructions when available (NEON, SSE2):
+ *
+ *     A3_T_F32      : float, no conversion
+ *     A3_T_I16X2    : int16_t, two elements per hardware word, no conversion
+ *     A3_T_Q(f)     : float, converted to/from 32-bit fixed point (Q format,
+ *                     f fractional bits)
+ *     A3_T_Q16X2(f) : float, converted to/from 16-bit fixed point (Q format,
+ *                     f fractional bits), two elements per hardware word
+ *
+ * For instance, the CORDIC kernel (Q2.29 phase input, Q1.30 sine/cosine
+ * outputs) can be fed with floating point data directly, instead of
+ * converting it with ftoa3()/a3tof() in the application:
+ *
+ *     float *phase = artico3_alloc_typed(size, "cordic", "port0", A3_P_I, A3_T_Q(29));
+ *     float *cosine = artico3_alloc_typed(size, "cordic", "port1", A3_P_O, A3_T_Q(30));
+ *
+ * @size is the size of the application buffer (in bytes), and has to be a
+ * multiple of the element size that fills whole hardware words (e.g. the
+ * buffer of a A3_T_Q16X2 port holds an even number of floats, which are
+ * transferred as half as many hardware words). Work sizes (gsize, lsize)
+ * are always expressed in hardware words.
+ *
+ * Fixed point conversions round to nearest (ties away from zero) and
+ * saturate. Typed buffers cannot be zero-copy.
+ *
+ */
+
+/*
+ * ARTICo3 allocate typed buffer memory
+ *
+ * @size  : amount of memory (in bytes) to be allocated for the buffer
+ * @kname : hardware kernel name to associate this buffer with
+ * @pname : port name to associate this buffer with
+ * @dir   : data direction of the port, optionally OR-ed with A3_P_HUGE
+ * @dtype : data type of the buffer (A3_T_*)
+ *
+ * Return : pointer to allocated memory on success, NULL otherwise
+ *
+ * NOTE   : typed buffers are released with artico3_free()
+ *
+ */
+void *artico3_alloc_typed(size_t size, const char *kname, const char *pname, enum a3pdir_t dir, unsigned int dtype);
+
+
+/*
+ * ARTICo3 allocate typed buffer memory (handle-based)
+ *
+ * @size   : amount of memory (in bytes) to be allocated for the buffer
+ * @kernel : handle of the hardware kernel to associate this buffer with
+ * @pname  : port name to associate this buffer with
+ * @dir    : data direction of the port, optionally OR-ed with A3_P_HUGE
+ * @dtype  : data type of the buffer (A3_T_*)
+ *
+ * Return : pointer to allocated memory on success, NULL otherwise
+ *
+ */
+void *artico3_alloc_typed_h(size_t size, int kernel, const char *pname, enum a3pdir_t dir, unsigned int dtype);
+
+
+/*
+ * ZERO-COPY PORTS
+ *
+ * Buffers allocated with artico3_alloc() are copied by the Daemon to/from
+ * DMA-capable memory in every round. Zero-copy buffers are allocated in
+ * DMA-capable memory shared between the application and the Daemon, so
+ * that rounds are transferred straight from/to them.
+ *
+ * A zero-copy buffer covers @nbanks consecutive memory banks, and stores
+ * them in hardware layout: for each work-group (lsize), the contents of
+ * the @nbanks banks one after the other. For instance, the inputs of a
+ * kernel with two input banks (a and b) are stored as follows:
+ *
+ *     | a[wg 0] | b[wg 0] | a[wg 1] | b[wg 1] | ... | a[wg n] | b[wg n] |
+ *
+ *     ab = artico3_alloc_zc(2 * size, "addvector", "ab", A3_P_I, 2);
+ *     c = artico3_alloc_zc(size, "addvector", "c", A3_P_O, 1);
+ *
+ * Rounds are transferred with a single DMA transfer when the zero-copy
+ * buffer is the only port of its direction (constant memories excluded,
+ * once loaded), and each work-group fills all the banks of the buffer
+ * (i.e. the size of the buffer is gsize / lsize times the size of @nbanks
+ * banks). Otherwise, each work-group of the buffer is transferred to
+ * consecutive banks with scatter-gather DMA, and only the other ports are
+ * copied by the Daemon.
+ *
+ * Zero-copy buffers are allocated in coherent DMA memory by default,
+ * which is not cached on ARM platforms (i.e. they should be filled/read
+ * sequentially by the application). Buffers whose direction is OR-ed with
+ * A3_P_CACHED are allocated in cached DMA memory instead, which is faster
+ * to access from the application, and the Daemon performs the required
+ * cache maintenance around each transfer (if cached memory cannot be
+ * allocated, e.g. for very large buffers, coherent memory is used):
+ *
+ *     ab = artico3_alloc_zc(2 * size, "addvector", "ab", A3_P_I | A3_P_CACHED, 2);
+ *
+ * The DMA staging buffers used by the Daemon for the other ports can be
+ * allocated in cached memory too (A3_DMA_CACHED=1 environment variable
+ * when starting the Daemon).
+ *
+ * IMPORTANT: zero-copy buffers require access to the ARTICo3 device
+ *            (/dev/artico3), and cannot be allocated in batches.
+ *
+ */
+
+/*
+ * ARTICo3 allocate zero-copy buffer memory
+ *
+ * This function allocates DMA-capable memory, shared between the
+ * application and the Daemon, to be used as a buffer for @nbanks
+ * consecutive local memories in the hardware kernels.
+ *
+ * @size   : amount of memory (in bytes) to be allocated for the buffer
+ * @kname  : hardware kernel name to associate this buffer with
+ * @pname  : port name to associate this buffer with
+ * @dir    : data direction of the port (A3_P_I, A3_P_O, A3_P_IO, optionally
+ *          OR-ed with A3_P_CACHED)
+ * @nbanks : number of local memory banks used by the port
+ *
+ * Return : pointer to allocated memory on success, NULL otherwise
+ *
+ * NOTE   : zero-copy buffers are released with artico3_free()
+ * NOTE   : zero-copy buffers can only be mapped by the calling process
+ *
+ */
+void *artico3_alloc_zc(size_t size, const char *kname, const char *pname, enum a3pdir_t dir, unsigned int nbanks);
+
+
+/*
+ * ARTICo3 allocate zero-copy buffer memory (handle-based)
+ *
+ * @size   : amount of memory (in bytes) to be allocated for the buffer
+ * @kernel : handle of the hardware kernel to associate this buffer with
+ * @pname  : port name to associate this buffer with
+ * @dir    : data direction of the port (A3_P_I, A3_P_O, A3_P_IO)
+ * @nbanks : number of local memory banks used by the port
+ *
+ * Return : pointer to allocated memory on success, NULL otherwise
+ *
+ */
+void *artico3_alloc_zc_h(size_t size, int kernel, const char *pname, enum a3pdir_t dir, unsigned int nbanks);
+
+
+/*
+ * PORT VIEWS
+ *
+ * By default, the data of each work-group (lsize work items) is one
+ * contiguous block of each port buffer, and consecutive work-groups use
+ * consecutive blocks. Port views let the Daemon extract the data of each
+ * work-group from a tile of a row-major matrix instead (and store it back
+ * into the matrix, for outputs), so that block-decomposed kernels can use
+ * the matrices of the application without re-tiling them:
+ *
+ *     struct a3view_t view = {
+ *         .offset = 0,                  // first tile at the top-left corner
+ *         .stride = N,                  // N x N matrix (32-bit words)
+ *         .rows   = 64,                 // 64 x 64 tiles
+ *         .cols   = 64,
+ *         .ntiles = N / 64,             // tiles per row of tiles
+ *         .tstep  = 64,                 // next tile: 64 columns to the right
+ *         .gstep  = 64 * N,             // next row of tiles: 64 rows down
+ *     };
+ *     c = artico3_alloc(N * N * sizeof *c, "matmul", "c", A3_P_O);
+ *     artico3_port_view("matmul", "c", &view);
+ *     artico3_kernel_execute("matmul", (N / 64) * (N / 64) * 64, 64);
+ *
+ * Work-group t uses the tile that starts at word
+ *
+ *     offset + ((t % ntiles) * tstep) + ((t / ntiles) * gstep)
+ *
+ * and its data is the concatenation of the rows of the tile (rows * cols
+ * words, or a proportional number of rows in a partial last work-group).
+ * Steps can be 0, e.g. to feed the same tile of an input matrix to
+ * several work-groups. The Daemon checks that all the tiles of an
+ * execution lie inside the port buffer.
+ *
+ * Views are set on input, output and bidirectional I/O ports allocated
+ * with artico3_alloc() or artico3_alloc_typed() (offsets and sizes are
+ * expressed in words of hardware data), and are used by the executions
+ * started afterwards (they cannot be changed while the kernel is being
+ * executed). Ports with view cannot be used in streaming executions.
+ *
+ */
+
+/*
+ * ARTICo3 set port view
+ *
+ * @kname : hardware kernel name the port is associated with
+ * @pname : port name
+ * @view  : port view (NULL to remove the view)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_port_view(const char *kname, const char *pname, const struct a3view_t *view);
+
+
+/*
+ * ARTICo3 set port view (handle-based)
+ *
+ * @kernel : handle of the hardware kernel the port is associated with
+ * @pname  : port name
+ * @view   : port view (NULL to remove the view)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_port_view_h(int kernel, const char *pname, const struct a3view_t *view);
+
+
+/*
+ * KERNEL HANDLES
+ *
+ * artico3_kernel_create() returns an opaque kernel handle (> 0), which
+ * can be used instead of the kernel name in every runtime call (handle-based
+ * variants, with the _h suffix). The Daemon uses handles to access its
+ * kernel list directly, instead of comparing the kernel name against
+ * every entry in the list:
+ *
+ *     kernel = artico3_kernel_create("addvector", 16384, 3, 0);
+ *     artico3_load_h(kernel, 0, 0, 0, 0);
+ *     a = artico3_alloc_h(size, kernel, "a", A3_P_I);
+ *     ...
+ *     artico3_kernel_execute_h(kernel, gsize, lsize);
+ *     artico3_kernel_wait_h(kernel);
+ *
+ * Handles are not reused when a kernel is released and created again.
+ * Name-based calls are still supported: the handle is looked up in the
+ * topology published by the Daemon, without sending additional requests.
+ *
+ */
+
+/*
+ * ARTICo3 get kernel handle
+ *
+ * This function gets the handle of a kernel from its name.
+ *
+ * @name : hardware kernel name
+ *
+ * Return : kernel handle (> 0) on success, error code otherwise
+ *
+ */
+int artico3_kernel_get(const char *name);
+
+
+/*
+ * ARTICo3 handle-based kernel management (see the name-based versions)
+ *
+ * @kernel : hardware kernel handle
+ *
+ * Return : same as the name-based versions (-EINVAL if @kernel is not a
+ *          valid handle, -ENODEV if the kernel has been released)
+ *
+ */
+int artico3_load_h(int kernel, uint8_t slot, uint8_t tmr, uint8_t dmr, uint8_t force);
+int artico3_kernel_release_h(int kernel);
+int artico3_kernel_execute_h(int kernel, size_t gsize, size_t lsize);
+int artico3_kernel_wait_h(int kernel);
+int artico3_kernel_execute_async_h(int kernel, size_t gsize, size_t lsize);
+int artico3_kernel_reset_h(int kernel);
+int artico3_kernel_wcfg_h(int kernel, uint16_t offset, a3data_t *cfg);
+int artico3_kernel_rcfg_h(int kernel, uint16_t offset, a3data_t *cfg);
+int artico3_kernel_get_naccs_h(int kernel);
+int artico3_kernel_vcount_h(int kernel, int reg);
+void *artico3_alloc_h(size_t size, int kernel, const char *pname, enum a3pdir_t dir);
+int artico3_free_h(int kernel, const char *pname);
+
+
+/*
+ * BATCHED REQUESTS
+ *
+ * Runtime calls made between artico3_batch_begin() and artico3_batch_submit()
+ * are not sent to the Daemon right away. Instead, they are recorded by the
+ * calling thread and sent together in a single request, which removes the
+ * per-call round trip when setting up short-lived jobs:
+ *
+ *     artico3_batch_begin();
+ *     artico3_kernel_create("addvector", 16384, 3, 0);
+ *     artico3_load("addvector", 0, 0, 0, 0);
+ *     a = artico3_alloc(size, "addvector", "a", A3_P_I);
+ *     ...
+ *     artico3_kernel_execute("addvector", gsize, lsize);
+ *     artico3_kernel_wait("addvector");
+ *     ret = artico3_batch_submit(results, ncalls);
+ *
+ * While recording, runtime calls return 0 (or a valid pointer, in the case
+ * of artico3_alloc()) and their actual return values are reported by
+ * artico3_batch_submit() (e.g. the handles of the kernels created in the
+ * batch). Buffers returned by artico3_alloc() can be written right away,
+ * but they are only associated with the kernel once the batch has been
+ * submitted successfully. Calls made with the name-based API reference
+ * kernels by name while recording, since they might be created in the
+ * same batch.
+ *
+ * IMPORTANT: artico3_kernel_wcfg(), artico3_kernel_rcfg() and artico3_exit()
+ *            cannot be recorded (they return -EINVAL while recording).
+ *
+ */
+
+/*
+ * ARTICo3 begin batch
+ *
+ * This function starts recording the runtime calls made by the calling
+ * thread, so that they can be sent to the Daemon in a single request.
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_batch_begin();
+
+
+/*
+ * ARTICo3 submit batch
+ *
+ * This function stops recording runtime calls and sends them to the
+ * Daemon, which executes them in order. Execution stops at the first
+ * failing call (the remaining ones are canceled, -ECANCELED).
+ *
+ * @results : array to store the return value of each recorded call (can be NULL)
+ * @n       : number of elements in @results
+ *
+ * Return : 0 on success, error code of the first failing call otherwise
+ *
+ * NOTE : user-side effects of calls that were not executed successfully
+ *        (e.g. kernels created or buffers allocated) are reverted.
+ *
+ */
+int artico3_batch_submit(int *results, size_t n);
+
+
+/*
+ * REQUEST QUEUES
+ *
+ * Runtime calls made between artico3_queue_begin() and artico3_queue_end()
+ * return as soon as their requests are posted to the Daemon, so that a
+ * single thread can keep several independent requests in flight (e.g.
+ * loading, allocating buffers and executing different kernels) and reap
+ * their completions later, in any order:
+ *
+ *     artico3_queue_begin();
+ *     artico3_load("addvector", 0, 0, 0, 0);
+ *     tags[0] = artico3_queue_tag();
+ *     artico3_load("matmul", 1, 0, 0, 0);
+ *     tags[1] = artico3_queue_tag();
+ *     artico3_queue_end();
+ *     while ((tag = artico3_queue_reap(&ret)) > 0) {
+ *         ...
+ *     }
+ *
+ * Queued calls behave as calls recorded in a batch: they return 0 (or a
+ * valid pointer, in the case of artico3_alloc()), their actual return
+ * values are reported by artico3_queue_reap(), and their user-side effects
+ * are reverted if they fail. Calls that cannot be batched are executed
+ * synchronously, as usual.
+ *
+ * IMPORTANT: the Daemon handles queued requests concurrently, without any
+ *            ordering guarantee. Calls that depend on each other (e.g.
+ *            artico3_kernel_create() and artico3_load() of the same
+ *            kernel) have to be reaped before posting the dependent ones.
+ *            Queued requests keep their channel (and their input arguments
+ *            in the argument arena) until they are reaped.
+ *
+ */
+
+/*
+ * ARTICo3 begin request queue
+ *
+ * This function makes the runtime calls of the calling thread return as
+ * soon as their requests are posted, without waiting for the responses.
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_queue_begin();
+
+
+/*
+ * ARTICo3 end request queue
+ *
+ * This function makes the runtime calls of the calling thread wait for
+ * their responses again. Requests already posted can still be reaped.
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_queue_end();
+
+
+/*
+ * ARTICo3 get request tag
+ *
+ * Return : tag (> 0) of the last request posted by the calling thread,
+ *          0 if none
+ *
+ */
+int artico3_queue_tag();
+
+
+/*
+ * ARTICo3 reap request
+ *
+ * This function waits until any of the requests posted by the calling
+ * thread has completed, and gets its return value.
+ *
+ * @response : return value of the reaped runtime call (can be NULL)
+ *
+ * Return : tag of the reaped request on success, error code otherwise
+ *          (-ENOENT if there are no requests to be reaped)
+ *
+ */
+int artico3_queue_reap(int *response);
+
+
+/*
+ * ARTICo3 poll request
+ *
+ * This function gets the return value of any of the requests posted by
+ * the calling thread that has completed, without waiting.
+ *
+ * @response : return value of the reaped runtime call (can be NULL)
+ *
+ * Return : tag of the reaped request on success, error code otherwise
+ *          (-EAGAIN if none has completed, -ENOENT if there are no
+ *          requests to be reaped)
+ *
+ */
+int artico3_queue_poll(int *response);
+
+
+/*
+ * STREAMING EXECUTION
+ *
+ * Regular executions process gsize work items that have to be written in
+ * the ports beforehand. Streaming executions use the ports as ring buffers
+ * that hold the data of depth work items instead: the application
+ * appends work items to the input ports as they are produced, the Daemon
+ * launches a transfer as soon as there are enough of them to keep every
+ * accelerator busy (naccs * lsize work items), and the application reads
+ * the results from the output ports as soon as they are available. This
+ * bounds the latency of each work item, and the memory used by a
+ * continuous data flow:
+ *
+ *     a = artico3_alloc(depth * sizeof *a, "addvector", "a", A3_P_I);
+ *     b = artico3_alloc(depth * sizeof *b, "addvector", "b", A3_P_I);
+ *     c = artico3_alloc(depth * sizeof *c, "addvector", "c", A3_P_O);
+ *     stream = artico3_stream_start("addvector", depth, lsize);
+ *
+ *     // Producer
+ *     while (...) {
+ *         pos = artico3_stream_reserve(stream, n);
+ *         for (i = 0; i < n; i++) {
+ *             a[(pos + i) % depth] = ...;
+ *             b[(pos + i) % depth] = ...;
+ *         }
+ *         artico3_stream_push(stream, n);
+ *     }
+ *     artico3_stream_close(stream);
+ *
+ *     // Consumer
+ *     n = 1;
+ *     while (((pos = artico3_stream_fetch(stream, &n)) >= 0) && n) {
+ *         for (i = 0; i < n; i++) {
+ *             ... = c[(pos + i) % depth];
+ *         }
+ *         artico3_stream_release(stream, n);
+ *         n = 1;
+ *     }
+ *
+ *     artico3_stream_stop(stream);
+ *
+ * Work item i is stored at ring position (i % depth) in every port, i.e.
+ * ports have to hold the same amount of data per work item (their size
+ * has to be a multiple of depth words), and depth has to be a multiple of
+ * lsize. Constant memories are transferred as in regular executions.
+ * Partial transfers (kernels that declare a valid count register get the
+ * number of valid work items, see artico3_kernel_vcount()) are only
+ * launched when the stream is closed, or when the producer or the
+ * consumer would block otherwise, i.e. when they sleep waiting for
+ * pending work items to be processed.
+ *
+ * A stream has one producer thread and one consumer thread (which can be
+ * the same thread, as long as it does not reserve more work items than
+ * it has released). The kernel cannot be executed, or reconfigured with
+ * ports of different sizes, until the stream is stopped.
+ *
+ * IMPORTANT: ring-buffered ports are always copied by the Daemon, i.e.
+ *            zero-copy buffers cannot be used in streams, and streams
+ *            cannot be started in batches.
+ *
+ */
+
+/*
+ * ARTICo3 start streaming execution
+ *
+ * This function starts the streaming execution of an ARTICo3 kernel, in
+ * which the ports of the kernel are used as ring buffers that hold the
+ * data of @depth work items.
+ *
+ * @name  : name of the hardware kernel to execute
+ * @depth : number of work items held by the ring-buffered ports
+ * @lsize : local work size (work that can be done by one accelerator)
+ *
+ * Return : stream descriptor (>= 0) on success, error code otherwise
+ *
+ */
+int artico3_stream_start(const char *name, size_t depth, size_t lsize);
+
+
+/*
+ * ARTICo3 start streaming execution (handle-based)
+ *
+ * @kernel : handle of the hardware kernel to execute
+ * @depth  : number of work items held by the ring-buffered ports
+ * @lsize  : local work size (work that can be done by one accelerator)
+ *
+ * Return : stream descriptor (>= 0) on success, error code otherwise
+ *
+ */
+int artico3_stream_start_h(int kernel, size_t depth, size_t lsize);
+
+
+/*
+ * ARTICo3 reserve stream work items
+ *
+ * This function waits until there is room in the ring-buffered ports for
+ * @n work items (i.e. until the consumer has released enough of them).
+ *
+ * @stream : stream descriptor
+ * @n      : number of work items to be produced (up to the ring depth)
+ *
+ * Return : ring position of the first work item on success, error code
+ *          otherwise (-EPIPE if the stream has been closed or has failed)
+ *
+ */
+int artico3_stream_reserve(int stream, size_t n);
+
+
+/*
+ * ARTICo3 push stream work items
+ *
+ * This function hands @n work items, already written in the ring-buffered
+ * input ports, over to the Daemon.
+ *
+ * @stream : stream descriptor
+ * @n      : number of work items produced (previously reserved)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_stream_push(int stream, size_t n);
+
+
+/*
+ * ARTICo3 fetch stream work items
+ *
+ * This function waits until @n work items have been processed (i.e. their
+ * results are available in the ring-buffered output ports), or until the
+ * stream has finished.
+ *
+ * @stream : stream descriptor
+ * @n      : number of work items to wait for (up to the ring depth); on
+ *           return, number of work items available (more than requested,
+ *           or fewer if the stream has finished, 0 once it is drained)
+ *
+ * Return : ring position of the first work item on success, error code
+ *          otherwise (stream execution result if it has failed)
+ *
+ * NOTE   : @n should not exceed the work items the producer keeps in the
+ *          ring while waiting for room (it could block forever otherwise)
+ *
+ */
+int artico3_stream_fetch(int stream, size_t *n);
+
+
+/*
+ * ARTICo3 release stream work items
+ *
+ * This function makes the room used by @n work items, whose results have
+ * already been read from the ring-buffered output ports, available to the
+ * producer.
+ *
+ * @stream : stream descriptor
+ * @n      : number of work items consumed (previously fetched)
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_stream_release(int stream, size_t n);
+
+
+/*
+ * ARTICo3 close stream
+ *
+ * This function notifies the Daemon that no more work items will be
+ * produced, so that the pending ones are processed even if they do not
+ * keep every accelerator busy. Processed work items can still be fetched.
+ *
+ * @stream : stream descriptor
+ *
+ * Return : 0 on success, error code otherwise
+ *
+ */
+int artico3_stream_close(int stream);
+
+
+/*
+ * ARTICo3 stop stream
+ *
+ * This function closes a stream (if not closed yet), waits until every
+ * work item has been processed, and releases the stream. Results that
+ * have not been fetched yet are discarded.
+ *
+ * @stream : stream descriptor
+ *
+ * Return : stream execution result (0 on success), error code otherwise
+ *
+ */
+int artico3_stream_stop(int stream);
+
+
 /*
  * ARTICo3 data reinterpretation: float to a3data_t (32 bits)
  *
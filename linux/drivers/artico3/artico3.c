@@ -8,14 +8,19 @@
  *     - Platform driver + character device
  *     - mmap()  : provides 1) zero-copy memory allocation (direct access
  *                 from user-space virtual memory to physical memory) for
- *                 data transfers using a DMA engine, and 2) direct access
- *                 to ARTICo³ configuration registers in the FPGA
+ *                 data transfers using a DMA engine, 2) direct access
+ *                 to ARTICo³ configuration registers in the FPGA, and 3)
+ *                 DMA memory regions shared between processes (by key)
  *     - ioctl() : enables command passing between user-space and
  *                 character device (e.g., to start DMA transfers)
  *     - poll()  : enables passive (i.e., sleep-based) waiting capabilities
  *                 for 1) DMA interrupts, and 2) ARTICo³ interrupts
  *     - [DMA] Targets memcpy operations (requires src and dst addresses)
  *     - [DMA] Relies on Device Tree (Open Firmware) to get DMA engine info
+ *     - [DMA] Supports several DMA channels (one per "dma-names" entry),
+ *             with independent completion tracking per channel
+ *     - [DMA] Supports coherent (uncached on ARM) and cached DMA memory
+ *             regions, the latter with explicit cache maintenance (ioctl)
  *
  */
 
@@ -74,22 +79,50 @@ struct artico3_hw {
     uint32_t readymask[ARTICo3_MAX_ID]; // Expected ready register values per kernel ID
 };
 
+// DMA channel states
+enum artico3_dma_state {
+    ARTICo3_DMA_IDLE,    // No transfer pending
+    ARTICo3_DMA_CLAIMED, // Channel claimed in ioctl(), transfer being set up
+    ARTICo3_DMA_RUNNING, // Transfer submitted, completion not reported yet
+};
+
+// DMA channel information
+struct artico3_dma {
+    struct dma_chan *chan;        // DMA channel
+    dma_cookie_t cookie;          // Last submitted transfer
+    enum artico3_dma_state state; // Channel state (protected by device spinlock)
+};
+
 // Custom device structure (DMA proxy device)
 struct artico3_device {
     dev_t devt;
     struct cdev cdev;
     struct device *dev;
     struct platform_device *pdev;
-    struct dma_chan *chan;
-    dma_cookie_t cookie;
+    struct artico3_dma dma[ARTICo3_DMA_MAXCHANS];
+    unsigned int nchans;
     struct mutex mutex;
     struct list_head head;
+    struct list_head shared;
     spinlock_t lock;
     wait_queue_head_t queue;
     unsigned int irq;
     struct artico3_hw hw;
 };
 
+// Custom data structure to store shared memory regions (one per key)
+struct artico3_shared {
+    unsigned long key;
+    void *addr_ker;
+    dma_addr_t addr_phy;
+    size_t size;
+    int cached;
+    unsigned int refs;
+    pid_t owner;
+    pid_t pid;
+    struct list_head list;
+};
+
 // Custom data structure to store allocated memory regions
 struct artico3_vm_list {
     struct artico3_device *artico3_dev;
@@ -97,7 +130,9 @@ struct artico3_vm_list {
     void *addr_ker;
     dma_addr_t addr_phy;
     size_t size;
+    int cached;
     pid_t pid;
+    struct artico3_shared *shared;
     struct list_head list;
 };
 
@@ -147,6 +182,122 @@ static irqreturn_t artico3_isr(unsigned int irq, void *data) {
 
 /* DMA MANAGEMENT */
 
+// Compute expected ready value for a kernel ID (accelerators started by a DMA transfer)
+static void artico3_readymask(struct artico3_device *artico3_dev, unsigned int id) {
+    uint64_t id_reg;
+    unsigned int i;
+
+    // Get current ID register
+    id_reg = (uint64_t)ioread32(artico3_dev->hw.regs + ARTICo3_ID_REG_HIGH) << 32 | (uint64_t)ioread32(artico3_dev->hw.regs + ARTICo3_ID_REG_LOW);
+    // Compute expected ready value
+    artico3_dev->hw.ready[id - 1] = 0x00000000;
+    artico3_dev->hw.readymask[id - 1] = 0x00000000;
+    i = 0;
+    while (id_reg) {
+        if ((id_reg & 0xf) == id) artico3_dev->hw.readymask[id - 1] |= 0x1 << i;
+        i++;
+        id_reg >>= 4;
+    }
+}
+
+// Search DMA memory region mapped by the current process
+// (has to be called with the device mutex locked)
+static struct artico3_vm_list *artico3_dma_region(struct artico3_device *artico3_dev, void *memaddr) {
+    struct artico3_vm_list *vm_list;
+
+    list_for_each_entry(vm_list, &artico3_dev->head, list) {
+        if ((vm_list->pid == current->tgid) && (vm_list->addr_usr == memaddr)) return vm_list;
+    }
+    return NULL;
+}
+
+// Search shared DMA memory region by key
+// (has to be called with the device mutex locked)
+static struct artico3_shared *artico3_shared_region(struct artico3_device *artico3_dev, unsigned long key) {
+    struct artico3_shared *shared;
+
+    list_for_each_entry(shared, &artico3_dev->shared, list) {
+        if (shared->key == key) return shared;
+    }
+    return NULL;
+}
+
+// Check whether a DMA channel is idle, reporting the completion of its
+// last transfer (has to be called with the device spinlock held)
+//
+// NOTE: this implementation does not consider errors in the data
+//       transfers.  If the callback is executed, it is assumed
+//       that the following check will always render DMA_COMPLETE.
+static int artico3_dma_idle(struct artico3_device *artico3_dev, unsigned int ch) {
+    struct artico3_dma *dma = &artico3_dev->dma[ch];
+
+    if (dma->state == ARTICo3_DMA_RUNNING) {
+        if (dma_async_is_tx_complete(dma->chan, dma->cookie, NULL, NULL) != DMA_COMPLETE) return 0;
+        dma->state = ARTICo3_DMA_IDLE;
+    }
+    return dma->state == ARTICo3_DMA_IDLE;
+}
+
+// Check whether a DMA channel is idle (takes the device spinlock)
+static int artico3_dma_idle_locked(struct artico3_device *artico3_dev, unsigned int ch) {
+    unsigned long flags;
+    int idle;
+
+    spin_lock_irqsave(&artico3_dev->lock, flags);
+    idle = artico3_dma_idle(artico3_dev, ch);
+    spin_unlock_irqrestore(&artico3_dev->lock, flags);
+    return idle;
+}
+
+// Check whether a DMA channel has no transfer in flight (takes the device spinlock)
+static int artico3_dma_quiet(struct artico3_device *artico3_dev, unsigned int ch) {
+    unsigned long flags;
+    int quiet;
+
+    spin_lock_irqsave(&artico3_dev->lock, flags);
+    artico3_dma_idle(artico3_dev, ch);
+    quiet = artico3_dev->dma[ch].state != ARTICo3_DMA_RUNNING;
+    spin_unlock_irqrestore(&artico3_dev->lock, flags);
+    return quiet;
+}
+
+// Claim DMA channel (waits for the completion of its previous transfer,
+// transfers in different channels are independent)
+static int artico3_dma_claim(struct artico3_device *artico3_dev, unsigned int ch) {
+    unsigned long flags;
+    int res, claimed;
+
+    while (1) {
+        res = wait_event_interruptible(artico3_dev->queue, artico3_dma_idle_locked(artico3_dev, ch));
+        if (res) return res;
+        spin_lock_irqsave(&artico3_dev->lock, flags);
+            claimed = artico3_dma_idle(artico3_dev, ch);
+            if (claimed) artico3_dev->dma[ch].state = ARTICo3_DMA_CLAIMED;
+        spin_unlock_irqrestore(&artico3_dev->lock, flags);
+        if (claimed) return 0;
+    }
+}
+
+// Track submitted transfer in a claimed DMA channel
+static void artico3_dma_submitted(struct artico3_device *artico3_dev, unsigned int ch, dma_cookie_t cookie) {
+    unsigned long flags;
+
+    spin_lock_irqsave(&artico3_dev->lock, flags);
+        artico3_dev->dma[ch].cookie = cookie;
+        artico3_dev->dma[ch].state = ARTICo3_DMA_RUNNING;
+    spin_unlock_irqrestore(&artico3_dev->lock, flags);
+}
+
+// Release claimed DMA channel if no transfer was submitted
+static void artico3_dma_abort(struct artico3_device *artico3_dev, unsigned int ch) {
+    unsigned long flags;
+
+    spin_lock_irqsave(&artico3_dev->lock, flags);
+        if (artico3_dev->dma[ch].state == ARTICo3_DMA_CLAIMED) artico3_dev->dma[ch].state = ARTICo3_DMA_IDLE;
+    spin_unlock_irqrestore(&artico3_dev->lock, flags);
+    wake_up(&artico3_dev->queue);
+}
+
 // DMA asynchronous callback function
 static void artico3_dma_callback(void *data) {
     struct artico3_device *artico3_dev = data;
@@ -159,14 +310,17 @@ static void artico3_dma_callback(void *data) {
     dev_info(artico3_dev->dev, "[+] artico3_dma_callback()");
 }
 
-// DMA transfer function
-static int artico3_dma_transfer(struct artico3_device *artico3_dev, dma_addr_t dst, dma_addr_t src, size_t len) {
-    struct dma_device *dma_dev = artico3_dev->chan->device;
+// DMA transfer function (the channel has to be claimed by the caller)
+static int artico3_dma_transfer(struct artico3_device *artico3_dev, unsigned int ch, dma_addr_t dst, dma_addr_t src, size_t len) {
+    struct artico3_dma *dma = &artico3_dev->dma[ch];
+    struct dma_device *dma_dev = dma->chan->device;
     struct dma_async_tx_descriptor *tx = NULL;
     enum dma_ctrl_flags flags = DMA_CTRL_ACK | DMA_PREP_INTERRUPT;
+    dma_cookie_t cookie;
     int res = 0;
 
     dev_info(dma_dev->dev, "[ ] DMA transfer");
+    dev_info(dma_dev->dev, "[i] DMA channel         = %u", ch);
     dev_info(dma_dev->dev, "[i] source address      = %p", (void *)src);
     dev_info(dma_dev->dev, "[i] destination address = %p", (void *)dst);
     dev_info(dma_dev->dev, "[i] transfer length     = %d bytes", len);
@@ -174,7 +328,7 @@ static int artico3_dma_transfer(struct artico3_device *artico3_dev, dma_addr_t d
 
     // Initialize asynchronous DMA descriptor
     dev_info(dma_dev->dev, "[ ] device_prep_dma_memcpy()");
-    tx = dma_dev->device_prep_dma_memcpy(artico3_dev->chan, dst, src, len, flags);
+    tx = dma_dev->device_prep_dma_memcpy(dma->chan, dst, src, len, flags);
     if (!tx) {
         dev_err(dma_dev->dev, "[X] device_prep_dma_memcpy()");
         res = -ENOMEM;
@@ -188,16 +342,17 @@ static int artico3_dma_transfer(struct artico3_device *artico3_dev, dma_addr_t d
 
     // Submit DMA transfer
     dev_info(dma_dev->dev, "[ ] dmaengine_submit()");
-    artico3_dev->cookie = dmaengine_submit(tx);
-    res = dma_submit_error(artico3_dev->cookie);
+    cookie = dmaengine_submit(tx);
+    res = dma_submit_error(cookie);
     if (res) {
         dev_err(dma_dev->dev, "[X] dmaengine_submit()");
         goto err_cookie;
     }
     dev_info(dma_dev->dev, "[+] dmaengine_submit()");
 
-    // Start pending transfers
-    dma_async_issue_pending(artico3_dev->chan);
+    // Start pending transfers (completion is tracked per channel)
+    artico3_dma_submitted(artico3_dev, ch, cookie);
+    dma_async_issue_pending(dma->chan);
 
 err_cookie:
     // Free descriptors
@@ -208,9 +363,137 @@ err_tx:
     return res;
 }
 
+// DMA scatter-gather transfer function (one memcpy descriptor per segment,
+// chained in the DMA channel and completed with a single callback, the
+// channel has to be claimed by the caller)
+static int artico3_dma_transfer_sg(struct artico3_device *artico3_dev, struct dmaproxy_sg_token *sg_token, int mem2hw) {
+    struct artico3_dma *dma = &artico3_dev->dma[sg_token->channel];
+    struct dma_device *dma_dev = dma->chan->device;
+    struct dma_async_tx_descriptor **tx = NULL;
+    struct dmaproxy_segment *segs = NULL;
+    struct artico3_vm_list *vm_list = NULL;
+    struct resource *rsrc;
+    resource_size_t address, size;
+    dma_addr_t mem, hw;
+    dma_cookie_t cookie = 0;
+    enum dma_ctrl_flags flags;
+    size_t i;
+    int res = 0;
+
+    dev_info(dma_dev->dev, "[ ] DMA transfer (scatter-gather)");
+    dev_info(dma_dev->dev, "[i] DMA channel         = %u", sg_token->channel);
+    dev_info(dma_dev->dev, "[i] number of segments  = %zd", sg_token->nsegs);
+
+    // Copy segments from user
+    segs = kmalloc_array(sg_token->nsegs, sizeof *segs, GFP_KERNEL);
+    if (!segs) {
+        dev_err(artico3_dev->dev, "[X] kmalloc_array() -> segs");
+        res = -ENOMEM;
+        goto err_kmalloc_segs;
+    }
+    if (copy_from_user(segs, sg_token->segs, sg_token->nsegs * sizeof *segs)) {
+        dev_err(artico3_dev->dev, "[X] copy_from_user() -> segs");
+        res = -ENOMEM;
+        goto err_kmalloc_tx;
+    }
+    tx = kcalloc(sg_token->nsegs, sizeof *tx, GFP_KERNEL);
+    if (!tx) {
+        dev_err(artico3_dev->dev, "[X] kcalloc() -> tx");
+        res = -ENOMEM;
+        goto err_kmalloc_tx;
+    }
+
+    // Get memory map base address and size
+    rsrc = platform_get_resource_byname(artico3_dev->pdev, IORESOURCE_MEM, "data");
+    address = rsrc->start;
+    size = rsrc->end - rsrc->start + 1;
+    if ((void *)address != sg_token->hwaddr) {
+        dev_err(artico3_dev->dev, "[X] DMA Slave -> hardware address does not match");
+        res = -EINVAL;
+        goto err_tx;
+    }
+
+    // Initialize asynchronous DMA descriptors
+    for (i = 0; i < sg_token->nsegs; i++) {
+        // Search if the requested memory region is allocated
+        vm_list = artico3_dma_region(artico3_dev, segs[i].memaddr);
+        if (!vm_list) {
+            dev_err(artico3_dev->dev, "[X] DMA -> segment %zd memory region not found", i);
+            res = -EINVAL;
+            goto err_tx;
+        }
+        // Memory check
+        if (vm_list->size < (segs[i].memoff + segs[i].size)) {
+            dev_err(artico3_dev->dev, "[X] DMA -> requested transfer out of memory region");
+            res = -EINVAL;
+            goto err_tx;
+        }
+        // Hardware check
+        if (size < (segs[i].hwoff + segs[i].size)) {
+            dev_err(artico3_dev->dev, "[X] DMA Slave -> requested transfer out of hardware region");
+            res = -EINVAL;
+            goto err_tx;
+        }
+        // Kernel ID check (the ready mask is computed for a single kernel ID)
+        if (((segs[i].hwoff >> 16) & 0xf) != ((segs[0].hwoff >> 16) & 0xf)) {
+            dev_err(artico3_dev->dev, "[X] DMA Slave -> segment %zd addresses a different kernel ID", i);
+            res = -EINVAL;
+            goto err_tx;
+        }
+        mem = vm_list->addr_phy + segs[i].memoff;
+        hw = address + segs[i].hwoff;
+        // Only the last descriptor generates an interrupt
+        flags = DMA_CTRL_ACK | ((i == (sg_token->nsegs - 1)) ? DMA_PREP_INTERRUPT : 0);
+        tx[i] = dma_dev->device_prep_dma_memcpy(dma->chan, mem2hw ? hw : mem, mem2hw ? mem : hw, segs[i].size, flags);
+        if (!tx[i]) {
+            dev_err(dma_dev->dev, "[X] device_prep_dma_memcpy() -> segment %zd", i);
+            res = -ENOMEM;
+            goto err_tx;
+        }
+    }
+
+    // Compute expected ready value (transfers to hardware start the accelerators)
+    if (mem2hw) {
+        artico3_readymask(artico3_dev, (segs[0].hwoff >> 16) & 0xf);
+    }
+
+    // Set asynchronous DMA transfer callback (last descriptor)
+    tx[sg_token->nsegs - 1]->callback = artico3_dma_callback;
+    tx[sg_token->nsegs - 1]->callback_param = artico3_dev;
+
+    // Submit DMA transfers
+    for (i = 0; i < sg_token->nsegs; i++) {
+        cookie = dmaengine_submit(tx[i]);
+        res = dma_submit_error(cookie);
+        if (res) {
+            dev_err(dma_dev->dev, "[X] dmaengine_submit() -> segment %zd", i);
+            dmaengine_terminate_sync(dma->chan);
+            goto err_tx;
+        }
+    }
+
+    // Start pending transfers (completion is tracked per channel)
+    artico3_dma_submitted(artico3_dev, sg_token->channel, cookie);
+    dma_async_issue_pending(dma->chan);
+
+err_tx:
+    // Free descriptors
+    for (i = 0; i < sg_token->nsegs; i++) {
+        if (tx[i]) dmaengine_desc_free(tx[i]);
+    }
+    kfree(tx);
+
+err_kmalloc_tx:
+    kfree(segs);
+
+err_kmalloc_segs:
+    dev_info(dma_dev->dev, "[+] DMA transfer (scatter-gather)");
+    return res;
+}
+
 // Set up DMA subsystem
 static int artico3_dma_init(struct platform_device *pdev) {
-    int res;
+    int res, nchans, ch;
     struct dma_chan *chan = NULL;
     const char *chan_name = ""; // e.g. "ps-dma"
 
@@ -222,41 +505,67 @@ static int artico3_dma_init(struct platform_device *pdev) {
 
     dev_info(&pdev->dev, "[ ] artico3_dma_init()");
 
-    // Read DMA channel info from device tree (only the first occurrence is used)
-    dev_info(&pdev->dev, "[ ] of_property_read_string()");
-    res = of_property_read_string(node, "dma-names", &chan_name);
-    //~ res = of_property_read_string_index(node, "dma-names", of_index, &chan_name);
-    if (res) {
-        dev_err(&pdev->dev, "[X] of_property_read_string()");
-        return res;
+    // Get number of DMA channels from device tree (one per "dma-names" entry)
+    nchans = of_property_count_strings(node, "dma-names");
+    if (nchans <= 0) {
+        dev_err(&pdev->dev, "[X] of_property_count_strings()");
+        return nchans ? nchans : -ENODEV;
     }
-    dev_info(&pdev->dev, "[+] of_property_read_string() -> %s", chan_name);
-
-    // Request DMA channel
-    dev_info(&pdev->dev, "[ ] dma_request_slave_channel()");
-    chan = dma_request_slave_channel(&pdev->dev, chan_name);
-    if (IS_ERR(chan) || (!chan)) {
-        dev_err(&pdev->dev, "[X] dma_request_slave_channel()");
-        //return PTR_ERR(chan);
-        return -EBUSY;
+    if (nchans > ARTICo3_DMA_MAXCHANS) {
+        dev_info(&pdev->dev, "[i] only %d DMA channels are used", ARTICo3_DMA_MAXCHANS);
+        nchans = ARTICo3_DMA_MAXCHANS;
     }
-    dev_info(&pdev->dev, "[+] dma_request_slave_channel() -> %s", chan_name);
-    dev_info(chan->device->dev, "[i] dma_request_slave_channel()");
 
-    artico3_dev->chan = chan;
+    for (ch = 0; ch < nchans; ch++) {
+
+        // Read DMA channel info from device tree
+        dev_info(&pdev->dev, "[ ] of_property_read_string_index()");
+        res = of_property_read_string_index(node, "dma-names", ch, &chan_name);
+        if (res) {
+            dev_err(&pdev->dev, "[X] of_property_read_string_index()");
+            goto err_chan;
+        }
+        dev_info(&pdev->dev, "[+] of_property_read_string_index() -> %s", chan_name);
+
+        // Request DMA channel
+        dev_info(&pdev->dev, "[ ] dma_request_slave_channel()");
+        chan = dma_request_slave_channel(&pdev->dev, chan_name);
+        if (IS_ERR(chan) || (!chan)) {
+            dev_err(&pdev->dev, "[X] dma_request_slave_channel()");
+            //res = PTR_ERR(chan);
+            res = -EBUSY;
+            goto err_chan;
+        }
+        dev_info(&pdev->dev, "[+] dma_request_slave_channel() -> %s", chan_name);
+        dev_info(chan->device->dev, "[i] dma_request_slave_channel()");
+
+        artico3_dev->dma[ch].chan = chan;
+        artico3_dev->dma[ch].cookie = 0;
+        artico3_dev->dma[ch].state = ARTICo3_DMA_IDLE;
+    }
+    artico3_dev->nchans = nchans;
 
     dev_info(&pdev->dev, "[+] artico3_dma_init()");
     return 0;
+
+err_chan:
+    while (ch--) {
+        dma_release_channel(artico3_dev->dma[ch].chan);
+    }
+    return res;
 }
 
 // Clean up DMA subsystem
 static void artico3_dma_exit(struct platform_device *pdev) {
+    unsigned int ch;
 
     // Retrieve custom device info using platform device (private data)
     struct artico3_device *artico3_dev = platform_get_drvdata(pdev);
 
     dev_info(&pdev->dev, "[ ] artico3_dma_exit()");
-    dma_release_channel(artico3_dev->chan);
+    for (ch = 0; ch < artico3_dev->nchans; ch++) {
+        dma_release_channel(artico3_dev->dma[ch].chan);
+    }
     dev_info(&pdev->dev, "[+] artico3_dma_exit()");
 }
 
@@ -286,13 +595,16 @@ static long artico3_ioctl(struct file *fp, unsigned int cmd, unsigned long arg)
     struct artico3_device *artico3_dev = fp->private_data;
     struct artico3_vm_list *vm_list, *backup;
     struct dmaproxy_token token;
+    struct dmaproxy_sg_token sg_token;
+    struct dmaproxy_sync_token sync_token;
+    struct dmaproxy_share_token share_token;
+    struct artico3_shared *shared;
     struct platform_device *pdev = artico3_dev->pdev;
     resource_size_t address, size;
+    unsigned int ch;
     int res;
     int retval = 0;
     struct resource *rsrc;
-    uint64_t id_reg;
-    unsigned int i;
 
     dev_info(artico3_dev->dev, "[ ] ioctl()");
     dev_info(artico3_dev->dev, "[i] ioctl() -> magic   = '%c'", _IOC_TYPE(cmd));
@@ -315,9 +627,6 @@ static long artico3_ioctl(struct file *fp, unsigned int cmd, unsigned long arg)
 
         case ARTICo3_IOC_DMA_MEM2HW:
 
-            // Lock mutex (released in artico3_poll() after DMA transfer)
-            mutex_lock(&artico3_dev->mutex);
-
             // Copy data from user
             dev_info(artico3_dev->dev, "[ ] copy_from_user()");
             res = copy_from_user(&token, (void *)arg, sizeof token);
@@ -328,34 +637,38 @@ static long artico3_ioctl(struct file *fp, unsigned int cmd, unsigned long arg)
             dev_info(artico3_dev->dev, "[+] copy_from_user() -> token");
 
             dev_info(artico3_dev->dev, "[i] DMA from memory to hardware");
+            dev_info(artico3_dev->dev, "[i] DMA -> channel          = %u", token.channel);
             dev_info(artico3_dev->dev, "[i] DMA -> memory address   = %p", token.memaddr);
             dev_info(artico3_dev->dev, "[i] DMA -> memory offset    = %p", (void *)token.memoff);
             dev_info(artico3_dev->dev, "[i] DMA -> hardware address = %p", token.hwaddr);
             dev_info(artico3_dev->dev, "[i] DMA -> hardware offset  = %p", (void *)token.hwoff);
             dev_info(artico3_dev->dev, "[i] DMA -> transfer size    = %d bytes", token.size);
 
+            // Channel check
+            if (token.channel >= artico3_dev->nchans) {
+                dev_err(artico3_dev->dev, "[X] DMA -> channel does not exist");
+                retval = -EINVAL;
+                break;
+            }
+
+            // Claim DMA channel (released in artico3_poll() or ARTICo3_IOC_DMA_WAIT after DMA transfer)
+            retval = artico3_dma_claim(artico3_dev, token.channel);
+            if (retval) break;
+
             // Transfers to constant input memories (transfer size is 0)
             if (token.size == 0) {
-                // Get current ID register
-                id_reg = (uint64_t)ioread32(artico3_dev->hw.regs + ARTICo3_ID_REG_HIGH) << 32 | (uint64_t)ioread32(artico3_dev->hw.regs + ARTICo3_ID_REG_LOW);
                 // Compute expected ready value
-                artico3_dev->hw.ready[((token.hwoff >> 16) & 0xf) - 1] = 0x00000000;
-                artico3_dev->hw.readymask[((token.hwoff >> 16) & 0xf) - 1] = 0x00000000;
-                i = 0;
-                while (id_reg) {
-                    if ((id_reg  & 0xf) == ((token.hwoff >> 16) & 0xf)) artico3_dev->hw.readymask[((token.hwoff >> 16) & 0xf) - 1] |= 0x1 << i;
-                    i++;
-                    id_reg >>= 4;
-                }
-                // Early release of mutex (this is not an actual transfer)
-                mutex_unlock(&artico3_dev->mutex);
+                artico3_readymask(artico3_dev, (token.hwoff >> 16) & 0xf);
+                // Early release of DMA channel (this is not an actual transfer)
+                artico3_dma_abort(artico3_dev, token.channel);
                 // Exit ioctl()
                 break;
             }
 
-            // Search if the requested memory region is allocated
+            // Critical section: search if the requested memory region is allocated
+            mutex_lock(&artico3_dev->mutex);
             list_for_each_entry_safe(vm_list, backup, &artico3_dev->head, list) {
-                if ((vm_list->pid == current->pid) && (vm_list->addr_usr == token.memaddr)) {
+                if ((vm_list->pid == current->tgid) && (vm_list->addr_usr == token.memaddr)) {
                     // Memory check
                     if (vm_list->size < (token.memoff + token.size)) {
                         dev_err(artico3_dev->dev, "[X] DMA -> requested transfer out of memory region");
@@ -383,30 +696,22 @@ static long artico3_ioctl(struct file *fp, unsigned int cmd, unsigned long arg)
                         retval = -EINVAL;
                         break;
                     }
-                    // Get current ID register
-                    id_reg = (uint64_t)ioread32(artico3_dev->hw.regs + ARTICo3_ID_REG_HIGH) << 32 | (uint64_t)ioread32(artico3_dev->hw.regs + ARTICo3_ID_REG_LOW);
                     // Compute expected ready value
-                    artico3_dev->hw.ready[((token.hwoff >> 16) & 0xf) - 1] = 0x00000000;
-                    artico3_dev->hw.readymask[((token.hwoff >> 16) & 0xf) - 1] = 0x00000000;
-                    i = 0;
-                    while (id_reg) {
-                        if ((id_reg  & 0xf) == ((token.hwoff >> 16) & 0xf)) artico3_dev->hw.readymask[((token.hwoff >> 16) & 0xf) - 1] |= 0x1 << i;
-                        i++;
-                        id_reg >>= 4;
-                    }
+                    artico3_readymask(artico3_dev, (token.hwoff >> 16) & 0xf);
                     // Perform transfer
-                    retval = artico3_dma_transfer(artico3_dev, address + token.hwoff, vm_list->addr_phy + token.memoff, token.size);
+                    retval = artico3_dma_transfer(artico3_dev, token.channel, address + token.hwoff, vm_list->addr_phy + token.memoff, token.size);
                     break;
                 }
             }
+            mutex_unlock(&artico3_dev->mutex);
+
+            // Release DMA channel if no transfer was submitted
+            artico3_dma_abort(artico3_dev, token.channel);
 
             break;
 
         case ARTICo3_IOC_DMA_HW2MEM:
 
-            // Lock mutex (released in artico3_poll() after DMA transfer)
-            mutex_lock(&artico3_dev->mutex);
-
             // Copy data from user
             dev_info(artico3_dev->dev, "[ ] copy_from_user()");
             res = copy_from_user(&token, (void *)arg, sizeof token);
@@ -417,15 +722,28 @@ static long artico3_ioctl(struct file *fp, unsigned int cmd, unsigned long arg)
             dev_info(artico3_dev->dev, "[+] copy_from_user() -> token");
 
             dev_info(artico3_dev->dev, "[i] DMA from hardware to memory");
+            dev_info(artico3_dev->dev, "[i] DMA -> channel          = %u", token.channel);
             dev_info(artico3_dev->dev, "[i] DMA -> memory address   = %p", token.memaddr);
             dev_info(artico3_dev->dev, "[i] DMA -> memory offset    = %p", (void *)token.memoff);
             dev_info(artico3_dev->dev, "[i] DMA -> hardware address = %p", token.hwaddr);
             dev_info(artico3_dev->dev, "[i] DMA -> hardware offset  = %p", (void *)token.hwoff);
             dev_info(artico3_dev->dev, "[i] DMA -> transfer size    = %d bytes", token.size);
 
-            // Search if the requested memory region is allocated
+            // Channel check
+            if (token.channel >= artico3_dev->nchans) {
+                dev_err(artico3_dev->dev, "[X] DMA -> channel does not exist");
+                retval = -EINVAL;
+                break;
+            }
+
+            // Claim DMA channel (released in artico3_poll() or ARTICo3_IOC_DMA_WAIT after DMA transfer)
+            retval = artico3_dma_claim(artico3_dev, token.channel);
+            if (retval) break;
+
+            // Critical section: search if the requested memory region is allocated
+            mutex_lock(&artico3_dev->mutex);
             list_for_each_entry_safe(vm_list, backup, &artico3_dev->head, list) {
-                if ((vm_list->pid == current->pid) && (vm_list->addr_usr == token.memaddr)) {
+                if ((vm_list->pid == current->tgid) && (vm_list->addr_usr == token.memaddr)) {
                     // Memory check
                     if (vm_list->size < (token.memoff + token.size)) {
                         dev_err(artico3_dev->dev, "[X] DMA -> requested transfer out of memory region");
@@ -454,13 +772,190 @@ static long artico3_ioctl(struct file *fp, unsigned int cmd, unsigned long arg)
                         break;
                     }
                     // Perform transfer
-                    retval = artico3_dma_transfer(artico3_dev, vm_list->addr_phy + token.memoff, address + token.hwoff, token.size);
+                    retval = artico3_dma_transfer(artico3_dev, token.channel, vm_list->addr_phy + token.memoff, address + token.hwoff, token.size);
                     break;
                 }
             }
+            mutex_unlock(&artico3_dev->mutex);
+
+            // Release DMA channel if no transfer was submitted
+            artico3_dma_abort(artico3_dev, token.channel);
 
             break;
 
+        case ARTICo3_IOC_DMA_MEM2HW_SG:
+        case ARTICo3_IOC_DMA_HW2MEM_SG:
+
+            // Copy data from user
+            dev_info(artico3_dev->dev, "[ ] copy_from_user()");
+            res = copy_from_user(&sg_token, (void *)arg, sizeof sg_token);
+            if (res) {
+                dev_err(artico3_dev->dev, "[X] copy_from_user()");
+                return -ENOMEM;
+            }
+            dev_info(artico3_dev->dev, "[+] copy_from_user() -> sg_token");
+
+            dev_info(artico3_dev->dev, "[i] DMA %s (scatter-gather)", (cmd == ARTICo3_IOC_DMA_MEM2HW_SG) ? "from memory to hardware" : "from hardware to memory");
+
+            // Segment count check
+            if ((sg_token.nsegs == 0) || (sg_token.nsegs > ARTICo3_DMA_MAXSEGS)) {
+                dev_err(artico3_dev->dev, "[X] DMA -> invalid number of segments");
+                retval = -EINVAL;
+                break;
+            }
+
+            // Channel check
+            if (sg_token.channel >= artico3_dev->nchans) {
+                dev_err(artico3_dev->dev, "[X] DMA -> channel does not exist");
+                retval = -EINVAL;
+                break;
+            }
+
+            // Claim DMA channel (released in artico3_poll() or ARTICo3_IOC_DMA_WAIT after DMA transfer)
+            retval = artico3_dma_claim(artico3_dev, sg_token.channel);
+            if (retval) break;
+
+            // Perform transfer (critical section: memory regions are searched)
+            mutex_lock(&artico3_dev->mutex);
+            retval = artico3_dma_transfer_sg(artico3_dev, &sg_token, cmd == ARTICo3_IOC_DMA_MEM2HW_SG);
+            mutex_unlock(&artico3_dev->mutex);
+
+            // Release DMA channel if no transfer was submitted
+            artico3_dma_abort(artico3_dev, sg_token.channel);
+            break;
+
+        case ARTICo3_IOC_DMA_WAIT:
+
+            // Copy data from user
+            dev_info(artico3_dev->dev, "[ ] copy_from_user()");
+            res = copy_from_user(&ch, (void *)arg, sizeof ch);
+            if (res) {
+                dev_err(artico3_dev->dev, "[X] copy_from_user()");
+                return -ENOMEM;
+            }
+            dev_info(artico3_dev->dev, "[+] copy_from_user() -> channel");
+
+            // Channel check
+            if (ch >= artico3_dev->nchans) {
+                dev_err(artico3_dev->dev, "[X] DMA -> channel does not exist");
+                retval = -EINVAL;
+                break;
+            }
+
+            // Wait for DMA transfer to finish (transfers in other channels are not affected)
+            retval = wait_event_interruptible(artico3_dev->queue, artico3_dma_idle_locked(artico3_dev, ch));
+            break;
+
+        case ARTICo3_IOC_DMA_SYNC_DEV:
+        case ARTICo3_IOC_DMA_SYNC_CPU:
+
+            // Copy data from user
+            dev_info(artico3_dev->dev, "[ ] copy_from_user()");
+            res = copy_from_user(&sync_token, (void *)arg, sizeof sync_token);
+            if (res) {
+                dev_err(artico3_dev->dev, "[X] copy_from_user()");
+                return -ENOMEM;
+            }
+            dev_info(artico3_dev->dev, "[+] copy_from_user() -> sync_token");
+
+            dev_info(artico3_dev->dev, "[i] DMA sync for %s", (cmd == ARTICo3_IOC_DMA_SYNC_DEV) ? "device" : "CPU");
+            dev_info(artico3_dev->dev, "[i] DMA -> memory address   = %p", sync_token.memaddr);
+            dev_info(artico3_dev->dev, "[i] DMA -> memory offset    = %p", (void *)sync_token.memoff);
+            dev_info(artico3_dev->dev, "[i] DMA -> sync size        = %d bytes", sync_token.size);
+
+            // Critical section: search if the requested memory region is allocated
+            mutex_lock(&artico3_dev->mutex);
+            vm_list = artico3_dma_region(artico3_dev, sync_token.memaddr);
+            if (!vm_list) {
+                dev_err(artico3_dev->dev, "[X] DMA -> memory region not found");
+                retval = -EINVAL;
+            }
+            else if (vm_list->size < (sync_token.memoff + sync_token.size)) {
+                dev_err(artico3_dev->dev, "[X] DMA -> requested sync out of memory region");
+                retval = -EINVAL;
+            }
+            // Cache maintenance (coherent regions do not require it)
+            else if (vm_list->cached) {
+                if (cmd == ARTICo3_IOC_DMA_SYNC_DEV) {
+                    dma_sync_single_range_for_device(artico3_dev->dma[0].chan->device->dev, vm_list->addr_phy, sync_token.memoff, sync_token.size, DMA_BIDIRECTIONAL);
+                }
+                else {
+                    dma_sync_single_range_for_cpu(artico3_dev->dma[0].chan->device->dev, vm_list->addr_phy, sync_token.memoff, sync_token.size, DMA_BIDIRECTIONAL);
+                }
+            }
+            mutex_unlock(&artico3_dev->mutex);
+            break;
+
+        case ARTICo3_IOC_DMA_NCHANS:
+
+            // Copy data to user
+            dev_info(artico3_dev->dev, "[ ] copy_to_user()");
+            res = copy_to_user((void *)arg, &artico3_dev->nchans, sizeof artico3_dev->nchans);
+            if (res) {
+                dev_err(artico3_dev->dev, "[X] copy_to_user()");
+                return -ENOMEM;
+            }
+            dev_info(artico3_dev->dev, "[+] copy_to_user() -> %u channels", artico3_dev->nchans);
+            break;
+
+        case ARTICo3_IOC_DMA_SHARE:
+
+            // Copy data from user
+            dev_info(artico3_dev->dev, "[ ] copy_from_user()");
+            res = copy_from_user(&share_token, (void *)arg, sizeof share_token);
+            if (res) {
+                dev_err(artico3_dev->dev, "[X] copy_from_user()");
+                return -ENOMEM;
+            }
+            dev_info(artico3_dev->dev, "[+] copy_from_user() -> share_token");
+
+            dev_info(artico3_dev->dev, "[i] shared region key = %lu", share_token.key);
+            dev_info(artico3_dev->dev, "[i] shared region pid = %d", share_token.pid);
+
+            // Critical section: only the process that created the region can share it
+            mutex_lock(&artico3_dev->mutex);
+            shared = artico3_shared_region(artico3_dev, share_token.key);
+            if (!shared) {
+                dev_err(artico3_dev->dev, "[X] shared region not found");
+                retval = -EINVAL;
+            }
+            else if (shared->owner != current->tgid) {
+                dev_err(artico3_dev->dev, "[X] shared region not owned by the calling process");
+                retval = -EPERM;
+            }
+            else {
+                shared->pid = share_token.pid;
+            }
+            mutex_unlock(&artico3_dev->mutex);
+            break;
+
+        case ARTICo3_IOC_DMA_REFS:
+
+            // Copy data from user
+            dev_info(artico3_dev->dev, "[ ] copy_from_user()");
+            res = copy_from_user(&share_token, (void *)arg, sizeof share_token);
+            if (res) {
+                dev_err(artico3_dev->dev, "[X] copy_from_user()");
+                return -ENOMEM;
+            }
+            dev_info(artico3_dev->dev, "[+] copy_from_user() -> share_token");
+
+            // Critical section: get number of mappings (regions are released with their last mapping)
+            mutex_lock(&artico3_dev->mutex);
+            shared = artico3_shared_region(artico3_dev, share_token.key);
+            share_token.refs = shared ? shared->refs : 0;
+            mutex_unlock(&artico3_dev->mutex);
+
+            // Copy data to user
+            dev_info(artico3_dev->dev, "[ ] copy_to_user()");
+            res = copy_to_user((void *)arg, &share_token, sizeof share_token);
+            if (res) {
+                dev_err(artico3_dev->dev, "[X] copy_to_user()");
+                return -ENOMEM;
+            }
+            dev_info(artico3_dev->dev, "[+] copy_to_user() -> %u mappings", share_token.refs);
+            break;
+
         default:
             dev_err(artico3_dev->dev, "[i] ioctl() -> command %x does not exist", cmd);
             retval = -ENOTTY;
@@ -471,22 +966,118 @@ static long artico3_ioctl(struct file *fp, unsigned int cmd, unsigned long arg)
     return retval;
 }
 
+// Allocate DMA memory region (coherent, or cached with a streaming DMA mapping)
+//
+// NOTE: DMA memory is allocated for the first channel (all channels are
+//       expected to share the same view of physical memory).  Cached
+//       regions are allocated with the page allocator, and are therefore
+//       limited in size (MAX_ORDER), while coherent ones can use CMA.
+static void *artico3_dma_alloc(struct artico3_device *artico3_dev, size_t size, dma_addr_t *addr_phy, int cached) {
+    struct dma_device *dma_dev = artico3_dev->dma[0].chan->device;
+    void *addr_ker = NULL;
+
+    // Coherent memory (uncached on ARM, no cache maintenance required)
+    if (!cached) {
+        dev_info(dma_dev->dev, "[ ] dma_alloc_coherent()");
+        addr_ker = dma_alloc_coherent(dma_dev->dev, size, addr_phy, GFP_KERNEL);
+        if (!addr_ker) {
+            dev_err(dma_dev->dev, "[X] dma_alloc_coherent()");
+            return NULL;
+        }
+        dev_info(dma_dev->dev, "[+] dma_alloc_coherent()");
+        return addr_ker;
+    }
+
+    // Cached memory (regular pages, mapped for bidirectional streaming DMA)
+    dev_info(dma_dev->dev, "[ ] alloc_pages_exact()");
+    addr_ker = alloc_pages_exact(size, GFP_KERNEL | __GFP_ZERO);
+    if (!addr_ker) {
+        dev_err(dma_dev->dev, "[X] alloc_pages_exact()");
+        return NULL;
+    }
+    dev_info(dma_dev->dev, "[+] alloc_pages_exact()");
+
+    dev_info(dma_dev->dev, "[ ] dma_map_single()");
+    *addr_phy = dma_map_single(dma_dev->dev, addr_ker, size, DMA_BIDIRECTIONAL);
+    if (dma_mapping_error(dma_dev->dev, *addr_phy)) {
+        dev_err(dma_dev->dev, "[X] dma_map_single()");
+        free_pages_exact(addr_ker, size);
+        return NULL;
+    }
+    dev_info(dma_dev->dev, "[+] dma_map_single()");
+    return addr_ker;
+}
+
+// Free DMA memory region (allocated with artico3_dma_alloc())
+static void artico3_dma_free(struct artico3_device *artico3_dev, size_t size, void *addr_ker, dma_addr_t addr_phy, int cached) {
+    struct dma_device *dma_dev = artico3_dev->dma[0].chan->device;
+
+    if (!cached) {
+        dma_free_coherent(dma_dev->dev, size, addr_ker, addr_phy);
+        return;
+    }
+    dma_unmap_single(dma_dev->dev, addr_phy, size, DMA_BIDIRECTIONAL);
+    free_pages_exact(addr_ker, size);
+}
+
+// Map DMA memory region (allocated with artico3_dma_alloc()) to user space
+static int artico3_dma_mmap(struct artico3_device *artico3_dev, struct vm_area_struct *vma, void *addr_ker, dma_addr_t addr_phy, size_t size, int cached) {
+    struct dma_device *dma_dev = artico3_dev->dma[0].chan->device;
+    int res;
+
+    if (!cached) {
+        dev_info(dma_dev->dev, "[ ] dma_mmap_coherent()");
+        res = dma_mmap_coherent(dma_dev->dev, vma, addr_ker, addr_phy, size);
+        if (res) {
+            dev_err(dma_dev->dev, "[X] dma_mmap_coherent() %d", res);
+            return res;
+        }
+        dev_info(dma_dev->dev, "[+] dma_mmap_coherent()");
+        return 0;
+    }
+
+    // Cached mapping (default page protection of the virtual memory area)
+    dev_info(dma_dev->dev, "[ ] remap_pfn_range()");
+    res = remap_pfn_range(vma, vma->vm_start, page_to_pfn(virt_to_page(addr_ker)), size, vma->vm_page_prot);
+    if (res) {
+        dev_err(dma_dev->dev, "[X] remap_pfn_range() %d", res);
+        return res;
+    }
+    dev_info(dma_dev->dev, "[+] remap_pfn_range()");
+    return 0;
+}
+
 // mmap close function (required to free allocated memory) - DMA transfers
 static void artico3_mmap_dma_close(struct vm_area_struct *vma) {
     struct artico3_vm_list *token = vma->vm_private_data;
     struct artico3_device *artico3_dev = token->artico3_dev;
-    struct dma_device *dma_dev = artico3_dev->chan->device;
+    unsigned int ch;
 
     dev_info(artico3_dev->dev, "[ ] munmap()");
     dev_info(artico3_dev->dev, "[i] vma->vm_start = %p", (void *)vma->vm_start);
     dev_info(artico3_dev->dev, "[i] vma->vm_end   = %p", (void *)vma->vm_end);
     dev_info(artico3_dev->dev, "[i] vma size      = %ld bytes", vma->vm_end - vma->vm_start);
 
-    dma_free_coherent(dma_dev->dev, token->size, token->addr_ker, token->addr_phy);
+    // Wait for in-flight DMA transfers (they may target this region)
+    for (ch = 0; ch < artico3_dev->nchans; ch++) {
+        wait_event(artico3_dev->queue, artico3_dma_quiet(artico3_dev, ch));
+    }
 
     // Critical section: remove region from dynamic list
     mutex_lock(&artico3_dev->mutex);
     list_del(&token->list);
+    // Shared regions are only released when their last mapping is removed
+    if (token->shared) {
+        if (--token->shared->refs == 0) {
+            dev_info(artico3_dev->dev, "[i] releasing shared region %lu", token->shared->key);
+            list_del(&token->shared->list);
+            artico3_dma_free(artico3_dev, token->shared->size, token->shared->addr_ker, token->shared->addr_phy, token->shared->cached);
+            kfree(token->shared);
+        }
+    }
+    else {
+        artico3_dma_free(artico3_dev, token->size, token->addr_ker, token->addr_phy, token->cached);
+    }
     mutex_unlock(&artico3_dev->mutex);
 
     kfree(token);
@@ -501,9 +1092,9 @@ static struct vm_operations_struct artico3_mmap_dma_ops = {
 };
 
 // File operation on char device: mmap - DMA transfers
-static int artico3_mmap_dma(struct file *fp, struct vm_area_struct *vma) {
+static int artico3_mmap_dma(struct file *fp, struct vm_area_struct *vma, int cached) {
     struct artico3_device *artico3_dev = fp->private_data;
-    struct dma_device *dma_dev = artico3_dev->chan->device;
+    struct dma_device *dma_dev = artico3_dev->dma[0].chan->device;
     void *addr_vir = NULL;
     dma_addr_t addr_phy;
     struct artico3_vm_list *token = NULL;
@@ -513,27 +1104,22 @@ static int artico3_mmap_dma(struct file *fp, struct vm_area_struct *vma) {
     dev_info(artico3_dev->dev, "[i] vma->vm_start = %p", (void *)vma->vm_start);
     dev_info(artico3_dev->dev, "[i] vma->vm_end   = %p", (void *)vma->vm_end);
     dev_info(artico3_dev->dev, "[i] vma size      = %ld bytes", vma->vm_end - vma->vm_start);
+    dev_info(artico3_dev->dev, "[i] cached        = %d", cached);
 
     // Allocate memory in kernel space
-    dev_info(dma_dev->dev, "[ ] dma_alloc_coherent()");
-    addr_vir = dma_alloc_coherent(dma_dev->dev, vma->vm_end - vma->vm_start, &addr_phy, GFP_KERNEL);
-    if (IS_ERR(addr_vir)) {
-        dev_err(dma_dev->dev, "[X] dma_alloc_coherent()");
-        return PTR_ERR(addr_vir);
+    addr_vir = artico3_dma_alloc(artico3_dev, vma->vm_end - vma->vm_start, &addr_phy, cached);
+    if (!addr_vir) {
+        return -ENOMEM;
     }
-    dev_info(dma_dev->dev, "[+] dma_alloc_coherent()");
-    dev_info(dma_dev->dev, "[i] dma_alloc_coherent() -> %p (virtual)", addr_vir);
-    dev_info(dma_dev->dev, "[i] dma_alloc_coherent() -> %p (physical)", (void *)addr_phy);
-    dev_info(dma_dev->dev, "[i] dma_alloc_coherent() -> %ld bytes", vma->vm_end - vma->vm_start);
+    dev_info(dma_dev->dev, "[i] artico3_dma_alloc() -> %p (virtual)", addr_vir);
+    dev_info(dma_dev->dev, "[i] artico3_dma_alloc() -> %p (physical)", (void *)addr_phy);
+    dev_info(dma_dev->dev, "[i] artico3_dma_alloc() -> %ld bytes", vma->vm_end - vma->vm_start);
 
     // Map kernel-space memory to DMA space
-    dev_info(dma_dev->dev, "[ ] dma_mmap_coherent()");
-    res = dma_mmap_coherent(dma_dev->dev, vma, addr_vir, addr_phy, vma->vm_end - vma->vm_start);
+    res = artico3_dma_mmap(artico3_dev, vma, addr_vir, addr_phy, vma->vm_end - vma->vm_start, cached);
     if (res) {
-        dev_err(dma_dev->dev, "[X] dma_mmap_coherent() %d", res);
         goto err_dma_mmap;
     }
-    dev_info(dma_dev->dev, "[+] dma_mmap_coherent()");
 
     // Create data structure with allocated memory info
     dev_info(artico3_dev->dev, "[ ] kzalloc() -> token");
@@ -551,7 +1137,9 @@ static int artico3_mmap_dma(struct file *fp, struct vm_area_struct *vma) {
     token->addr_ker = addr_vir;
     token->addr_phy = addr_phy;
     token->size = vma->vm_end - vma->vm_start;
-    token->pid = current->pid;
+    token->cached = cached;
+    token->pid = current->tgid;
+    token->shared = NULL;
     INIT_LIST_HEAD(&token->list);
 
     // Critical section: add new region to dynamic list
@@ -571,7 +1159,123 @@ static int artico3_mmap_dma(struct file *fp, struct vm_area_struct *vma) {
 err_kmalloc_token:
 
 err_dma_mmap:
-    dma_free_coherent(dma_dev->dev, vma->vm_end - vma->vm_start, addr_vir, addr_phy);
+    artico3_dma_free(artico3_dev, vma->vm_end - vma->vm_start, addr_vir, addr_phy, cached);
+    return res;
+}
+
+// File operation on char device: mmap - DMA transfers (shared regions)
+//
+// Regions are identified by the mmap() page offset (key). The first
+// mapping of a key allocates the region, and the following ones (with a
+// size that fits in the region) map the same memory. The memory type
+// (coherent or cached) is also set by the first mapping. Only the process
+// that created the region, and the process it has been shared with (see
+// ARTICo3_IOC_DMA_SHARE), can map an existing region.
+static int artico3_mmap_shared(struct file *fp, struct vm_area_struct *vma, unsigned long key, int cached) {
+    struct artico3_device *artico3_dev = fp->private_data;
+    struct artico3_shared *region = NULL;
+    struct artico3_vm_list *token = NULL;
+    size_t size = vma->vm_end - vma->vm_start;
+    int res;
+
+    dev_info(artico3_dev->dev, "[ ] mmap_shared()");
+    dev_info(artico3_dev->dev, "[i] shared region key = %lu", key);
+    dev_info(artico3_dev->dev, "[i] vma size          = %ld bytes", size);
+
+    // Create data structure with allocated memory info
+    dev_info(artico3_dev->dev, "[ ] kzalloc() -> token");
+    token = kzalloc(sizeof *token, GFP_KERNEL);
+    if (!token) {
+        dev_err(artico3_dev->dev, "[X] kzalloc() -> token");
+        return -ENOMEM;
+    }
+    dev_info(artico3_dev->dev, "[+] kzalloc() -> token");
+
+    // Critical section: search region in shared list
+    mutex_lock(&artico3_dev->mutex);
+    region = artico3_shared_region(artico3_dev, key);
+    if (region && (region->owner != current->tgid) && (region->pid != current->tgid)) {
+        dev_err(artico3_dev->dev, "[X] mmap_shared() -> shared region not shared with the calling process");
+        res = -EACCES;
+        goto err_kmalloc_region;
+    }
+
+    // Allocate memory in kernel space (first mapping only)
+    if (!region) {
+        dev_info(artico3_dev->dev, "[ ] kzalloc() -> region");
+        region = kzalloc(sizeof *region, GFP_KERNEL);
+        if (!region) {
+            dev_err(artico3_dev->dev, "[X] kzalloc() -> region");
+            res = -ENOMEM;
+            goto err_kmalloc_region;
+        }
+        dev_info(artico3_dev->dev, "[+] kzalloc() -> region");
+
+        region->addr_ker = artico3_dma_alloc(artico3_dev, size, &region->addr_phy, cached);
+        if (!region->addr_ker) {
+            kfree(region);
+            res = -ENOMEM;
+            goto err_kmalloc_region;
+        }
+
+        region->key = key;
+        region->size = size;
+        region->cached = cached;
+        region->refs = 0;
+        region->owner = current->tgid;
+        region->pid = 0;
+        INIT_LIST_HEAD(&region->list);
+        list_add(&region->list, &artico3_dev->shared);
+    }
+
+    // Size and memory type check
+    if ((size > region->size) || (cached != region->cached)) {
+        dev_err(artico3_dev->dev, "[X] mmap_shared() -> requested map out of shared region");
+        res = -EINVAL;
+        goto err_dma_mmap;
+    }
+
+    // Map kernel-space memory to DMA space
+    res = artico3_dma_mmap(artico3_dev, vma, region->addr_ker, region->addr_phy, size, region->cached);
+    if (res) {
+        goto err_dma_mmap;
+    }
+
+    // Set values in data structure
+    token->artico3_dev = artico3_dev;
+    token->addr_usr = (void *)vma->vm_start;
+    token->addr_ker = region->addr_ker;
+    token->addr_phy = region->addr_phy;
+    token->size = size;
+    token->cached = region->cached;
+    token->pid = current->tgid;
+    token->shared = region;
+    INIT_LIST_HEAD(&token->list);
+
+    // Add new mapping to dynamic list
+    region->refs++;
+    list_add(&token->list, &artico3_dev->head);
+    mutex_unlock(&artico3_dev->mutex);
+
+    // Set virtual memory structure operations
+    vma->vm_ops = &artico3_mmap_dma_ops;
+
+    // Pass data to virtual memory structure (private data) to enable proper cleanup
+    vma->vm_private_data = token;
+
+    dev_info(artico3_dev->dev, "[+] mmap_shared()");
+    return 0;
+
+err_dma_mmap:
+    if (region->refs == 0) {
+        list_del(&region->list);
+        artico3_dma_free(artico3_dev, region->size, region->addr_ker, region->addr_phy, region->cached);
+        kfree(region);
+    }
+
+err_kmalloc_region:
+    mutex_unlock(&artico3_dev->mutex);
+    kfree(token);
     return res;
 }
 
@@ -610,23 +1314,30 @@ static int artico3_mmap_hw(struct file *fp, struct vm_area_struct *vma) {
 static int artico3_mmap(struct file *fp, struct vm_area_struct *vma) {
     struct artico3_device *artico3_dev = fp->private_data;
     int res;
-    int mem_idx = (int)vma->vm_pgoff;
+    int mem_idx = (int)(vma->vm_pgoff & ~ARTICo3_MMAP_CACHED);
+    int cached = (vma->vm_pgoff & ARTICo3_MMAP_CACHED) != 0;
 
     dev_info(artico3_dev->dev, "[ ] mmap()");
     dev_info(artico3_dev->dev, "[i] memory index : %d", mem_idx);
     switch (mem_idx) {
         case 0:
             dev_info(artico3_dev->dev, "[i] ARTICo\u00b3 control map");
+            if (cached) {
+                dev_err(artico3_dev->dev, "[X] mmap() -> control map cannot be cached");
+                res = -EINVAL;
+                break;
+            }
             res = artico3_mmap_hw(fp, vma);
             break;
         case 1:
             dev_info(artico3_dev->dev, "[i] ARTICo\u00b3 data map");
             vma->vm_pgoff = 0; // Trick to avoid errors on dma_mmap_coherent()
-            res = artico3_mmap_dma(fp, vma);
+            res = artico3_mmap_dma(fp, vma, cached);
             break;
         default:
-            dev_info(artico3_dev->dev, "[i] YOU SHOULD NOT BE HERE");
-            res = -EINVAL;
+            dev_info(artico3_dev->dev, "[i] ARTICo\u00b3 shared data map");
+            vma->vm_pgoff = 0; // Trick to avoid errors on dma_mmap_coherent()
+            res = artico3_mmap_shared(fp, vma, mem_idx, cached);
             break;
     }
     dev_info(artico3_dev->dev, "[+] mmap()");
@@ -639,7 +1350,6 @@ static unsigned int artico3_poll(struct file *fp, struct poll_table_struct *wait
     struct artico3_device *artico3_dev = fp->private_data;
     unsigned long flags;
     unsigned int ret, id;
-    enum dma_status status;
 
     dev_info(artico3_dev->dev, "[ ] poll()");
     poll_wait(fp, &artico3_dev->queue, wait);
@@ -648,17 +1358,11 @@ static unsigned int artico3_poll(struct file *fp, struct poll_table_struct *wait
         ret = 0;
 
         //
-        // DMA check
+        // DMA check (first channel, the others use ARTICo3_IOC_DMA_WAIT)
         //
-        // NOTE: this implementation does not consider errors in the data
-        //       transfers.  If the callback is executed, it is assumed
-        //       that the following check will always render DMA_COMPLETE.
-        status = dma_async_is_tx_complete(artico3_dev->chan, artico3_dev->cookie, NULL, NULL);
-        if (status == DMA_COMPLETE) {
+        if (artico3_dma_idle(artico3_dev, 0)) {
             dev_info(artico3_dev->dev, "[i] poll() : ret |= POLLDMA");
             ret |= POLLDMA;
-            // Release mutex (acquired in artico3_ioctl() before DMA transfer)
-            mutex_unlock(&artico3_dev->mutex);
         }
 
         //
@@ -808,6 +1512,7 @@ static int artico3_probe(struct platform_device *pdev) {
 
     // Initialize list head
     INIT_LIST_HEAD(&artico3_dev->head);
+    INIT_LIST_HEAD(&artico3_dev->shared);
 
     // Pass platform device pointer to custom device structure
     artico3_dev->pdev = pdev;
@@ -8,14 +8,19 @@
  *     - Platform driver + character device
  *     - mmap()  : provides 1) zero-copy memory allocation (direct access
  *                 from user-space virtual memory to physical memory) for
- *                 data transfers using a DMA engine, and 2) direct access
- *                 to ARTICo³ configuration registers in the FPGA
+ *                 data transfers using a DMA engine, 2) direct access
+ *                 to ARTICo³ configuration registers in the FPGA, and 3)
+ *                 DMA memory regions shared between processes (by key)
  *     - ioctl() : enables command passing between user-space and
  *                 character device (e.g., to start DMA transfers)
  *     - poll()  : enables passive (i.e., sleep-based) waiting capabilities
  *                 for 1) DMA interrupts, and 2) ARTICo³ interrupts
  *     - [DMA] Targets memcpy operations (requires src and dst addresses)
  *     - [DMA] Relies on Device Tree (Open Firmware) to get DMA engine info
+ *     - [DMA] Supports several DMA channels (one per "dma-names" entry),
+ *             with independent completion tracking per channel
+ *     - [DMA] Supports coherent (uncached on ARM) and cached DMA memory
+ *             regions, the latter with explicit cache maintenance (ioctl)
  *
  */
 
@@ -33,6 +38,7 @@
  * @hwaddr  - hardware address
  * @hwoff   - hardware address offset
  * @size    - number of bytes to be transferred
+ * @channel - DMA channel (0 - number of channels - 1)
  *
  */
 struct dmaproxy_token {
@@ -41,30 +47,126 @@ struct dmaproxy_token {
     void *hwaddr;
     size_t hwoff;
     size_t size;
+    unsigned int channel;
+};
+
+
+/*
+ * Scatter-gather segment to use DMA proxy devices via ioctl()
+ *
+ * @memaddr - memory address (DMA memory region obtained with mmap())
+ * @memoff  - memory address offset
+ * @hwoff   - hardware address offset
+ * @size    - number of bytes to be transferred
+ *
+ */
+struct dmaproxy_segment {
+    void *memaddr;
+    size_t memoff;
+    size_t hwoff;
+    size_t size;
+};
+
+
+/*
+ * Scatter-gather data structure to use DMA proxy devices via ioctl()
+ *
+ * Segments are chained and transferred in order, as a single DMA
+ * transfer (i.e. only one completion is reported to poll()). Every
+ * segment has to address the same kernel ID (bits 16-19 of @hwoff).
+ *
+ * @hwaddr  - hardware address
+ * @nsegs   - number of segments (1 - ARTICo3_DMA_MAXSEGS)
+ * @segs    - list of segments
+ * @channel - DMA channel (0 - number of channels - 1)
+ *
+ */
+struct dmaproxy_sg_token {
+    void *hwaddr;
+    size_t nsegs;
+    struct dmaproxy_segment *segs;
+    unsigned int channel;
+};
+
+
+/*
+ * Cache maintenance data structure to use DMA proxy devices via ioctl()
+ *
+ * @memaddr - memory address (DMA memory region obtained with mmap())
+ * @memoff  - memory address offset
+ * @size    - number of bytes to be synchronized
+ *
+ */
+struct dmaproxy_sync_token {
+    void *memaddr;
+    size_t memoff;
+    size_t size;
+};
+
+
+/*
+ * Shared DMA region data structure to use DMA proxy devices via ioctl()
+ *
+ * @key  - shared DMA region key (mmap() page offset, without ARTICo3_MMAP_CACHED)
+ * @pid  - process allowed to map the region (besides the one that created it)
+ * @refs - number of mappings of the region (0 if the region does not exist)
+ *
+ */
+struct dmaproxy_share_token {
+    unsigned long key;
+    int pid;
+    unsigned int refs;
 };
 
 
 /*
  * IOCTL definitions for DMA proxy devices
  *
- * dma_mem2hw - start transfer from main memory to hardware device
- * dma_hw2mem - start transfer from hardware device to main memory
+ * dma_mem2hw    - start transfer from main memory to hardware device
+ * dma_hw2mem    - start transfer from hardware device to main memory
+ * dma_mem2hw_sg - start scatter-gather transfer from main memory to hardware device
+ * dma_hw2mem_sg - start scatter-gather transfer from hardware device to main memory
+ * dma_wait      - wait for the last transfer in a DMA channel to finish
+ * dma_nchans    - get number of DMA channels
+ * dma_sync_dev  - give ownership of a DMA memory range to the device (before
+ *                 any DMA transfer: CPU caches are written back and invalidated)
+ * dma_sync_cpu  - give ownership of a DMA memory range back to the CPU (after
+ *                 a transfer from hardware device: CPU caches are invalidated)
+ * dma_share     - allow a process to map a shared DMA region (only the
+ *                 process that created the region can share it)
+ * dma_refs      - get number of mappings of a shared DMA region
+ *
+ * Each DMA channel accepts one transfer at a time (a new transfer waits
+ * for the previous one to finish), while transfers in different channels
+ * run concurrently. Cache maintenance is only performed in cached DMA
+ * memory regions (see ARTICo3_MMAP_CACHED), and is a no-op otherwise.
  *
  */
 
 
 #define ARTICo3_IOC_MAGIC 'x'
 
-#define ARTICo3_IOC_DMA_MEM2HW _IOW(ARTICo3_IOC_MAGIC, 0, struct dmaproxy_token)
-#define ARTICo3_IOC_DMA_HW2MEM _IOW(ARTICo3_IOC_MAGIC, 1, struct dmaproxy_token)
+#define ARTICo3_IOC_DMA_MEM2HW    _IOW(ARTICo3_IOC_MAGIC, 0, struct dmaproxy_token)
+#define ARTICo3_IOC_DMA_HW2MEM    _IOW(ARTICo3_IOC_MAGIC, 1, struct dmaproxy_token)
+#define ARTICo3_IOC_DMA_MEM2HW_SG _IOW(ARTICo3_IOC_MAGIC, 2, struct dmaproxy_sg_token)
+#define ARTICo3_IOC_DMA_HW2MEM_SG _IOW(ARTICo3_IOC_MAGIC, 3, struct dmaproxy_sg_token)
+#define ARTICo3_IOC_DMA_WAIT      _IOW(ARTICo3_IOC_MAGIC, 4, unsigned int)
+#define ARTICo3_IOC_DMA_NCHANS    _IOR(ARTICo3_IOC_MAGIC, 5, unsigned int)
+#define ARTICo3_IOC_DMA_SYNC_DEV  _IOW(ARTICo3_IOC_MAGIC, 6, struct dmaproxy_sync_token)
+#define ARTICo3_IOC_DMA_SYNC_CPU  _IOW(ARTICo3_IOC_MAGIC, 7, struct dmaproxy_sync_token)
+#define ARTICo3_IOC_DMA_SHARE     _IOW(ARTICo3_IOC_MAGIC, 8, struct dmaproxy_share_token)
+#define ARTICo3_IOC_DMA_REFS      _IOWR(ARTICo3_IOC_MAGIC, 9, struct dmaproxy_share_token)
+
+#define ARTICo3_IOC_MAXNR 9
 
-#define ARTICo3_IOC_MAXNR 1
+#define ARTICo3_DMA_MAXSEGS  (4096)
+#define ARTICo3_DMA_MAXCHANS (8)
 
 
 /*
  * poll() definitions for ARTICo³
  *
- * polldma - wait for DMA transfer to finish
+ * polldma - wait for DMA transfer to finish (first DMA channel)
  * pollirq - wait for ARTICo³ accelerators to finish
  *           1 << kernel_id [kernel_id < 3]
  *           1 << (kernel_id + 3) [kernel_id >= 3]*
@@ -76,6 +178,29 @@ struct dmaproxy_token {
 #define POLLDMA 0x0001
 #define POLLIRQ(id) ((id) < 3 ? (1 << (id)) : (1 << (id) + 3))
 
+/*
+ * mmap() definitions for ARTICo³ (page offsets)
+ *
+ * mmap_hw     - ARTICo³ configuration registers
+ * mmap_dma    - DMA memory region (private to the mapping)
+ * mmap_shared - first DMA memory region shared between processes
+ *               (the page offset is used as region key, and mappings
+ *               of the same key share the memory allocated by the first
+ *               one until all of them are removed). Existing regions can
+ *               only be mapped by the process that created them, and by
+ *               the process they are shared with (see dma_share)
+ * mmap_cached - flag to be OR-ed with mmap_dma and mmap_shared offsets
+ *               to allocate cached DMA memory instead of coherent memory
+ *               (requires dma_sync_dev/dma_sync_cpu around each transfer,
+ *               and is limited in size by the kernel page allocator)
+ *
+ */
+
+#define ARTICo3_MMAP_HW     (0)
+#define ARTICo3_MMAP_DMA    (1)
+#define ARTICo3_MMAP_SHARED (2)
+#define ARTICo3_MMAP_CACHED (0x20000)
+
 /*
  * Hardware definitions for ARTICo³
  *